@@ -0,0 +1,53 @@
+//===- ADTBench - Benchmark the ADT containers ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program measures the throughput of the ADT containers on key sets that
+// look like the ones the compiler actually works with. It prints the number
+// of operations per second of each benchmark and the memory footprint of each
+// container.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/Support/CommandLine.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace bench;
+
+static cl::opt<unsigned>
+NumKeys("keys", cl::desc("Number of elements to benchmark with"),
+        cl::init(200000));
+
+static cl::opt<unsigned>
+Repeat("repeat", cl::desc("Number of runs of each benchmark; the fastest one "
+                          "is reported"),
+       cl::init(5));
+
+static cl::opt<std::string>
+Filter("filter", cl::desc("Only run the benchmarks whose name contains this "
+                          "string"));
+
+static cl::opt<bool>
+Verify("verify", cl::desc("Run a quick verification useful for regression "
+                          "testing"),
+       cl::init(false));
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "ADT container benchmarks\n");
+  if (Verify) {
+    NumKeys = 1000;
+    Repeat = 1;
+  }
+
+  BenchmarkRunner Runner(std::max(1u, unsigned(NumKeys)),
+                         std::max(1u, unsigned(Repeat)), Filter, Verify);
+  BenchmarkSuite::runAll(Runner);
+  return 0;
+}
@@ -0,0 +1,188 @@
+//===- Benchmark.cpp - Timing harness for the ADT benchmarks --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace bench;
+
+volatile size_t bench::Sink;
+
+void BenchmarkRunner::reportTime(StringRef Name, size_t Ops, double Seconds) {
+  outs() << format("%-40s", Name.str().c_str());
+  if (Verify)
+    outs() << "ok\n";
+  else
+    outs() << format("%10.2f Mops/s\n", Seconds > 0 ? Ops / Seconds / 1e6
+                                                    : 0.0);
+}
+
+void BenchmarkRunner::reportMemory(StringRef Name, size_t Bytes,
+                                   size_t NumElements) {
+  outs() << format("%-40s", Name.str().c_str());
+  if (Verify)
+    outs() << "ok\n";
+  else
+    outs() << format("%10.2f bytes/elt\n",
+                     NumElements ? double(Bytes) / NumElements : 0.0);
+}
+
+namespace {
+typedef std::pair<const char *, BenchmarkSuite::RunFn> SuiteEntry;
+}
+
+/// The registered suites. This is a function-local static because suites are
+/// registered by static constructors in other files.
+static std::vector<SuiteEntry> &getSuites() {
+  static std::vector<SuiteEntry> Suites;
+  return Suites;
+}
+
+BenchmarkSuite::BenchmarkSuite(const char *Name, RunFn Run) {
+  getSuites().push_back(SuiteEntry(Name, Run));
+}
+
+void BenchmarkSuite::runAll(BenchmarkRunner &Runner) {
+  std::vector<SuiteEntry> Suites = getSuites();
+  // The order of static construction is unspecified; sort for stable output.
+  std::sort(Suites.begin(), Suites.end(),
+            [](const SuiteEntry &A, const SuiteEntry &B) {
+              return std::strcmp(A.first, B.first) < 0;
+            });
+  for (const SuiteEntry &S : Suites)
+    S.second(Runner);
+}
+
+namespace {
+/// Builds symbol names out of words that are common in C++ identifiers.
+class SymbolNameGenerator {
+  std::mt19937 Rand;
+
+  StringRef pickWord() {
+    static const char *const Words[] = {
+        "llvm",     "clang",   "detail",    "DenseMap",  "SmallVector",
+        "StringRef", "Value",  "Instruction", "BasicBlock", "Function",
+        "Module",   "Type",    "Pass",      "Analysis",  "Info",
+        "get",      "set",     "create",    "run",       "visit",
+        "Impl",     "Base",    "Builder",   "Context",   "Manager",
+        "iterator", "size",    "insert",    "erase",     "find",
+        "operator", "Node",    "Graph",     "Loop",      "Scalar",
+        "Register", "Machine", "Target",    "Lowering",  "Selection"};
+    return Words[Rand() % array_lengthof(Words)];
+  }
+
+  std::string makeIdentifier(unsigned NumWords) {
+    std::string Id;
+    for (unsigned I = 0; I != NumWords; ++I)
+      Id += pickWord();
+    return Id;
+  }
+
+  static void appendSourceName(std::string &Name, StringRef Id) {
+    Name += utostr(Id.size());
+    Name += Id;
+  }
+
+public:
+  explicit SymbolNameGenerator(unsigned Seed) : Rand(Seed) {}
+
+  /// Returns a name containing \p Serial, which makes it distinct from the
+  /// names generated for other serial numbers.
+  std::string next(unsigned Serial) {
+    unsigned Kind = Rand() % 10;
+    std::string Unique = makeIdentifier(1) + utostr(Serial);
+    if (Kind == 0)
+      return ".LBB" + utostr(Serial) + "_" + utostr(Rand() % 64);
+    if (Kind <= 2)
+      return makeIdentifier(1 + Rand() % 2) + "_" + Unique;
+
+    std::string Name = "_ZN";
+    for (unsigned I = 0, E = 1 + Rand() % 3; I != E; ++I)
+      appendSourceName(Name, makeIdentifier(1 + Rand() % 2));
+    appendSourceName(Name, Unique);
+    if (Kind <= 5) {
+      Name += "I";
+      for (unsigned I = 0, E = 1 + Rand() % 2; I != E; ++I) {
+        Name += "PN4llvm";
+        appendSourceName(Name, makeIdentifier(1));
+        Name += "E";
+      }
+      Name += "E";
+    }
+    Name += "E";
+    static const char *const Params[] = {"v", "j", "RKS_", "PKcj", "S0_S1_"};
+    Name += Params[Rand() % array_lengthof(Params)];
+    return Name;
+  }
+};
+}
+
+std::vector<std::string> bench::generateSymbolNames(unsigned N,
+                                                    unsigned Seed) {
+  SymbolNameGenerator Gen(Seed);
+  std::vector<std::string> Names;
+  Names.reserve(N);
+  for (unsigned I = 0; I != N; ++I)
+    Names.push_back(Gen.next(Seed * N + I));
+  return Names;
+}
+
+std::vector<const void *> bench::generatePointers(unsigned N,
+                                                  BumpPtrAllocator &Alloc,
+                                                  unsigned Seed) {
+  std::mt19937 Rand(Seed);
+  std::vector<const void *> Pointers;
+  Pointers.reserve(N);
+  for (unsigned I = 0; I != N; ++I) {
+    // Most objects are small; a few, like functions and basic blocks, are
+    // larger.
+    size_t Size =
+        Rand() % 8 ? 32 + 8 * (Rand() % 8) : 128 + 16 * (Rand() % 16);
+    Pointers.push_back(Alloc.Allocate(Size, 8));
+  }
+  return Pointers;
+}
+
+std::vector<unsigned> bench::generateClusteredInts(unsigned N,
+                                                   unsigned Seed) {
+  std::mt19937 Rand(Seed);
+  std::vector<unsigned> Ints;
+  Ints.reserve(N);
+  unsigned Next = 0;
+  while (Ints.size() != N) {
+    Next += 1 + Rand() % 64;
+    for (unsigned Len = 1 + Rand() % 16; Len && Ints.size() != N; --Len)
+      Ints.push_back(Next++);
+  }
+  std::shuffle(Ints.begin(), Ints.end(), Rand);
+  return Ints;
+}
+
+std::vector<std::pair<unsigned, unsigned>>
+bench::generateIntervals(unsigned N, unsigned Seed) {
+  std::mt19937 Rand(Seed);
+  std::vector<std::pair<unsigned, unsigned>> Intervals;
+  Intervals.reserve(N);
+  unsigned Start = 0;
+  for (unsigned I = 0; I != N; ++I) {
+    // Slot indexes are spaced 16 apart for each instruction.
+    Start += 16 * (1 + Rand() % 4);
+    unsigned End = Start + 16 * (1 + Rand() % 8);
+    Intervals.push_back(std::make_pair(Start, End));
+    Start = End;
+  }
+  std::shuffle(Intervals.begin(), Intervals.end(), Rand);
+  return Intervals;
+}
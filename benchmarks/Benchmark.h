@@ -0,0 +1,128 @@
+//===- Benchmark.h - Timing harness for the ADT benchmarks ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the harness shared by the container benchmarks: a runner
+// that times benchmarks and measures the memory footprint of containers, the
+// registry of benchmark suites and generators for realistic key sets.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BENCHMARKS_BENCHMARK_H
+#define LLVM_BENCHMARKS_BENCHMARK_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Timer.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+namespace bench {
+
+/// Results are accumulated here so that the work that produced them cannot be
+/// optimized away.
+extern volatile size_t Sink;
+
+/// Times benchmarks and prints one line of results for each of them.
+class BenchmarkRunner {
+  unsigned NumKeys;
+  unsigned Repeat;
+  std::string Filter;
+  bool Verify;
+
+  bool isEnabled(StringRef Name) const {
+    return Name.find(Filter) != StringRef::npos;
+  }
+  void reportTime(StringRef Name, size_t Ops, double Seconds);
+  void reportMemory(StringRef Name, size_t Bytes, size_t NumElements);
+
+public:
+  BenchmarkRunner(unsigned NumKeys, unsigned Repeat, StringRef Filter,
+                  bool Verify)
+      : NumKeys(NumKeys), Repeat(Repeat), Filter(Filter), Verify(Verify) {}
+
+  /// Returns the number of elements each benchmark should work on.
+  unsigned getNumKeys() const { return NumKeys; }
+
+  /// Calls \p Body repeatedly and reports the throughput of the fastest run.
+  /// \p Body returns the number of operations it performed.
+  template <class BodyTy> void run(StringRef Name, BodyTy Body) {
+    if (!isEnabled(Name))
+      return;
+    double Best = 0;
+    size_t Ops = 0;
+    for (unsigned I = 0; I != Repeat; ++I) {
+      TimeRecord Start = TimeRecord::getCurrentTime(true);
+      Ops = Body();
+      TimeRecord End = TimeRecord::getCurrentTime(false);
+      double Elapsed = End.getWallTime() - Start.getWallTime();
+      if (I == 0 || Elapsed < Best)
+        Best = Elapsed;
+    }
+    reportTime(Name, Ops, Best);
+  }
+
+  /// Reports the heap memory used by the container that \p Build returns,
+  /// per element. \p Build returns the container through a std::unique_ptr,
+  /// so that the container object itself is counted, and must not leave other
+  /// allocations behind.
+  template <class BuildTy>
+  void measureMemory(StringRef Name, size_t NumElements, BuildTy Build) {
+    if (!isEnabled(Name))
+      return;
+    size_t Before = sys::Process::GetMallocUsage();
+    auto Container = Build();
+    size_t After = sys::Process::GetMallocUsage();
+    reportMemory(Name, After > Before ? After - Before : 0, NumElements);
+  }
+};
+
+/// A set of related benchmarks, usually those of one container. Suites
+/// register themselves by defining a static BenchmarkSuite object.
+class BenchmarkSuite {
+public:
+  typedef void (*RunFn)(BenchmarkRunner &Runner);
+
+  BenchmarkSuite(const char *Name, RunFn Run);
+
+  /// Runs all registered suites in the order of their names.
+  static void runAll(BenchmarkRunner &Runner);
+};
+
+/// Returns \p N distinct symbol names with roughly the distribution seen in
+/// the symbol tables of large C++ programs: mostly Itanium-mangled nested
+/// names, some of them template instantiations, plus plain C identifiers and
+/// assembler-local labels. Sets of the same size generated with different
+/// seeds are disjoint.
+std::vector<std::string> generateSymbolNames(unsigned N, unsigned Seed);
+
+/// Allocates \p N objects of the varying sizes typical of IR objects and
+/// returns their addresses in allocation order. The addresses are clustered
+/// in slabs like those of Values, Instructions and MachineInstrs.
+std::vector<const void *> generatePointers(unsigned N, BumpPtrAllocator &Alloc,
+                                           unsigned Seed);
+
+/// Returns \p N distinct integers in random order that form runs of
+/// consecutive values with gaps in between, like register or instruction
+/// numbers in a live set.
+std::vector<unsigned> generateClusteredInts(unsigned N, unsigned Seed);
+
+/// Returns \p N disjoint half-open intervals with gaps in between, like the
+/// live segments of a virtual register in slot index order.
+std::vector<std::pair<unsigned, unsigned>> generateIntervals(unsigned N,
+                                                             unsigned Seed);
+
+} // end namespace bench
+} // end namespace llvm
+
+#endif
@@ -0,0 +1,93 @@
+//===- DenseMapBench.cpp - DenseMap benchmarks ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissMap.h"
+#include "llvm/ADT/Twine.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+/// Benchmarks a map of type \p MapTy from \p Keys, none of which is in
+/// \p Missing.
+template <class MapTy, class KeyT>
+static void runMapBenchmarks(BenchmarkRunner &Runner, StringRef Name,
+                             const std::vector<KeyT> &Keys,
+                             const std::vector<KeyT> &Missing) {
+  unsigned N = Keys.size();
+
+  Runner.run((Name + "/insert").str(), [&] {
+    MapTy Map;
+    for (unsigned I = 0; I != N; ++I)
+      Map[Keys[I]] = I;
+    Sink = Map.size();
+    return N;
+  });
+
+  MapTy Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[Keys[I]] = I;
+  std::vector<KeyT> Lookups = Keys;
+  std::shuffle(Lookups.begin(), Lookups.end(), std::mt19937(1));
+  Runner.run((Name + "/lookup-hit").str(), [&] {
+    size_t Found = 0;
+    for (const KeyT &K : Lookups)
+      Found += Map.find(K)->second;
+    Sink = Found;
+    return N;
+  });
+  Runner.run((Name + "/lookup-miss").str(), [&] {
+    size_t Found = 0;
+    for (const KeyT &K : Missing)
+      Found += Map.count(K);
+    Sink = Found;
+    return Missing.size();
+  });
+  Runner.run((Name + "/iterate").str(), [&] {
+    size_t Sum = 0;
+    for (const auto &Entry : Map)
+      Sum += Entry.second;
+    Sink = Sum;
+    return Map.size();
+  });
+
+  Runner.measureMemory((Name + "/memory").str(), N, [&] {
+    std::unique_ptr<MapTy> M(new MapTy());
+    for (unsigned I = 0; I != N; ++I)
+      (*M)[Keys[I]] = I;
+    return M;
+  });
+}
+
+static void runDenseMapBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+
+  BumpPtrAllocator Alloc;
+  std::vector<const void *> Pointers = generatePointers(N, Alloc, 0);
+  std::vector<const void *> MissingPointers = generatePointers(N, Alloc, 1);
+  runMapBenchmarks<DenseMap<const void *, unsigned>>(
+      Runner, "DenseMap<ptr>", Pointers, MissingPointers);
+  runMapBenchmarks<SwissMap<const void *, unsigned>>(
+      Runner, "SwissMap<ptr>", Pointers, MissingPointers);
+
+  // The integers are shuffled, so the missing half is interleaved with the
+  // keys that are in the map.
+  std::vector<unsigned> Ints = generateClusteredInts(2 * N, 0);
+  std::vector<unsigned> Keys(Ints.begin(), Ints.begin() + N);
+  std::vector<unsigned> Missing(Ints.begin() + N, Ints.end());
+  runMapBenchmarks<DenseMap<unsigned, unsigned>>(Runner, "DenseMap<unsigned>",
+                                                 Keys, Missing);
+  runMapBenchmarks<SwissMap<unsigned, unsigned>>(Runner, "SwissMap<unsigned>",
+                                                 Keys, Missing);
+}
+
+static BenchmarkSuite X("DenseMap", runDenseMapBenchmarks);
@@ -0,0 +1,130 @@
+//===- FoldingSetBench.cpp - FoldingSet benchmarks ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/FoldingSet.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+namespace {
+/// The operands of a node, which identify it.
+struct NodeKey {
+  unsigned Opcode;
+  const void *Ops[2];
+};
+
+/// A uniqued node in the style of SDNode or SCEV.
+struct Node : FoldingSetNode {
+  NodeKey Key;
+
+  explicit Node(const NodeKey &Key) : Key(Key) {}
+
+  static void Profile(FoldingSetNodeID &ID, const NodeKey &Key) {
+    ID.AddInteger(Key.Opcode);
+    ID.AddPointer(Key.Ops[0]);
+    ID.AddPointer(Key.Ops[1]);
+  }
+  void Profile(FoldingSetNodeID &ID) const { Profile(ID, Key); }
+};
+
+/// A set of uniqued nodes and the allocator that owns them.
+struct NodeSet {
+  BumpPtrAllocator Alloc;
+  FoldingSet<Node> Set;
+
+  Node *find(const NodeKey &Key) {
+    FoldingSetNodeID ID;
+    Node::Profile(ID, Key);
+    void *InsertPos;
+    return Set.FindNodeOrInsertPos(ID, InsertPos);
+  }
+
+  Node *getOrInsert(const NodeKey &Key) {
+    FoldingSetNodeID ID;
+    Node::Profile(ID, Key);
+    void *InsertPos;
+    if (Node *N = Set.FindNodeOrInsertPos(ID, InsertPos))
+      return N;
+    Node *N = new (Alloc.Allocate<Node>()) Node(Key);
+    Set.InsertNode(N, InsertPos);
+    return N;
+  }
+};
+}
+
+static std::vector<NodeKey> generateNodeKeys(unsigned N,
+                                             ArrayRef<const void *> Operands,
+                                             unsigned Seed) {
+  std::mt19937 Rand(Seed);
+  std::vector<NodeKey> Keys(N);
+  for (NodeKey &K : Keys) {
+    K.Opcode = Rand() % 32;
+    K.Ops[0] = Operands[Rand() % Operands.size()];
+    K.Ops[1] = Operands[Rand() % Operands.size()];
+  }
+  return Keys;
+}
+
+static void runFoldingSetBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  BumpPtrAllocator Alloc;
+  std::vector<const void *> Operands = generatePointers(N, Alloc, 0);
+  // Operands are drawn from a large pool, so the rare duplicate keys are
+  // uniqued just like the duplicates a real DAG would produce.
+  std::vector<NodeKey> Keys = generateNodeKeys(N, Operands, 0);
+  std::vector<NodeKey> Missing = generateNodeKeys(N, Operands, 1);
+
+  Runner.run("FoldingSet/insert", [&] {
+    NodeSet Nodes;
+    for (const NodeKey &K : Keys)
+      Nodes.getOrInsert(K);
+    Sink = Nodes.Set.size();
+    return N;
+  });
+
+  NodeSet Nodes;
+  for (const NodeKey &K : Keys)
+    Nodes.getOrInsert(K);
+  std::vector<NodeKey> Lookups = Keys;
+  std::shuffle(Lookups.begin(), Lookups.end(), std::mt19937(1));
+  Runner.run("FoldingSet/lookup-hit", [&] {
+    size_t Found = 0;
+    for (const NodeKey &K : Lookups)
+      Found += Nodes.find(K) != nullptr;
+    Sink = Found;
+    return N;
+  });
+  Runner.run("FoldingSet/lookup-miss", [&] {
+    size_t Found = 0;
+    for (const NodeKey &K : Missing)
+      Found += Nodes.find(K) != nullptr;
+    Sink = Found;
+    return N;
+  });
+  Runner.run("FoldingSet/iterate", [&] {
+    size_t Sum = 0;
+    for (const Node &Nd : Nodes.Set)
+      Sum += Nd.Key.Opcode;
+    Sink = Sum;
+    return Nodes.Set.size();
+  });
+
+  // This includes the nodes, which embed the set's links.
+  Runner.measureMemory("FoldingSet/memory", N, [&] {
+    std::unique_ptr<NodeSet> S(new NodeSet());
+    for (const NodeKey &K : Keys)
+      S->getOrInsert(K);
+    return S;
+  });
+}
+
+static BenchmarkSuite X("FoldingSet", runFoldingSetBenchmarks);
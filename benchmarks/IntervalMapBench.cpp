@@ -0,0 +1,84 @@
+//===- IntervalMapBench.cpp - IntervalMap benchmarks ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/IntervalMap.h"
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+typedef IntervalMap<unsigned, unsigned> MapTy;
+
+namespace {
+/// An interval map and the allocator of its nodes.
+struct IntervalMapWithAllocator {
+  MapTy::Allocator Alloc;
+  MapTy Map;
+
+  IntervalMapWithAllocator() : Map(Alloc) {}
+};
+}
+
+/// Inserts the half-open \p Intervals with distinct values, so that none of
+/// them are coalesced.
+static void insertIntervals(MapTy &Map,
+                            ArrayRef<std::pair<unsigned, unsigned>> Intervals) {
+  for (unsigned I = 0, E = Intervals.size(); I != E; ++I)
+    Map.insert(Intervals[I].first, Intervals[I].second - 1, I + 1);
+}
+
+static void runIntervalMapBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  // Insert the intervals in random order, the way live ranges are added to a
+  // LiveIntervalUnion.
+  std::vector<std::pair<unsigned, unsigned>> Intervals =
+      generateIntervals(N, 0);
+
+  Runner.run("IntervalMap/insert", [&] {
+    IntervalMapWithAllocator M;
+    insertIntervals(M.Map, Intervals);
+    Sink = M.Map.stop();
+    return N;
+  });
+
+  IntervalMapWithAllocator M;
+  insertIntervals(M.Map, Intervals);
+  Runner.run("IntervalMap/lookup-hit", [&] {
+    size_t Sum = 0;
+    for (const auto &I : Intervals)
+      Sum += M.Map.lookup((I.first + I.second) / 2);
+    Sink = Sum;
+    return N;
+  });
+  // Intervals are separated by gaps, so the slot before each one is free.
+  Runner.run("IntervalMap/lookup-miss", [&] {
+    size_t Sum = 0;
+    for (const auto &I : Intervals)
+      Sum += M.Map.lookup(I.first - 1);
+    Sink = Sum;
+    return N;
+  });
+  Runner.run("IntervalMap/iterate", [&] {
+    size_t Sum = 0, Count = 0;
+    for (MapTy::const_iterator I = M.Map.begin(); I.valid(); ++I, ++Count)
+      Sum += I.stop() - I.start();
+    Sink = Sum;
+    return Count;
+  });
+
+  Runner.measureMemory("IntervalMap/memory", N, [&] {
+    std::unique_ptr<IntervalMapWithAllocator> Result(
+        new IntervalMapWithAllocator());
+    insertIntervals(Result->Map, Intervals);
+    return Result;
+  });
+}
+
+static BenchmarkSuite X("IntervalMap", runIntervalMapBenchmarks);
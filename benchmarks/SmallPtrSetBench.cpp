@@ -0,0 +1,81 @@
+//===- SmallPtrSetBench.cpp - SmallPtrSet benchmarks ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+typedef SmallPtrSet<const void *, 8> SetTy;
+
+static void runSmallPtrSetBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  BumpPtrAllocator Alloc;
+  std::vector<const void *> Keys = generatePointers(N, Alloc, 0);
+  std::vector<const void *> Missing = generatePointers(N, Alloc, 1);
+
+  // A single large set, like a visited set over a whole function.
+  Runner.run("SmallPtrSet/insert", [&] {
+    SetTy Set;
+    for (const void *K : Keys)
+      Set.insert(K);
+    Sink = Set.size();
+    return N;
+  });
+
+  SetTy Set(Keys.begin(), Keys.end());
+  std::vector<const void *> Lookups = Keys;
+  std::shuffle(Lookups.begin(), Lookups.end(), std::mt19937(1));
+  Runner.run("SmallPtrSet/lookup-hit", [&] {
+    size_t Found = 0;
+    for (const void *K : Lookups)
+      Found += Set.count(K);
+    Sink = Found;
+    return N;
+  });
+  Runner.run("SmallPtrSet/lookup-miss", [&] {
+    size_t Found = 0;
+    for (const void *K : Missing)
+      Found += Set.count(K);
+    Sink = Found;
+    return N;
+  });
+  Runner.run("SmallPtrSet/iterate", [&] {
+    uintptr_t Sum = 0;
+    for (const void *K : Set)
+      Sum += reinterpret_cast<uintptr_t>(K);
+    Sink = Sum;
+    return Set.size();
+  });
+
+  // Many sets that stay in small mode, like the predecessor or operand sets
+  // built by most passes.
+  const unsigned SmallSize = 6;
+  Runner.run("SmallPtrSet/small-insert-lookup", [&] {
+    size_t Found = 0;
+    for (unsigned I = 0; I + SmallSize <= N; I += SmallSize) {
+      SetTy Small;
+      for (unsigned J = 0; J != SmallSize; ++J)
+        Small.insert(Keys[I + J]);
+      for (unsigned J = 0; J != SmallSize; ++J)
+        Found += Small.count(Keys[I + J]) + Small.count(Missing[I + J]);
+    }
+    Sink = Found;
+    return N / SmallSize * SmallSize * 3;
+  });
+
+  Runner.measureMemory("SmallPtrSet/memory", N, [&] {
+    return std::unique_ptr<SetTy>(new SetTy(Keys.begin(), Keys.end()));
+  });
+}
+
+static BenchmarkSuite X("SmallPtrSet", runSmallPtrSetBenchmarks);
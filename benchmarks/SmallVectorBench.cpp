@@ -0,0 +1,85 @@
+//===- SmallVectorBench.cpp - SmallVector benchmarks ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+typedef SmallVector<unsigned, 4> VectorTy;
+
+/// Returns the sizes of vectors holding \p N elements in total. Most vectors
+/// are short, like operand or successor lists, and a few are long enough to
+/// leave the inline storage.
+static std::vector<unsigned> generateSizes(unsigned N) {
+  std::mt19937 Rand(0);
+  std::vector<unsigned> Sizes;
+  unsigned Total = 0;
+  while (Total < N) {
+    unsigned Size = Rand() % 16 ? Rand() % 5 : 5 + Rand() % 60;
+    Size = std::min(Size, N - Total);
+    Sizes.push_back(Size);
+    Total += Size;
+  }
+  return Sizes;
+}
+
+static void buildVectors(std::vector<VectorTy> &Vectors,
+                         const std::vector<unsigned> &Sizes) {
+  Vectors.resize(Sizes.size());
+  unsigned Value = 0;
+  for (unsigned I = 0, E = Sizes.size(); I != E; ++I)
+    for (unsigned J = 0; J != Sizes[I]; ++J)
+      Vectors[I].push_back(Value++);
+}
+
+static void runSmallVectorBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  std::vector<unsigned> Sizes = generateSizes(N);
+
+  Runner.run("SmallVector/push_back", [&] {
+    std::vector<VectorTy> Vectors;
+    buildVectors(Vectors, Sizes);
+    Sink = Vectors.size();
+    return N;
+  });
+
+  std::vector<VectorTy> Vectors;
+  buildVectors(Vectors, Sizes);
+  Runner.run("SmallVector/iterate", [&] {
+    size_t Sum = 0;
+    for (const VectorTy &V : Vectors)
+      for (unsigned X : V)
+        Sum += X;
+    Sink = Sum;
+    return N;
+  });
+  // Linear searches, as done to check whether a short list contains a value.
+  Runner.run("SmallVector/find", [&] {
+    size_t Found = 0;
+    unsigned Value = 0;
+    for (const VectorTy &V : Vectors)
+      for (unsigned J = 0, E = V.size(); J != E; ++J, ++Value)
+        Found += std::find(V.begin(), V.end(), Value) != V.end();
+    Sink = Found;
+    return N;
+  });
+
+  // This includes the inline storage of every vector.
+  Runner.measureMemory("SmallVector/memory", N, [&] {
+    std::unique_ptr<std::vector<VectorTy>> Vs(new std::vector<VectorTy>());
+    buildVectors(*Vs, Sizes);
+    return Vs;
+  });
+}
+
+static BenchmarkSuite X("SmallVector", runSmallVectorBenchmarks);
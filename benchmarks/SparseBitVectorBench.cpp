@@ -0,0 +1,86 @@
+//===- SparseBitVectorBench.cpp - SparseBitVector benchmarks --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+typedef SparseBitVector<128> BitVectorTy;
+
+static void runSparseBitVectorBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  // The integers are shuffled, so the missing half is interleaved with the
+  // bits that are set. SparseBitVector is a list that is searched from the
+  // last element accessed, so random accesses take linear time; it is meant
+  // to be accessed mostly in increasing order, as these benchmarks do.
+  std::vector<unsigned> Ints = generateClusteredInts(2 * N, 0);
+  std::vector<unsigned> Bits(Ints.begin(), Ints.begin() + N);
+  std::vector<unsigned> Missing(Ints.begin() + N, Ints.end());
+  std::sort(Bits.begin(), Bits.end());
+  std::sort(Missing.begin(), Missing.end());
+
+  Runner.run("SparseBitVector/set", [&] {
+    BitVectorTy BV;
+    for (unsigned B : Bits)
+      BV.set(B);
+    Sink = BV.count();
+    return N;
+  });
+
+  BitVectorTy BV;
+  for (unsigned B : Bits)
+    BV.set(B);
+  Runner.run("SparseBitVector/test-hit", [&] {
+    size_t Found = 0;
+    for (unsigned B : Bits)
+      Found += BV.test(B);
+    Sink = Found;
+    return N;
+  });
+  Runner.run("SparseBitVector/test-miss", [&] {
+    size_t Found = 0;
+    for (unsigned B : Missing)
+      Found += BV.test(B);
+    Sink = Found;
+    return N;
+  });
+  Runner.run("SparseBitVector/iterate", [&] {
+    size_t Sum = 0, Count = 0;
+    for (unsigned B : BV) {
+      Sum += B;
+      ++Count;
+    }
+    Sink = Sum;
+    return Count;
+  });
+
+  // Unions of overlapping sets, as computed by dataflow analyses.
+  BitVectorTy Other;
+  for (unsigned B : Missing)
+    Other.set(B);
+  Runner.run("SparseBitVector/union", [&] {
+    BitVectorTy Result = BV;
+    Result |= Other;
+    Sink = Result.count();
+    return 2 * N;
+  });
+
+  Runner.measureMemory("SparseBitVector/memory", N, [&] {
+    std::unique_ptr<BitVectorTy> Result(new BitVectorTy());
+    for (unsigned B : Bits)
+      Result->set(B);
+    return Result;
+  });
+}
+
+static BenchmarkSuite X("SparseBitVector", runSparseBitVectorBenchmarks);
@@ -0,0 +1,91 @@
+//===- StringMapBench.cpp - StringMap benchmarks --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include <algorithm>
+#include <memory>
+
+using namespace llvm;
+using namespace bench;
+
+/// Benchmarks StringMap on symbol names. The hash functions are measured on
+/// their own as well so that the cost of hashing can be told apart from the
+/// cost of probing.
+static void runStringMapBenchmarks(BenchmarkRunner &Runner) {
+  unsigned N = Runner.getNumKeys();
+  std::vector<std::string> Keys = generateSymbolNames(N, 0);
+  // Names that are not in the map but share their structure and most of
+  // their characters with the ones that are.
+  std::vector<std::string> Missing = generateSymbolNames(N, 1);
+
+  Runner.run("hash/HashString", [&] {
+    unsigned H = 0;
+    for (const std::string &K : Keys)
+      H += HashString(K);
+    Sink = H;
+    return Keys.size();
+  });
+  Runner.run("hash/hash_combine_range", [&] {
+    size_t H = 0;
+    for (const std::string &K : Keys)
+      H += hash_combine_range(K.begin(), K.end());
+    Sink = H;
+    return Keys.size();
+  });
+
+  Runner.run("StringMap/insert", [&] {
+    StringMap<unsigned> Map;
+    for (unsigned I = 0; I != N; ++I)
+      Map[Keys[I]] = I;
+    Sink = Map.size();
+    return N;
+  });
+
+  StringMap<unsigned> Map;
+  for (unsigned I = 0; I != N; ++I)
+    Map[Keys[I]] = I;
+  // Look the keys up in a different order than they were inserted in, as a
+  // symbol table usually is.
+  std::vector<StringRef> Lookups(Keys.begin(), Keys.end());
+  std::shuffle(Lookups.begin(), Lookups.end(), std::mt19937(1));
+  Runner.run("StringMap/lookup-hit", [&] {
+    size_t Found = 0;
+    for (StringRef K : Lookups)
+      Found += Map.find(K)->second;
+    Sink = Found;
+    return Lookups.size();
+  });
+  Runner.run("StringMap/lookup-miss", [&] {
+    size_t Found = 0;
+    for (const std::string &K : Missing)
+      Found += Map.count(K);
+    Sink = Found;
+    return Missing.size();
+  });
+  Runner.run("StringMap/iterate", [&] {
+    size_t Sum = 0;
+    for (const auto &Entry : Map)
+      Sum += Entry.getKeyLength() + Entry.second;
+    Sink = Sum;
+    return Map.size();
+  });
+
+  // The keys are stored in the map, so this includes their characters.
+  Runner.measureMemory("StringMap/memory", N, [&] {
+    std::unique_ptr<StringMap<unsigned>> M(new StringMap<unsigned>());
+    for (unsigned I = 0; I != N; ++I)
+      (*M)[Keys[I]] = I;
+    return M;
+  });
+}
+
+static BenchmarkSuite X("StringMap", runStringMapBenchmarks);
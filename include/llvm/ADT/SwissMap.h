@@ -0,0 +1,621 @@
+//===- llvm/ADT/SwissMap.h - Group probed hash table ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissMap class, an open addressing hash table with the
+// interface of DenseMap.
+//
+// DenseMap finds a key by comparing it with every bucket on its probe
+// sequence, and each of those buckets may be on a different cache line.
+// SwissMap keeps one control byte per bucket in a separate array instead. The
+// byte tells whether the bucket is empty, deleted, or full, and for full
+// buckets holds 7 bits of the hash of their key. A lookup loads a group of 16
+// control bytes at once (8 without SSE2), finds the buckets of the group whose
+// hash bits match in a few instructions, and only compares the keys of those,
+// which are almost always the key being looked up.
+//
+// SwissMap uses DenseMapInfo to hash and compare keys, but never uses the
+// empty and tombstone keys, so a DenseMap can be replaced with a SwissMap by
+// changing its type. Like with DenseMap, inserting into or erasing from the
+// map invalidates its iterators, and the iteration order is unspecified.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSMAP_H
+#define LLVM_ADT_SWISSMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLVM_SWISSMAP_HAS_SSE2 1
+#else
+#define LLVM_SWISSMAP_HAS_SSE2 0
+#endif
+
+namespace llvm {
+
+namespace detail {
+/// Control byte values. A full bucket holds 7 bits of the hash of its key,
+/// so its control byte is never negative.
+enum SwissCtrl : int8_t { SwissCtrlEmpty = -128, SwissCtrlDeleted = -2 };
+
+/// A set of positions within a group of control bytes. The implementations
+/// of the groups set one bit per position, or one bit per byte, which Shift
+/// accounts for.
+template <typename T, unsigned Shift> class SwissBitMask {
+  T Mask;
+
+public:
+  explicit SwissBitMask(T Mask) : Mask(Mask) {}
+  explicit operator bool() const { return Mask != 0; }
+  unsigned lowest() const { return countTrailingZeros(Mask) >> Shift; }
+  void clearLowest() { Mask &= Mask - 1; }
+};
+
+/// A group of 8 control bytes, matched with integer arithmetic. This works on
+/// every host.
+class SwissGroupPortable {
+  uint64_t Ctrl;
+  static const uint64_t LSBs = 0x0101010101010101ULL;
+  static const uint64_t MSBs = 0x8080808080808080ULL;
+
+public:
+  enum { Width = 8 };
+  typedef SwissBitMask<uint64_t, 3> MaskT;
+
+  explicit SwissGroupPortable(const int8_t *Pos)
+      : Ctrl(support::endian::read<uint64_t, support::little,
+                                   support::unaligned>(Pos)) {}
+
+  /// Returns the positions whose control byte is \p H2. This may also return
+  /// positions above a real match, which the caller rejects when it compares
+  /// the keys.
+  MaskT match(int8_t H2) const {
+    uint64_t X = Ctrl ^ (LSBs * uint8_t(H2));
+    return MaskT((X - LSBs) & ~X & MSBs);
+  }
+  /// Returns the empty positions: those with the high bit set but not bit 1.
+  MaskT matchEmpty() const { return MaskT(Ctrl & (~Ctrl << 6) & MSBs); }
+  /// Returns the empty and deleted positions: those with the high bit set.
+  MaskT matchEmptyOrDeleted() const { return MaskT(Ctrl & MSBs); }
+};
+
+#if LLVM_SWISSMAP_HAS_SSE2
+/// A group of 16 control bytes, matched with SSE2 instructions.
+class SwissGroupSSE2 {
+  __m128i Ctrl;
+
+public:
+  enum { Width = 16 };
+  typedef SwissBitMask<uint32_t, 0> MaskT;
+
+  explicit SwissGroupSSE2(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  MaskT match(int8_t H2) const {
+    return MaskT(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl)));
+  }
+  MaskT matchEmpty() const { return match(SwissCtrlEmpty); }
+  MaskT matchEmptyOrDeleted() const {
+    return MaskT(_mm_movemask_epi8(Ctrl));
+  }
+};
+
+typedef SwissGroupSSE2 SwissGroup;
+#else
+typedef SwissGroupPortable SwissGroup;
+#endif
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class SwissMapIterator;
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class SwissMap : public DebugEpochBase {
+public:
+  typedef unsigned size_type;
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef detail::DenseMapPair<KeyT, ValueT> value_type;
+
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, false> iterator;
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, true> const_iterator;
+
+private:
+  typedef detail::SwissGroup Group;
+
+  /// NumBuckets control bytes, followed by a copy of the first Group::Width
+  /// ones so that a group can be loaded from any position without wrapping
+  /// around.
+  int8_t *Ctrl;
+  value_type *Buckets;
+  unsigned NumBuckets;
+  unsigned NumEntries;
+  /// The number of empty buckets that can still be filled before the table
+  /// has to grow. Deleted buckets are not counted as empty.
+  unsigned GrowthLeft;
+
+public:
+  /// Creates a map with room for at least \p InitialReserve entries.
+  explicit SwissMap(unsigned InitialReserve = 0) { init(InitialReserve); }
+
+  SwissMap(const SwissMap &Other) : DebugEpochBase() {
+    init(0);
+    copyFrom(Other);
+  }
+
+  SwissMap(SwissMap &&Other) : DebugEpochBase() {
+    init(0);
+    swap(Other);
+  }
+
+  template <typename InputIt> SwissMap(const InputIt &I, const InputIt &E) {
+    init(std::distance(I, E));
+    insert(I, E);
+  }
+
+  ~SwissMap() {
+    destroyAll();
+    operator delete(Ctrl);
+  }
+
+  SwissMap &operator=(const SwissMap &Other) {
+    if (&Other != this)
+      copyFrom(Other);
+    return *this;
+  }
+
+  SwissMap &operator=(SwissMap &&Other) {
+    destroyAll();
+    operator delete(Ctrl);
+    init(0);
+    swap(Other);
+    return *this;
+  }
+
+  void swap(SwissMap &RHS) {
+    incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  iterator begin() {
+    return empty() ? end() : iterator(Ctrl, Buckets, Buckets + NumBuckets,
+                                      *this);
+  }
+  iterator end() {
+    return iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                    Buckets + NumBuckets, *this, true);
+  }
+  const_iterator begin() const {
+    return empty() ? end() : const_iterator(Ctrl, Buckets,
+                                            Buckets + NumBuckets, *this);
+  }
+  const_iterator end() const {
+    return const_iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                          Buckets + NumBuckets, *this, true);
+  }
+
+  bool LLVM_ATTRIBUTE_UNUSED_RESULT empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grows the map so that it can hold at least \p Size entries without
+  /// growing again. Does not shrink.
+  void reserve(size_type Size) {
+    incrementEpoch();
+    unsigned Needed = getMinBucketsFor(Size);
+    if (Needed > NumBuckets)
+      rehash(Needed);
+  }
+  /// Same as reserve, for compatibility with DenseMap.
+  void resize(size_type Size) { reserve(Size); }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == getCapacity(NumBuckets))
+      return;
+    destroyAll();
+    // If the table is huge and mostly empty, shrink it.
+    if (NumEntries * 4 < NumBuckets && NumBuckets > 64) {
+      operator delete(Ctrl);
+      init(0);
+      return;
+    }
+    std::memset(Ctrl, detail::SwissCtrlEmpty, NumBuckets + Group::Width);
+    NumEntries = 0;
+    GrowthLeft = getCapacity(NumBuckets);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Val) const { return lookupBucket(Val) ? 1 : 0; }
+
+  iterator find(const KeyT &Val) { return find_as(Val); }
+  const_iterator find(const KeyT &Val) const { return find_as(Val); }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type, like DenseMap::find_as.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    if (value_type *B = lookupBucket(Val))
+      return makeIterator(B);
+    return end();
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    if (value_type *B = lookupBucket(Val))
+      return makeIterator(B);
+    return end();
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    if (value_type *B = lookupBucket(Val))
+      return B->getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    std::pair<value_type *, bool> R = findOrPrepareInsert(KV.first);
+    if (R.second)
+      construct(R.first, KV.first, KV.second);
+    return std::make_pair(makeIterator(R.first), R.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    std::pair<value_type *, bool> R = findOrPrepareInsert(KV.first);
+    if (R.second)
+      construct(R.first, std::move(KV.first), std::move(KV.second));
+    return std::make_pair(makeIterator(R.first), R.second);
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    value_type *B = lookupBucket(Val);
+    if (!B)
+      return false;
+    eraseBucket(B);
+    return true;
+  }
+  void erase(iterator I) { eraseBucket(&*I); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    std::pair<value_type *, bool> R = findOrPrepareInsert(Key);
+    if (R.second)
+      construct(R.first, Key, ValueT());
+    return *R.first;
+  }
+
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    std::pair<value_type *, bool> R = findOrPrepareInsert(Key);
+    if (R.second)
+      construct(R.first, std::move(Key), ValueT());
+    return *R.first;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// Return the approximate size (in bytes) of the actual map, including the
+  /// control bytes. If entries are pointers to objects, the size of the
+  /// referenced objects are not included.
+  size_t getMemorySize() const {
+    if (!NumBuckets)
+      return 0;
+    return getCtrlSize(NumBuckets) + NumBuckets * sizeof(value_type);
+  }
+
+private:
+  /// The number of entries a table of \p NumBuckets buckets can hold: 7/8 of
+  /// its buckets.
+  static unsigned getCapacity(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+  static unsigned getMinBucketsFor(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    unsigned Buckets = Group::Width;
+    while (getCapacity(Buckets) < NumEntries)
+      Buckets *= 2;
+    return Buckets;
+  }
+  static size_t getCtrlSize(unsigned NumBuckets) {
+    return RoundUpToAlignment(NumBuckets + Group::Width,
+                              alignOf<value_type>());
+  }
+
+  /// DenseMapInfo hashes are cheap and often have weak low bits, like those
+  /// of pointers. Multiplying by an odd constant makes every bit of the
+  /// result depend on the lower bits of the hash; the top 7 bits become the
+  /// control byte and the ones below select the bucket.
+  template <typename LookupKeyT> static uint64_t getHash(const LookupKeyT &K) {
+    return uint64_t(KeyInfoT::getHashValue(K)) * 0x9E3779B97F4A7C15ULL;
+  }
+  static unsigned getH1(uint64_t Hash) { return unsigned(Hash >> 25); }
+  static int8_t getH2(uint64_t Hash) { return int8_t(Hash >> 57); }
+
+  static bool isFull(int8_t C) { return C >= 0; }
+
+  void init(unsigned InitialReserve) {
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumBuckets = 0;
+    NumEntries = 0;
+    GrowthLeft = 0;
+    if (unsigned N = getMinBucketsFor(InitialReserve))
+      allocate(N);
+  }
+
+  /// Allocates an empty table of \p N buckets. Does not free the old one.
+  void allocate(unsigned N) {
+    assert(isPowerOf2_32(N) && N >= Group::Width && "Invalid table size!");
+    size_t CtrlSize = getCtrlSize(N);
+    char *Mem = static_cast<char *>(
+        operator new(CtrlSize + size_t(N) * sizeof(value_type)));
+    Ctrl = reinterpret_cast<int8_t *>(Mem);
+    Buckets = reinterpret_cast<value_type *>(Mem + CtrlSize);
+    std::memset(Ctrl, detail::SwissCtrlEmpty, N + Group::Width);
+    NumBuckets = N;
+    GrowthLeft = getCapacity(N);
+  }
+
+  template <typename KeyArgT, typename ValueArgT>
+  static void construct(value_type *B, KeyArgT &&Key, ValueArgT &&Value) {
+    new (&B->getFirst()) KeyT(std::forward<KeyArgT>(Key));
+    new (&B->getSecond()) ValueT(std::forward<ValueArgT>(Value));
+  }
+
+  void setCtrl(unsigned I, int8_t C) {
+    Ctrl[I] = C;
+    if (I < Group::Width)
+      Ctrl[NumBuckets + I] = C;
+  }
+
+  void destroyAll() {
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (isFull(Ctrl[I]))
+        Buckets[I].~value_type();
+  }
+
+  void copyFrom(const SwissMap &Other) {
+    destroyAll();
+    operator delete(Ctrl);
+    init(0);
+    if (!Other.NumBuckets)
+      return;
+    allocate(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + Group::Width);
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (isFull(Ctrl[I]))
+        construct(&Buckets[I], Other.Buckets[I].getFirst(),
+                  Other.Buckets[I].getSecond());
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+
+  iterator makeIterator(value_type *B) {
+    return iterator(Ctrl + (B - Buckets), B, Buckets + NumBuckets, *this,
+                    true);
+  }
+  const_iterator makeIterator(value_type *B) const {
+    return const_iterator(Ctrl + (B - Buckets), B, Buckets + NumBuckets,
+                          *this, true);
+  }
+
+  /// Returns the bucket holding \p Val, or null. Groups are probed with
+  /// increasing strides of Group::Width buckets, which visits every group of
+  /// a power of two sized table.
+  template <typename LookupKeyT>
+  value_type *lookupBucket(const LookupKeyT &Val) const {
+    if (NumBuckets == 0)
+      return nullptr;
+    uint64_t Hash = getHash(Val);
+    int8_t H2 = getH2(Hash);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash) & Mask;
+    for (unsigned Stride = Group::Width;; Stride += Group::Width) {
+      Group G(Ctrl + Pos);
+      for (Group::MaskT M = G.match(H2); M; M.clearLowest()) {
+        unsigned I = (Pos + M.lowest()) & Mask;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[I].getFirst())))
+          return Buckets + I;
+      }
+      // Insertions fill the first free bucket of the probe sequence, so the
+      // key would have been placed in this group.
+      if (G.matchEmpty())
+        return nullptr;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  /// Returns the first empty or deleted bucket on the probe sequence of
+  /// \p Hash. There always is one since the table is never completely full.
+  unsigned findFirstNonFull(uint64_t Hash) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash) & Mask;
+    for (unsigned Stride = Group::Width;; Stride += Group::Width) {
+      Group::MaskT M = Group(Ctrl + Pos).matchEmptyOrDeleted();
+      if (M)
+        return (Pos + M.lowest()) & Mask;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  /// Returns the bucket holding \p Key and false if there is one. Otherwise,
+  /// marks a bucket as full and returns it and true; the caller must
+  /// construct the entry in it.
+  std::pair<value_type *, bool> findOrPrepareInsert(const KeyT &Key) {
+    if (value_type *B = lookupBucket(Key))
+      return std::make_pair(B, false);
+    incrementEpoch();
+    if (GrowthLeft == 0)
+      grow();
+    uint64_t Hash = getHash(Key);
+    unsigned I = findFirstNonFull(Hash);
+    if (Ctrl[I] == detail::SwissCtrlEmpty)
+      --GrowthLeft;
+    setCtrl(I, getH2(Hash));
+    ++NumEntries;
+    return std::make_pair(Buckets + I, true);
+  }
+
+  void eraseBucket(value_type *B) {
+    incrementEpoch();
+    B->~value_type();
+    setCtrl(B - Buckets, detail::SwissCtrlDeleted);
+    --NumEntries;
+  }
+
+  /// Makes room for one more entry. If most of the used buckets are deleted
+  /// ones, the table is rehashed at the same size to reclaim them.
+  void grow() {
+    if (NumBuckets && NumEntries < getCapacity(NumBuckets) / 2)
+      rehash(NumBuckets);
+    else
+      rehash(NumBuckets ? NumBuckets * 2 : unsigned(Group::Width));
+  }
+
+  /// Moves all entries into a new table of \p N buckets.
+  void rehash(unsigned N) {
+    int8_t *OldCtrl = Ctrl;
+    value_type *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+    allocate(N);
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (!isFull(OldCtrl[I]))
+        continue;
+      uint64_t Hash = getHash(OldBuckets[I].getFirst());
+      unsigned J = findFirstNonFull(Hash);
+      setCtrl(J, getH2(Hash));
+      construct(&Buckets[J], std::move(OldBuckets[I].getFirst()),
+                std::move(OldBuckets[I].getSecond()));
+      OldBuckets[I].~value_type();
+    }
+    GrowthLeft -= NumEntries;
+    operator delete(OldCtrl);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class SwissMapIterator : DebugEpochBase::HandleBase {
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, true> ConstIterator;
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, true>;
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, false>;
+
+  typedef detail::DenseMapPair<KeyT, ValueT> Bucket;
+
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<IsConst, const Bucket, Bucket>::type
+  value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+
+private:
+  const int8_t *Ctrl;
+  pointer Ptr, End;
+
+public:
+  SwissMapIterator() : Ctrl(nullptr), Ptr(nullptr), End(nullptr) {}
+
+  SwissMapIterator(const int8_t *C, Bucket *Pos, Bucket *E,
+                   const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ctrl(C), Ptr(Pos), End(E) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      advancePastEmptyBuckets();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  SwissMapIterator(
+      const SwissMapIterator<KeyT, ValueT, KeyInfoT, IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ctrl(I.Ctrl), Ptr(I.Ptr), End(I.End) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const ConstIterator &RHS) const { return !(*this == RHS); }
+
+  SwissMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ptr;
+    ++Ctrl;
+    advancePastEmptyBuckets();
+    return *this;
+  }
+  SwissMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    SwissMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void advancePastEmptyBuckets() {
+    while (Ptr != End && *Ctrl < 0) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+static inline size_t
+capacity_in_bytes(const SwissMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif
@@ -766,6 +766,9 @@ public:
   /// \brief Calculate the natural loop information for a given function.
   bool runOnFunction(Function &F) override;
 
+  /// Loops are computed from the CFG and the dominator tree only.
+  bool isThreadSafe() const override { return true; }
+
   void verifyAnalysis() const override;
 
   void releaseMemory() override { LI.releaseMemory(); }
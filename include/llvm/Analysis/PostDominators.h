@@ -34,6 +34,9 @@ struct PostDominatorTree : public FunctionPass {
 
   bool runOnFunction(Function &F) override;
 
+  /// The post-dominator tree only reads the CFG of the function.
+  bool isThreadSafe() const override { return true; }
+
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.setPreservesAll();
   }
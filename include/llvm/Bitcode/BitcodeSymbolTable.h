@@ -0,0 +1,71 @@
+//===-- llvm/Bitcode/BitcodeSymbolTable.h - Bitcode symbols -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the symbol table that can be written after the module
+// block of a bitcode file. It describes the symbols of the module as a linker
+// sees them, so that tools which only need the symbols, like the LTO plugins
+// scanning archives, don't have to parse the module.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BITCODE_BITCODESYMBOLTABLE_H
+#define LLVM_BITCODE_BITCODESYMBOLTABLE_H
+
+#include "llvm/IR/Comdat.h"
+#include "llvm/IR/GlobalValue.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+struct BitcodeSymbolTable {
+  /// A global value of the module. The symbols are listed in the order
+  /// object::IRObjectFile lists them: functions, variables, then aliases.
+  struct Symbol {
+    enum FlagBits {
+      /// A declaration, or an available_externally definition.
+      SF_Undefined = 1U << 0,
+      SF_Function = 1U << 1,
+      SF_Alias = 1U << 2,
+      /// A variable that is constant.
+      SF_Constant = 1U << 3,
+      SF_UnnamedAddr = 1U << 4,
+      /// An llvm.* symbol or a variable in the llvm.metadata section, which
+      /// doesn't make it to the object file.
+      SF_FormatSpecific = 1U << 5
+    };
+
+    /// The name with the prefix the target's mangling adds.
+    std::string Name;
+    GlobalValue::LinkageTypes Linkage;
+    GlobalValue::VisibilityTypes Visibility;
+    unsigned Flags;
+    unsigned Alignment;
+    /// The size of common variables, zero otherwise.
+    uint64_t CommonSize;
+    /// The index in Comdats of the comdat of the symbol, or of the object an
+    /// alias refers to. -1 if there is none.
+    int Comdat;
+
+    bool isUndefined() const { return Flags & SF_Undefined; }
+    bool isFunction() const { return Flags & SF_Function; }
+    bool isAlias() const { return Flags & SF_Alias; }
+  };
+
+  std::string TargetTriple;
+  std::vector<std::pair<std::string, Comdat::SelectionKind>> Comdats;
+  std::vector<Symbol> Symbols;
+  /// The strings of the "Linker Options" module flag.
+  std::vector<std::string> LinkerOptions;
+};
+
+} // End llvm namespace
+
+#endif
@@ -42,7 +42,11 @@ namespace bitc {
 
     TYPE_BLOCK_ID_NEW,
 
-    USELIST_BLOCK_ID
+    USELIST_BLOCK_ID,
+
+    // Optional top-level blocks following the module block.
+    SYMTAB_BLOCK_ID,
+    FUNCTION_SUMMARY_BLOCK_ID
   };
 
 
@@ -355,6 +359,29 @@ namespace bitc {
     USELIST_CODE_BB      = 2  // BB: [index..., bb-id]
   };
 
+  /// SYMTAB blocks describe the symbols of the preceding module, so that
+  /// linkers can read them without parsing the module.
+  enum SymtabCodes {
+    SYMTAB_CODE_TRIPLE        = 1, // TRIPLE:        [strchr x N]
+    SYMTAB_CODE_COMDAT        = 2, // COMDAT:        [selection_kind,
+                                   //                 strchr x N]
+    // SYMBOL: [flags, linkage, visibility, alignment, comdat, commonsize,
+    //          strchr x N]
+    SYMTAB_CODE_SYMBOL        = 3,
+    SYMTAB_CODE_LINKER_OPTION = 4  // LINKER_OPTION: [strchr x N]
+  };
+
+  /// FUNCTION_SUMMARY blocks describe the functions of the preceding module,
+  /// or of all the modules of a combined index, for cross-module importing.
+  /// Functions are referred to by the index of their NAME record.
+  enum FunctionSummaryCodes {
+    FS_CODE_MODULE_PATH = 1, // MODULE_PATH: [strchr x N]
+    FS_CODE_NAME        = 2, // NAME:        [strchr x N]
+    // ENTRY: [nameid, moduleid, flags, instcount,
+    //         n x [calleenameid, callsites]]
+    FS_CODE_ENTRY       = 3
+  };
+
   enum AttributeKindCodes {
     // = 0 is unused
     ATTR_KIND_ALIGNMENT = 1,
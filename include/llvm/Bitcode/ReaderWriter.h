@@ -21,8 +21,10 @@
 #include <string>
 
 namespace llvm {
+  struct BitcodeSymbolTable;
   class BitstreamWriter;
   class DataStreamer;
+  class FunctionInfoIndex;
   class LLVMContext;
   class Module;
   class ModulePass;
@@ -51,6 +53,22 @@ namespace llvm {
   getBitcodeTargetTriple(MemoryBufferRef Buffer, LLVMContext &Context,
                          DiagnosticHandlerFunction DiagnosticHandler = nullptr);
 
+  /// Read the symbol table following the module block of the specified
+  /// bitcode buffer, without parsing the module. If the buffer has no symbol
+  /// table, this returns null.
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>>
+  readBitcodeSymbolTable(MemoryBufferRef Buffer, LLVMContext &Context,
+                         DiagnosticHandlerFunction DiagnosticHandler = nullptr);
+
+  /// Read the function summaries of the specified bitcode buffer, without
+  /// parsing any module: those following the module of a bitcode file, whose
+  /// module path is the buffer identifier, or those of a combined index
+  /// written by WriteFunctionInfoIndex(). If the buffer has no summaries,
+  /// this returns null.
+  ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+  readFunctionInfoIndex(MemoryBufferRef Buffer, LLVMContext &Context,
+                        DiagnosticHandlerFunction DiagnosticHandler = nullptr);
+
   /// Read the specified bitcode file, returning the module.
   ErrorOr<Module *>
   parseBitcodeFile(MemoryBufferRef Buffer, LLVMContext &Context,
@@ -64,8 +82,30 @@ namespace llvm {
   /// If \c ShouldPreserveUseListOrder, encode the use-list order for each \a
   /// Value in \c M.  These will be reconstructed exactly when \a M is
   /// deserialized.
+  ///
+  /// If \c EmitSymbolTable, follow the module with a description of its
+  /// symbols that readBitcodeSymbolTable() can read, if buildBitcodeSymbolTable
+  /// can describe them.
+  ///
+  /// If \c EmitFunctionSummary, also follow it with the summaries of the
+  /// functions it defines, that readFunctionInfoIndex() can read.
   void WriteBitcodeToFile(const Module *M, raw_ostream &Out,
-                          bool ShouldPreserveUseListOrder = false);
+                          bool ShouldPreserveUseListOrder = false,
+                          bool EmitSymbolTable = false,
+                          bool EmitFunctionSummary = false);
+
+  /// Write \p Index, the combined function summaries of several modules, to
+  /// the specified raw output stream, as a bitcode file with no module.
+  void WriteFunctionInfoIndex(const FunctionInfoIndex &Index,
+                              raw_ostream &Out);
+
+  /// Describe the symbols of \p M in \p Symtab. Returns false if they can't
+  /// be described without the IR: if \p M has no data layout, so the mangled
+  /// names would depend on the target the reader picks, if it has module
+  /// inline asm, whose symbols only the target's assembler knows about, or
+  /// data in the old Objective-C sections, from which LTOModule makes up
+  /// more symbols.
+  bool buildBitcodeSymbolTable(const Module &M, BitcodeSymbolTable &Symtab);
 
   /// isBitcodeWrapper - Return true if the given bytes are the magic bytes
   /// for an LLVM IR bitcode wrapper.
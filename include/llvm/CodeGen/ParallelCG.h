@@ -0,0 +1,51 @@
+//===-- llvm/CodeGen/ParallelCG.h - Parallel code generation ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This header declares functions that can be used for parallel code generation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_PARALLELCG_H
+#define LLVM_CODEGEN_PARALLELCG_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Target/TargetMachine.h"
+#include <functional>
+#include <memory>
+
+namespace llvm {
+
+class Module;
+class raw_pwrite_stream;
+
+/// Split M into OSs.size() partitions, and generate code for each partition on
+/// its own thread, writing the output to the corresponding element of OSs.
+/// TMFactory is called once per partition, on the calling thread, to create
+/// the target machine used for that partition.
+///
+/// If OSs has a single element, M is compiled in place without splitting.
+/// Otherwise local symbols of M may be promoted (see SplitModule), so M should
+/// not be code generated again afterwards.
+///
+/// Returns true if the target does not support emitting files of type FT.
+bool splitCodeGen(
+    Module &M, ArrayRef<raw_pwrite_stream *> OSs,
+    const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
+    TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile);
+
+/// Same as above, but each partition is compiled with a new target machine
+/// configured like TM: same target, triple, CPU, features, options, relocation
+/// model, code model and optimization level.
+bool splitCodeGen(
+    Module &M, ArrayRef<raw_pwrite_stream *> OSs, const TargetMachine &TM,
+    TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile);
+
+} // namespace llvm
+
+#endif
@@ -11,6 +11,7 @@
 #define LLVM_LIB_DEBUGINFO_DWARFCONTEXT_H
 
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/DebugInfo/DWARF/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
@@ -19,8 +20,10 @@
 #include "llvm/DebugInfo/DWARF/DWARFDebugLine.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugLoc.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugRangeList.h"
+#include "llvm/DebugInfo/DWARF/DWARFLookupIndex.h"
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/DebugInfo/DWARF/DWARFTypeUnit.h"
+#include <system_error>
 #include <vector>
 
 namespace llvm {
@@ -38,6 +41,8 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugAranges> Aranges;
   std::unique_ptr<DWARFDebugLine> Line;
   std::unique_ptr<DWARFDebugFrame> DebugFrame;
+  std::unique_ptr<DWARFLookupIndex> LookupIndex;
+  Optional<uint64_t> LookupIndexKey;
 
   DWARFUnitSection<DWARFCompileUnit> DWOCUs;
   std::vector<DWARFUnitSection<DWARFTypeUnit>> DWOTUs;
@@ -157,6 +162,30 @@ public:
   /// Get a pointer to a parsed line table corresponding to a compile unit.
   const DWARFDebugLine::LineTable *getLineTableForUnit(DWARFUnit *cu);
 
+  /// Get the address and name index of the compile units, building it if
+  /// necessary. Once the index exists, address lookups use its ranges.
+  const DWARFLookupIndex &getLookupIndex();
+
+  /// Get the key that identifies the debug info the lookup index is built
+  /// from, see DWARFLookupIndex::computeKey.
+  uint64_t getLookupIndexKey();
+
+  /// Use the lookup index stored in the file \p Path if it was written for
+  /// the same debug info. Returns false if the file could not be used.
+  bool loadLookupIndex(StringRef Path);
+
+  /// Write the lookup index to the file \p Path, building it if necessary.
+  /// The file is replaced atomically, so concurrent readers see either the
+  /// old or the new index.
+  std::error_code saveLookupIndex(StringRef Path);
+
+  /// Find the DIEs named \p Name using the lookup index, and append them to
+  /// \p DIEs along with their compile units.
+  void findDIEsByName(
+      StringRef Name,
+      SmallVectorImpl<std::pair<DWARFCompileUnit *,
+                                const DWARFDebugInfoEntryMinimal *>> &DIEs);
+
   DILineInfo getLineInfoForAddress(uint64_t Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
   DILineInfoTable getLineInfoForAddressRange(uint64_t Address, uint64_t Size,
@@ -17,12 +17,20 @@
 namespace llvm {
 
 class DWARFContext;
+class raw_ostream;
 
 class DWARFDebugAranges {
 public:
   void generate(DWARFContext *CTX);
   uint32_t findAddress(uint64_t Address) const;
 
+  /// Writes the generated ranges to \p OS, so that they can be read back with
+  /// deserialize() instead of being generated again.
+  void serialize(raw_ostream &OS) const;
+  /// Reads ranges written by serialize(), starting at \p *OffsetPtr. Returns
+  /// false if \p Data does not hold valid ranges.
+  bool deserialize(DataExtractor Data, uint32_t *OffsetPtr);
+
 private:
   void clear();
   void extract(DataExtractor DebugArangesData);
@@ -0,0 +1,68 @@
+//===-- DWARFLookupIndex.h --------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_DEBUGINFO_DWARFLOOKUPINDEX_H
+#define LLVM_LIB_DEBUGINFO_DWARFLOOKUPINDEX_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/DebugInfo/DWARF/DWARFDebugAranges.h"
+
+namespace llvm {
+
+class DWARFContext;
+class raw_ostream;
+
+/// DWARFLookupIndex maps addresses to the compile units that cover them, and
+/// the names of functions, variables, types and namespaces to the DIEs that
+/// define them. Building the index parses every compile unit, concurrently.
+/// The index can be written to a file and read back by later runs on the same
+/// debug info instead of being built again.
+class DWARFLookupIndex {
+public:
+  /// The location of a DIE in .debug_info.
+  struct DIERef {
+    uint32_t CUOffset;
+    uint32_t DIEOffset;
+  };
+
+  /// Builds the index of the compile units of \p C.
+  void build(DWARFContext &C);
+
+  /// Returns a hash of the debug info that the index of \p C is built from.
+  /// An index read from a file is only used if it was written with the same
+  /// key.
+  static uint64_t computeKey(DWARFContext &C);
+
+  /// Writes the index to \p OS, tagged with \p Key.
+  void write(raw_ostream &OS, uint64_t Key) const;
+  /// Reads an index written by write(). Returns false, leaving the index
+  /// empty, if \p Data is not a valid index or was written with another key.
+  bool read(StringRef Data, uint64_t Key);
+
+  /// Returns the address ranges of the compile units.
+  const DWARFDebugAranges &getAranges() const { return Aranges; }
+
+  /// Returns the DIEs named \p Name, in the order they appear in .debug_info.
+  ArrayRef<DIERef> findName(StringRef Name) const;
+
+  /// Returns the number of distinct names in the index.
+  unsigned getNumNames() const { return Names.size(); }
+
+private:
+  void clear();
+
+  DWARFDebugAranges Aranges;
+  StringMap<SmallVector<DIERef, 1>> Names;
+};
+
+}
+
+#endif
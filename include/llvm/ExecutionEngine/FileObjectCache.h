@@ -0,0 +1,79 @@
+//===-- FileObjectCache.h - Persistent on-disk ObjectCache ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/Mutex.h"
+#include <string>
+
+namespace llvm {
+
+class TargetMachine;
+
+/// An ObjectCache that keeps compiled objects in a directory on disk, so that
+/// they survive the process. Objects are keyed by a hash of the module's
+/// bitcode and of the target triple, CPU, features, optimization level,
+/// relocation and code models and code generation options of the
+/// TargetMachine that compiles them, so the module identifier doesn't matter
+/// and a changed module or configuration never gets a stale object.
+///
+/// The cache can be shared by any number of threads and processes: entries
+/// are written to temporary files and renamed into place, and when the
+/// directory grows beyond the size limit, one process at a time deletes the
+/// least recently used entries.
+///
+/// It can be used with MCJIT (ExecutionEngine::setObjectCache) and with
+/// Orc's IRCompileLayer (setObjectCache). Both call getObject on a module
+/// before compiling it, which is when its key is computed; code generation
+/// may change the module before notifyObjectCompiled is called.
+class FileObjectCache : public ObjectCache {
+public:
+  /// Create a cache in \p CacheDir for objects compiled by \p TM. The
+  /// directory is created if it doesn't exist. If \p MaxCacheSize is not zero,
+  /// the least recently used entries are deleted whenever a new entry makes
+  /// the directory hold more than \p MaxCacheSize bytes of objects.
+  FileObjectCache(StringRef CacheDir, const TargetMachine &TM,
+                  uint64_t MaxCacheSize = 0);
+  ~FileObjectCache() override;
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+  void notifyCompileFailed(const Module *M) override;
+
+  /// Return the key of the cache entry for \p M.
+  std::string getKey(const Module &M) const;
+
+  /// Return the path of the cache entry with the given key.
+  std::string getEntryPath(StringRef Key) const;
+
+  /// Delete the least recently used entries until the cache is no larger than
+  /// its size limit. Does nothing if the cache is unbounded, or if another
+  /// process is pruning it.
+  void prune();
+
+  StringRef getCacheDir() const { return CacheDir; }
+
+private:
+  std::string CacheDir;
+  // The code generation options that affect the object, folded into keys.
+  std::string TargetKey;
+  uint64_t MaxCacheSize;
+
+  // Keys of the modules that were looked up and missed, for
+  // notifyObjectCompiled.
+  sys::Mutex Lock;
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace llvm
+
+#endif
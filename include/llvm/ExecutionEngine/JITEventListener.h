@@ -81,6 +81,16 @@ public:
   // Get a pointe to the GDB debugger registration listener.
   static JITEventListener *createGDBRegistrationListener();
 
+  // Construct a PerfJITEventListener, which writes /tmp/perf-<pid>.map and a
+  // jitdump file in $JITDUMPDIR or ~/.debug/jit for Linux perf. Returns null
+  // on hosts perf doesn't run on.
+  static JITEventListener *createPerfJITEventListener();
+
+  // Construct a PerfJITEventListener that writes its files to the given
+  // directories.
+  static JITEventListener *createPerfJITEventListener(StringRef PerfMapDir,
+                                                      StringRef JITDumpDir);
+
 #if LLVM_USE_INTEL_JITEVENTS
   // Construct an IntelJITEventListener
   static JITEventListener *createIntelJITEventListener();
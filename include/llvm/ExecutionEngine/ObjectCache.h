@@ -33,6 +33,10 @@ public:
   /// object which corresponds with Module M, or 0 if an object is not
   /// available.
   virtual std::unique_ptr<MemoryBuffer> getObject(const Module* M) = 0;
+
+  /// notifyCompileFailed - Called when Module M, for which getObject returned
+  /// no object, could not be compiled.
+  virtual void notifyCompileFailed(const Module *M) {}
 };
 
 }
@@ -18,8 +18,16 @@
 #include "IndirectionUtils.h"
 #include "LambdaResolver.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/Support/Debug.h"
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <mutex>
+#include <thread>
+
+#define DEBUG_TYPE "orc-cod"
 
 namespace llvm {
 namespace orc {
@@ -34,6 +42,15 @@ namespace orc {
 /// It is expected that this layer will frequently be used on top of a
 /// LazyEmittingLayer. The combination of the two ensures that each function is
 /// compiled only when it is first called.
+///
+///   Optionally, the layer speculatively compiles the functions that a compiled
+/// function refers to on a background thread, and points their stubs at the
+/// compiled bodies, so that the first call to them does not have to wait for
+/// the compiler. The modules added to the layer share an LLVMContext, which is
+/// not thread safe, so the layer serializes all work on its modules: a first
+/// call only blocks while the function it needs, or the one the background
+/// thread is working on, is being compiled. While background compilation is
+/// enabled, the context of the modules must not be used outside of the layer.
 template <typename BaseLayerT, typename CompileCallbackMgrT>
 class CompileOnDemandLayer {
 private:
@@ -137,10 +154,28 @@ private:
   typedef typename BaseLayerT::ModuleSetHandleT BaseLayerModuleSetHandleT;
   typedef std::vector<BaseLayerModuleSetHandleT> BaseLayerModuleSetHandleListT;
 
+  // A function whose body is compiled on demand.
+  struct LazyFunction {
+    // The base layer module set holding the body, and its mangled name.
+    BaseLayerModuleSetHandleT BodyH;
+    std::string BodyName;
+    // Points the stub of the function at its compiled body.
+    typename CompileCallbackMgrT::UpdateFtor UpdateStub;
+    // The functions that the body refers to, which are the likely next ones
+    // to be called.
+    std::vector<LazyFunction *> Callees;
+    bool Compiled;
+
+    LazyFunction() : Compiled(false) {}
+  };
+
   struct ModuleSetInfo {
     // Symbol lookup - just one for the whole module set.
     std::shared_ptr<CODScopedLookup> Lookup;
 
+    // The functions of the module set that are compiled on demand.
+    std::list<LazyFunction> LazyFunctions;
+
     // Logical module handles.
     std::vector<typename CODScopedLookup::LMHandle> LMHandles;
 
@@ -167,8 +202,29 @@ public:
   typedef typename ModuleSetInfoListT::iterator ModuleSetHandleT;
 
   /// @brief Construct a compile-on-demand layer instance.
-  CompileOnDemandLayer(BaseLayerT &BaseLayer, CompileCallbackMgrT &CallbackMgr)
-      : BaseLayer(BaseLayer), CompileCallbackMgr(CallbackMgr) {}
+  /// @param CompileInBackground If true, speculatively compile the functions
+  ///        that compiled functions refer to on a background thread. This is
+  ///        ignored if LLVM was built without thread support.
+  CompileOnDemandLayer(BaseLayerT &BaseLayer, CompileCallbackMgrT &CallbackMgr,
+                       bool CompileInBackground = false)
+      : BaseLayer(BaseLayer), CompileCallbackMgr(CallbackMgr),
+        StopWorker(false) {
+#if LLVM_ENABLE_THREADS
+    if (CompileInBackground)
+      Worker = std::thread([this]() { runWorker(); });
+#endif
+  }
+
+  ~CompileOnDemandLayer() {
+    if (!Worker.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> Lock(QueueMutex);
+      StopWorker = true;
+    }
+    QueueChanged.notify_one();
+    Worker.join();
+  }
 
   /// @brief Add a module to the compile-on-demand layer.
   template <typename ModuleSetT, typename MemoryManagerPtrT,
@@ -179,6 +235,7 @@ public:
 
     assert(MemMgr == nullptr &&
            "User supplied memory managers not supported with COD yet.");
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
 
     // Create a lookup context and ModuleSetInfo for this module set.
     // For the purposes of symbol resolution the set Ms will be treated as if
@@ -200,6 +257,16 @@ public:
   ///   This will remove all modules in the layers below that were derived from
   /// the module represented by H.
   void removeModuleSet(ModuleSetHandleT H) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    {
+      // Forget the pending background work on the module set.
+      std::lock_guard<std::mutex> QueueLock(QueueMutex);
+      for (auto &LF : H->LazyFunctions)
+        LF.Compiled = true;
+      Queue.erase(std::remove_if(Queue.begin(), Queue.end(),
+                                 [](LazyFunction *LF) { return LF->Compiled; }),
+                  Queue.end());
+    }
     H->releaseResources(BaseLayer);
     ModuleSetInfos.erase(H);
   }
@@ -209,6 +276,7 @@ public:
   /// @param ExportedSymbolsOnly If true, search only for exported symbols.
   /// @return A handle for the given named symbol, if it exists.
   JITSymbol findSymbol(StringRef Name, bool ExportedSymbolsOnly) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     return BaseLayer.findSymbol(Name, ExportedSymbolsOnly);
   }
 
@@ -216,7 +284,7 @@ public:
   ///        below this one.
   JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name,
                          bool ExportedSymbolsOnly) {
-
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     for (auto &BH : H->BaseLayerModuleSetHandles) {
       if (auto Symbol = BaseLayer.findSymbolIn(BH, Name, ExportedSymbolsOnly))
         return Symbol;
@@ -249,13 +317,20 @@ private:
     auto CommonHandle = addModule(std::move(CommonsModule), MSI, LogicalModule);
     BaseLayer.emitAndFinalize(CommonHandle);
 
-    // Map of definition names to callback-info data structures. We'll use
-    // this to build the compile actions for the stubs below.
+    // Map of definition names to callback-info data structures and lazy
+    // function records. We'll use this to build the compile actions for the
+    // stubs below.
+    typedef typename CompileCallbackMgrT::CompileCallbackInfo
+      CompileCallbackInfo;
     typedef std::map<std::string,
-                     typename CompileCallbackMgrT::CompileCallbackInfo>
+                     std::pair<CompileCallbackInfo, LazyFunction *>>
       StubInfoMap;
     StubInfoMap StubInfos;
 
+    // The functions that each lazy function refers to, by name.
+    std::vector<std::pair<LazyFunction *, std::vector<std::string>>>
+      CalleeNames;
+
     // Now we need to take each of the extracted Modules and add them to
     // base layer. Each Module will be added individually to make sure they
     // can be compiled separately, and each will get its own lookaside
@@ -265,12 +340,16 @@ private:
       // Keep track of the stubs we create for this module so that we can set
       // their compile actions.
       std::vector<typename StubInfoMap::iterator> NewStubInfos;
+      std::vector<std::string> Referenced;
 
       // Search for function definitions and insert stubs into the stubs
       // module.
       for (auto &F : *SubM) {
-        if (F.isDeclaration())
+        if (F.isDeclaration()) {
+          if (!F.isIntrinsic())
+            Referenced.push_back(F.getName());
           continue;
+        }
 
         std::string Name = F.getName();
         Function *Proto = StubsModule->getFunction(Name);
@@ -287,7 +366,12 @@ private:
         F.setName(Name + BodySuffix);
         F.setVisibility(GlobalValue::HiddenVisibility);
 
-        auto KV = std::make_pair(std::move(Name), std::move(CallbackInfo));
+        MSI.LazyFunctions.push_back(LazyFunction());
+        LazyFunction *LF = &MSI.LazyFunctions.back();
+        LF->BodyName = Mangle(Name + BodySuffix, M.getDataLayout());
+
+        auto KV = std::make_pair(std::move(Name),
+                                 std::make_pair(std::move(CallbackInfo), LF));
         NewStubInfos.push_back(StubInfos.insert(StubInfos.begin(), KV));
       }
 
@@ -295,13 +379,11 @@ private:
 
       // Set the compile actions for this module:
       for (auto &KVPair : NewStubInfos) {
-        std::string BodyName = Mangle(KVPair->first + BodySuffix,
-                                      M.getDataLayout());
-        auto &CCInfo = KVPair->second;
-        CCInfo.setCompileAction(
-          [=](){
-            return BaseLayer.findSymbolIn(H, BodyName, false).getAddress();
-          });
+        LazyFunction *LF = KVPair->second.second;
+        LF->BodyH = H;
+        CalleeNames.push_back(std::make_pair(LF, Referenced));
+        auto &CCInfo = KVPair->second.first;
+        CCInfo.setCompileAction([=]() { return compileFunction(*LF); });
       }
 
     }
@@ -314,9 +396,74 @@ private:
     for (auto &KVPair : StubInfos) {
       std::string AddrName = Mangle(KVPair.first + AddrSuffix,
                                     M.getDataLayout());
-      auto &CCInfo = KVPair.second;
-      CCInfo.setUpdateAction(
-        getLocalFPUpdater(BaseLayer, StubsH, AddrName));
+      auto &CCInfo = KVPair.second.first;
+      LazyFunction *LF = KVPair.second.second;
+      LF->UpdateStub = getLocalFPUpdater(BaseLayer, StubsH, AddrName);
+      // The update action runs after the compile action has returned, so it
+      // has to take the layer lock again before it looks into the base layer.
+      CCInfo.setUpdateAction([this, LF](TargetAddress Addr) {
+        std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+        LF->UpdateStub(Addr);
+      });
+    }
+
+    // Link each function to the lazy functions of this module it refers to.
+    for (auto &Entry : CalleeNames)
+      for (auto &Name : Entry.second) {
+        auto I = StubInfos.find(Name);
+        if (I != StubInfos.end())
+          Entry.first->Callees.push_back(I->second.second);
+      }
+  }
+
+  // Compile the body of LF, queue the functions it refers to for background
+  // compilation, and return the address of the body.
+  TargetAddress compileFunction(LazyFunction &LF) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    TargetAddress Addr =
+      BaseLayer.findSymbolIn(LF.BodyH, LF.BodyName, false).getAddress();
+    if (Worker.joinable()) {
+      std::lock_guard<std::mutex> QueueLock(QueueMutex);
+      LF.Compiled = true;
+      for (LazyFunction *Callee : LF.Callees)
+        if (!Callee->Compiled)
+          Queue.push_back(Callee);
+      QueueChanged.notify_one();
+    }
+    return Addr;
+  }
+
+  // Body of the background compilation thread.
+  void runWorker() {
+    while (true) {
+      std::unique_lock<std::recursive_mutex> Lock(LayerMutex, std::defer_lock);
+      LazyFunction *LF = nullptr;
+      {
+        std::unique_lock<std::mutex> QueueLock(QueueMutex);
+        QueueChanged.wait(QueueLock,
+                          [this]() { return StopWorker || !Queue.empty(); });
+        if (StopWorker)
+          return;
+        // Take the layer lock before dequeueing, so that the module set of
+        // the function can't be removed before we're done with it.
+        QueueLock.unlock();
+        Lock.lock();
+        QueueLock.lock();
+        while (!Queue.empty() && !LF) {
+          LF = Queue.front();
+          Queue.pop_front();
+          if (LF->Compiled)
+            LF = nullptr;
+        }
+      }
+      if (!LF)
+        continue;
+      // Still holding the layer lock, compile the body and point the stub at
+      // it.
+      TargetAddress Addr = compileFunction(*LF);
+      DEBUG(dbgs() << "Compiled " << LF->BodyName << " in the background\n");
+      if (Addr)
+        LF->UpdateStub(Addr);
     }
   }
 
@@ -374,9 +521,22 @@ private:
   BaseLayerT &BaseLayer;
   CompileCallbackMgrT &CompileCallbackMgr;
   ModuleSetInfoListT ModuleSetInfos;
+
+  // Serializes all use of the base layer (and hence of the LLVMContext of the
+  // modules) between the JIT'd code and the background compilation thread.
+  std::recursive_mutex LayerMutex;
+
+  // Functions waiting for background compilation.
+  std::mutex QueueMutex;
+  std::condition_variable QueueChanged;
+  std::deque<LazyFunction *> Queue;
+  bool StopWorker;
+  std::thread Worker;
 };
 
 } // End namespace orc.
 } // End namespace llvm.
 
+#undef DEBUG_TYPE
+
 #endif // LLVM_EXECUTIONENGINE_ORC_COMPILEONDEMANDLAYER_H
@@ -74,8 +74,12 @@ public:
 
       if (!Object) {
         std::tie(Object, Buffer) = Compile(*M).takeBinary();
-        if (ObjCache)
-          ObjCache->notifyObjectCompiled(&*M, Buffer->getMemBufferRef());
+        if (ObjCache) {
+          if (Object)
+            ObjCache->notifyObjectCompiled(&*M, Buffer->getMemBufferRef());
+          else
+            ObjCache->notifyCompileFailed(&*M);
+        }
       }
 
       Objects.push_back(std::move(Object));
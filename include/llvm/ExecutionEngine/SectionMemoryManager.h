@@ -19,8 +19,105 @@
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Memory.h"
+#include "llvm/Support/Mutex.h"
+#include <map>
+#include <memory>
 
 namespace llvm {
+
+/// A pool of large memory slabs that SectionMemoryManagers carve their
+/// sections out of, instead of mapping fresh memory for every allocation.
+///
+/// Slabs are reserved next to each other, so that the code and data of all
+/// the modules that share a pool stay close together and are reachable with
+/// 32-bit PC-relative relocations. Memory is handed out in chunks that each
+/// get their own page permissions, and chunks returned by a
+/// SectionMemoryManager when it is destroyed are reused for later modules.
+///
+/// Chunks are normally page-granular. A pool may back large code chunks with
+/// huge pages to reduce iTLB misses. Changing the permissions of part of a
+/// huge page splits it, so those chunks are made of whole huge pages, and
+/// only code chunks of at least MinHugeCodeChunk bytes get them: rounding up
+/// then wastes less than half of the chunk. Smaller code chunks are packed
+/// into regular slabs, so many small modules don't each use a huge page.
+///
+/// A pool may be shared by SectionMemoryManagers on any number of threads.
+class SectionMemoryPool {
+  SectionMemoryPool(const SectionMemoryPool&) = delete;
+  void operator=(const SectionMemoryPool&) = delete;
+
+public:
+  enum class AllocationPurpose { Code, ROData, RWData };
+
+  static const size_t DefaultSlabSize = 4 * 1024 * 1024;
+
+  /// The size of the huge pages that code slabs ask for.
+  static const size_t HugePageSize = 2 * 1024 * 1024;
+
+  /// The smallest code chunk that is backed by huge pages.
+  static const size_t MinHugeCodeChunk = HugePageSize / 2;
+
+  /// Create a pool that reserves memory \p SlabSize bytes at a time. If
+  /// \p UseHugePages is true, code chunks of at least MinHugeCodeChunk bytes
+  /// come from slabs requested with sys::Memory::MF_HUGE_HINT, and are whole
+  /// huge pages, so that giving a chunk its final permissions doesn't split a
+  /// huge page.
+  explicit SectionMemoryPool(size_t SlabSize = DefaultSlabSize,
+                             bool UseHugePages = false);
+  ~SectionMemoryPool();
+
+  /// Allocate a read-write chunk of at least \p Size bytes for the given
+  /// purpose. The chunk is aligned to, and a whole number of,
+  /// getChunkAlignment(Purpose, Size) bytes long.
+  /// Returns a null block and sets \p EC if memory could not be reserved.
+  sys::MemoryBlock allocate(AllocationPurpose Purpose, size_t Size,
+                            std::error_code &EC);
+
+  /// Return a chunk obtained from allocate to the pool. The chunk is made
+  /// read-write again, whatever permissions it was given in the meantime.
+  void release(AllocationPurpose Purpose, sys::MemoryBlock Block);
+
+  /// Return the granularity of a chunk of \p Size bytes allocated for
+  /// \p Purpose: the huge page size for code chunks backed by huge pages,
+  /// and the page size otherwise.
+  size_t getChunkAlignment(AllocationPurpose Purpose, size_t Size) const;
+
+  /// Return the number of slabs reserved so far.
+  unsigned getNumSlabs() const;
+
+  /// Return the number of bytes in the slabs for \p Purpose that are not
+  /// currently allocated.
+  size_t getFreeSize(AllocationPurpose Purpose) const;
+
+private:
+  struct PurposeInfo {
+    SmallVector<sys::MemoryBlock, 4> Slabs;
+    // Free ranges, from start address to size, coalesced on release.
+    std::map<uintptr_t, size_t> FreeRanges;
+  };
+
+  /// Return true if a chunk of \p Size bytes, a whole number of pages, is
+  /// backed by huge pages.
+  bool isHugeCodeChunk(AllocationPurpose Purpose, size_t Size) const;
+
+  PurposeInfo &getInfo(AllocationPurpose Purpose, size_t Size) {
+    if (isHugeCodeChunk(Purpose, Size))
+      return HugeCode;
+    return Purposes[static_cast<unsigned>(Purpose)];
+  }
+
+  size_t SlabSize;
+  size_t PageSize;
+  bool UseHugePages;
+
+  mutable sys::Mutex Lock;
+  PurposeInfo Purposes[3];
+  // The code chunks backed by huge pages.
+  PurposeInfo HugeCode;
+  // The last slab reserved for any purpose; new slabs are placed after it.
+  sys::MemoryBlock Near;
+};
+
 /// This is a simple memory manager which implements the methods called by
 /// the RuntimeDyld class to allocate memory for section-based loading of
 /// objects, usually those generated by the MCJIT execution engine.
@@ -40,8 +137,24 @@ class SectionMemoryManager : public RTDyldMemoryManager {
 
 public:
   SectionMemoryManager() { }
+
+  /// Create a memory manager that takes its memory from \p Pool, and returns
+  /// it to the pool when it is destroyed. The manager reserves the space for
+  /// each object up front, so that the sections of an object are allocated
+  /// contiguously.
+  explicit SectionMemoryManager(std::shared_ptr<SectionMemoryPool> Pool)
+    : Pool(std::move(Pool)) { }
+
   ~SectionMemoryManager() override;
 
+  /// \brief Returns true if this memory manager allocates from a pool.
+  bool needsToReserveAllocationSpace() override { return Pool != nullptr; }
+
+  /// \brief Reserve pool chunks large enough for all the sections of the
+  /// object about to be loaded.
+  void reserveAllocationSpace(uintptr_t CodeSize, uintptr_t DataSizeRO,
+                              uintptr_t DataSizeRW) override;
+
   /// \brief Allocates a memory block of (at least) the given size suitable for
   /// executable code.
   ///
@@ -95,6 +208,12 @@ private:
   std::error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                               unsigned Permissions);
 
+  sys::MemoryBlock allocateMemory(MemoryGroup &MemGroup, size_t Size,
+                                  std::error_code &EC);
+  void releaseMemoryGroup(MemoryGroup &MemGroup);
+  SectionMemoryPool::AllocationPurpose getPurpose(const MemoryGroup &MemGroup);
+
+  std::shared_ptr<SectionMemoryPool> Pool;
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
@@ -219,6 +219,9 @@ public:
 
   bool runOnFunction(Function &F) override;
 
+  /// The dominator tree only reads the CFG of the function.
+  bool isThreadSafe() const override { return true; }
+
   void verifyAnalysis() const override;
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -0,0 +1,114 @@
+//===-- llvm/IR/FunctionInfo.h - Function summary index ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// @file
+/// This file contains the declarations of the FunctionSummary and
+/// FunctionInfoIndex classes, which describe the functions of one or more
+/// modules so that a module can decide what to import from the others without
+/// loading them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IR_FUNCTIONINFO_H
+#define LLVM_IR_FUNCTIONINFO_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+class Function;
+class Module;
+
+/// \brief What a module needs to know about a function of another module to
+/// decide whether to import it.
+class FunctionSummary {
+public:
+  enum FlagBits {
+    /// The function can be imported into other modules as an
+    /// available_externally copy: its definition can't be overridden, and its
+    /// body refers to no local values, linkonce definitions or aliases that
+    /// would not be visible from the importing module.
+    Importable = 1U << 0,
+    /// The function is marked cold.
+    Cold = 1U << 1
+  };
+
+  /// The number of instructions in the function, ignoring debug intrinsics.
+  unsigned InstCount;
+  /// OR'ed FlagBits.
+  unsigned Flags;
+  /// The non-local functions this function calls directly, with the number
+  /// of call sites of each.
+  std::vector<std::pair<std::string, unsigned>> Calls;
+
+  FunctionSummary() : InstCount(0), Flags(0) {}
+
+  bool isImportable() const { return Flags & Importable; }
+  bool isCold() const { return Flags & Cold; }
+
+  /// Compute the summary of the definition \p F.
+  static FunctionSummary compute(const Function &F);
+};
+
+/// \brief The summaries of the non-local functions defined by a set of
+/// modules, with the path of the module that defines each.
+///
+/// The index of a single module is written along with it in its bitcode. The
+/// combined index of all the modules of a link is built from those without
+/// loading the modules, and is what each module consults to import functions
+/// from the others.
+class FunctionInfoIndex {
+public:
+  struct Entry {
+    /// Index in the module paths of the module defining the function.
+    unsigned ModuleId;
+    FunctionSummary Summary;
+  };
+
+private:
+  std::vector<std::string> ModulePaths;
+  StringMap<Entry> Functions;
+
+public:
+  /// Add the module \p Path, returning its id.
+  unsigned addModulePath(StringRef Path);
+
+  StringRef getModulePath(unsigned ModuleId) const {
+    return ModulePaths[ModuleId];
+  }
+  const std::vector<std::string> &getModulePaths() const {
+    return ModulePaths;
+  }
+
+  /// Add the summary of the function \p Name defined in the module
+  /// \p ModuleId. If several modules define the function, as they may for
+  /// linkonce_odr functions, the first one is kept.
+  void addFunction(StringRef Name, unsigned ModuleId, FunctionSummary Summary);
+
+  /// Return the entry for the function \p Name, or null if no module defines
+  /// it.
+  const Entry *findFunction(StringRef Name) const;
+
+  const StringMap<Entry> &functions() const { return Functions; }
+
+  /// Add the modules and functions of \p Other to this index.
+  void mergeFrom(const FunctionInfoIndex &Other);
+
+  /// Add \p M, identified by its module identifier, and the summaries of the
+  /// non-local functions it defines to this index. \p M must be materialized.
+  void addModule(const Module &M);
+};
+
+} // End llvm namespace
+
+#endif
@@ -58,6 +58,13 @@ public:
   /// whether any of the passes modifies the module, and if so, return true.
   bool run(Module &M);
 
+  /// setFunctionPassThreads - Run function passes on up to N functions at the
+  /// same time. This only has an effect on sequences of function passes that
+  /// are all thread safe (see FunctionPass::isThreadSafe); other sequences
+  /// still process one function at a time. The default is given by the
+  /// -function-pass-threads option.
+  void setFunctionPassThreads(unsigned N);
+
 private:
   /// PassManagerImpl_New is the actual class. PassManager is just the
   /// wraper to publish simple pass manager interface
@@ -227,6 +227,11 @@ public:
   void dumpPasses() const;
   void dumpArguments() const;
 
+  /// Set the number of functions that thread safe function passes may process
+  /// at the same time.
+  void setFunctionPassThreads(unsigned N) { FunctionPassThreads = N; }
+  unsigned getFunctionPassThreads() const { return FunctionPassThreads; }
+
   // Active Pass Managers
   PMStack activeStack;
 
@@ -255,6 +260,9 @@ private:
 
   DenseMap<Pass *, AnalysisUsage *> AnUsageMap;
 
+  /// Number of functions that FPPassManagers may run on concurrently.
+  unsigned FunctionPassThreads;
+
   /// Collection of PassInfo objects found via analysis IDs and in this top
   /// level manager. This is used to memoize queries to the pass registry.
   /// FIXME: This is an egregious hack because querying the pass registry is
@@ -470,6 +478,16 @@ public:
   PassManagerType getPassManagerType() const override {
     return PMT_FunctionPassManager;
   }
+
+private:
+  /// Return the number of threads to use to run the contained passes over the
+  /// functions of M, or 1 if they have to run serially.
+  unsigned getNumThreads(Module &M);
+
+  /// Run the contained passes on the functions of M using NumThreads threads.
+  /// Each additional thread runs private instances of the passes, with its own
+  /// analysis results.
+  bool runOnModuleConcurrently(Module &M, unsigned NumThreads);
 };
 
 Timer *getPassTimer(Pass *);
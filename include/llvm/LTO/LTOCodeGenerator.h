@@ -40,6 +40,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Target/TargetOptions.h"
 #include <string>
 #include <vector>
@@ -50,6 +51,7 @@ namespace llvm {
   class GlobalValue;
   class Mangler;
   class MemoryBuffer;
+  class Target;
   class TargetLibraryInfo;
   class TargetMachine;
   class raw_ostream;
@@ -133,6 +135,16 @@ struct LTOCodeGenerator {
   // if the compilation was not successful.
   const void *compileOptimized(size_t *length, std::string &errMsg);
 
+  // Compiles the merged optimized module into multiple object files, writing
+  // one to each element of Out. The merged module is split into Out.size()
+  // partitions which are code generated concurrently, so a parallel link only
+  // pays for the slowest partition. Return true on success.
+  //
+  // NOTE that with more than one output the merged module is modified in
+  // place (local symbols may be promoted), so it should not be compiled again.
+  bool compileOptimized(ArrayRef<raw_pwrite_stream *> Out,
+                        std::string &errMsg);
+
   void setDiagnosticHandler(lto_diagnostic_handler_t, void *);
 
   LLVMContext &getContext() { return Context; }
@@ -148,6 +160,7 @@ private:
                         SmallPtrSetImpl<GlobalValue *> &AsmUsed,
                         Mangler &Mangler);
   bool determineTarget(std::string &errMsg);
+  std::unique_ptr<TargetMachine> createTargetMachine();
 
   static void DiagnosticHandler(const DiagnosticInfo &DI, void *Context);
 
@@ -161,6 +174,11 @@ private:
   LLVMContext &Context;
   Linker IRLinker;
   TargetMachine *TargetMach;
+  const Target *MArch;
+  std::string TripleStr;
+  std::string FeatureStr;
+  Reloc::Model RelocModel;
+  CodeGenOpt::Level CGOptLevel;
   bool EmitDwarfDebugInfo;
   bool ScopeRestrictionsDone;
   lto_codegen_model CodeModel;
@@ -100,6 +100,9 @@ public:
                                      TargetOptions options, std::string &errMsg,
                                      StringRef path = "");
 
+  /// Create an LTOModule in its own context, only to look at its symbols. If
+  /// the bitcode has a symbol table, the module isn't parsed at all, and
+  /// getModule() must not be called.
   static LTOModule *createInLocalContext(const void *mem, size_t length,
                                          TargetOptions options,
                                          std::string &errMsg, StringRef path);
@@ -116,12 +119,17 @@ public:
 
   /// Return the Module's target triple.
   const std::string &getTargetTriple() {
+    if (BitcodeSymbolTable *Symtab = IRFile->getSymbolTable())
+      return Symtab->TargetTriple;
     return getModule().getTargetTriple();
   }
 
   /// Set the Module's target triple.
   void setTargetTriple(StringRef Triple) {
-    getModule().setTargetTriple(Triple);
+    if (BitcodeSymbolTable *Symtab = IRFile->getSymbolTable())
+      Symtab->TargetTriple = Triple;
+    else
+      getModule().setTargetTriple(Triple);
   }
 
   /// Get the number of symbols
@@ -187,6 +195,12 @@ private:
   /// Add a defined symbol to the list.
   void addDefinedSymbol(const char *Name, const GlobalValue *def,
                         bool isFunction);
+  void addDefinedSymbol(const char *Name, uint32_t attr, bool isFunction,
+                        const GlobalValue *def);
+
+  /// Add a symbol defined by an entry of the bitcode symbol table to the list.
+  void addDefinedSymbol(const object::BasicSymbolRef &Sym,
+                        const BitcodeSymbolTable::Symbol &Entry);
 
   /// Add a data symbol as defined to the list.
   void addDefinedDataSymbol(const object::BasicSymbolRef &Sym);
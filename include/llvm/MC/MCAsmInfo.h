@@ -18,6 +18,7 @@
 
 #include "llvm/MC/MCDirectives.h"
 #include "llvm/MC/MCDwarf.h"
+#include "llvm/MC/MCTargetOptions.h"
 #include "llvm/MC/MachineLocation.h"
 #include <cassert>
 #include <vector>
@@ -348,8 +349,8 @@ protected:
   /// construction (see LLVMTargetMachine::initAsmInfo()).
   bool UseIntegratedAssembler;
 
-  /// Compress DWARF debug sections. Defaults to false.
-  bool CompressDebugSections;
+  /// Compress DWARF debug sections. Defaults to DCT_None.
+  DebugCompressionType CompressDebugSections;
 
 public:
   explicit MCAsmInfo();
@@ -533,9 +534,11 @@ public:
     UseIntegratedAssembler = Value;
   }
 
-  bool compressDebugSections() const { return CompressDebugSections; }
+  DebugCompressionType compressDebugSections() const {
+    return CompressDebugSections;
+  }
 
-  void setCompressDebugSections(bool CompressDebugSections) {
+  void setCompressDebugSections(DebugCompressionType CompressDebugSections) {
     this->CompressDebugSections = CompressDebugSections;
   }
 };
@@ -956,13 +956,25 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
+  /// \brief The fragments of each section that layout iterations may still
+  /// have to relax.
+  struct RelaxationState;
+
   /// \brief Perform one layout iteration and return true if any offsets
   /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  bool layoutOnce(MCAsmLayout &Layout, RelaxationState &State);
 
   /// \brief Perform one layout iteration of the given section and return true
   /// if any offsets were adjusted.
-  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD);
+  ///
+  /// Only the fragments whose contents depend on fragments that changed size
+  /// in the previous iteration, or on other sections, are relaxed again.
+  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                         RelaxationState &State);
+
+  /// \brief Relax the given fragment if needed, and return true if its size
+  /// changed.
+  bool relaxFragment(MCAsmLayout &Layout, MCFragment &F);
 
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
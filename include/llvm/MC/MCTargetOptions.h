@@ -16,6 +16,13 @@ namespace llvm {
 
 class StringRef;
 
+/// How to compress the DWARF debug sections of object files.
+enum class DebugCompressionType {
+  DCT_None,   // no compression
+  DCT_Zlib,   // zlib, in SHF_COMPRESSED sections
+  DCT_ZlibGnu // zlib, in .zdebug_* sections with a "ZLIB" header
+};
+
 class MCTargetOptions {
 public:
   enum AsmInstrumentation {
@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Object/Binary.h"
@@ -21,6 +22,9 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 namespace object {
@@ -94,11 +98,15 @@ public:
     /// \return the size in the archive header for this member.
     uint64_t getRawSize() const;
 
-    StringRef getBuffer() const {
-      return StringRef(Data.data() + StartOfFile, getSize());
-    }
+    /// \return the contents of the member. Those of a member of a thin
+    /// archive are read from the file the member refers to.
+    ErrorOr<StringRef> getBuffer() const;
     uint64_t getChildOffset() const;
 
+    /// \return true if the contents of the member are stored outside of the
+    /// archive, in the file named by the member.
+    bool isThinMember() const;
+
     ErrorOr<MemoryBufferRef> getMemoryBufferRef() const;
 
     ErrorOr<std::unique_ptr<Binary>>
@@ -173,6 +181,7 @@ public:
   };
 
   Archive(MemoryBufferRef Source, std::error_code &EC);
+  ~Archive() override;
   static ErrorOr<std::unique_ptr<Archive>> create(MemoryBufferRef Source);
 
   enum Kind {
@@ -202,18 +211,34 @@ public:
     return v->isArchive();
   }
 
-  // check if a symbol is in the archive
+  /// \brief Find the member defining the symbol \p name, or child_end() if
+  /// the symbol table doesn't list it.
+  ///
+  /// The first call builds a hash index of the symbol table, so that each
+  /// lookup takes constant time instead of scanning the table. Lookups may
+  /// be made from several threads at once.
   child_iterator findSym(StringRef name) const;
 
   bool hasSymbolTable() const;
   child_iterator getSymbolTableChild() const { return SymbolTable; }
+  bool isThin() const { return IsThin; }
 
 private:
+  struct SymbolIndex;
+
   child_iterator SymbolTable;
   child_iterator StringTable;
   child_iterator FirstRegular;
   unsigned Format : 2;
   unsigned IsThin : 1;
+
+  /// The symbols of the symbol table by name, built by the first findSym().
+  mutable std::unique_ptr<SymbolIndex> SymIndex;
+  mutable std::mutex SymIndexMutex;
+
+  /// The files the members of a thin archive refer to, keyed by the header
+  /// of the member, read by the first getBuffer() of each member.
+  mutable DenseMap<const char *, std::unique_ptr<MemoryBuffer>> ThinBuffers;
 };
 
 }
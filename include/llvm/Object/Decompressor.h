@@ -0,0 +1,69 @@
+//===- Decompressor.h - Compressed section reader ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the Decompressor class, which reads the contents of
+// compressed sections: ELF sections with the SHF_COMPRESSED flag, and the
+// .zdebug_* sections of the older GNU format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_DECOMPRESSOR_H
+#define LLVM_OBJECT_DECOMPRESSOR_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ErrorOr.h"
+#include <system_error>
+
+namespace llvm {
+template <typename T> class SmallVectorImpl;
+
+namespace object {
+class SectionRef;
+
+/// Decompressor reads the compression header of a compressed section and
+/// uncompresses its contents.
+class Decompressor {
+public:
+  /// Create a decompressor for the contents \p Data of the compressed section
+  /// \p Name, read from an object file of the given byte order and class.
+  static ErrorOr<Decompressor> create(StringRef Name, StringRef Data,
+                                      bool IsLittleEndian, bool Is64Bit);
+
+  /// Uncompress the contents of the section into \p Out.
+  std::error_code decompress(SmallVectorImpl<char> &Out) const;
+
+  /// Return the size of the uncompressed contents.
+  uint64_t getDecompressedSize() const { return DecompressedSize; }
+
+  /// Return true if \p Section is compressed.
+  static bool isCompressed(const SectionRef &Section);
+
+  /// Return true if an ELF section with the flags \p Flags and the name
+  /// \p Name is compressed.
+  static bool isCompressedELFSection(uint64_t Flags, StringRef Name);
+
+  /// Return true if \p Name is the name of a .zdebug_* section, which starts
+  /// with a "ZLIB" header instead of a compression header.
+  static bool isGnuStyle(StringRef Name);
+
+private:
+  explicit Decompressor(StringRef Data) : SectionData(Data) {}
+
+  std::error_code consumeCompressedGnuHeader();
+  std::error_code consumeCompressedZLibHeader(bool IsLittleEndian,
+                                              bool Is64Bit);
+
+  StringRef SectionData;
+  uint64_t DecompressedSize;
+};
+
+} // end namespace object
+} // end namespace llvm
+
+#endif
@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_IROBJECTFILE_H
 #define LLVM_OBJECT_IROBJECTFILE_H
 
+#include "llvm/Bitcode/BitcodeSymbolTable.h"
 #include "llvm/Object/SymbolicFile.h"
 
 namespace llvm {
@@ -29,8 +30,14 @@ class IRObjectFile : public SymbolicFile {
   std::unique_ptr<Mangler> Mang;
   std::vector<std::pair<std::string, uint32_t>> AsmSymbols;
 
+  /// The symbol table of the bitcode, if the symbols come from it instead of
+  /// from M.
+  std::unique_ptr<BitcodeSymbolTable> Symtab;
+
 public:
   IRObjectFile(MemoryBufferRef Object, std::unique_ptr<Module> M);
+  IRObjectFile(MemoryBufferRef Object,
+               std::unique_ptr<BitcodeSymbolTable> Symtab);
   ~IRObjectFile() override;
   void moveSymbolNext(DataRefImpl &Symb) const override;
   std::error_code printSymbolName(raw_ostream &OS,
@@ -43,14 +50,24 @@ public:
   basic_symbol_iterator symbol_begin_impl() const override;
   basic_symbol_iterator symbol_end_impl() const override;
 
+  /// Return the entry of the bitcode symbol table for \p Symb, if the symbols
+  /// come from one.
+  const BitcodeSymbolTable::Symbol *getSymbolTableEntry(DataRefImpl Symb) const;
+
+  /// Files created from a bitcode symbol table have no module.
+  bool hasModule() const { return M != nullptr; }
   const Module &getModule() const {
     return const_cast<IRObjectFile*>(this)->getModule();
   }
   Module &getModule() {
+    assert(M && "Created from a symbol table");
     return *M;
   }
   std::unique_ptr<Module> takeModule();
 
+  const BitcodeSymbolTable *getSymbolTable() const { return Symtab.get(); }
+  BitcodeSymbolTable *getSymbolTable() { return Symtab.get(); }
+
   static inline bool classof(const Binary *v) {
     return v->isIR();
   }
@@ -67,6 +84,12 @@ public:
 
   static ErrorOr<std::unique_ptr<IRObjectFile>> create(MemoryBufferRef Object,
                                                        LLVMContext &Context);
+
+  /// \brief Create a file whose symbols come from the symbol table of the
+  /// bitcode, without parsing the module, if the bitcode has one. Otherwise
+  /// this is the same as create().
+  static ErrorOr<std::unique_ptr<IRObjectFile>>
+  createFromSymbolTable(MemoryBufferRef Object, LLVMContext &Context);
 };
 }
 }
@@ -304,6 +304,15 @@ public:
   ///
   virtual bool runOnFunction(Function &F) = 0;
 
+  /// isThreadSafe - Return true if this pass can run on different functions
+  /// of a module at the same time. When the pass manager runs functions
+  /// concurrently, each thread uses its own instance of the pass, created
+  /// through the PassRegistry, so the pass must be registered and default
+  /// constructible. It must not modify anything that is shared between
+  /// functions: in particular it may not create types, constants or metadata
+  /// in the LLVMContext, nor add or remove uses of globals and constants.
+  virtual bool isThreadSafe() const { return false; }
+
   void assignPassManager(PMStack &PMS, PassManagerType T) override;
 
   ///  Return what kind of Pass Manager can manage this pass.
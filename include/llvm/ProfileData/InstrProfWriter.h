@@ -17,6 +17,7 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Support/DataTypes.h"
@@ -36,12 +37,19 @@ private:
 public:
   InstrProfWriter() : MaxFunctionCount(0) {}
 
-  /// Add function counts for the given function. If there are already counts
-  /// for this function and the hash and number of counts match, each counter is
-  /// summed.
+  /// Add function counts for the given function, multiplied by \p Weight. If
+  /// there are already counts for this function and the hash and number of
+  /// counts match, each counter is summed.
   std::error_code addFunctionCounts(StringRef FunctionName,
                                     uint64_t FunctionHash,
-                                    ArrayRef<uint64_t> Counters);
+                                    ArrayRef<uint64_t> Counters,
+                                    uint64_t Weight = 1);
+  /// Add the function counts of \p IPW to this writer. The counts of functions
+  /// this writer has not seen are taken over unchanged; \p Warn is called for
+  /// the functions whose counts could not be added.
+  void mergeRecordsFromWriter(
+      InstrProfWriter &&IPW,
+      function_ref<void(StringRef, std::error_code)> Warn);
   /// Write the profile to \c OS
   void write(raw_fd_ostream &OS);
   /// Write the profile, returning the raw data. For testing.
@@ -19,7 +19,10 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -113,6 +116,7 @@ namespace sampleprof {
 class SampleRecord {
 public:
   typedef StringMap<unsigned> CallTargetMap;
+  typedef std::vector<std::pair<StringRef, unsigned>> SortedCallTargetList;
 
   SampleRecord() : NumSamples(0), CallTargets() {}
 
@@ -145,6 +149,17 @@ public:
   unsigned getSamples() const { return NumSamples; }
   const CallTargetMap &getCallTargets() const { return CallTargets; }
 
+  /// \brief Return the call targets sorted by name. Profiles are written and
+  /// printed in this order, so that they do not depend on the order of the
+  /// CallTargetMap.
+  SortedCallTargetList getSortedCallTargets() const {
+    SortedCallTargetList Sorted;
+    for (const auto &I : CallTargets)
+      Sorted.push_back(std::make_pair(I.first(), I.second));
+    std::sort(Sorted.begin(), Sorted.end());
+    return Sorted;
+  }
+
   /// \brief Merge the samples in \p Other into this record.
   void merge(const SampleRecord &Other) {
     addSamples(Other.getSamples());
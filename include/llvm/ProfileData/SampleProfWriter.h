@@ -57,16 +57,18 @@ public:
     return true;
   }
 
-  /// \brief Write all the sample profiles in the given map of samples.
+  /// \brief Write all the sample profiles in the given map of samples, sorted
+  /// by function name.
   ///
   /// \returns true if the file was updated successfully. False, otherwise.
   bool write(StringMap<FunctionSamples> &ProfileMap) {
-    for (auto &I : ProfileMap) {
-      StringRef FName = I.first();
-      FunctionSamples &Profile = I.second;
-      if (!write(FName, Profile))
+    std::vector<StringRef> Names;
+    for (const auto &I : ProfileMap)
+      Names.push_back(I.first());
+    std::sort(Names.begin(), Names.end());
+    for (StringRef FName : Names)
+      if (!write(FName, ProfileMap[FName]))
         return false;
-    }
     return true;
   }
 
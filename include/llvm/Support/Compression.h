@@ -15,6 +15,7 @@
 #define LLVM_SUPPORT_COMPRESSION_H
 
 #include "llvm/Support/DataTypes.h"
+#include <vector>
 
 namespace llvm {
 template <typename T> class SmallVectorImpl;
@@ -49,6 +50,49 @@ Status uncompress(StringRef InputBuffer,
 
 uint32_t crc32(StringRef Buffer);
 
+/// Compresses a stream of data into a single zlib stream, which uncompress()
+/// and any other zlib consumer can read.
+///
+/// The data is split in chunks of a fixed size, which are deflated
+/// independently and concurrently. Each chunk uses the end of the previous one
+/// as its dictionary, so the output only depends on the data and the chunk
+/// size, and is barely larger than the one of compress(). Only a batch of
+/// chunks is buffered at a time, however large the stream is.
+class ChunkedCompressor {
+public:
+  enum : size_t { DefaultChunkSize = 256 * 1024 };
+
+  /// Appends the compressed stream to \p CompressedBuffer.
+  ChunkedCompressor(SmallVectorImpl<char> &CompressedBuffer,
+                    CompressionLevel Level = DefaultCompression,
+                    size_t ChunkSize = DefaultChunkSize);
+
+  /// Adds \p Data to the stream.
+  void write(StringRef Data);
+
+  /// Compresses the rest of the stream and ends it. The compressor must not be
+  /// used afterwards.
+  Status finish();
+
+  /// Returns the number of bytes written to the stream so far.
+  uint64_t getUncompressedSize() const { return UncompressedSize; }
+
+private:
+  /// Deflates the data of Buffer that isn't compressed yet.
+  void compressPending(bool Final);
+
+  SmallVectorImpl<char> &Out;
+  CompressionLevel Level;
+  size_t ChunkSize;
+  /// The data to compress, preceded by the last DictionarySize bytes of the
+  /// data already compressed.
+  std::vector<char> Buffer;
+  size_t DictionarySize;
+  uint32_t Checksum;
+  uint64_t UncompressedSize;
+  Status Result;
+};
+
 }  // End of namespace zlib
 
 } // End of namespace llvm
@@ -15,9 +15,12 @@
 #define LLVM_SUPPORT_FILEOUTPUTBUFFER_H
 
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
 
 namespace llvm {
 /// FileOutputBuffer - This interface provides simple way to create an in-memory
@@ -84,6 +87,68 @@ private:
   SmallString<128>    FinalPath;
   SmallString<128>    TempPath;
 };
+
+/// raw_mapped_file_ostream - A raw_pwrite_stream that writes into a
+/// FileOutputBuffer. Once the client has told the stream how large the output
+/// is going to be with reserveExtraSpace(), the stream's buffer points
+/// directly into the mapped file, so the output is written in place without
+/// being copied or seeked. Output that was written before the reservation or
+/// that does not fit into it is kept in memory and copied into the file when
+/// the stream is committed. If the stream is destroyed without being
+/// committed, the file is not written.
+///
+/// The output is written to a temporary file that is renamed over the
+/// destination on commit, so an existing file is replaced rather than
+/// rewritten: hard links to it keep the old contents, and the new file gets
+/// the owner and group of the process. Clients that need to keep either
+/// should use tool_output_file.
+class raw_mapped_file_ostream : public raw_pwrite_stream {
+  SmallString<128> Path;
+  unsigned Flags;
+
+  /// The mapped file, once space has been reserved.
+  std::unique_ptr<FileOutputBuffer> Buffer;
+
+  /// The number of bytes that have been written into Buffer.
+  uint64_t MappedSize = 0;
+
+  /// The output that follows the mapped bytes.
+  SmallVector<char, 0> Tail;
+
+  /// See raw_ostream::write_impl.
+  void write_impl(const char *Ptr, size_t Size) override;
+
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
+
+  /// Return the current position within the stream, not counting the bytes
+  /// currently in the buffer.
+  uint64_t current_pos() const override { return MappedSize + Tail.size(); }
+
+  /// Point the raw_ostream buffer at the next free byte of the mapped file,
+  /// or at the end of Tail once the mapped file is full.
+  void resetBuffer();
+
+public:
+  /// Construct a stream that writes to the file at \p Path when committed.
+  /// \p Flags are passed on to FileOutputBuffer::create.
+  explicit raw_mapped_file_ostream(StringRef Path, unsigned Flags = 0);
+  ~raw_mapped_file_ostream() override;
+
+  /// Map a file large enough for the current output and \p ExtraSize more
+  /// bytes, and write to it from now on. This only has an effect the first
+  /// time it is called; if the file cannot be mapped, the output stays in
+  /// memory and the error is reported by commit().
+  void reserveExtraSpace(uint64_t ExtraSize) override;
+
+  /// Write the output to the file. The stream must not be written to after
+  /// it has been committed.
+  std::error_code commit();
+
+  /// Return true if \p Path does not exist or is a regular file, which is
+  /// what FileOutputBuffer can replace. Devices, pipes and symlinks need a
+  /// raw_fd_ostream instead.
+  static bool isMappable(StringRef Path);
+};
 } // end namespace llvm
 
 #endif
@@ -480,6 +480,18 @@ bool is_other(file_status status);
 ///          platform-specific error_code.
 std::error_code is_other(const Twine &path, bool &result);
 
+/// @brief Is path a symbolic link?
+///
+/// Unlike the other predicates, this looks at \a path itself rather than at
+/// the file it refers to.
+///
+/// @param path Input path.
+/// @param result Set to true if \a path is a symbolic link, false if it is
+///               not. Undefined otherwise.
+/// @returns errc::success if result has been successfully set, otherwise a
+///          platform-specific error_code.
+std::error_code is_symlink(const Twine &path, bool &result);
+
 /// @brief Get file status as if by POSIX stat().
 ///
 /// @param path Input path.
@@ -0,0 +1,184 @@
+//===- llvm/Support/Parallel.h - Parallel algorithms ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines parallel versions of a few standard algorithms:
+// parallel_for_each, parallel_sort and parallel_transform_reduce. The work is
+// run on a thread pool shared by the whole process, with the calling thread
+// taking part in it.
+//
+// The results of these algorithms never depend on the number of threads or on
+// the scheduling of the work: parallel_sort is a stable sort, and
+// parallel_transform_reduce always combines the same partial results in the
+// same order. When LLVM is built without thread support everything runs on the
+// calling thread.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/ADT/STLExtras.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace llvm {
+
+namespace detail {
+/// Calls \p Fn once for every task index in [0, NumTasks), potentially
+/// concurrently. Returns once all calls have completed. Calls may be nested:
+/// the calling thread runs tasks itself rather than blocking on the pool.
+void parallel_for_tasks(size_t NumTasks, function_ref<void(size_t)> Fn);
+
+/// Ranges with fewer elements than this are not worth distributing.
+enum { MinParallelSize = 1024 };
+
+/// Returns the number of tasks to split a range of \p N elements into. It only
+/// depends on N so that results do not vary with the number of threads.
+inline size_t getNumTasks(size_t N) {
+  const size_t MaxTasks = 64;
+  return std::max<size_t>(1, std::min(MaxTasks, N / MinParallelSize));
+}
+
+/// Returns the position at which task \p I of \p NumTasks over \p N elements
+/// begins.
+inline size_t getTaskBegin(size_t N, size_t NumTasks, size_t I) {
+  return N / NumTasks * I + std::min(I, N % NumTasks);
+}
+} // end namespace detail
+
+/// Calls \p Fn for every index in [\p Begin, \p End), potentially
+/// concurrently.
+template <class IndexTy, class FuncTy>
+void parallel_for(IndexTy Begin, IndexTy End, FuncTy Fn) {
+  if (End <= Begin)
+    return;
+  size_t N = End - Begin;
+  size_t NumTasks = detail::getNumTasks(N);
+  detail::parallel_for_tasks(NumTasks, [&](size_t Task) {
+    IndexTy I = Begin + detail::getTaskBegin(N, NumTasks, Task);
+    IndexTy E = Begin + detail::getTaskBegin(N, NumTasks, Task + 1);
+    for (; I != E; ++I)
+      Fn(I);
+  });
+}
+
+/// Calls \p Fn for every index in [\p Begin, \p End), potentially
+/// concurrently, with every call scheduled as a task of its own. parallel_for
+/// only distributes ranges that are large enough to amortize the cost of a
+/// task; this is for a few expensive calls, such as one per input file.
+template <class IndexTy, class FuncTy>
+void parallel_for_each_task(IndexTy Begin, IndexTy End, FuncTy Fn) {
+  if (End <= Begin)
+    return;
+  detail::parallel_for_tasks(End - Begin,
+                             [&](size_t Task) { Fn(Begin + Task); });
+}
+
+/// Calls \p Fn for every element of [\p Begin, \p End), potentially
+/// concurrently. \p Fn must be safe to call on distinct elements at the same
+/// time.
+template <class RandomAccessIterator, class FuncTy>
+void parallel_for_each(RandomAccessIterator Begin, RandomAccessIterator End,
+                       FuncTy Fn) {
+  parallel_for<size_t>(0, End - Begin, [&](size_t I) { Fn(Begin[I]); });
+}
+
+template <class RangeTy, class FuncTy>
+void parallel_for_each(RangeTy &&Range, FuncTy Fn) {
+  parallel_for_each(std::begin(Range), std::end(Range), Fn);
+}
+
+/// Sorts [\p Begin, \p End) according to \p Comp. The sort is stable, so the
+/// result is the same as the one of std::stable_sort.
+///
+/// The range is split in chunks which are sorted concurrently, then adjacent
+/// chunks are merged pairwise until a single sorted range is left.
+template <class RandomAccessIterator, class Comparator>
+void parallel_sort(RandomAccessIterator Begin, RandomAccessIterator End,
+                   Comparator Comp) {
+  size_t N = End - Begin;
+  size_t NumTasks = detail::getNumTasks(N);
+  if (NumTasks == 1) {
+    std::stable_sort(Begin, End, Comp);
+    return;
+  }
+
+  auto ChunkBegin = [&](size_t I) {
+    return Begin + detail::getTaskBegin(N, NumTasks, std::min(I, NumTasks));
+  };
+  detail::parallel_for_tasks(NumTasks, [&](size_t I) {
+    std::stable_sort(ChunkBegin(I), ChunkBegin(I + 1), Comp);
+  });
+  // Each round merges pairs of sorted runs of Width chunks. Merging adjacent
+  // runs keeps equal elements in their original order.
+  for (size_t Width = 1; Width < NumTasks; Width *= 2) {
+    size_t NumMerges = (NumTasks + 2 * Width - 1) / (2 * Width);
+    detail::parallel_for_tasks(NumMerges, [&](size_t I) {
+      size_t First = 2 * Width * I;
+      std::inplace_merge(ChunkBegin(First), ChunkBegin(First + Width),
+                         ChunkBegin(First + 2 * Width), Comp);
+    });
+  }
+}
+
+template <class RandomAccessIterator>
+void parallel_sort(RandomAccessIterator Begin, RandomAccessIterator End) {
+  parallel_sort(
+      Begin, End,
+      std::less<
+          typename std::iterator_traits<RandomAccessIterator>::value_type>());
+}
+
+/// Applies \p Transform to every element of [\p Begin, \p End), potentially
+/// concurrently, and combines the results with \p Reduce, starting from
+/// \p Init. \p Reduce must be associative. Partial results are always combined
+/// in the same order, so the result is deterministic even for operations that
+/// are not exactly associative, like floating point additions.
+template <class RandomAccessIterator, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(RandomAccessIterator Begin,
+                                   RandomAccessIterator End, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  size_t N = End - Begin;
+  if (N == 0)
+    return Init;
+  size_t NumTasks = detail::getNumTasks(N);
+  std::vector<ResultTy> Results(NumTasks, Init);
+  detail::parallel_for_tasks(NumTasks, [&](size_t Task) {
+    RandomAccessIterator I = Begin + detail::getTaskBegin(N, NumTasks, Task);
+    RandomAccessIterator E =
+        Begin + detail::getTaskBegin(N, NumTasks, Task + 1);
+    ResultTy R = Transform(*I);
+    for (++I; I != E; ++I)
+      R = Reduce(R, Transform(*I));
+    Results[Task] = std::move(R);
+  });
+
+  ResultTy Result = std::move(Init);
+  for (ResultTy &R : Results)
+    Result = Reduce(Result, std::move(R));
+  return Result;
+}
+
+template <class RangeTy, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(RangeTy &&Range, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  return parallel_transform_reduce(std::begin(Range), std::end(Range),
+                                   std::move(Init), Reduce, Transform);
+}
+
+} // end namespace llvm
+
+#endif
@@ -127,6 +127,11 @@ public:
     return OutBufCur - OutBufStart;
   }
 
+  /// Tell the stream that \p ExtraSize more bytes are about to be
+  /// written to it. Streams that write into memory can use this to allocate
+  /// their storage once instead of growing it while the output is written.
+  virtual void reserveExtraSpace(uint64_t ExtraSize) {}
+
   //===--------------------------------------------------------------------===//
   // Data Output Interface
   //===--------------------------------------------------------------------===//
@@ -502,6 +507,7 @@ public:
   explicit raw_svector_ostream(SmallVectorImpl<char> &O);
   ~raw_svector_ostream() override;
 
+  void reserveExtraSpace(uint64_t ExtraSize) override;
 
   /// This is called when the SmallVector we're appending to is changed outside
   /// of the raw_svector_ostream's control.  It is only safe to do this if the
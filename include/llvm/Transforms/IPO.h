@@ -16,12 +16,14 @@
 #define LLVM_TRANSFORMS_IPO_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include <string>
 
 namespace llvm {
 
 class ModulePass;
 class Pass;
 class Function;
+class FunctionInfoIndex;
 class BasicBlock;
 class GlobalValue;
 
@@ -199,6 +201,16 @@ ModulePass *createMetaRenamerPass();
 /// manager.
 ModulePass *createBarrierNoopPass();
 
+/// \brief This pass imports into the module the small functions of other
+/// modules that it calls, according to \p Index, the combined function
+/// summary index of the modules, or to the one read from -summary-file.
+///
+/// Errors are fatal, unless \p ErrMsg is given: then the pass stores them
+/// there instead of printing anything or exiting, so it can run on threads of
+/// its own.
+ModulePass *createFunctionImportPass(const FunctionInfoIndex *Index = nullptr,
+                                     std::string *ErrMsg = nullptr);
+
 /// \brief This pass lowers bitset metadata and the llvm.bitset.test intrinsic
 /// to bitsets.
 ModulePass *createLowerBitSetsPass();
@@ -0,0 +1,87 @@
+//===- FunctionImport.h - Summary-based function importing ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the FunctionImporter class, which imports into a module
+// the definitions of functions of other modules that a combined function
+// summary index says are worth importing.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_FUNCTIONIMPORT_H
+#define LLVM_TRANSFORMS_IPO_FUNCTIONIMPORT_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/Support/ErrorOr.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace llvm {
+
+class FunctionInfoIndex;
+class LLVMContext;
+class Module;
+
+/// \brief Imports into a module the definitions of the functions it calls
+/// that other modules define, when the combined summary index says they are
+/// small enough, and recursively the functions those call.
+///
+/// Imported functions keep their bodies but become available_externally (or
+/// stay linkonce_odr), so the module can inline them without emitting them.
+/// Source modules are loaded lazily: only the bodies of the imported
+/// functions are materialized.
+class FunctionImporter {
+public:
+  /// The names of the functions to import, keyed by the path of the module
+  /// that defines them.
+  typedef StringMap<std::vector<std::string>> ImportListTy;
+
+  /// Loads the module at the given path in the given context, lazily.
+  typedef std::function<ErrorOr<std::unique_ptr<Module>>(StringRef Path,
+                                                         LLVMContext &Context)>
+      ModuleLoaderTy;
+
+private:
+  const FunctionInfoIndex &Index;
+  ModuleLoaderTy ModuleLoader;
+  DiagnosticHandlerFunction DiagnosticHandler;
+
+public:
+  /// Import from the modules of \p Index, which are loaded from their bitcode
+  /// files unless a \p ModuleLoader is given.
+  FunctionImporter(const FunctionInfoIndex &Index,
+                   ModuleLoaderTy ModuleLoader = nullptr,
+                   DiagnosticHandlerFunction DiagnosticHandler = nullptr);
+
+  /// Compute what to import into \p M: the importable functions it declares,
+  /// and calls, whose summaries have at most \p InstLimit instructions, and
+  /// the functions they call, with a limit that decreases with the depth of
+  /// the call chain. Cold functions are not imported.
+  static void computeImportList(const Module &M,
+                                const FunctionInfoIndex &Index,
+                                unsigned InstLimit, ImportListTy &ImportList);
+
+  /// Import into \p M the functions of \p ImportList.
+  /// Returns true on error, and describes it in \p ErrMsg. Errors the linker
+  /// reports go to the diagnostic handler first.
+  bool importFunctions(Module &M, const ImportListTy &ImportList,
+                       std::string &ErrMsg);
+
+  /// Import into \p M what computeImportList() selects.
+  /// Returns true on error, and describes it in \p ErrMsg.
+  bool importFunctions(Module &M, unsigned InstLimit, std::string &ErrMsg);
+};
+
+} // End llvm namespace
+
+#endif
@@ -0,0 +1,44 @@
+//===- SplitModule.h - Split a module into partitions -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the function llvm::SplitModule, which splits a module
+// into multiple linkable partitions. It can be used to implement parallel code
+// generation for link-time optimization.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_UTILS_SPLITMODULE_H
+#define LLVM_TRANSFORMS_UTILS_SPLITMODULE_H
+
+#include <functional>
+#include <memory>
+
+namespace llvm {
+
+class Module;
+
+/// Splits the module M into N linkable partitions. The function ModuleCallback
+/// is called N times passing each individual partition as the MPart argument.
+///
+/// Globals that must be emitted together (members of the same comdat, aliases
+/// and their aliasees, functions referenced by a blockaddress) always land in
+/// the same partition. Beyond that, callers and callees are kept together as
+/// long as the partitions stay roughly balanced in size. Local symbols that
+/// end up being referenced from another partition are promoted to hidden
+/// external symbols with a unique name, so M is modified in place.
+///
+/// FIXME: Local symbols defined in module-level inline asm are not made
+/// visible to the other partitions.
+void SplitModule(
+    Module &M, unsigned N,
+    std::function<void(std::unique_ptr<Module> MPart)> ModuleCallback);
+
+} // End llvm namespace
+
+#endif
@@ -12,6 +12,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeSymbolTable.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
 #include "llvm/IR/AutoUpgrade.h"
@@ -20,6 +21,7 @@
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/IR/FunctionInfo.h"
 #include "llvm/IR/GVMaterializer.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/IntrinsicInst.h"
@@ -253,6 +255,16 @@ public:
   /// @returns true if an error occurred.
   ErrorOr<std::string> parseTriple();
 
+  /// @brief Read the symbol table following the module, skipping the module.
+  /// @returns null if there is no symbol table.
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>> parseSymbolTable();
+
+  /// @brief Read the function summaries following the module, or those of a
+  /// combined index, skipping the module.
+  /// @returns null if there are no summaries.
+  ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+  parseFunctionInfoIndex(StringRef ModulePath);
+
   static uint64_t decodeSignRotatedValue(uint64_t V);
 
   /// Materialize any deferred Metadata block.
@@ -372,6 +384,10 @@ private:
   std::error_code ParseMetadata();
   std::error_code ParseMetadataAttachment();
   ErrorOr<std::string> parseModuleTriple();
+  std::error_code parseSymbolTableBlock(BitcodeSymbolTable &Symtab);
+  std::error_code parseFunctionSummaryBlock(FunctionInfoIndex &Index,
+                                            StringRef ModulePath);
+  std::error_code findTopLevelBlock(unsigned BlockID, bool &Found);
   std::error_code ParseUseLists();
   std::error_code InitStream();
   std::error_code InitStreamFromBuffer();
@@ -3199,6 +3215,234 @@ ErrorOr<std::string> BitcodeReader::parseTriple() {
   }
 }
 
+std::error_code
+BitcodeReader::parseSymbolTableBlock(BitcodeSymbolTable &Symtab) {
+  if (Stream.EnterSubBlock(bitc::SYMTAB_BLOCK_ID))
+    return Error("Invalid record");
+
+  SmallVector<uint64_t, 64> Record;
+
+  // Read all the records for this symbol table.
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return Error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      return std::error_code();
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default: break;  // Default behavior, ignore unknown content.
+    case bitc::SYMTAB_CODE_TRIPLE: {  // TRIPLE: [strchr x N]
+      if (ConvertToString(Record, 0, Symtab.TargetTriple))
+        return Error("Invalid record");
+      break;
+    }
+    case bitc::SYMTAB_CODE_COMDAT: {  // COMDAT: [selection_kind, strchr x N]
+      std::string Name;
+      if (Record.empty() || ConvertToString(Record, 1, Name))
+        return Error("Invalid record");
+      Symtab.Comdats.push_back(
+          std::make_pair(Name, getDecodedComdatSelectionKind(Record[0])));
+      break;
+    }
+    // SYMBOL: [flags, linkage, visibility, alignment, comdat, commonsize,
+    //          strchr x N]
+    case bitc::SYMTAB_CODE_SYMBOL: {
+      if (Record.size() < 6)
+        return Error("Invalid record");
+      BitcodeSymbolTable::Symbol Sym;
+      Sym.Flags = Record[0];
+      Sym.Linkage = getDecodedLinkage(Record[1]);
+      Sym.Visibility = GetDecodedVisibility(Record[2]);
+      if (std::error_code EC = parseAlignmentValue(Record[3], Sym.Alignment))
+        return EC;
+      if (Record[4] > Symtab.Comdats.size())
+        return Error("Invalid comdat");
+      Sym.Comdat = int(Record[4]) - 1;
+      Sym.CommonSize = Record[5];
+      if (ConvertToString(Record, 6, Sym.Name))
+        return Error("Invalid record");
+      Symtab.Symbols.push_back(std::move(Sym));
+      break;
+    }
+    case bitc::SYMTAB_CODE_LINKER_OPTION: {  // LINKER_OPTION: [strchr x N]
+      std::string Option;
+      if (ConvertToString(Record, 0, Option))
+        return Error("Invalid record");
+      Symtab.LinkerOptions.push_back(Option);
+      break;
+    }
+    }
+  }
+}
+
+std::error_code
+BitcodeReader::parseFunctionSummaryBlock(FunctionInfoIndex &Index,
+                                         StringRef ModulePath) {
+  if (Stream.EnterSubBlock(bitc::FUNCTION_SUMMARY_BLOCK_ID))
+    return Error("Invalid record");
+
+  SmallVector<uint64_t, 64> Record;
+  std::vector<std::string> Names;
+  bool HasModulePaths = false;
+
+  // Read all the records for this block.
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return Error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      if (!HasModulePaths)
+        Index.addModulePath(ModulePath);
+      return std::error_code();
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default: break;  // Default behavior, ignore unknown content.
+    case bitc::FS_CODE_MODULE_PATH: {  // MODULE_PATH: [strchr x N]
+      std::string Path;
+      if (ConvertToString(Record, 0, Path))
+        return Error("Invalid record");
+      Index.addModulePath(Path);
+      HasModulePaths = true;
+      break;
+    }
+    case bitc::FS_CODE_NAME: {  // NAME: [strchr x N]
+      std::string Name;
+      if (ConvertToString(Record, 0, Name))
+        return Error("Invalid record");
+      Names.push_back(std::move(Name));
+      break;
+    }
+    // ENTRY: [nameid, moduleid, flags, instcount,
+    //         n x [calleenameid, callsites]]
+    case bitc::FS_CODE_ENTRY: {
+      if (Record.size() < 4 || Record.size() % 2 != 0 ||
+          Record[0] >= Names.size())
+        return Error("Invalid record");
+      // The summaries of a single module don't name it.
+      if (!HasModulePaths) {
+        Index.addModulePath(ModulePath);
+        HasModulePaths = true;
+      }
+      if (Record[1] >= Index.getModulePaths().size())
+        return Error("Invalid record");
+      FunctionSummary Summary;
+      Summary.Flags = Record[2];
+      Summary.InstCount = Record[3];
+      for (unsigned I = 4, E = Record.size(); I != E; I += 2) {
+        if (Record[I] >= Names.size())
+          return Error("Invalid record");
+        Summary.Calls.push_back(
+            std::make_pair(Names[Record[I]], unsigned(Record[I + 1])));
+      }
+      Index.addFunction(Names[Record[0]], Record[1], std::move(Summary));
+      break;
+    }
+    }
+  }
+}
+
+/// Move to the top-level block \p BlockID, skipping the others without
+/// looking inside them. On success, \p Found tells whether the block was
+/// found, and if it was, the stream is positioned to enter it.
+std::error_code BitcodeReader::findTopLevelBlock(unsigned BlockID,
+                                                 bool &Found) {
+  Found = false;
+  if (std::error_code EC = InitStream())
+    return EC;
+
+  // Sniff for the signature.
+  if (Stream.Read(8) != 'B' ||
+      Stream.Read(8) != 'C' ||
+      Stream.Read(4) != 0x0 ||
+      Stream.Read(4) != 0xC ||
+      Stream.Read(4) != 0xE ||
+      Stream.Read(4) != 0xD)
+    return Error("Invalid bitcode signature");
+
+  while (1) {
+    if (Stream.AtEndOfStream())
+      return std::error_code();
+
+    BitstreamEntry Entry = Stream.advance();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return Error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      return std::error_code();
+
+    case BitstreamEntry::SubBlock:
+      if (Entry.ID == BlockID) {
+        Found = true;
+        return std::error_code();
+      }
+
+      // Skip the module, and any other blocks, without looking inside.
+      if (Stream.SkipBlock())
+        return Error("Malformed block");
+      continue;
+
+    case BitstreamEntry::Record:
+      // There should be no records in the top-level of blocks, except for the
+      // padding the ranlib in Xcode 4 adds (see ParseBitcodeInto).
+      if (Stream.getAbbrevIDWidth() == 2 && Entry.ID == 2 &&
+          Stream.Read(6) == 2 && Stream.Read(24) == 0xa0a0a &&
+          Stream.AtEndOfStream())
+        return std::error_code();
+
+      return Error("Invalid record");
+    }
+  }
+}
+
+ErrorOr<std::unique_ptr<BitcodeSymbolTable>>
+BitcodeReader::parseSymbolTable() {
+  bool Found;
+  if (std::error_code EC = findTopLevelBlock(bitc::SYMTAB_BLOCK_ID, Found))
+    return EC;
+  if (!Found)
+    return std::unique_ptr<BitcodeSymbolTable>();
+
+  auto Symtab = llvm::make_unique<BitcodeSymbolTable>();
+  if (std::error_code EC = parseSymbolTableBlock(*Symtab))
+    return EC;
+  return std::move(Symtab);
+}
+
+ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+BitcodeReader::parseFunctionInfoIndex(StringRef ModulePath) {
+  bool Found;
+  if (std::error_code EC =
+          findTopLevelBlock(bitc::FUNCTION_SUMMARY_BLOCK_ID, Found))
+    return EC;
+  if (!Found)
+    return std::unique_ptr<FunctionInfoIndex>();
+
+  auto Index = llvm::make_unique<FunctionInfoIndex>();
+  if (std::error_code EC = parseFunctionSummaryBlock(*Index, ModulePath))
+    return EC;
+  return std::move(Index);
+}
+
 /// ParseMetadataAttachment - Parse metadata attachments.
 std::error_code BitcodeReader::ParseMetadataAttachment() {
   if (Stream.EnterSubBlock(bitc::METADATA_ATTACHMENT_ID))
@@ -4609,3 +4853,21 @@ llvm::getBitcodeTargetTriple(MemoryBufferRef Buffer, LLVMContext &Context,
     return "";
   return Triple.get();
 }
+
+ErrorOr<std::unique_ptr<BitcodeSymbolTable>>
+llvm::readBitcodeSymbolTable(MemoryBufferRef Buffer, LLVMContext &Context,
+                             DiagnosticHandlerFunction DiagnosticHandler) {
+  std::unique_ptr<MemoryBuffer> Buf = MemoryBuffer::getMemBuffer(Buffer, false);
+  auto R = llvm::make_unique<BitcodeReader>(Buf.release(), Context,
+                                            DiagnosticHandler);
+  return R->parseSymbolTable();
+}
+
+ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+llvm::readFunctionInfoIndex(MemoryBufferRef Buffer, LLVMContext &Context,
+                            DiagnosticHandlerFunction DiagnosticHandler) {
+  std::unique_ptr<MemoryBuffer> Buf = MemoryBuffer::getMemBuffer(Buffer, false);
+  auto R = llvm::make_unique<BitcodeReader>(Buf.release(), Context,
+                                            DiagnosticHandler);
+  return R->parseFunctionInfoIndex(Buffer.getBufferIdentifier());
+}
@@ -13,14 +13,18 @@
 
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "ValueEnumerator.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeSymbolTable.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/FunctionInfo.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/UseListOrder.h"
@@ -30,6 +34,7 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cctype>
 #include <map>
 using namespace llvm;
@@ -479,8 +484,8 @@ static void WriteTypeTable(const ValueEnumerator &VE, BitstreamWriter &Stream) {
   Stream.ExitBlock();
 }
 
-static unsigned getEncodedLinkage(const GlobalValue &GV) {
-  switch (GV.getLinkage()) {
+static unsigned getEncodedLinkage(const GlobalValue::LinkageTypes Linkage) {
+  switch (Linkage) {
   case GlobalValue::ExternalLinkage:
     return 0;
   case GlobalValue::WeakAnyLinkage:
@@ -507,8 +512,13 @@ static unsigned getEncodedLinkage(const GlobalValue &GV) {
   llvm_unreachable("Invalid linkage");
 }
 
-static unsigned getEncodedVisibility(const GlobalValue &GV) {
-  switch (GV.getVisibility()) {
+static unsigned getEncodedLinkage(const GlobalValue &GV) {
+  return getEncodedLinkage(GV.getLinkage());
+}
+
+static unsigned
+getEncodedVisibility(const GlobalValue::VisibilityTypes Visibility) {
+  switch (Visibility) {
   case GlobalValue::DefaultVisibility:   return 0;
   case GlobalValue::HiddenVisibility:    return 1;
   case GlobalValue::ProtectedVisibility: return 2;
@@ -516,6 +526,10 @@ static unsigned getEncodedVisibility(const GlobalValue &GV) {
   llvm_unreachable("Invalid visibility");
 }
 
+static unsigned getEncodedVisibility(const GlobalValue &GV) {
+  return getEncodedVisibility(GV.getVisibility());
+}
+
 static unsigned getEncodedDLLStorageClass(const GlobalValue &GV) {
   switch (GV.getDLLStorageClass()) {
   case GlobalValue::DefaultStorageClass:   return 0;
@@ -536,8 +550,8 @@ static unsigned getEncodedThreadLocalMode(const GlobalValue &GV) {
   llvm_unreachable("Invalid TLS model");
 }
 
-static unsigned getEncodedComdatSelectionKind(const Comdat &C) {
-  switch (C.getSelectionKind()) {
+static unsigned getEncodedComdatSelectionKind(Comdat::SelectionKind SK) {
+  switch (SK) {
   case Comdat::Any:
     return bitc::COMDAT_SELECTION_KIND_ANY;
   case Comdat::ExactMatch:
@@ -552,6 +566,10 @@ static unsigned getEncodedComdatSelectionKind(const Comdat &C) {
   llvm_unreachable("Invalid selection kind");
 }
 
+static unsigned getEncodedComdatSelectionKind(const Comdat &C) {
+  return getEncodedComdatSelectionKind(C.getSelectionKind());
+}
+
 static void writeComdats(const ValueEnumerator &VE, BitstreamWriter &Stream) {
   SmallVector<uint16_t, 64> Vals;
   for (const Comdat *C : VE.getComdats()) {
@@ -2367,6 +2385,230 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream,
   Stream.ExitBlock();
 }
 
+bool llvm::buildBitcodeSymbolTable(const Module &M,
+                                   BitcodeSymbolTable &Symtab) {
+  if (M.getDataLayoutStr().empty() || !M.getModuleInlineAsm().empty())
+    return false;
+
+  Symtab.TargetTriple = M.getTargetTriple();
+
+  const DataLayout &DL = M.getDataLayout();
+  Mangler Mang(&DL);
+  DenseMap<const Comdat *, int> ComdatIndices;
+  auto AddSymbol = [&](const GlobalValue &GV) {
+    if (StringRef(GV.getSection()).startswith("__OBJC,"))
+      return false;
+
+    const GlobalObject *Base = dyn_cast<GlobalObject>(&GV);
+    if (!Base)
+      Base = cast<GlobalAlias>(GV).getBaseObject();
+    if (!Base)
+      return false;
+
+    BitcodeSymbolTable::Symbol Sym;
+    {
+      raw_string_ostream OS(Sym.Name);
+      Mang.getNameWithPrefix(OS, &GV, false);
+    }
+    Sym.Linkage = GV.getLinkage();
+    Sym.Visibility = GV.getVisibility();
+    Sym.Alignment = GV.getAlignment();
+
+    auto *Var = dyn_cast<GlobalVariable>(&GV);
+    Sym.Flags = 0;
+    if (GV.isDeclarationForLinker())
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_Undefined;
+    if (isa<Function>(GV))
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_Function;
+    if (isa<GlobalAlias>(GV))
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_Alias;
+    if (Var && Var->isConstant())
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_Constant;
+    if (GV.hasUnnamedAddr())
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_UnnamedAddr;
+    if (GV.getName().startswith("llvm.") ||
+        (Var && Var->getSection() == StringRef("llvm.metadata")))
+      Sym.Flags |= BitcodeSymbolTable::Symbol::SF_FormatSpecific;
+
+    Sym.CommonSize = 0;
+    if (GV.hasCommonLinkage())
+      Sym.CommonSize = DL.getTypeAllocSize(GV.getType()->getElementType());
+
+    Sym.Comdat = -1;
+    if (const Comdat *C = Base->getComdat()) {
+      auto Insert = ComdatIndices.insert(
+          std::make_pair(C, int(Symtab.Comdats.size())));
+      if (Insert.second)
+        Symtab.Comdats.push_back(
+            std::make_pair(C->getName().str(), C->getSelectionKind()));
+      Sym.Comdat = Insert.first->second;
+    }
+
+    Symtab.Symbols.push_back(std::move(Sym));
+    return true;
+  };
+
+  for (const Function &F : M)
+    if (!AddSymbol(F))
+      return false;
+  for (const GlobalVariable &GV : M.globals())
+    if (!AddSymbol(GV))
+      return false;
+  for (const GlobalAlias &GA : M.aliases())
+    if (!AddSymbol(GA))
+      return false;
+
+  if (auto *LinkerOptions =
+          cast_or_null<MDNode>(M.getModuleFlag("Linker Options")))
+    for (const MDOperand &Options : LinkerOptions->operands())
+      for (const MDOperand &Option : cast<MDNode>(Options)->operands())
+        Symtab.LinkerOptions.push_back(cast<MDString>(Option)->getString());
+
+  return true;
+}
+
+/// WriteSymbolTable - Emit the symbols of a module, for tools that only need
+/// those, after the module block.
+static void WriteSymbolTable(const BitcodeSymbolTable &Symtab,
+                             BitstreamWriter &Stream) {
+  Stream.EnterSubblock(bitc::SYMTAB_BLOCK_ID, 3);
+
+  // SYMBOL: [flags, linkage, visibility, alignment, comdat, commonsize,
+  //          strchr x N]
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::SYMTAB_CODE_SYMBOL));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 5));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 3));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8));
+  unsigned SymbolAbbrev = Stream.EmitAbbrev(Abbv);
+
+  WriteStringRecord(bitc::SYMTAB_CODE_TRIPLE, Symtab.TargetTriple, 0, Stream);
+
+  SmallVector<uint64_t, 64> Vals;
+  for (const auto &C : Symtab.Comdats) {
+    // COMDAT: [selection_kind, strchr x N]
+    Vals.push_back(getEncodedComdatSelectionKind(C.second));
+    for (char Chr : C.first)
+      Vals.push_back((unsigned char)Chr);
+    Stream.EmitRecord(bitc::SYMTAB_CODE_COMDAT, Vals);
+    Vals.clear();
+  }
+
+  for (const BitcodeSymbolTable::Symbol &Sym : Symtab.Symbols) {
+    Vals.push_back(Sym.Flags);
+    Vals.push_back(getEncodedLinkage(Sym.Linkage));
+    Vals.push_back(getEncodedVisibility(Sym.Visibility));
+    Vals.push_back(Log2_32(Sym.Alignment) + 1);
+    Vals.push_back(Sym.Comdat + 1);
+    Vals.push_back(Sym.CommonSize);
+    for (char Chr : Sym.Name)
+      Vals.push_back((unsigned char)Chr);
+    Stream.EmitRecord(bitc::SYMTAB_CODE_SYMBOL, Vals, SymbolAbbrev);
+    Vals.clear();
+  }
+
+  for (const std::string &Option : Symtab.LinkerOptions)
+    WriteStringRecord(bitc::SYMTAB_CODE_LINKER_OPTION, Option, 0, Stream);
+
+  Stream.ExitBlock();
+}
+
+/// WriteFunctionSummary - Emit the function summaries of \p Index. The
+/// summaries of a single module are written without its path, which is known
+/// to the reader as the one of the file.
+static void WriteFunctionSummary(const FunctionInfoIndex &Index,
+                                 bool WriteModulePaths,
+                                 BitstreamWriter &Stream) {
+  Stream.EnterSubblock(bitc::FUNCTION_SUMMARY_BLOCK_ID, 3);
+
+  // NAME: [strchr x N]
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FS_CODE_NAME));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8));
+  unsigned NameAbbrev = Stream.EmitAbbrev(Abbv);
+
+  // ENTRY: [nameid, moduleid, flags, instcount,
+  //         n x [calleenameid, callsites]]
+  Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FS_CODE_ENTRY));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 2));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
+  unsigned EntryAbbrev = Stream.EmitAbbrev(Abbv);
+
+  if (WriteModulePaths)
+    for (const std::string &Path : Index.getModulePaths())
+      WriteStringRecord(bitc::FS_CODE_MODULE_PATH, Path, 0, Stream);
+
+  // Number the names of the functions and of their callees as they are first
+  // needed, emitting a NAME record for each.
+  StringMap<unsigned> NameIds;
+  SmallVector<uint64_t, 64> Vals;
+  auto GetNameId = [&](StringRef Name) {
+    auto Insert = NameIds.insert(std::make_pair(Name, NameIds.size()));
+    if (Insert.second) {
+      for (char C : Name)
+        Vals.push_back((unsigned char)C);
+      Stream.EmitRecord(bitc::FS_CODE_NAME, Vals, NameAbbrev);
+      Vals.clear();
+    }
+    return Insert.first->second;
+  };
+
+  // Write the functions in a deterministic order: by module, then by name.
+  typedef StringMapEntry<FunctionInfoIndex::Entry> FunctionEntry;
+  std::vector<const FunctionEntry *> Functions;
+  for (const auto &I : Index.functions())
+    Functions.push_back(&I);
+  std::sort(Functions.begin(), Functions.end(),
+            [](const FunctionEntry *A, const FunctionEntry *B) {
+              if (A->second.ModuleId != B->second.ModuleId)
+                return A->second.ModuleId < B->second.ModuleId;
+              return A->first() < B->first();
+            });
+
+  std::vector<unsigned> CalleeIds;
+  for (const FunctionEntry *I : Functions) {
+    const FunctionSummary &Summary = I->second.Summary;
+    unsigned NameId = GetNameId(I->first());
+    CalleeIds.clear();
+    for (const auto &Call : Summary.Calls)
+      CalleeIds.push_back(GetNameId(Call.first));
+
+    Vals.push_back(NameId);
+    Vals.push_back(I->second.ModuleId);
+    Vals.push_back(Summary.Flags);
+    Vals.push_back(Summary.InstCount);
+    for (unsigned C = 0, E = Summary.Calls.size(); C != E; ++C) {
+      Vals.push_back(CalleeIds[C]);
+      Vals.push_back(Summary.Calls[C].second);
+    }
+    Stream.EmitRecord(bitc::FS_CODE_ENTRY, Vals, EntryAbbrev);
+    Vals.clear();
+  }
+
+  Stream.ExitBlock();
+}
+
+/// WriteBitcodeHeader - Emit the magic number of bitcode files.
+static void WriteBitcodeHeader(BitstreamWriter &Stream) {
+  Stream.Emit((unsigned)'B', 8);
+  Stream.Emit((unsigned)'C', 8);
+  Stream.Emit(0x0, 4);
+  Stream.Emit(0xC, 4);
+  Stream.Emit(0xE, 4);
+  Stream.Emit(0xD, 4);
+}
+
 /// EmitDarwinBCHeader - If generating a bc file on darwin, we have to emit a
 /// header and trailer to make it compatible with the system archiver.  To do
 /// this we emit the following header, and then emit a trailer that pads the
@@ -2443,7 +2685,8 @@ static void EmitDarwinBCHeaderAndTrailer(SmallVectorImpl<char> &Buffer,
 /// WriteBitcodeToFile - Write the specified module to the specified output
 /// stream.
 void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
-                              bool ShouldPreserveUseListOrder) {
+                              bool ShouldPreserveUseListOrder,
+                              bool EmitSymbolTable, bool EmitFunctionSummary) {
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256*1024);
 
@@ -2458,15 +2701,20 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
     BitstreamWriter Stream(Buffer);
 
     // Emit the file header.
-    Stream.Emit((unsigned)'B', 8);
-    Stream.Emit((unsigned)'C', 8);
-    Stream.Emit(0x0, 4);
-    Stream.Emit(0xC, 4);
-    Stream.Emit(0xE, 4);
-    Stream.Emit(0xD, 4);
+    WriteBitcodeHeader(Stream);
 
     // Emit the module.
     WriteModule(M, Stream, ShouldPreserveUseListOrder);
+
+    BitcodeSymbolTable Symtab;
+    if (EmitSymbolTable && buildBitcodeSymbolTable(*M, Symtab))
+      WriteSymbolTable(Symtab, Stream);
+
+    if (EmitFunctionSummary) {
+      FunctionInfoIndex Index;
+      Index.addModule(*M);
+      WriteFunctionSummary(Index, /*WriteModulePaths=*/false, Stream);
+    }
   }
 
   if (TT.isOSDarwin())
@@ -2475,3 +2723,17 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
   // Write the generated bitstream to "Out".
   Out.write((char*)&Buffer.front(), Buffer.size());
 }
+
+void llvm::WriteFunctionInfoIndex(const FunctionInfoIndex &Index,
+                                  raw_ostream &Out) {
+  SmallVector<char, 0> Buffer;
+  Buffer.reserve(256 * 1024);
+
+  {
+    BitstreamWriter Stream(Buffer);
+    WriteBitcodeHeader(Stream);
+    WriteFunctionSummary(Index, /*WriteModulePaths=*/true, Stream);
+  }
+
+  Out.write((char *)&Buffer.front(), Buffer.size());
+}
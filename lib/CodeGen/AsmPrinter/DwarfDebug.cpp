@@ -1422,10 +1422,21 @@ void DwarfDebug::emitDebugPubSection(
     Asm->OutStreamer.AddComment("Compilation Unit Length");
     Asm->EmitInt32(TheU->getLength());
 
-    // Emit the pubnames for this compilation unit.
-    for (const auto &GI : Globals) {
-      const char *Name = GI.getKeyData();
-      const DIE *Entity = GI.second;
+    // Emit the pubnames for this compilation unit, in DIE order so that the
+    // output does not depend on the iteration order of the StringMap.
+    SmallVector<const StringMapEntry<const DIE *> *, 32> Entries;
+    for (const auto &GI : Globals)
+      Entries.push_back(&GI);
+    std::sort(Entries.begin(), Entries.end(),
+              [](const StringMapEntry<const DIE *> *A,
+                 const StringMapEntry<const DIE *> *B) {
+                if (A->second->getOffset() != B->second->getOffset())
+                  return A->second->getOffset() < B->second->getOffset();
+                return A->getKey() < B->getKey();
+              });
+    for (const StringMapEntry<const DIE *> *GI : Entries) {
+      const char *Name = GI->getKeyData();
+      const DIE *Entity = GI->second;
 
       Asm->OutStreamer.AddComment("DIE offset");
       Asm->EmitInt32(Entity->getOffset());
@@ -1439,7 +1450,7 @@ void DwarfDebug::emitDebugPubSection(
       }
 
       Asm->OutStreamer.AddComment("External Name");
-      Asm->OutStreamer.EmitBytes(StringRef(Name, GI.getKeyLength() + 1));
+      Asm->OutStreamer.EmitBytes(StringRef(Name, GI->getKeyLength() + 1));
     }
 
     Asm->OutStreamer.AddComment("End Mark");
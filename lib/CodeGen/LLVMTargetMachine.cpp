@@ -64,8 +64,8 @@ void LLVMTargetMachine::initAsmInfo() {
   if (Options.DisableIntegratedAS)
     TmpAsmInfo->setUseIntegratedAssembler(false);
 
-  if (Options.CompressDebugSections)
-    TmpAsmInfo->setCompressDebugSections(true);
+  if (Options.CompressDebugSections != DebugCompressionType::DCT_None)
+    TmpAsmInfo->setCompressDebugSections(Options.CompressDebugSections);
 
   AsmInfo = TmpAsmInfo;
 }
@@ -0,0 +1,101 @@
+//===-- ParallelCG.cpp ----------------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines functions that can be used for parallel code generation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/thread.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include <vector>
+
+using namespace llvm;
+
+static bool codegen(Module &M, raw_pwrite_stream &OS, TargetMachine &TM,
+                    TargetMachine::CodeGenFileType FT) {
+  legacy::PassManager CodeGenPasses;
+  if (TM.addPassesToEmitFile(CodeGenPasses, OS, FT))
+    return true;
+  CodeGenPasses.run(M);
+  return false;
+}
+
+bool llvm::splitCodeGen(
+    Module &M, ArrayRef<raw_pwrite_stream *> OSs,
+    const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
+    TargetMachine::CodeGenFileType FT) {
+  if (OSs.size() == 1)
+    return codegen(M, *OSs[0], *TMFactory(), FT);
+
+  std::vector<thread> Threads;
+  // One flag per partition; std::vector<bool> would not be safe to write from
+  // several threads.
+  std::vector<char> Failed(OSs.size(), false);
+  SplitModule(M, OSs.size(), [&](std::unique_ptr<Module> MPart) {
+    // We want to clone the module in a new context to multi-thread the codegen.
+    // We do it by serializing partition modules to bitcode (while still on the
+    // main thread, in order to avoid data races) and spinning up new threads
+    // which deserialize the partitions into separate contexts.
+    SmallVector<char, 0> BC;
+    raw_svector_ostream BCOS(BC);
+    WriteBitcodeToFile(MPart.get(), BCOS);
+    BCOS.flush();
+
+    unsigned Part = Threads.size();
+    std::shared_ptr<TargetMachine> TM = TMFactory();
+    raw_pwrite_stream *ThreadOS = OSs[Part];
+    char *ThreadFailed = &Failed[Part];
+    // Keep the module identifier, which names the source file in the output.
+    std::string ModuleID = MPart->getModuleIdentifier();
+    Threads.emplace_back(
+        [TM, FT, ThreadOS, ThreadFailed, ModuleID](
+            const SmallVector<char, 0> &BC) {
+          LLVMContext Ctx;
+          ErrorOr<Module *> MOrErr =
+              parseBitcodeFile(MemoryBufferRef(StringRef(BC.data(), BC.size()),
+                                               ModuleID),
+                               Ctx);
+          if (!MOrErr)
+            report_fatal_error("Failed to read bitcode");
+          std::unique_ptr<Module> MPartInCtx(MOrErr.get());
+          *ThreadFailed = codegen(*MPartInCtx, *ThreadOS, *TM, FT);
+        },
+        // Pass BC using std::move to ensure that it get moved rather than
+        // copied into the thread's context.
+        std::move(BC));
+  });
+
+  for (thread &T : Threads)
+    T.join();
+
+  for (char F : Failed)
+    if (F)
+      return true;
+  return false;
+}
+
+bool llvm::splitCodeGen(Module &M, ArrayRef<raw_pwrite_stream *> OSs,
+                        const TargetMachine &TM,
+                        TargetMachine::CodeGenFileType FT) {
+  return splitCodeGen(M, OSs, [&]() {
+    return std::unique_ptr<TargetMachine>(TM.getTarget().createTargetMachine(
+        TM.getTargetTriple(), TM.getTargetCPU(), TM.getTargetFeatureString(),
+        TM.Options, TM.getRelocationModel(), TM.getCodeModel(),
+        TM.getOptLevel()));
+  }, FT);
+}
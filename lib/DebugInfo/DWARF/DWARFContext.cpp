@@ -12,9 +12,12 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h"
-#include "llvm/Support/Compression.h"
+#include "llvm/Object/Decompressor.h"
 #include "llvm/Support/Dwarf.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -292,6 +295,8 @@ const DWARFDebugLocDWO *DWARFContext::getDebugLocDWO() {
 }
 
 const DWARFDebugAranges *DWARFContext::getDebugAranges() {
+  if (LookupIndex)
+    return &LookupIndex->getAranges();
   if (Aranges)
     return Aranges.get();
 
@@ -341,6 +346,72 @@ DWARFContext::getLineTableForUnit(DWARFUnit *cu) {
   return Line->getOrParseLineTable(lineData, stmtOffset);
 }
 
+const DWARFLookupIndex &DWARFContext::getLookupIndex() {
+  if (!LookupIndex) {
+    LookupIndex.reset(new DWARFLookupIndex());
+    LookupIndex->build(*this);
+  }
+  return *LookupIndex;
+}
+
+uint64_t DWARFContext::getLookupIndexKey() {
+  if (!LookupIndexKey)
+    LookupIndexKey = DWARFLookupIndex::computeKey(*this);
+  return *LookupIndexKey;
+}
+
+bool DWARFContext::loadLookupIndex(StringRef Path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = MemoryBuffer::getFile(
+      Path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return false;
+  std::unique_ptr<DWARFLookupIndex> Index(new DWARFLookupIndex());
+  if (!Index->read((*BufOrErr)->getBuffer(), getLookupIndexKey()))
+    return false;
+  LookupIndex = std::move(Index);
+  return true;
+}
+
+std::error_code DWARFContext::saveLookupIndex(StringRef Path) {
+  const DWARFLookupIndex &Index = getLookupIndex();
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC =
+          sys::fs::createUniqueFile(Path + ".tmp%%%%%%", FD, TempPath))
+    return EC;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    Index.write(OS, getLookupIndexKey());
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return make_error_code(errc::io_error);
+    }
+  }
+  if (std::error_code EC = sys::fs::rename(TempPath, Path)) {
+    sys::fs::remove(TempPath);
+    return EC;
+  }
+  return std::error_code();
+}
+
+void DWARFContext::findDIEsByName(
+    StringRef Name,
+    SmallVectorImpl<std::pair<DWARFCompileUnit *,
+                              const DWARFDebugInfoEntryMinimal *>> &DIEs) {
+  for (const DWARFLookupIndex::DIERef &Ref : getLookupIndex().findName(Name)) {
+    DWARFCompileUnit *CU = getCompileUnitForOffset(Ref.CUOffset);
+    // The index may have been read from a file, so the DIEs of the unit may
+    // not be parsed yet.
+    if (!CU || CU->getOffset() != Ref.CUOffset || !CU->getNumDIEs())
+      continue;
+    const DWARFDebugInfoEntryMinimal *Die = CU->getDIEForOffset(Ref.DIEOffset);
+    if (Die && Die->getOffset() == Ref.DIEOffset)
+      DIEs.push_back(std::make_pair(CU, Die));
+  }
+}
+
 void DWARFContext::parseCompileUnits() {
   CUs.parse(*this, getInfoSection());
 }
@@ -521,22 +592,6 @@ DWARFContext::getInliningInfoForAddress(uint64_t Address,
   return InliningInfo;
 }
 
-static bool consumeCompressedDebugSectionHeader(StringRef &data,
-                                                uint64_t &OriginalSize) {
-  // Consume "ZLIB" prefix.
-  if (!data.startswith("ZLIB"))
-    return false;
-  data = data.substr(4);
-  // Consume uncompressed section size (big-endian 8 bytes).
-  DataExtractor extractor(data, false, 8);
-  uint32_t Offset = 0;
-  OriginalSize = extractor.getU64(&Offset);
-  if (Offset == 0)
-    return false;
-  data = data.substr(Offset);
-  return true;
-}
-
 DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj)
     : IsLittleEndian(Obj.isLittleEndian()),
       AddressSize(Obj.getBytesInAddress()) {
@@ -553,25 +608,25 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj)
     StringRef data;
     Section.getContents(data);
 
-    name = name.substr(name.find_first_not_of("._")); // Skip . and _ prefixes.
-
     // Check if debug info section is compressed with zlib.
-    if (name.startswith("zdebug_")) {
-      uint64_t OriginalSize;
-      if (!zlib::isAvailable() ||
-          !consumeCompressedDebugSectionHeader(data, OriginalSize))
+    if (Decompressor::isCompressed(Section)) {
+      ErrorOr<Decompressor> D = Decompressor::create(
+          name, data, IsLittleEndian, AddressSize == 8);
+      if (!D)
         continue;
       UncompressedSections.resize(UncompressedSections.size() + 1);
-      if (zlib::uncompress(data, UncompressedSections.back(), OriginalSize) !=
-          zlib::StatusOK) {
+      if (D->decompress(UncompressedSections.back())) {
         UncompressedSections.pop_back();
         continue;
       }
       // Make data point to uncompressed section contents and save its contents.
-      name = name.substr(1);
+      if (Decompressor::isGnuStyle(name))
+        name = name.substr(2); // Drop the ".z" of ".zdebug_".
       data = UncompressedSections.back();
     }
 
+    name = name.substr(name.find_first_not_of("._")); // Skip . and _ prefixes.
+
     StringRef *SectionData =
         StringSwitch<StringRef *>(name)
             .Case("debug_info", &InfoSection.Data)
@@ -11,7 +11,9 @@
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugArangeSet.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -46,17 +48,19 @@ void DWARFDebugAranges::generate(DWARFContext *CTX) {
 
   // Generate aranges from DIEs: even if .debug_aranges section is present,
   // it may describe only a small subset of compilation units, so we need to
-  // manually build aranges for the rest of them.
-  for (const auto &CU : CTX->compile_units()) {
-    uint32_t CUOffset = CU->getOffset();
-    if (ParsedCUOffsets.insert(CUOffset).second) {
-      DWARFAddressRangesVector CURanges;
-      CU->collectAddressRanges(CURanges);
-      for (const auto &R : CURanges) {
-        appendRange(CUOffset, R.first, R.second);
-      }
-    }
-  }
+  // manually build aranges for the rest of them. This may parse the DIEs of
+  // every unit, so the units are processed concurrently.
+  std::vector<DWARFCompileUnit *> CUs;
+  for (const auto &CU : CTX->compile_units())
+    if (ParsedCUOffsets.insert(CU->getOffset()).second)
+      CUs.push_back(CU.get());
+  std::vector<DWARFAddressRangesVector> CURanges(CUs.size());
+  parallel_for_each_task(size_t(0), CUs.size(), [&](size_t I) {
+    CUs[I]->collectAddressRanges(CURanges[I]);
+  });
+  for (size_t I = 0, E = CUs.size(); I != E; ++I)
+    for (const auto &R : CURanges[I])
+      appendRange(CUs[I]->getOffset(), R.first, R.second);
 
   construct();
 }
@@ -127,3 +131,33 @@ uint32_t DWARFDebugAranges::findAddress(uint64_t Address) const {
   }
   return -1U;
 }
+
+void DWARFDebugAranges::serialize(raw_ostream &OS) const {
+  support::endian::Writer<support::little> W(OS);
+  W.write<uint64_t>(Aranges.size());
+  for (const auto &R : Aranges) {
+    W.write<uint64_t>(R.LowPC);
+    W.write<uint32_t>(R.Length);
+    W.write<uint32_t>(R.CUOffset);
+  }
+}
+
+bool DWARFDebugAranges::deserialize(DataExtractor Data, uint32_t *OffsetPtr) {
+  clear();
+  uint64_t NumRanges = Data.getU64(OffsetPtr);
+  // Every range takes 16 bytes.
+  if (NumRanges > UINT32_MAX / 16 ||
+      !Data.isValidOffsetForDataOfSize(*OffsetPtr, NumRanges * 16))
+    return false;
+  Aranges.reserve(NumRanges);
+  for (uint64_t I = 0; I != NumRanges; ++I) {
+    Range R;
+    R.LowPC = Data.getU64(OffsetPtr);
+    R.Length = Data.getU32(OffsetPtr);
+    R.CUOffset = Data.getU32(OffsetPtr);
+    if (!Aranges.empty() && R < Aranges.back())
+      return false;
+    Aranges.push_back(R);
+  }
+  return true;
+}
@@ -0,0 +1,237 @@
+//===-- DWARFLookupIndex.cpp ----------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/DWARF/DWARFLookupIndex.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
+#include "llvm/Support/Dwarf.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+using namespace llvm;
+using namespace dwarf;
+
+namespace {
+/// The magic number and version of the index files.
+enum : uint32_t { IndexMagic = 0x58444957, IndexVersion = 1 };
+
+/// A named DIE of a unit, before it is added to the index.
+typedef std::pair<const char *, uint32_t> NamedDIE;
+}
+
+/// Returns true if DIEs with \p Tag are indexed by name.
+static bool isIndexedTag(uint32_t Tag) {
+  switch (Tag) {
+  case DW_TAG_subprogram:
+  case DW_TAG_variable:
+  case DW_TAG_base_type:
+  case DW_TAG_class_type:
+  case DW_TAG_structure_type:
+  case DW_TAG_union_type:
+  case DW_TAG_enumeration_type:
+  case DW_TAG_typedef:
+  case DW_TAG_namespace:
+    return true;
+  }
+  return false;
+}
+
+/// Returns true if the children of a DIE with \p Tag are in a scope whose
+/// names are visible outside of it, unlike the locals of a function.
+static bool isNamedScopeTag(uint32_t Tag) {
+  switch (Tag) {
+  case DW_TAG_compile_unit:
+  case DW_TAG_namespace:
+  case DW_TAG_class_type:
+  case DW_TAG_structure_type:
+  case DW_TAG_union_type:
+    return true;
+  }
+  return false;
+}
+
+/// Appends the names of the children of \p Die, and of their children in
+/// nested scopes, to \p Names.
+static void collectNames(const DWARFUnit *U,
+                         const DWARFDebugInfoEntryMinimal *Die,
+                         std::vector<NamedDIE> &Names) {
+  for (const DWARFDebugInfoEntryMinimal *Child = Die->getFirstChild();
+       Child && !Child->isNULL(); Child = Child->getSibling()) {
+    uint32_t Tag = Child->getTag();
+    DWARFFormValue Declaration;
+    if (isIndexedTag(Tag) &&
+        !Child->getAttributeValue(U, DW_AT_declaration, Declaration)) {
+      const char *ShortName = Child->getName(U, DINameKind::ShortName);
+      const char *LinkageName = Child->getName(U, DINameKind::LinkageName);
+      if (ShortName)
+        Names.push_back(std::make_pair(ShortName, Child->getOffset()));
+      if (LinkageName && (!ShortName || strcmp(ShortName, LinkageName)))
+        Names.push_back(std::make_pair(LinkageName, Child->getOffset()));
+    }
+    if (isNamedScopeTag(Tag))
+      collectNames(U, Child, Names);
+  }
+}
+
+void DWARFLookupIndex::clear() {
+  Aranges = DWARFDebugAranges();
+  Names.clear();
+}
+
+void DWARFLookupIndex::build(DWARFContext &C) {
+  clear();
+
+  // Parse the DIEs of every unit and collect their names concurrently. The
+  // parsed DIEs are kept, so generating the aranges does not parse them again
+  // and later lookups in any unit are fast.
+  std::vector<DWARFCompileUnit *> CUs;
+  for (const auto &CU : C.compile_units())
+    CUs.push_back(CU.get());
+  std::vector<std::vector<NamedDIE>> CUNames(CUs.size());
+  parallel_for_each_task(size_t(0), CUs.size(), [&](size_t I) {
+    if (const DWARFDebugInfoEntryMinimal *CUDie =
+            CUs[I]->getCompileUnitDIE(false))
+      collectNames(CUs[I], CUDie, CUNames[I]);
+  });
+
+  // Add the names in unit order, so that the DIEs of each name are sorted by
+  // offset.
+  for (size_t I = 0, E = CUs.size(); I != E; ++I) {
+    uint32_t CUOffset = CUs[I]->getOffset();
+    for (const NamedDIE &Name : CUNames[I])
+      Names[Name.first].push_back({CUOffset, Name.second});
+  }
+
+  Aranges.generate(&C);
+}
+
+/// Adds \p Value to \p Hash in a fixed byte order.
+static void updateHash(MD5 &Hash, uint64_t Value) {
+  uint8_t Bytes[8];
+  support::endian::write64le(Bytes, Value);
+  Hash.update(Bytes);
+}
+
+/// Adds the size and the contents of \p Data to \p Hash, so that adjacent
+/// sections cannot be confused.
+static void updateHash(MD5 &Hash, StringRef Data) {
+  updateHash(Hash, Data.size());
+  Hash.update(Data);
+}
+
+uint64_t DWARFLookupIndex::computeKey(DWARFContext &C) {
+  // The key is stored in index files, so it must not change from one run to
+  // the next; use MD5 rather than hash_combine, whose seed may vary.
+  MD5 Hash;
+  updateHash(Hash, IndexVersion);
+  updateHash(Hash, C.isLittleEndian());
+  updateHash(Hash, C.getAddressSize());
+  const DWARFSection &Info = C.getInfoSection();
+  updateHash(Hash, Info.Data);
+  for (StringRef Data : {C.getAbbrevSection(), C.getStringSection(),
+                         C.getARangeSection(), C.getRangeSection()})
+    updateHash(Hash, Data);
+
+  // Relocations change the values read from .debug_info, so hash them too,
+  // sorted by offset.
+  std::vector<std::pair<uint64_t, std::pair<uint8_t, int64_t>>> Relocs(
+      Info.Relocs.begin(), Info.Relocs.end());
+  std::sort(Relocs.begin(), Relocs.end());
+  updateHash(Hash, Relocs.size());
+  for (const auto &R : Relocs) {
+    updateHash(Hash, R.first);
+    updateHash(Hash, R.second.first);
+    updateHash(Hash, R.second.second);
+  }
+
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  return support::endian::read64le(Result);
+}
+
+void DWARFLookupIndex::write(raw_ostream &OS, uint64_t Key) const {
+  support::endian::Writer<support::little> W(OS);
+  W.write<uint32_t>(IndexMagic);
+  W.write<uint32_t>(IndexVersion);
+  W.write<uint64_t>(Key);
+  Aranges.serialize(OS);
+
+  // Write the names in a fixed order, so that the file only depends on the
+  // debug info.
+  std::vector<const StringMapEntry<SmallVector<DIERef, 1>> *> Entries;
+  Entries.reserve(Names.size());
+  for (const auto &Entry : Names)
+    Entries.push_back(&Entry);
+  std::sort(Entries.begin(), Entries.end(),
+            [](const StringMapEntry<SmallVector<DIERef, 1>> *A,
+               const StringMapEntry<SmallVector<DIERef, 1>> *B) {
+              return A->getKey() < B->getKey();
+            });
+  W.write<uint32_t>(Entries.size());
+  for (const auto *Entry : Entries) {
+    W.write<uint32_t>(Entry->getKey().size());
+    OS << Entry->getKey();
+    W.write<uint32_t>(Entry->getValue().size());
+    for (const DIERef &Ref : Entry->getValue()) {
+      W.write<uint32_t>(Ref.CUOffset);
+      W.write<uint32_t>(Ref.DIEOffset);
+    }
+  }
+}
+
+bool DWARFLookupIndex::read(StringRef Data, uint64_t Key) {
+  clear();
+  DataExtractor Extractor(Data, /*IsLittleEndian=*/true, 0);
+  uint32_t Offset = 0;
+  if (!Extractor.isValidOffsetForDataOfSize(0, 16) ||
+      Extractor.getU32(&Offset) != IndexMagic ||
+      Extractor.getU32(&Offset) != IndexVersion ||
+      Extractor.getU64(&Offset) != Key ||
+      !Aranges.deserialize(Extractor, &Offset)) {
+    clear();
+    return false;
+  }
+
+  uint32_t NumNames = Extractor.getU32(&Offset);
+  for (uint32_t I = 0; I != NumNames; ++I) {
+    uint32_t Length = Extractor.getU32(&Offset);
+    if (!Extractor.isValidOffsetForDataOfSize(Offset, Length) ||
+        !Extractor.isValidOffsetForDataOfSize(Offset + Length, 4))
+      break;
+    StringRef Name = Data.substr(Offset, Length);
+    Offset += Length;
+    uint32_t NumRefs = Extractor.getU32(&Offset);
+    if (NumRefs > UINT32_MAX / 8 ||
+        !Extractor.isValidOffsetForDataOfSize(Offset, NumRefs * 8))
+      break;
+    SmallVector<DIERef, 1> &Refs = Names[Name];
+    for (uint32_t J = 0; J != NumRefs; ++J) {
+      uint32_t CUOffset = Extractor.getU32(&Offset);
+      uint32_t DIEOffset = Extractor.getU32(&Offset);
+      Refs.push_back({CUOffset, DIEOffset});
+    }
+  }
+  if (Names.size() != NumNames || Offset != Data.size()) {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+ArrayRef<DWARFLookupIndex::DIERef>
+DWARFLookupIndex::findName(StringRef Name) const {
+  auto I = Names.find(Name);
+  if (I == Names.end())
+    return None;
+  return I->getValue();
+}
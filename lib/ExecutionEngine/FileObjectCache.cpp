@@ -0,0 +1,212 @@
+//===-- FileObjectCache.cpp - Persistent on-disk ObjectCache --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/FileObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+
+using namespace llvm;
+
+FileObjectCache::FileObjectCache(StringRef CacheDir, const TargetMachine &TM,
+                                 uint64_t MaxCacheSize)
+    : CacheDir(CacheDir), MaxCacheSize(MaxCacheSize) {
+  raw_string_ostream OS(TargetKey);
+  OS << LLVM_VERSION_STRING << '\0' << TM.getTargetTriple() << '\0'
+     << TM.getTargetCPU() << '\0' << TM.getTargetFeatureString() << '\0'
+     << TM.getOptLevel() << '\0' << TM.getRelocationModel() << '\0'
+     << TM.getCodeModel() << '\0';
+
+  // The options that change the object code; the ones that only affect
+  // assembly output or diagnostics are left out.
+  const TargetOptions &Opts = TM.Options;
+  OS << Opts.NoFramePointerElim << Opts.LessPreciseFPMADOption
+     << Opts.UnsafeFPMath << Opts.NoInfsFPMath << Opts.NoNaNsFPMath
+     << Opts.HonorSignDependentRoundingFPMathOption << Opts.UseSoftFloat
+     << Opts.NoZerosInBSS << Opts.GuaranteedTailCallOpt
+     << Opts.DisableTailCalls << Opts.EnableFastISel
+     << Opts.PositionIndependentExecutable << Opts.UseInitArray
+     << Opts.FunctionSections << Opts.DataSections << Opts.UniqueSectionNames
+     << Opts.TrapUnreachable << '\0' << Opts.StackAlignmentOverride << '\0'
+     << unsigned(Opts.CompressDebugSections) << '\0'
+     << Opts.TrapFuncName << '\0'
+     << Opts.FloatABIType << '\0' << Opts.AllowFPOpFusion << '\0'
+     << Opts.JTType << '\0' << Opts.ThreadModel << '\0';
+
+  const MCTargetOptions &MCOpts = Opts.MCOptions;
+  OS << MCOpts.SanitizeAddress << MCOpts.MCRelaxAll << MCOpts.MCNoExecStack
+     << MCOpts.MCSaveTempLabels << '\0' << MCOpts.DwarfVersion << '\0'
+     << MCOpts.getABIName();
+  OS.flush();
+  sys::fs::create_directories(CacheDir);
+}
+
+FileObjectCache::~FileObjectCache() {}
+
+std::string FileObjectCache::getKey(const Module &M) const {
+  SmallString<4096> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(&M, OS);
+  }
+
+  MD5 Hash;
+  Hash.update(TargetKey);
+  Hash.update(Bitcode);
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+std::string FileObjectCache::getEntryPath(StringRef Key) const {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, Key + ".o");
+  return Path.str();
+}
+
+std::unique_ptr<MemoryBuffer> FileObjectCache::getObject(const Module *M) {
+  std::string Key = getKey(*M);
+  std::string Path = getEntryPath(Key);
+
+  int FD;
+  if (sys::fs::openFileForRead(Path, FD)) {
+    MutexGuard Guard(Lock);
+    PendingKeys[M] = std::move(Key);
+    return nullptr;
+  }
+
+  // A hit needs no key later on; drop any left over from a module that
+  // lived at the same address and whose compilation failed.
+  {
+    MutexGuard Guard(Lock);
+    PendingKeys.erase(M);
+  }
+
+  // Mark the entry as recently used, for pruning.
+  sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getOpenFile(FD, Path, -1, false);
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (!Buffer) {
+    MutexGuard Guard(Lock);
+    PendingKeys[M] = std::move(Key);
+    return nullptr;
+  }
+
+  // The JIT may write into the buffer, which must not change the file, so
+  // hand it a copy.
+  return MemoryBuffer::getMemBufferCopy((*Buffer)->getBuffer(),
+                                        (*Buffer)->getBufferIdentifier());
+}
+
+void FileObjectCache::notifyObjectCompiled(const Module *M,
+                                           MemoryBufferRef Obj) {
+  std::string Key;
+  {
+    MutexGuard Guard(Lock);
+    auto I = PendingKeys.find(M);
+    if (I != PendingKeys.end()) {
+      Key = std::move(I->second);
+      PendingKeys.erase(I);
+    }
+  }
+  if (Key.empty())
+    Key = getKey(*M);
+
+  // Write the object to a temporary file and rename it into place, so that
+  // readers never see a partial entry. If another process wrote the same
+  // entry in the meantime, one of the identical files wins.
+  SmallString<128> TempPath;
+  int FD;
+  if (sys::fs::createUniqueFile(Twine(getEntryPath(Key)) + "-%%%%%%.tmp", FD,
+                                TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Obj.getBuffer();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, getEntryPath(Key))) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+
+  prune();
+}
+
+void FileObjectCache::notifyCompileFailed(const Module *M) {
+  MutexGuard Guard(Lock);
+  PendingKeys.erase(M);
+}
+
+void FileObjectCache::prune() {
+  if (!MaxCacheSize)
+    return;
+
+  // Let one process at a time prune the cache; the others skip it, as the
+  // pruning process will account for their entries.
+  SmallString<128> LockPath(CacheDir);
+  sys::path::append(LockPath, "prune");
+  LockFileManager Locked(LockPath);
+  if (Locked != LockFileManager::LFS_Owned)
+    return;
+
+  struct Entry {
+    std::string Path;
+    sys::TimeValue LastUsed;
+    uint64_t Size;
+  };
+  std::vector<Entry> Entries;
+  uint64_t TotalSize = 0;
+
+  std::error_code EC;
+  for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    if (sys::path::extension(I->path()) != ".o")
+      continue;
+    sys::fs::file_status Status;
+    if (I->status(Status) || !sys::fs::is_regular_file(Status))
+      continue;
+    Entry NewEntry = { I->path(), Status.getLastModificationTime(),
+                       Status.getSize() };
+    Entries.push_back(NewEntry);
+    TotalSize += Status.getSize();
+  }
+  if (TotalSize <= MaxCacheSize)
+    return;
+
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+              return LHS.LastUsed < RHS.LastUsed;
+            });
+  for (const Entry &E : Entries) {
+    if (TotalSize <= MaxCacheSize)
+      break;
+    if (!sys::fs::remove(E.Path))
+      TotalSize -= E.Size;
+  }
+}
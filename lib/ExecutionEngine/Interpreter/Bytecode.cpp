@@ -0,0 +1,1062 @@
+//===-- Bytecode.cpp - Translate functions to bytecode and run them -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file translates functions into the register-based bytecode described
+//  in Bytecode.h, and contains the loop that executes it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Interpreter.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/IntrinsicLowering.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace llvm;
+
+#define DEBUG_TYPE "interpreter"
+
+STATISTIC(NumBytecodeFunctions, "Number of functions translated to bytecode");
+STATISTIC(NumIRFunctions, "Number of functions interpreted from IR");
+
+static cl::opt<bool> UseBytecode("interpreter-bytecode", cl::init(true),
+    cl::desc("Translate functions to bytecode before interpreting them"));
+
+// GCC and Clang can take the address of a label, which lets the code for each
+// opcode jump directly to the code for the next one instead of going through
+// a central switch.
+#if defined(__GNUC__)
+#define LLVM_INTERPRETER_DIRECT_THREADED
+#endif
+
+//===----------------------------------------------------------------------===//
+//                     Values in Register Slots
+//===----------------------------------------------------------------------===//
+
+static bool isSupportedType(Type *Ty) {
+  if (IntegerType *ITy = dyn_cast<IntegerType>(Ty))
+    return ITy->getBitWidth() <= 64;
+  return Ty->isVoidTy() || Ty->isFloatTy() || Ty->isDoubleTy() ||
+         Ty->isPointerTy();
+}
+
+static uint64_t getMask(unsigned BitWidth) {
+  return BitWidth >= 64 ? ~uint64_t(0) : (uint64_t(1) << BitWidth) - 1;
+}
+
+static uint64_t toSlot(const GenericValue &V, Type *Ty) {
+  switch (Ty->getTypeID()) {
+  case Type::IntegerTyID: return V.IntVal.getZExtValue();
+  case Type::FloatTyID:   return FloatToBits(V.FloatVal);
+  case Type::DoubleTyID:  return DoubleToBits(V.DoubleVal);
+  case Type::PointerTyID: return (uintptr_t)V.PointerVal;
+  default:                return 0;
+  }
+}
+
+static GenericValue fromSlot(uint64_t Slot, Type *Ty) {
+  GenericValue V;
+  switch (Ty->getTypeID()) {
+  case Type::IntegerTyID:
+    V.IntVal = APInt(cast<IntegerType>(Ty)->getBitWidth(), Slot);
+    break;
+  case Type::FloatTyID:   V.FloatVal = BitsToFloat(uint32_t(Slot)); break;
+  case Type::DoubleTyID:  V.DoubleVal = BitsToDouble(Slot); break;
+  case Type::PointerTyID: V.PointerVal = (void *)(uintptr_t)Slot; break;
+  default:                break;
+  }
+  return V;
+}
+
+//===----------------------------------------------------------------------===//
+//                     Translation to Bytecode
+//===----------------------------------------------------------------------===//
+
+namespace llvm {
+
+/// Translates one function to bytecode. Branch targets are emitted as label
+/// numbers and replaced with instruction indices once all code is laid out.
+class BytecodeBuilder {
+public:
+  BytecodeBuilder(Interpreter &Interp, Function &F)
+      : Interp(Interp), DL(Interp.TD), F(F), BF(new BytecodeFunction(&F)),
+        NumTemps(0) {}
+
+  /// Return the bytecode of the function, or null if it uses types or
+  /// instructions the bytecode doesn't support.
+  std::unique_ptr<BytecodeFunction> build();
+
+private:
+  void lowerIntrinsics();
+  bool assignSlots();
+  bool emitInstruction(Instruction &I);
+  bool emitBinaryOperator(BinaryOperator &I);
+  bool emitCast(CastInst &I);
+  bool emitGEP(GetElementPtrInst &I);
+  bool emitCall(CallInst &I);
+  void emitEdge(BasicBlock *From, BasicBlock *To);
+  void resolveLabels();
+
+  uint32_t getSlot(Value *V);
+  uint32_t getEdgeLabel(BasicBlock *From, BasicBlock *To);
+
+  BytecodeInst &emit(BytecodeOpcode Op, uint32_t Dst = 0, uint32_t A = 0,
+                     uint32_t B = 0, uint32_t C = 0, uint64_t Imm = 0,
+                     uint8_t Aux = 0) {
+    BytecodeInst I = { nullptr, uint16_t(Op), Aux, Dst, A, B, C, Imm };
+    BF->Code.push_back(I);
+    return BF->Code.back();
+  }
+
+  Interpreter &Interp;
+  const DataLayout &DL;
+  Function &F;
+  std::unique_ptr<BytecodeFunction> BF;
+
+  DenseMap<Value *, uint32_t> Slots;
+  DenseMap<BasicBlock *, uint32_t> BlockLabels;
+  DenseMap<std::pair<BasicBlock *, BasicBlock *>, uint32_t> EdgeLabels;
+  std::vector<std::pair<BasicBlock *, BasicBlock *>> Edges;
+  std::vector<uint32_t> LabelPositions;
+  unsigned TempBase, NumTemps;
+};
+
+} // End llvm namespace
+
+// Intrinsics that IntrinsicLowering turns into plain IR or library calls
+// without side effects at lowering time.
+static bool isLowerableIntrinsic(unsigned ID) {
+  switch (ID) {
+  case Intrinsic::expect:
+  case Intrinsic::ctpop:
+  case Intrinsic::bswap:
+  case Intrinsic::ctlz:
+  case Intrinsic::cttz:
+  case Intrinsic::prefetch:
+  case Intrinsic::annotation:
+  case Intrinsic::ptr_annotation:
+  case Intrinsic::assume:
+  case Intrinsic::var_annotation:
+  case Intrinsic::memcpy:
+  case Intrinsic::memmove:
+  case Intrinsic::memset:
+  case Intrinsic::sqrt:
+  case Intrinsic::log:
+  case Intrinsic::log2:
+  case Intrinsic::log10:
+  case Intrinsic::exp:
+  case Intrinsic::exp2:
+  case Intrinsic::pow:
+  case Intrinsic::sin:
+  case Intrinsic::cos:
+  case Intrinsic::floor:
+  case Intrinsic::ceil:
+  case Intrinsic::trunc:
+  case Intrinsic::round:
+  case Intrinsic::copysign:
+  case Intrinsic::invariant_start:
+  case Intrinsic::invariant_end:
+  case Intrinsic::lifetime_start:
+  case Intrinsic::lifetime_end:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void BytecodeBuilder::lowerIntrinsics() {
+  // The IR interpreter lowers intrinsics when it first executes them; lower
+  // them all up front so that the bytecode only sees plain instructions.
+  SmallVector<CallInst *, 8> ToLower;
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB)
+      if (CallInst *CI = dyn_cast<CallInst>(&I))
+        if (Function *Callee = CI->getCalledFunction())
+          if (isLowerableIntrinsic(Callee->getIntrinsicID()))
+            ToLower.push_back(CI);
+  for (CallInst *CI : ToLower)
+    Interp.IL->LowerIntrinsicCall(CI);
+}
+
+bool BytecodeBuilder::assignSlots() {
+  if (!isSupportedType(F.getReturnType()))
+    return false;
+
+  uint32_t NextSlot = 0;
+  for (Argument &A : F.args()) {
+    if (!isSupportedType(A.getType()))
+      return false;
+    Slots[&A] = NextSlot++;
+  }
+  BF->NumArgs = NextSlot;
+
+  for (BasicBlock &BB : F) {
+    BlockLabels[&BB] = LabelPositions.size();
+    LabelPositions.push_back(0);
+
+    unsigned NumPHIs = 0;
+    for (Instruction &I : BB) {
+      if (!isSupportedType(I.getType()))
+        return false;
+      if (!isa<DbgInfoIntrinsic>(I))
+        for (Value *Op : I.operands())
+          if (!isa<BasicBlock>(Op) && !isSupportedType(Op->getType()))
+            return false;
+      if (isa<PHINode>(I))
+        ++NumPHIs;
+      if (!I.getType()->isVoidTy())
+        Slots[&I] = NextSlot++;
+    }
+    // Blocks with several PHIs read all their inputs into temporaries first.
+    if (NumPHIs > 1)
+      NumTemps = std::max(NumTemps, NumPHIs);
+  }
+
+  TempBase = NextSlot;
+  BF->ConstBase = TempBase + NumTemps;
+  return true;
+}
+
+uint32_t BytecodeBuilder::getSlot(Value *V) {
+  auto I = Slots.find(V);
+  if (I != Slots.end())
+    return I->second;
+
+  // Anything else is a constant, global or function, which is evaluated now
+  // and copied into its slot whenever the function is entered.
+  ExecutionContext Unused;
+  GenericValue Val = Interp.getOperandValue(V, Unused);
+  uint32_t Slot = BF->ConstBase + BF->Constants.size();
+  BF->Constants.push_back(toSlot(Val, V->getType()));
+  Slots[V] = Slot;
+  return Slot;
+}
+
+uint32_t BytecodeBuilder::getEdgeLabel(BasicBlock *From, BasicBlock *To) {
+  if (!isa<PHINode>(To->begin()))
+    return BlockLabels[To];
+
+  // Edges into blocks with PHIs go through a stub that sets the PHIs.
+  auto Key = std::make_pair(From, To);
+  auto I = EdgeLabels.find(Key);
+  if (I != EdgeLabels.end())
+    return I->second;
+  uint32_t Label = LabelPositions.size();
+  LabelPositions.push_back(0);
+  EdgeLabels[Key] = Label;
+  Edges.push_back(Key);
+  return Label;
+}
+
+void BytecodeBuilder::emitEdge(BasicBlock *From, BasicBlock *To) {
+  SmallVector<PHINode *, 4> PHIs;
+  for (BasicBlock::iterator I = To->begin(); PHINode *PN = dyn_cast<PHINode>(I);
+       ++I)
+    PHIs.push_back(PN);
+
+  // All PHIs of a block are set at once, so with several PHIs read all the
+  // inputs before writing any of them, as SwitchToNewBasicBlock does.
+  if (PHIs.size() == 1) {
+    PHINode *PN = PHIs[0];
+    emit(BC_Move, getSlot(PN), getSlot(PN->getIncomingValueForBlock(From)));
+  } else {
+    for (unsigned i = 0, e = PHIs.size(); i != e; ++i)
+      emit(BC_Move, TempBase + i,
+           getSlot(PHIs[i]->getIncomingValueForBlock(From)));
+    for (unsigned i = 0, e = PHIs.size(); i != e; ++i)
+      emit(BC_Move, getSlot(PHIs[i]), TempBase + i);
+  }
+  emit(BC_Br, 0, 0, 0, 0, BlockLabels[To]);
+}
+
+bool BytecodeBuilder::emitBinaryOperator(BinaryOperator &I) {
+  uint32_t Dst = getSlot(&I);
+  uint32_t A = getSlot(I.getOperand(0));
+  uint32_t B = getSlot(I.getOperand(1));
+  Type *Ty = I.getType();
+
+  if (Ty->isFloatTy() || Ty->isDoubleTy()) {
+    bool IsFloat = Ty->isFloatTy();
+    BytecodeOpcode Op;
+    switch (I.getOpcode()) {
+    case Instruction::FAdd: Op = IsFloat ? BC_FAddF : BC_FAddD; break;
+    case Instruction::FSub: Op = IsFloat ? BC_FSubF : BC_FSubD; break;
+    case Instruction::FMul: Op = IsFloat ? BC_FMulF : BC_FMulD; break;
+    case Instruction::FDiv: Op = IsFloat ? BC_FDivF : BC_FDivD; break;
+    case Instruction::FRem: Op = IsFloat ? BC_FRemF : BC_FRemD; break;
+    default: return false;
+    }
+    emit(Op, Dst, A, B);
+    return true;
+  }
+
+  if (!Ty->isIntegerTy())
+    return false;
+  BytecodeOpcode Op;
+  switch (I.getOpcode()) {
+  case Instruction::Add:  Op = BC_Add; break;
+  case Instruction::Sub:  Op = BC_Sub; break;
+  case Instruction::Mul:  Op = BC_Mul; break;
+  case Instruction::UDiv: Op = BC_UDiv; break;
+  case Instruction::SDiv: Op = BC_SDiv; break;
+  case Instruction::URem: Op = BC_URem; break;
+  case Instruction::SRem: Op = BC_SRem; break;
+  case Instruction::And:  Op = BC_And; break;
+  case Instruction::Or:   Op = BC_Or; break;
+  case Instruction::Xor:  Op = BC_Xor; break;
+  case Instruction::Shl:  Op = BC_Shl; break;
+  case Instruction::LShr: Op = BC_LShr; break;
+  case Instruction::AShr: Op = BC_AShr; break;
+  default: return false;
+  }
+  unsigned BitWidth = Ty->getIntegerBitWidth();
+  emit(Op, Dst, A, B, 0, getMask(BitWidth), 64 - BitWidth);
+  return true;
+}
+
+bool BytecodeBuilder::emitCast(CastInst &I) {
+  uint32_t Dst = getSlot(&I);
+  uint32_t A = getSlot(I.getOperand(0));
+  Type *SrcTy = I.getSrcTy();
+  Type *DstTy = I.getDestTy();
+  unsigned SrcBits = SrcTy->isIntegerTy() ? SrcTy->getIntegerBitWidth() : 0;
+  unsigned DstBits = DstTy->isIntegerTy() ? DstTy->getIntegerBitWidth() : 0;
+  unsigned PtrBits = DL.getPointerSizeInBits();
+
+  switch (I.getOpcode()) {
+  case Instruction::Trunc:
+    emit(BC_Mask, Dst, A, 0, 0, getMask(DstBits));
+    return true;
+  case Instruction::ZExt:
+  case Instruction::BitCast:
+  case Instruction::AddrSpaceCast:
+    emit(BC_Move, Dst, A);
+    return true;
+  case Instruction::SExt:
+    emit(BC_SExt, Dst, A, 0, 0, getMask(DstBits), 64 - SrcBits);
+    return true;
+  case Instruction::PtrToInt:
+    emit(BC_Mask, Dst, A, 0, 0, getMask(std::min(DstBits, PtrBits)));
+    return true;
+  case Instruction::IntToPtr:
+    emit(BC_Mask, Dst, A, 0, 0, getMask(std::min(SrcBits, PtrBits)));
+    return true;
+  case Instruction::FPTrunc:
+    if (!SrcTy->isDoubleTy() || !DstTy->isFloatTy())
+      return false;
+    emit(BC_FPTrunc, Dst, A);
+    return true;
+  case Instruction::FPExt:
+    if (!SrcTy->isFloatTy() || !DstTy->isDoubleTy())
+      return false;
+    emit(BC_FPExt, Dst, A);
+    return true;
+  case Instruction::FPToUI:
+    emit(SrcTy->isFloatTy() ? BC_FToUI : BC_DToUI, Dst, A, 0, 0,
+         getMask(DstBits));
+    return true;
+  case Instruction::FPToSI:
+    emit(SrcTy->isFloatTy() ? BC_FToSI : BC_DToSI, Dst, A, 0, 0,
+         getMask(DstBits));
+    return true;
+  case Instruction::UIToFP:
+    emit(DstTy->isFloatTy() ? BC_UIToF : BC_UIToD, Dst, A);
+    return true;
+  case Instruction::SIToFP:
+    emit(DstTy->isFloatTy() ? BC_SIToF : BC_SIToD, Dst, A, 0, 0, 0,
+         64 - SrcBits);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool BytecodeBuilder::emitGEP(GetElementPtrInst &I) {
+  if (!I.getType()->isPointerTy())
+    return false;
+
+  // Fold constant indices into one offset, and scale the others at run time.
+  uint64_t Offset = 0;
+  SmallVector<std::pair<Value *, uint64_t>, 4> Scaled;
+  for (gep_type_iterator GTI = gep_type_begin(I), E = gep_type_end(I);
+       GTI != E; ++GTI) {
+    if (StructType *STy = dyn_cast<StructType>(*GTI)) {
+      unsigned Field = cast<ConstantInt>(GTI.getOperand())->getZExtValue();
+      Offset += DL.getStructLayout(STy)->getElementOffset(Field);
+      continue;
+    }
+    uint64_t Size =
+        DL.getTypeAllocSize(cast<SequentialType>(*GTI)->getElementType());
+    Value *Idx = GTI.getOperand();
+    if (!Idx->getType()->isIntegerTy())
+      return false;
+    if (ConstantInt *CI = dyn_cast<ConstantInt>(Idx))
+      Offset += Size * CI->getSExtValue();
+    else
+      Scaled.push_back(std::make_pair(Idx, Size));
+  }
+
+  uint32_t Dst = getSlot(&I);
+  uint32_t Base = getSlot(I.getPointerOperand());
+  for (auto &Index : Scaled) {
+    unsigned BitWidth = Index.first->getType()->getIntegerBitWidth();
+    emit(BC_PtrAddScaled, Dst, Base, getSlot(Index.first), 0, Index.second,
+         64 - BitWidth);
+    Base = Dst;
+  }
+  if (Offset || Base != Dst)
+    emit(BC_PtrAdd, Dst, Base, 0, 0, Offset);
+  return true;
+}
+
+bool BytecodeBuilder::emitCall(CallInst &I) {
+  if (isa<InlineAsm>(I.getCalledValue()))
+    return false;
+  Function *Callee = I.getCalledFunction();
+  // Intrinsics that weren't lowered up front need the IR interpreter.
+  if (Callee && Callee->isIntrinsic())
+    return false;
+
+  BytecodeCall Call;
+  Call.Callee = Callee;
+  Call.CalleeSlot = Callee ? 0 : getSlot(I.getCalledValue());
+  Call.Target = nullptr;
+  Call.TargetResolved = false;
+  Call.RetTy = I.getType();
+  for (unsigned i = 0, e = I.getNumArgOperands(); i != e; ++i) {
+    Value *Arg = I.getArgOperand(i);
+    if (!isSupportedType(Arg->getType()))
+      return false;
+    Call.Args.push_back(getSlot(Arg));
+    Call.ArgTys.push_back(Arg->getType());
+  }
+
+  uint32_t Dst = I.getType()->isVoidTy() ? 0 : getSlot(&I);
+  emit(BC_Call, Dst, 0, 0, 0, BF->Calls.size());
+  BF->Calls.push_back(std::move(Call));
+  return true;
+}
+
+bool BytecodeBuilder::emitInstruction(Instruction &I) {
+  BasicBlock *BB = I.getParent();
+
+  switch (I.getOpcode()) {
+  case Instruction::Ret:
+    if (I.getNumOperands())
+      emit(BC_Ret, 0, getSlot(I.getOperand(0)));
+    else
+      emit(BC_RetVoid);
+    return true;
+
+  case Instruction::Br: {
+    BranchInst &BI = cast<BranchInst>(I);
+    if (BI.isUnconditional()) {
+      emit(BC_Br, 0, 0, 0, 0, getEdgeLabel(BB, BI.getSuccessor(0)));
+      return true;
+    }
+    emit(BC_CondBr, 0, getSlot(BI.getCondition()),
+         getEdgeLabel(BB, BI.getSuccessor(0)),
+         getEdgeLabel(BB, BI.getSuccessor(1)));
+    return true;
+  }
+
+  case Instruction::Switch: {
+    SwitchInst &SI = cast<SwitchInst>(I);
+    BytecodeSwitch Table;
+    for (SwitchInst::CaseIt i = SI.case_begin(), e = SI.case_end(); i != e;
+         ++i)
+      Table.Cases.push_back(
+          std::make_pair(i.getCaseValue()->getZExtValue(),
+                         getEdgeLabel(BB, i.getCaseSuccessor())));
+    emit(BC_Switch, getEdgeLabel(BB, SI.getDefaultDest()),
+         getSlot(SI.getCondition()), 0, 0, BF->Switches.size());
+    BF->Switches.push_back(std::move(Table));
+    return true;
+  }
+
+  case Instruction::Unreachable:
+    emit(BC_Unreachable);
+    return true;
+
+  case Instruction::ICmp: {
+    ICmpInst &CI = cast<ICmpInst>(I);
+    Type *OpTy = CI.getOperand(0)->getType();
+    unsigned BitWidth = OpTy->isPointerTy() ? DL.getPointerSizeInBits()
+                                            : OpTy->getIntegerBitWidth();
+    BytecodeOpcode Op;
+    switch (CI.getPredicate()) {
+    case ICmpInst::ICMP_EQ:  Op = BC_ICmpEQ; break;
+    case ICmpInst::ICMP_NE:  Op = BC_ICmpNE; break;
+    case ICmpInst::ICMP_UGT: Op = BC_ICmpUGT; break;
+    case ICmpInst::ICMP_UGE: Op = BC_ICmpUGE; break;
+    case ICmpInst::ICMP_ULT: Op = BC_ICmpULT; break;
+    case ICmpInst::ICMP_ULE: Op = BC_ICmpULE; break;
+    case ICmpInst::ICMP_SGT: Op = BC_ICmpSGT; break;
+    case ICmpInst::ICMP_SGE: Op = BC_ICmpSGE; break;
+    case ICmpInst::ICMP_SLT: Op = BC_ICmpSLT; break;
+    case ICmpInst::ICMP_SLE: Op = BC_ICmpSLE; break;
+    default: return false;
+    }
+    emit(Op, getSlot(&I), getSlot(CI.getOperand(0)), getSlot(CI.getOperand(1)),
+         0, 0, 64 - BitWidth);
+    return true;
+  }
+
+  case Instruction::FCmp: {
+    FCmpInst &CI = cast<FCmpInst>(I);
+    emit(CI.getOperand(0)->getType()->isFloatTy() ? BC_FCmpF : BC_FCmpD,
+         getSlot(&I), getSlot(CI.getOperand(0)), getSlot(CI.getOperand(1)), 0,
+         0, CI.getPredicate());
+    return true;
+  }
+
+  case Instruction::Select:
+    emit(BC_Select, getSlot(&I), getSlot(I.getOperand(0)),
+         getSlot(I.getOperand(1)), getSlot(I.getOperand(2)));
+    return true;
+
+  case Instruction::Load: {
+    LoadInst &LI = cast<LoadInst>(I);
+    Type *Ty = LI.getType();
+    BytecodeOpcode Op;
+    switch (DL.getTypeStoreSize(Ty)) {
+    case 1: Op = BC_Load1; break;
+    case 2: Op = BC_Load2; break;
+    case 4: Op = BC_Load4; break;
+    case 8: Op = BC_Load8; break;
+    default: return false;
+    }
+    uint64_t Mask = Ty->isIntegerTy() ? getMask(Ty->getIntegerBitWidth())
+                                      : ~uint64_t(0);
+    emit(Op, getSlot(&I), getSlot(LI.getPointerOperand()), 0, 0, Mask);
+    return true;
+  }
+
+  case Instruction::Store: {
+    StoreInst &SI = cast<StoreInst>(I);
+    BytecodeOpcode Op;
+    switch (DL.getTypeStoreSize(SI.getValueOperand()->getType())) {
+    case 1: Op = BC_Store1; break;
+    case 2: Op = BC_Store2; break;
+    case 4: Op = BC_Store4; break;
+    case 8: Op = BC_Store8; break;
+    default: return false;
+    }
+    emit(Op, 0, getSlot(SI.getValueOperand()), getSlot(SI.getPointerOperand()));
+    return true;
+  }
+
+  case Instruction::Alloca: {
+    AllocaInst &AI = cast<AllocaInst>(I);
+    emit(BC_Alloca, getSlot(&I), getSlot(AI.getArraySize()), 0, 0,
+         DL.getTypeAllocSize(AI.getAllocatedType()));
+    return true;
+  }
+
+  case Instruction::GetElementPtr:
+    return emitGEP(cast<GetElementPtrInst>(I));
+
+  case Instruction::Call:
+    // Debug intrinsics don't do anything.
+    if (isa<DbgInfoIntrinsic>(I))
+      return true;
+    return emitCall(cast<CallInst>(I));
+
+  case Instruction::PHI:
+    // PHIs are set by the edges that lead to their block.
+    return true;
+
+  default:
+    if (BinaryOperator *BO = dyn_cast<BinaryOperator>(&I))
+      return emitBinaryOperator(*BO);
+    if (CastInst *CI = dyn_cast<CastInst>(&I))
+      return emitCast(*CI);
+    return false;
+  }
+}
+
+void BytecodeBuilder::resolveLabels() {
+  for (BytecodeInst &I : BF->Code) {
+    switch (I.Op) {
+    case BC_Br:
+      I.Imm = LabelPositions[I.Imm];
+      break;
+    case BC_CondBr:
+      I.B = LabelPositions[I.B];
+      I.C = LabelPositions[I.C];
+      break;
+    case BC_Switch:
+      I.Dst = LabelPositions[I.Dst];
+      for (auto &Case : BF->Switches[I.Imm].Cases)
+        Case.second = LabelPositions[Case.second];
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+std::unique_ptr<BytecodeFunction> BytecodeBuilder::build() {
+  lowerIntrinsics();
+  if (!assignSlots())
+    return nullptr;
+
+  for (BasicBlock &BB : F) {
+    LabelPositions[BlockLabels[&BB]] = BF->Code.size();
+    for (Instruction &I : BB) {
+      if (!emitInstruction(I)) {
+        DEBUG(dbgs() << "Interpreting " << F.getName()
+                     << " from IR, because of: " << I << '\n');
+        return nullptr;
+      }
+    }
+  }
+  // Edges can't add more edges, so this visits all of them.
+  for (unsigned i = 0; i != Edges.size(); ++i) {
+    LabelPositions[EdgeLabels[Edges[i]]] = BF->Code.size();
+    emitEdge(Edges[i].first, Edges[i].second);
+  }
+  resolveLabels();
+
+  BF->NumSlots = BF->ConstBase + BF->Constants.size();
+  DEBUG(dbgs() << "Translated " << F.getName() << " to "
+               << BF->Code.size() << " bytecode instructions using "
+               << BF->NumSlots << " slots.\n");
+  return std::move(BF);
+}
+
+BytecodeFunction *Interpreter::getBytecode(Function *F) {
+  if (!UseBytecode || F->isDeclaration())
+    return nullptr;
+
+  auto I = Bytecode.find(F);
+  if (I != Bytecode.end())
+    return I->second.get();
+
+  std::unique_ptr<BytecodeFunction> BF = BytecodeBuilder(*this, *F).build();
+  if (BF)
+    ++NumBytecodeFunctions;
+  else
+    ++NumIRFunctions;
+  BytecodeFunction *Result = BF.get();
+  Bytecode[F] = std::move(BF);
+  return Result;
+}
+
+//===----------------------------------------------------------------------===//
+//                     Bytecode Execution
+//===----------------------------------------------------------------------===//
+
+static inline int64_t signExtend(uint64_t V, unsigned Shift) {
+  return int64_t(V << Shift) >> Shift;
+}
+
+static inline float asFloat(uint64_t V) { return BitsToFloat(uint32_t(V)); }
+static inline double asDouble(uint64_t V) { return BitsToDouble(V); }
+
+// Shift amounts of at least the bit width are reduced the way visitShl and
+// friends do.
+static inline unsigned getShiftAmount(uint64_t Amount, unsigned BitWidth) {
+  if (Amount < BitWidth)
+    return Amount;
+  return (NextPowerOf2(BitWidth - 1) - 1) & Amount;
+}
+
+// Convert to an integer, wrapping the way APIntOps::RoundDoubleToAPInt does
+// for values that are in range for the unsigned or signed type.
+static inline uint64_t fpToInt(double D) {
+  if (D >= 9223372036854775808.0)
+    return uint64_t(D);
+  return uint64_t(int64_t(D));
+}
+
+static bool evaluateFCmp(unsigned Predicate, double A, double B) {
+  bool Unordered = std::isnan(A) || std::isnan(B);
+  switch (Predicate) {
+  case FCmpInst::FCMP_FALSE: return false;
+  case FCmpInst::FCMP_OEQ:   return !Unordered && A == B;
+  case FCmpInst::FCMP_OGT:   return !Unordered && A > B;
+  case FCmpInst::FCMP_OGE:   return !Unordered && A >= B;
+  case FCmpInst::FCMP_OLT:   return !Unordered && A < B;
+  case FCmpInst::FCMP_OLE:   return !Unordered && A <= B;
+  case FCmpInst::FCMP_ONE:   return !Unordered && A != B;
+  case FCmpInst::FCMP_ORD:   return !Unordered;
+  case FCmpInst::FCMP_UNO:   return Unordered;
+  case FCmpInst::FCMP_UEQ:   return Unordered || A == B;
+  case FCmpInst::FCMP_UGT:   return Unordered || A > B;
+  case FCmpInst::FCMP_UGE:   return Unordered || A >= B;
+  case FCmpInst::FCMP_ULT:   return Unordered || A < B;
+  case FCmpInst::FCMP_ULE:   return Unordered || A <= B;
+  case FCmpInst::FCMP_UNE:   return Unordered || A != B;
+  case FCmpInst::FCMP_TRUE:  return true;
+  default: llvm_unreachable("Invalid FCmp predicate!");
+  }
+}
+
+BytecodeFunction *Interpreter::getCallTarget(BytecodeCall &Call,
+                                             const uint64_t *Regs,
+                                             Function *&Callee) {
+  Callee = Call.Callee;
+  if (!Callee) {
+    Callee = (Function *)(uintptr_t)Regs[Call.CalleeSlot];
+    return getBytecode(Callee);
+  }
+  if (!Call.TargetResolved) {
+    Call.Target = getBytecode(Callee);
+    Call.TargetResolved = true;
+  }
+  return Call.Target;
+}
+
+uint64_t Interpreter::callIRFromBytecode(Function *Callee, BytecodeCall &Call,
+                                         const uint64_t *Regs) {
+  // External functions and functions the bytecode can't express are run by
+  // the IR interpreter. Push a frame without a call site to collect the
+  // result, which popStackAndReturnValueToCaller leaves in ExitValue.
+  std::vector<GenericValue> ArgVals;
+  ArgVals.reserve(Call.Args.size());
+  for (unsigned i = 0, e = Call.Args.size(); i != e; ++i)
+    ArgVals.push_back(fromSlot(Regs[Call.Args[i]], Call.ArgTys[i]));
+
+  ECStack.push_back(ExecutionContext());
+  size_t Depth = ECStack.size();
+  callFunction(Callee, ArgVals);
+  runUntil(Depth);
+  ECStack.pop_back();
+  return toSlot(ExitValue, Call.RetTy);
+}
+
+GenericValue
+Interpreter::runBytecode(BytecodeFunction &BF,
+                         const std::vector<GenericValue> &ArgVals) {
+  Function *F = BF.F;
+  SmallVector<uint64_t, 8> Args;
+  unsigned i = 0;
+  for (Function::arg_iterator AI = F->arg_begin(), E = F->arg_end(); AI != E;
+       ++AI, ++i)
+    Args.push_back(toSlot(ArgVals[i], AI->getType()));
+  return fromSlot(executeBytecode(BF, Args.data(), Args.size()),
+                  F->getReturnType());
+}
+
+#ifdef LLVM_INTERPRETER_DIRECT_THREADED
+// Labels as values and computed gotos are GNU extensions.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+namespace {
+/// A bytecode function that is running, in the frame stack of
+/// executeBytecode.
+struct BytecodeFrame {
+  BytecodeFunction *BF;
+  /// The Call instruction that is waiting for a callee to return.
+  const BytecodeInst *PC;
+  /// The index of the first register slot of the frame.
+  size_t RegBase;
+  AllocaHolder Allocas;
+
+  BytecodeFrame(BytecodeFunction *BF, size_t RegBase)
+      : BF(BF), PC(nullptr), RegBase(RegBase) {}
+
+  // Make this type move-only. Define explicit move special members for MSVC.
+  BytecodeFrame(BytecodeFrame &&RHS)
+      : BF(RHS.BF), PC(RHS.PC), RegBase(RHS.RegBase),
+        Allocas(std::move(RHS.Allocas)) {}
+  BytecodeFrame &operator=(BytecodeFrame &&RHS) {
+    BF = RHS.BF;
+    PC = RHS.PC;
+    RegBase = RHS.RegBase;
+    Allocas = std::move(RHS.Allocas);
+    return *this;
+  }
+};
+} // end anonymous namespace
+
+uint64_t Interpreter::executeBytecode(BytecodeFunction &BF,
+                                      const uint64_t *Args, unsigned NumArgs) {
+#ifdef LLVM_INTERPRETER_DIRECT_THREADED
+  static const void *const Handlers[] = {
+#define HANDLE_BYTECODE_OP(Name) &&Op_##Name,
+#include "Bytecode.def"
+  };
+#define CASE(Name) Op_##Name:
+#define DISPATCH() goto *PC->Handler
+#else
+#define CASE(Name) case BC_##Name:
+#define DISPATCH() goto Dispatch
+#endif
+#define NEXT() do { ++PC; DISPATCH(); } while (0)
+#define JUMP(Target) do { PC = Code + (Target); DISPATCH(); } while (0)
+#define R(Field) Regs[PC->Field]
+#define SA(Field) signExtend(R(Field), PC->Aux)
+
+  // Calls between bytecode functions don't recurse on the C stack: the
+  // frames and their registers live on the heap, so deeply recursive
+  // programs run as deep as they do on the IR interpreter. Registers are
+  // addressed through Regs, which must be reloaded whenever Slots grows.
+  std::vector<BytecodeFrame> Frames;
+  std::vector<uint64_t> Slots;
+  Slots.reserve(1024);
+
+  BytecodeFunction *Cur = &BF;
+  const BytecodeInst *Code;
+  const BytecodeInst *PC;
+  uint64_t *Regs;
+  uint64_t Result;
+
+  // Push a frame for Cur, whose arguments have been copied into the slots
+  // from Slots.size() on, and start running it.
+#ifdef LLVM_INTERPRETER_DIRECT_THREADED
+#define ENTER_FRAME(Base) do {                                                 \
+    if (!Cur->Threaded) {                                                      \
+      for (BytecodeInst &I : Cur->Code)                                        \
+        I.Handler = Handlers[I.Op];                                            \
+      Cur->Threaded = true;                                                    \
+    }                                                                          \
+    ENTER_FRAME_IMPL(Base);                                                    \
+  } while (0)
+#else
+#define ENTER_FRAME(Base) ENTER_FRAME_IMPL(Base)
+#endif
+#define ENTER_FRAME_IMPL(Base) do {                                            \
+    Slots.resize((Base) + Cur->NumSlots);                                      \
+    std::copy(Cur->Constants.begin(), Cur->Constants.end(),                    \
+              Slots.begin() + (Base) + Cur->ConstBase);                        \
+    Frames.push_back(BytecodeFrame(Cur, (Base)));                              \
+    Regs = Slots.data() + (Base);                                              \
+    Code = Cur->Code.data();                                                   \
+    PC = Code;                                                                 \
+  } while (0)
+
+  Slots.resize(BF.NumSlots);
+  std::copy(Args, Args + std::min(NumArgs, BF.NumArgs), Slots.begin());
+  ENTER_FRAME(0);
+
+#ifdef LLVM_INTERPRETER_DIRECT_THREADED
+  DISPATCH();
+#else
+Dispatch:
+  switch (PC->Op) {
+#endif
+
+  CASE(Move) R(Dst) = R(A); NEXT();
+  CASE(Mask) R(Dst) = R(A) & PC->Imm; NEXT();
+  CASE(SExt) R(Dst) = uint64_t(SA(A)) & PC->Imm; NEXT();
+
+  CASE(Add) R(Dst) = (R(A) + R(B)) & PC->Imm; NEXT();
+  CASE(Sub) R(Dst) = (R(A) - R(B)) & PC->Imm; NEXT();
+  CASE(Mul) R(Dst) = (R(A) * R(B)) & PC->Imm; NEXT();
+  CASE(UDiv) R(Dst) = R(A) / R(B); NEXT();
+  CASE(URem) R(Dst) = R(A) % R(B); NEXT();
+  CASE(SDiv) {
+    int64_t Divisor = SA(B);
+    // Dividing the smallest value by -1 overflows, which traps on some hosts.
+    uint64_t Quotient = Divisor == -1 ? 0 - R(A) : uint64_t(SA(A) / Divisor);
+    R(Dst) = Quotient & PC->Imm;
+    NEXT();
+  }
+  CASE(SRem) {
+    int64_t Divisor = SA(B);
+    R(Dst) = Divisor == -1 ? 0 : uint64_t(SA(A) % Divisor) & PC->Imm;
+    NEXT();
+  }
+  CASE(And) R(Dst) = R(A) & R(B); NEXT();
+  CASE(Or) R(Dst) = R(A) | R(B); NEXT();
+  CASE(Xor) R(Dst) = R(A) ^ R(B); NEXT();
+  CASE(Shl) {
+    unsigned Amount = getShiftAmount(R(B), 64 - PC->Aux);
+    R(Dst) = (R(A) << Amount) & PC->Imm;
+    NEXT();
+  }
+  CASE(LShr) R(Dst) = R(A) >> getShiftAmount(R(B), 64 - PC->Aux); NEXT();
+  CASE(AShr) {
+    unsigned Amount = getShiftAmount(R(B), 64 - PC->Aux);
+    R(Dst) = uint64_t(SA(A) >> Amount) & PC->Imm;
+    NEXT();
+  }
+
+  CASE(FAddF) R(Dst) = FloatToBits(asFloat(R(A)) + asFloat(R(B))); NEXT();
+  CASE(FSubF) R(Dst) = FloatToBits(asFloat(R(A)) - asFloat(R(B))); NEXT();
+  CASE(FMulF) R(Dst) = FloatToBits(asFloat(R(A)) * asFloat(R(B))); NEXT();
+  CASE(FDivF) R(Dst) = FloatToBits(asFloat(R(A)) / asFloat(R(B))); NEXT();
+  CASE(FRemF) R(Dst) = FloatToBits(fmod(asFloat(R(A)), asFloat(R(B)))); NEXT();
+  CASE(FAddD) R(Dst) = DoubleToBits(asDouble(R(A)) + asDouble(R(B))); NEXT();
+  CASE(FSubD) R(Dst) = DoubleToBits(asDouble(R(A)) - asDouble(R(B))); NEXT();
+  CASE(FMulD) R(Dst) = DoubleToBits(asDouble(R(A)) * asDouble(R(B))); NEXT();
+  CASE(FDivD) R(Dst) = DoubleToBits(asDouble(R(A)) / asDouble(R(B))); NEXT();
+  CASE(FRemD)
+    R(Dst) = DoubleToBits(fmod(asDouble(R(A)), asDouble(R(B))));
+    NEXT();
+
+  CASE(ICmpEQ) R(Dst) = R(A) == R(B); NEXT();
+  CASE(ICmpNE) R(Dst) = R(A) != R(B); NEXT();
+  CASE(ICmpUGT) R(Dst) = R(A) > R(B); NEXT();
+  CASE(ICmpUGE) R(Dst) = R(A) >= R(B); NEXT();
+  CASE(ICmpULT) R(Dst) = R(A) < R(B); NEXT();
+  CASE(ICmpULE) R(Dst) = R(A) <= R(B); NEXT();
+  CASE(ICmpSGT) R(Dst) = SA(A) > SA(B); NEXT();
+  CASE(ICmpSGE) R(Dst) = SA(A) >= SA(B); NEXT();
+  CASE(ICmpSLT) R(Dst) = SA(A) < SA(B); NEXT();
+  CASE(ICmpSLE) R(Dst) = SA(A) <= SA(B); NEXT();
+  CASE(FCmpF)
+    R(Dst) = evaluateFCmp(PC->Aux, asFloat(R(A)), asFloat(R(B)));
+    NEXT();
+  CASE(FCmpD)
+    R(Dst) = evaluateFCmp(PC->Aux, asDouble(R(A)), asDouble(R(B)));
+    NEXT();
+
+  CASE(FPTrunc) R(Dst) = FloatToBits(float(asDouble(R(A)))); NEXT();
+  CASE(FPExt) R(Dst) = DoubleToBits(double(asFloat(R(A)))); NEXT();
+  CASE(FToUI) R(Dst) = fpToInt(asFloat(R(A))) & PC->Imm; NEXT();
+  CASE(FToSI) R(Dst) = fpToInt(asFloat(R(A))) & PC->Imm; NEXT();
+  CASE(DToUI) R(Dst) = fpToInt(asDouble(R(A))) & PC->Imm; NEXT();
+  CASE(DToSI) R(Dst) = fpToInt(asDouble(R(A))) & PC->Imm; NEXT();
+  CASE(UIToF) R(Dst) = FloatToBits(float(R(A))); NEXT();
+  CASE(SIToF) R(Dst) = FloatToBits(float(SA(A))); NEXT();
+  CASE(UIToD) R(Dst) = DoubleToBits(double(R(A))); NEXT();
+  CASE(SIToD) R(Dst) = DoubleToBits(double(SA(A))); NEXT();
+
+  CASE(Select) R(Dst) = R(A) ? R(B) : R(C); NEXT();
+
+  CASE(Load1) {
+    uint8_t V;
+    memcpy(&V, (void *)(uintptr_t)R(A), sizeof(V));
+    R(Dst) = V & PC->Imm;
+    NEXT();
+  }
+  CASE(Load2) {
+    uint16_t V;
+    memcpy(&V, (void *)(uintptr_t)R(A), sizeof(V));
+    R(Dst) = V & PC->Imm;
+    NEXT();
+  }
+  CASE(Load4) {
+    uint32_t V;
+    memcpy(&V, (void *)(uintptr_t)R(A), sizeof(V));
+    R(Dst) = V & PC->Imm;
+    NEXT();
+  }
+  CASE(Load8) {
+    uint64_t V;
+    memcpy(&V, (void *)(uintptr_t)R(A), sizeof(V));
+    R(Dst) = V & PC->Imm;
+    NEXT();
+  }
+  CASE(Store1) {
+    uint8_t V = uint8_t(R(A));
+    memcpy((void *)(uintptr_t)R(B), &V, sizeof(V));
+    NEXT();
+  }
+  CASE(Store2) {
+    uint16_t V = uint16_t(R(A));
+    memcpy((void *)(uintptr_t)R(B), &V, sizeof(V));
+    NEXT();
+  }
+  CASE(Store4) {
+    uint32_t V = uint32_t(R(A));
+    memcpy((void *)(uintptr_t)R(B), &V, sizeof(V));
+    NEXT();
+  }
+  CASE(Store8) {
+    uint64_t V = R(A);
+    memcpy((void *)(uintptr_t)R(B), &V, sizeof(V));
+    NEXT();
+  }
+  CASE(Alloca) {
+    // Avoid malloc-ing zero bytes, as visitAllocaInst does.
+    void *Memory = malloc(std::max(uint64_t(1), R(A) * PC->Imm));
+    Frames.back().Allocas.add(Memory);
+    R(Dst) = (uintptr_t)Memory;
+    NEXT();
+  }
+  CASE(PtrAdd) R(Dst) = R(A) + PC->Imm; NEXT();
+  CASE(PtrAddScaled) R(Dst) = R(A) + uint64_t(SA(B)) * PC->Imm; NEXT();
+
+  CASE(Br) JUMP(PC->Imm);
+  CASE(CondBr) JUMP(R(A) ? PC->B : PC->C);
+  CASE(Switch) {
+    uint64_t V = R(A);
+    for (const auto &Case : Cur->Switches[PC->Imm].Cases)
+      if (Case.first == V)
+        JUMP(Case.second);
+    JUMP(PC->Dst);
+  }
+  CASE(Call) {
+    BytecodeCall &Call = Cur->Calls[PC->Imm];
+    Function *Callee;
+    BytecodeFunction *Target = getCallTarget(Call, Regs, Callee);
+    if (!Target) {
+      Result = callIRFromBytecode(Callee, Call, Regs);
+      if (!Call.RetTy->isVoidTy())
+        R(Dst) = Result;
+      NEXT();
+    }
+
+    // Copy the arguments into the callee's slots, which may move the caller's.
+    Frames.back().PC = PC;
+    size_t CallerBase = Frames.back().RegBase;
+    size_t Base = Slots.size();
+    unsigned NumCallArgs = std::min<unsigned>(Call.Args.size(),
+                                              Target->NumArgs);
+    Slots.resize(Base + Target->NumArgs);
+    for (unsigned i = 0; i != NumCallArgs; ++i)
+      Slots[Base + i] = Slots[CallerBase + Call.Args[i]];
+    Cur = Target;
+    ENTER_FRAME(Base);
+    DISPATCH();
+  }
+  CASE(Ret) Result = R(A); goto Return;
+  CASE(RetVoid) Result = 0; goto Return;
+  CASE(Unreachable)
+    report_fatal_error("Program executed an 'unreachable' instruction!");
+
+#ifndef LLVM_INTERPRETER_DIRECT_THREADED
+  default:
+    llvm_unreachable("Invalid bytecode opcode!");
+  }
+#endif
+
+Return:
+  // Free the frame's allocas and registers, and resume the caller after its
+  // Call instruction.
+  Slots.resize(Frames.back().RegBase);
+  Frames.pop_back();
+  if (Frames.empty())
+    return Result;
+  Cur = Frames.back().BF;
+  Code = Cur->Code.data();
+  PC = Frames.back().PC;
+  Regs = Slots.data() + Frames.back().RegBase;
+  if (!Cur->Calls[PC->Imm].RetTy->isVoidTy())
+    R(Dst) = Result;
+  NEXT();
+
+#undef ENTER_FRAME
+#undef ENTER_FRAME_IMPL
+#undef CASE
+#undef DISPATCH
+#undef NEXT
+#undef JUMP
+#undef R
+#undef SA
+}
+
+#ifdef LLVM_INTERPRETER_DIRECT_THREADED
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,92 @@
+//===-- Bytecode.h - Register-based interpreter bytecode --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The interpreter translates each function it can into a compact bytecode the
+// first time the function is called. Every value of the function gets a
+// 64-bit register slot: arguments come first, then the results of
+// instructions, then constants, which are evaluated once at translation time.
+// Operands are slot numbers, so executing an instruction involves no lookups
+// and no GenericValue boxing.
+//
+// Integers are kept zero extended in their slots, floats and doubles as their
+// bit patterns, and pointers as their addresses. Functions that use other
+// types, or instructions the bytecode doesn't cover, keep running on the IR.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_BYTECODE_H
+#define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_BYTECODE_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace llvm {
+
+class Function;
+class Type;
+struct BytecodeFunction;
+
+enum BytecodeOpcode {
+#define HANDLE_BYTECODE_OP(Name) BC_##Name,
+#include "Bytecode.def"
+  BC_NumOpcodes
+};
+
+/// One bytecode instruction. Bytecode.def describes the operands of each
+/// opcode.
+struct BytecodeInst {
+  /// The address of the code that executes the opcode, when the interpreter
+  /// uses direct-threaded dispatch.
+  const void *Handler;
+  uint16_t Op;
+  uint8_t Aux;
+  uint32_t Dst, A, B, C;
+  uint64_t Imm;
+};
+
+/// A call site, referenced by the Imm field of a Call instruction.
+struct BytecodeCall {
+  /// The called function, or null for an indirect call through slot Callee.
+  Function *Callee;
+  uint32_t CalleeSlot;
+  /// The bytecode of Callee, once it has been looked up.
+  BytecodeFunction *Target;
+  bool TargetResolved;
+  Type *RetTy;
+  SmallVector<uint32_t, 4> Args;
+  SmallVector<Type *, 4> ArgTys;
+};
+
+/// A switch table, referenced by the Imm field of a Switch instruction.
+struct BytecodeSwitch {
+  SmallVector<std::pair<uint64_t, uint32_t>, 8> Cases;
+};
+
+/// The bytecode of one function.
+struct BytecodeFunction {
+  Function *F;
+  std::vector<BytecodeInst> Code;
+  /// The initial contents of the constant slots, which start at ConstBase.
+  std::vector<uint64_t> Constants;
+  unsigned NumArgs;
+  unsigned ConstBase;
+  unsigned NumSlots;
+  std::vector<BytecodeCall> Calls;
+  std::vector<BytecodeSwitch> Switches;
+  /// Whether the Handler fields of Code have been filled in.
+  bool Threaded;
+
+  explicit BytecodeFunction(Function *F)
+      : F(F), NumArgs(0), ConstBase(0), NumSlots(0), Threaded(false) {}
+};
+
+} // End llvm namespace
+
+#endif
@@ -856,6 +856,9 @@ void Interpreter::popStackAndReturnValueToCaller(Type *RetTy,
       if (InvokeInst *II = dyn_cast<InvokeInst> (I))
         SwitchToNewBasicBlock (II->getNormalDest (), CallingSF);
       CallingSF.Caller = CallSite();          // We returned from the call...
+    } else {
+      // A call from bytecode, which picks up the result from ExitValue.
+      ExitValue = Result;
     }
   }
 }
@@ -2091,6 +2094,13 @@ void Interpreter::callFunction(Function *F,
     return;
   }
 
+  // Functions translated to bytecode run to completion right away.
+  if (BytecodeFunction *BF = getBytecode(F)) {
+    GenericValue Result = runBytecode(*BF, ArgVals);
+    popStackAndReturnValueToCaller(F->getReturnType(), Result);
+    return;
+  }
+
   // Get pointers to first LLVM BB & Instruction in function.
   StackFrame.CurBB     = F->begin();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
@@ -2112,7 +2122,11 @@ void Interpreter::callFunction(Function *F,
 
 
 void Interpreter::run() {
-  while (!ECStack.empty()) {
+  runUntil(0);
+}
+
+void Interpreter::runUntil(size_t Depth) {
+  while (ECStack.size() > Depth) {
     // Interpret a single instruction & increment the "PC".
     ExecutionContext &SF = ECStack.back();  // Current stack frame
     Instruction &I = *SF.CurInst++;         // Increment before execute
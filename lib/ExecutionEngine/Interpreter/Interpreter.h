@@ -14,6 +14,8 @@
 #ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 #define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 
+#include "Bytecode.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/IR/CallSite.h"
@@ -106,6 +108,12 @@ class Interpreter : public ExecutionEngine, public InstVisitor<Interpreter> {
   // registered with the atexit() library function.
   std::vector<Function*> AtExitHandlers;
 
+  // Bytecode - The bytecode of each function that has been called, or null
+  // for functions that are interpreted from the IR.
+  DenseMap<Function*, std::unique_ptr<BytecodeFunction>> Bytecode;
+
+  friend class BytecodeBuilder;
+
 public:
   explicit Interpreter(std::unique_ptr<Module> M);
   ~Interpreter() override;
@@ -215,6 +223,22 @@ private:  // Helper functions
   //
   void SwitchToNewBasicBlock(BasicBlock *Dest, ExecutionContext &SF);
 
+  // runUntil - Execute instructions until the stack has no more than Depth
+  // frames.
+  //
+  void runUntil(size_t Depth);
+
+  // Bytecode execution, see Bytecode.cpp.
+  BytecodeFunction *getBytecode(Function *F);
+  GenericValue runBytecode(BytecodeFunction &BF,
+                           const std::vector<GenericValue> &ArgVals);
+  uint64_t executeBytecode(BytecodeFunction &BF, const uint64_t *Args,
+                           unsigned NumArgs);
+  BytecodeFunction *getCallTarget(BytecodeCall &Call, const uint64_t *Regs,
+                                  Function *&Callee);
+  uint64_t callIRFromBytecode(Function *Callee, BytecodeCall &Call,
+                              const uint64_t *Regs);
+
   void *getPointerToFunction(Function *F) override { return (void*)F; }
 
   void initializeExecutionEngine() { }
@@ -0,0 +1,354 @@
+//===-- PerfJITEventListener.cpp - Tell Linux perf about JITted code ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a JITEventListener object that tells Linux perf about
+// JITted functions, in the two formats perf understands:
+//
+//  - /tmp/perf-<pid>.map, a text file with one "start size name" line per
+//    function, which perf report reads to symbolize samples.
+//
+//  - jit-<pid>.dump, a binary jitdump file with a copy of the code and the
+//    line tables of each function. perf inject --jit turns it into ELF files
+//    perf report can annotate with source lines. The file is mmap'd once so
+//    perf record notices it in the event stream.
+//
+// The jitdump format is described in tools/perf/Documentation/
+// jitdump-specification.txt in the Linux sources.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Config/config.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/DebugInfo/DWARF/DIContext.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Errno.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+using namespace llvm::object;
+
+#define DEBUG_TYPE "perf-jit-event-listener"
+
+#if defined(__linux__)
+
+namespace {
+
+// The jitdump records this listener writes.
+enum JITDumpRecordType {
+  JIT_CODE_LOAD = 0,
+  JIT_CODE_DEBUG_INFO = 2,
+  JIT_CODE_CLOSE = 3
+};
+
+const uint32_t JITDumpMagic = 0x4A695444; // "JiTD"
+const uint32_t JITDumpVersion = 1;
+const uint32_t JITDumpHeaderSize = 40;
+const uint32_t JITDumpRecordHeaderSize = 16;
+
+class PerfJITEventListener : public JITEventListener {
+  sys::Mutex Lock;
+  uint32_t Pid;
+
+  std::unique_ptr<raw_fd_ostream> PerfMap;
+
+  std::unique_ptr<raw_fd_ostream> JITDump;
+  /// The mapping of the start of the jitdump file that tells perf record
+  /// where to find it.
+  void *Marker;
+  size_t MarkerSize;
+  uint64_t CodeIndex;
+
+  std::map<const char*, OwningBinary<ObjectFile>> DebugObjects;
+
+  void openPerfMap(StringRef Dir);
+  void openJITDump(StringRef Dir);
+
+  void writeDebugInfo(uint64_t Addr, const DILineInfoTable &Lines);
+  void writeCodeLoad(StringRef Name, uint64_t Addr, uint64_t Size);
+
+  template <typename T> void write(T Value) {
+    JITDump->write(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+  void writeString(StringRef S) {
+    *JITDump << S;
+    JITDump->write('\0');
+  }
+  void writeRecordHeader(JITDumpRecordType Type, uint32_t Size) {
+    write<uint32_t>(Type);
+    write<uint32_t>(Size);
+    write<uint64_t>(getTimestamp());
+  }
+
+  static uint64_t getTimestamp();
+
+public:
+  PerfJITEventListener(StringRef PerfMapDir, StringRef JITDumpDir);
+  ~PerfJITEventListener();
+
+  void NotifyObjectEmitted(const ObjectFile &Obj,
+                           const RuntimeDyld::LoadedObjectInfo &L) override;
+
+  void NotifyFreeingObject(const ObjectFile &Obj) override;
+};
+
+/// Return the ELF machine perf should disassemble the code in jitdump files
+/// as.
+static uint32_t getELFMachine() {
+  switch (Triple(sys::getProcessTriple()).getArch()) {
+  case Triple::x86:         return ELF::EM_386;
+  case Triple::x86_64:      return ELF::EM_X86_64;
+  case Triple::arm:
+  case Triple::thumb:       return ELF::EM_ARM;
+  case Triple::aarch64:     return ELF::EM_AARCH64;
+  case Triple::mips:
+  case Triple::mipsel:
+  case Triple::mips64:
+  case Triple::mips64el:    return ELF::EM_MIPS;
+  case Triple::ppc:         return ELF::EM_PPC;
+  case Triple::ppc64:
+  case Triple::ppc64le:     return ELF::EM_PPC64;
+  case Triple::systemz:     return ELF::EM_S390;
+  default:                  return ELF::EM_NONE;
+  }
+}
+
+PerfJITEventListener::PerfJITEventListener(StringRef PerfMapDir,
+                                           StringRef JITDumpDir)
+    : Pid(::getpid()), Marker(nullptr), MarkerSize(0), CodeIndex(0) {
+  openPerfMap(PerfMapDir);
+  openJITDump(JITDumpDir);
+}
+
+void PerfJITEventListener::openPerfMap(StringRef Dir) {
+  SmallString<128> Path(Dir);
+  sys::path::append(Path, "perf-" + Twine(Pid) + ".map");
+  std::error_code EC;
+  PerfMap.reset(new raw_fd_ostream(Path, EC, sys::fs::F_Text));
+  if (EC) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << EC.message() << "\n");
+    PerfMap.reset();
+  }
+}
+
+void PerfJITEventListener::openJITDump(StringRef Dir) {
+  SmallString<128> Path(Dir);
+  if (std::error_code EC = sys::fs::create_directories(Path)) {
+    DEBUG(dbgs() << "Failed to create " << Path << ": " << EC.message()
+                 << "\n");
+    return;
+  }
+  sys::path::append(Path, "jit-" + Twine(Pid) + ".dump");
+
+  // The file must be opened for reading as well, so it can be mapped below.
+  int FD = ::open(Path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0666);
+  if (FD < 0) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << sys::StrError()
+                 << "\n");
+    return;
+  }
+
+  // perf record only sees the file if the process maps it executable; perf
+  // inject then looks for the jitdump file by the name of the mapping.
+  MarkerSize = ::sysconf(_SC_PAGESIZE);
+  Marker = ::mmap(nullptr, MarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, FD,
+                  0);
+  if (Marker == MAP_FAILED) {
+    DEBUG(dbgs() << "Failed to map " << Path << ": " << sys::StrError()
+                 << "\n");
+    Marker = nullptr;
+    ::close(FD);
+    return;
+  }
+
+  JITDump.reset(new raw_fd_ostream(FD, /*shouldClose=*/true));
+  write<uint32_t>(JITDumpMagic);
+  write<uint32_t>(JITDumpVersion);
+  write<uint32_t>(JITDumpHeaderSize);
+  write<uint32_t>(getELFMachine());
+  write<uint32_t>(0); // Padding.
+  write<uint32_t>(Pid);
+  write<uint64_t>(getTimestamp());
+  write<uint64_t>(0); // Flags.
+  JITDump->flush();
+}
+
+PerfJITEventListener::~PerfJITEventListener() {
+  if (JITDump) {
+    writeRecordHeader(JIT_CODE_CLOSE, JITDumpRecordHeaderSize);
+    JITDump.reset();
+  }
+  if (Marker)
+    ::munmap(Marker, MarkerSize);
+}
+
+/// The timestamps in jitdump files must come from the clock perf record uses
+/// for its samples, which is CLOCK_MONOTONIC when it runs with -k 1.
+uint64_t PerfJITEventListener::getTimestamp() {
+  struct timespec TS;
+  if (::clock_gettime(CLOCK_MONOTONIC, &TS))
+    return 0;
+  return uint64_t(TS.tv_sec) * 1000000000 + TS.tv_nsec;
+}
+
+void PerfJITEventListener::writeDebugInfo(uint64_t Addr,
+                                          const DILineInfoTable &Lines) {
+  uint32_t Size = JITDumpRecordHeaderSize + 16;
+  for (const auto &Line : Lines)
+    Size += 16 + Line.second.FileName.size() + 1;
+
+  writeRecordHeader(JIT_CODE_DEBUG_INFO, Size);
+  write<uint64_t>(Addr);
+  write<uint64_t>(Lines.size());
+  for (const auto &Line : Lines) {
+    write<uint64_t>(Line.first);
+    write<uint32_t>(Line.second.Line);
+    write<uint32_t>(0); // Discriminator.
+    writeString(Line.second.FileName);
+  }
+}
+
+void PerfJITEventListener::writeCodeLoad(StringRef Name, uint64_t Addr,
+                                         uint64_t Size) {
+  uint32_t RecordSize = JITDumpRecordHeaderSize + 40 + Name.size() + 1 + Size;
+  writeRecordHeader(JIT_CODE_LOAD, RecordSize);
+  write<uint32_t>(Pid);
+  // The thread that loaded the code; glibc has no wrapper for gettid.
+  write<uint32_t>(::syscall(SYS_gettid));
+  write<uint64_t>(Addr); // Virtual address of the code.
+  write<uint64_t>(Addr); // Address of the code in this process.
+  write<uint64_t>(Size);
+  write<uint64_t>(CodeIndex++);
+  writeString(Name);
+  JITDump->write(reinterpret_cast<const char *>(Addr), Size);
+}
+
+void PerfJITEventListener::NotifyObjectEmitted(
+                                       const ObjectFile &Obj,
+                                       const RuntimeDyld::LoadedObjectInfo &L) {
+  if (!PerfMap && !JITDump)
+    return;
+
+  OwningBinary<ObjectFile> DebugObjOwner = L.getObjectForDebug(Obj);
+  const ObjectFile &DebugObj = *DebugObjOwner.getBinary();
+  std::unique_ptr<DIContext> Context;
+  if (JITDump)
+    Context.reset(DIContext::getDWARFContext(DebugObj));
+
+  MutexGuard Guard(Lock);
+
+  // Use symbol info to iterate functions in the object.
+  for (symbol_iterator I = DebugObj.symbol_begin(), E = DebugObj.symbol_end();
+       I != E; ++I) {
+    SymbolRef::Type SymType;
+    if (I->getType(SymType)) continue;
+    if (SymType != SymbolRef::ST_Function) continue;
+
+    StringRef Name;
+    uint64_t Addr;
+    uint64_t Size;
+    if (I->getName(Name)) continue;
+    if (I->getAddress(Addr)) continue;
+    if (I->getSize(Size)) continue;
+    if (Size == 0) continue;
+
+    if (PerfMap)
+      *PerfMap << format("%" PRIx64 " %" PRIx64 " ", Addr, Size) << Name
+               << "\n";
+
+    if (JITDump) {
+      // The line table of a function must precede the code it describes.
+      if (Context) {
+        DILineInfoTable Lines = Context->getLineInfoForAddressRange(
+            Addr, Size, DILineInfoSpecifier(
+                DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath));
+        if (!Lines.empty())
+          writeDebugInfo(Addr, Lines);
+      }
+      writeCodeLoad(Name, Addr, Size);
+    }
+  }
+
+  // perf may read the files while the process is still running, so don't
+  // leave records sitting in the buffers.
+  if (PerfMap)
+    PerfMap->flush();
+  if (JITDump)
+    JITDump->flush();
+
+  DebugObjects[Obj.getData().data()] = std::move(DebugObjOwner);
+}
+
+void PerfJITEventListener::NotifyFreeingObject(const ObjectFile &Obj) {
+  // perf has no way to forget code, and later code loaded at the same
+  // addresses takes precedence, so there is nothing to write here.
+  MutexGuard Guard(Lock);
+  DebugObjects.erase(Obj.getData().data());
+}
+
+}  // anonymous namespace.
+
+namespace llvm {
+JITEventListener *JITEventListener::createPerfJITEventListener() {
+  // perf looks for the map in /tmp, and for jitdump files in ~/.debug/jit by
+  // default.
+  SmallString<128> JITDumpDir;
+  if (const char *Dir = ::getenv("JITDUMPDIR")) {
+    JITDumpDir = Dir;
+  } else {
+    if (!sys::path::home_directory(JITDumpDir))
+      JITDumpDir = ".";
+    sys::path::append(JITDumpDir, ".debug", "jit");
+  }
+  return createPerfJITEventListener("/tmp", JITDumpDir);
+}
+
+JITEventListener *
+JITEventListener::createPerfJITEventListener(StringRef PerfMapDir,
+                                             StringRef JITDumpDir) {
+  return new PerfJITEventListener(PerfMapDir, JITDumpDir);
+}
+
+} // namespace llvm
+
+#else // !defined(__linux__)
+
+namespace llvm {
+// perf only exists on Linux.
+JITEventListener *JITEventListener::createPerfJITEventListener() {
+  return nullptr;
+}
+
+JITEventListener *
+JITEventListener::createPerfJITEventListener(StringRef PerfMapDir,
+                                             StringRef JITDumpDir) {
+  return nullptr;
+}
+
+} // namespace llvm
+
+#endif // defined(__linux__)
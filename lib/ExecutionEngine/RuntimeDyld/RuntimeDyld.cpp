@@ -21,6 +21,7 @@
 #include "llvm/Object/COFF.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MutexGuard.h"
+#include <algorithm>
 
 using namespace llvm;
 using namespace llvm::object;
@@ -82,23 +83,23 @@ static void dumpSectionMemory(const SectionEntry &S, StringRef State) {
 void RuntimeDyldImpl::resolveRelocations() {
   MutexGuard locked(lock);
 
-  // First, resolve relocations associated with external symbols.
-  resolveExternalSymbols();
-
-  // Just iterate over the sections we have and resolve all the relocations
-  // in them. Gross overkill, but it gets the job done.
-  for (int i = 0, e = Sections.size(); i != e; ++i) {
-    // The Section here (Sections[i]) refers to the section in which the
-    // symbol for the relocation is located.  The SectionID in the relocation
-    // entry provides the section to which the relocation will be applied.
-    uint64_t Addr = Sections[i].LoadAddress;
-    DEBUG(dbgs() << "Resolving relocations Section #" << i << "\t"
-                 << format("%p", (uintptr_t)Addr) << "\n");
-    DEBUG(dumpSectionMemory(Sections[i], "before relocations"));
-    resolveRelocationList(Relocations[i], Addr);
-    DEBUG(dumpSectionMemory(Sections[i], "after relocations"));
-    Relocations.erase(i);
-  }
+  // First, find the addresses of the external symbols. This may load more
+  // objects, and so add more relocations.
+  std::vector<std::pair<uint64_t, RelocationList>> ExternalRelocations;
+  resolveExternalSymbols(ExternalRelocations);
+
+  // Then apply all the relocations we have in one batch. The relocations to
+  // loaded sections take the address the section currently has.
+  std::vector<ResolvedRelocation> Batch;
+  Batch.reserve(Relocations.size());
+  for (const auto &ExternalRelocs : ExternalRelocations)
+    for (const RelocationEntry &RE : ExternalRelocs.second)
+      Batch.push_back(ResolvedRelocation(ExternalRelocs.first, &RE));
+  for (const auto &SectionReloc : Relocations)
+    Batch.push_back(ResolvedRelocation(
+        Sections[SectionReloc.first].LoadAddress, &SectionReloc.second));
+  applyRelocations(Batch);
+  Relocations.clear();
 }
 
 void RuntimeDyldImpl::mapSectionAddress(const void *LocalAddress,
@@ -648,7 +649,7 @@ unsigned RuntimeDyldImpl::findOrEmitSection(const ObjectFile &Obj,
 
 void RuntimeDyldImpl::addRelocationForSection(const RelocationEntry &RE,
                                               unsigned SectionID) {
-  Relocations[SectionID].push_back(RE);
+  Relocations.push_back(std::make_pair(SectionID, RE));
 }
 
 void RuntimeDyldImpl::addRelocationForSymbol(const RelocationEntry &RE,
@@ -664,7 +665,7 @@ void RuntimeDyldImpl::addRelocationForSymbol(const RelocationEntry &RE,
     RelocationEntry RECopy = RE;
     const auto &SymInfo = Loc->second;
     RECopy.Addend += SymInfo.getOffset();
-    Relocations[SymInfo.getSectionID()].push_back(RECopy);
+    Relocations.push_back(std::make_pair(SymInfo.getSectionID(), RECopy));
   }
 }
 
@@ -765,42 +766,62 @@ void RuntimeDyldImpl::reassignSectionAddress(unsigned SectionID,
   Sections[SectionID].LoadAddress = Addr;
 }
 
-void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
-                                            uint64_t Value) {
-  for (unsigned i = 0, e = Relocs.size(); i != e; ++i) {
-    const RelocationEntry &RE = Relocs[i];
+void RuntimeDyldImpl::applyRelocations(
+    std::vector<ResolvedRelocation> &Batch) {
+  // Patch one section at a time, in address order. Relocations that patch the
+  // same location keep the order they were added in.
+  std::stable_sort(Batch.begin(), Batch.end(),
+                   [](const ResolvedRelocation &A,
+                      const ResolvedRelocation &B) {
+    if (A.second->SectionID != B.second->SectionID)
+      return A.second->SectionID < B.second->SectionID;
+    return A.second->Offset < B.second->Offset;
+  });
+
+  for (unsigned i = 0, e = Batch.size(); i != e;) {
+    unsigned SectionID = Batch[i].second->SectionID;
+    unsigned End = i + 1;
+    while (End != e && Batch[End].second->SectionID == SectionID)
+      ++End;
+
     // Ignore relocations for sections that were not loaded
-    if (Sections[RE.SectionID].Address == nullptr)
-      continue;
-    resolveRelocation(RE, Value);
+    if (Sections[SectionID].Address != nullptr) {
+      DEBUG(dbgs() << "Resolving relocations Section #" << SectionID << "\t"
+                   << format("%p", (uintptr_t)Sections[SectionID].LoadAddress)
+                   << "\n");
+      DEBUG(dumpSectionMemory(Sections[SectionID], "before relocations"));
+      for (; i != End; ++i)
+        resolveRelocation(*Batch[i].second, Batch[i].first);
+      DEBUG(dumpSectionMemory(Sections[SectionID], "after relocations"));
+    }
+    i = End;
   }
 }
 
-void RuntimeDyldImpl::resolveExternalSymbols() {
+void RuntimeDyldImpl::resolveExternalSymbols(
+    std::vector<std::pair<uint64_t, RelocationList>> &Resolved) {
   while (!ExternalSymbolRelocations.empty()) {
-    StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
+    // Looking up a symbol in the symbol resolver may load more objects, which
+    // may add entries to ExternalSymbolRelocations, so take the current
+    // entries out of the map and handle any new ones in the next round.
+    StringMap<RelocationList> Pending(std::move(ExternalSymbolRelocations));
 
-    StringRef Name = i->first();
-    if (Name.size() == 0) {
-      // This is an absolute symbol, use an address of zero.
-      DEBUG(dbgs() << "Resolving absolute relocations."
-                   << "\n");
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, 0);
-    } else {
+    for (auto &Entry : Pending) {
+      StringRef Name = Entry.first();
       uint64_t Addr = 0;
+      if (Name.size() == 0) {
+        // This is an absolute symbol, use an address of zero.
+        DEBUG(dbgs() << "Resolving absolute relocations."
+                     << "\n");
+        Resolved.push_back(std::make_pair(0, std::move(Entry.second)));
+        continue;
+      }
+
       RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
       if (Loc == GlobalSymbolTable.end()) {
         // This is an external symbol, try to get its address from the symbol
         // resolver.
         Addr = Resolver.findSymbol(Name.data()).getAddress();
-        // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
@@ -816,13 +837,8 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
 
       DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
                    << format("0x%lx", Addr) << "\n");
-      // This list may have been updated when we called getSymbolAddress, so
-      // don't change this code to get the list earlier.
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, Addr);
+      Resolved.push_back(std::make_pair(Addr, std::move(Entry.second)));
     }
-
-    ExternalSymbolRelocations.erase(i);
   }
 }
 
@@ -218,19 +218,25 @@ protected:
   // For each symbol, keep a list of relocations based on it. Anytime
   // its address is reassigned (the JIT re-compiled the function, e.g.),
   // the relocations get re-resolved.
-  // The symbol (or section) the relocation is sourced from is the Key
-  // in the relocation list where it's stored.
-  typedef SmallVector<RelocationEntry, 64> RelocationList;
-  // Relocations to sections already loaded. Indexed by SectionID which is the
-  // source of the address. The target where the address will be written is
-  // SectionID/Offset in the relocation itself.
-  DenseMap<unsigned, RelocationList> Relocations;
+  typedef std::vector<RelocationEntry> RelocationList;
+
+  // Relocations to sections already loaded, in one flat list, paired with the
+  // SectionID which is the source of the address. The target where the
+  // address will be written is SectionID/Offset in the relocation itself.
+  typedef std::vector<std::pair<SID, RelocationEntry>> SectionRelocationList;
+  SectionRelocationList Relocations;
 
   // Relocations to external symbols that are not yet resolved.  Symbols are
   // external when they aren't found in the global symbol table of all loaded
   // modules.  This map is indexed by symbol name.
   StringMap<RelocationList> ExternalSymbolRelocations;
 
+  // A relocation that is ready to be applied, with the value of the symbol or
+  // section it refers to. resolveRelocations collects these and applies them
+  // sorted by the section they patch, rather than by the symbol they refer
+  // to, so each section's memory is written in one pass.
+  typedef std::pair<uint64_t, const RelocationEntry *> ResolvedRelocation;
+
 
   typedef std::map<RelocationValueRef, uintptr_t> StubMap;
 
@@ -341,8 +347,9 @@ protected:
   /// \return Pointer to the memory area for emitting target address.
   uint8_t *createStubFunction(uint8_t *Addr, unsigned AbiVariant = 0);
 
-  /// \brief Resolves relocations from Relocs list with address from Value.
-  void resolveRelocationList(const RelocationList &Relocs, uint64_t Value);
+  /// \brief Sort the given relocations by the location they patch and apply
+  /// them.
+  void applyRelocations(std::vector<ResolvedRelocation> &Batch);
 
   /// \brief A object file specific relocation resolver
   /// \param RE The relocation to be resolved
@@ -358,8 +365,11 @@ protected:
                        const ObjectFile &Obj, ObjSectionToIDMap &ObjSectionToID,
                        StubMap &Stubs) = 0;
 
-  /// \brief Resolve relocations to external symbols.
-  void resolveExternalSymbols();
+  /// \brief Look up the addresses of the external symbols that have
+  /// relocations, and move those relocations to Resolved along with the
+  /// addresses.
+  void resolveExternalSymbols(
+      std::vector<std::pair<uint64_t, RelocationList>> &Resolved);
 
   // \brief Compute an upper bound of the memory that is required to load all
   // sections
@@ -15,9 +15,142 @@
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Process.h"
 
 namespace llvm {
 
+SectionMemoryPool::SectionMemoryPool(size_t SlabSize, bool UseHugePages)
+    : SlabSize(SlabSize), PageSize(sys::Process::getPageSize()),
+      UseHugePages(UseHugePages) {}
+
+SectionMemoryPool::~SectionMemoryPool() {
+  for (PurposeInfo &Info : Purposes)
+    for (sys::MemoryBlock &Slab : Info.Slabs)
+      sys::Memory::releaseMappedMemory(Slab);
+  for (sys::MemoryBlock &Slab : HugeCode.Slabs)
+    sys::Memory::releaseMappedMemory(Slab);
+}
+
+sys::MemoryBlock SectionMemoryPool::allocate(AllocationPurpose Purpose,
+                                             size_t Size,
+                                             std::error_code &EC) {
+  EC = std::error_code();
+  if (!Size)
+    return sys::MemoryBlock();
+  Size = RoundUpToAlignment(Size, getChunkAlignment(Purpose, Size));
+  bool Huge = isHugeCodeChunk(Purpose, Size);
+
+  MutexGuard Guard(Lock);
+  PurposeInfo &Info = getInfo(Purpose, Size);
+
+  // Take the first free range that is large enough. Ranges are ordered by
+  // address, which keeps allocations packed at the start of the slabs.
+  for (auto I = Info.FreeRanges.begin(), E = Info.FreeRanges.end(); I != E;
+       ++I) {
+    if (I->second < Size)
+      continue;
+    uintptr_t Addr = I->first;
+    size_t Remaining = I->second - Size;
+    Info.FreeRanges.erase(I);
+    if (Remaining)
+      Info.FreeRanges[Addr + Size] = Remaining;
+    return sys::MemoryBlock((void *)Addr, Size);
+  }
+
+  // Reserve a new slab, after the last one so that all slabs stay close.
+  unsigned Flags = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+  if (Huge)
+    Flags |= sys::Memory::MF_HUGE_HINT;
+  sys::MemoryBlock Slab = sys::Memory::allocateMappedMemory(
+      std::max(SlabSize, Size), &Near, Flags, EC);
+  if (EC)
+    return sys::MemoryBlock();
+  Near = Slab;
+  Info.Slabs.push_back(Slab);
+
+  uintptr_t Addr = (uintptr_t)Slab.base();
+  if (Slab.size() > Size)
+    Info.FreeRanges[Addr + Size] = Slab.size() - Size;
+  return sys::MemoryBlock((void *)Addr, Size);
+}
+
+bool SectionMemoryPool::isHugeCodeChunk(AllocationPurpose Purpose,
+                                        size_t Size) const {
+  return UseHugePages && Purpose == AllocationPurpose::Code &&
+         PageSize < HugePageSize && Size >= MinHugeCodeChunk;
+}
+
+size_t SectionMemoryPool::getChunkAlignment(AllocationPurpose Purpose,
+                                            size_t Size) const {
+  // Changing the permissions of part of a huge page splits it, so code
+  // chunks backed by huge pages are made of whole huge pages, which are then
+  // finalized at once.
+  if (isHugeCodeChunk(Purpose, RoundUpToAlignment(Size, PageSize)))
+    return HugePageSize;
+  return PageSize;
+}
+
+void SectionMemoryPool::release(AllocationPurpose Purpose,
+                                sys::MemoryBlock Block) {
+  if (!Block.base() || !Block.size())
+    return;
+
+  // The chunk may have been finalized as read-only or executable.
+  sys::Memory::protectMappedMemory(Block, sys::Memory::MF_READ |
+                                              sys::Memory::MF_WRITE);
+
+  // Huge-page chunks are at least MinHugeCodeChunk bytes long, and the others
+  // shorter, so the size tells which slabs the chunk came from.
+  MutexGuard Guard(Lock);
+  PurposeInfo &Info = getInfo(Purpose, Block.size());
+  auto IsSlabStart = [&](uintptr_t Addr) {
+    for (const sys::MemoryBlock &Slab : Info.Slabs)
+      if ((uintptr_t)Slab.base() == Addr)
+        return true;
+    return false;
+  };
+
+  // Coalesce the chunk with its free neighbours in the same slab, so that
+  // memory freed by small modules can be reused by large ones.
+  uintptr_t Addr = (uintptr_t)Block.base();
+  size_t Size = Block.size();
+  auto Next = Info.FreeRanges.lower_bound(Addr);
+  if (Next != Info.FreeRanges.end() && Next->first == Addr + Size &&
+      !IsSlabStart(Next->first)) {
+    Size += Next->second;
+    Next = Info.FreeRanges.erase(Next);
+  }
+  if (Next != Info.FreeRanges.begin() && !IsSlabStart(Addr)) {
+    auto Prev = std::prev(Next);
+    if (Prev->first + Prev->second == Addr) {
+      Prev->second += Size;
+      return;
+    }
+  }
+  Info.FreeRanges[Addr] = Size;
+}
+
+unsigned SectionMemoryPool::getNumSlabs() const {
+  MutexGuard Guard(Lock);
+  unsigned NumSlabs = HugeCode.Slabs.size();
+  for (const PurposeInfo &Info : Purposes)
+    NumSlabs += Info.Slabs.size();
+  return NumSlabs;
+}
+
+size_t SectionMemoryPool::getFreeSize(AllocationPurpose Purpose) const {
+  MutexGuard Guard(Lock);
+  size_t FreeSize = 0;
+  for (const auto &Range :
+       Purposes[static_cast<unsigned>(Purpose)].FreeRanges)
+    FreeSize += Range.second;
+  if (Purpose == AllocationPurpose::Code)
+    for (const auto &Range : HugeCode.FreeRanges)
+      FreeSize += Range.second;
+  return FreeSize;
+}
+
 uint8_t *SectionMemoryManager::allocateDataSection(uintptr_t Size,
                                                    unsigned Alignment,
                                                    unsigned SectionID,
@@ -72,11 +205,7 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
   std::error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
-                                                          &MemGroup.Near,
-                                                          sys::Memory::MF_READ |
-                                                            sys::Memory::MF_WRITE,
-                                                          ec);
+  sys::MemoryBlock MB = allocateMemory(MemGroup, RequiredSize, ec);
   if (ec) {
     // FIXME: Add error propagation to the interface.
     return nullptr;
@@ -102,6 +231,47 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   return (uint8_t*)Addr;
 }
 
+void SectionMemoryManager::reserveAllocationSpace(uintptr_t CodeSize,
+                                                  uintptr_t DataSizeRO,
+                                                  uintptr_t DataSizeRW) {
+  std::pair<MemoryGroup *, uintptr_t> Requests[] = {
+    std::make_pair(&CodeMem, CodeSize),
+    std::make_pair(&RODataMem, DataSizeRO),
+    std::make_pair(&RWDataMem, DataSizeRW)
+  };
+  for (auto &Request : Requests) {
+    if (!Request.second)
+      continue;
+    std::error_code ec;
+    sys::MemoryBlock MB = allocateMemory(*Request.first, Request.second, ec);
+    // If the reservation fails, allocateSection will try again per section.
+    if (ec)
+      continue;
+    Request.first->AllocatedMem.push_back(MB);
+    Request.first->FreeMem.push_back(MB);
+  }
+}
+
+sys::MemoryBlock SectionMemoryManager::allocateMemory(MemoryGroup &MemGroup,
+                                                      size_t Size,
+                                                      std::error_code &EC) {
+  if (Pool)
+    return Pool->allocate(getPurpose(MemGroup), Size, EC);
+  return sys::Memory::allocateMappedMemory(Size, &MemGroup.Near,
+                                           sys::Memory::MF_READ |
+                                             sys::Memory::MF_WRITE,
+                                           EC);
+}
+
+SectionMemoryPool::AllocationPurpose
+SectionMemoryManager::getPurpose(const MemoryGroup &MemGroup) {
+  if (&MemGroup == &CodeMem)
+    return SectionMemoryPool::AllocationPurpose::Code;
+  if (&MemGroup == &RODataMem)
+    return SectionMemoryPool::AllocationPurpose::ROData;
+  return SectionMemoryPool::AllocationPurpose::RWData;
+}
+
 bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
 {
   // FIXME: Should in-progress permissions be reverted if an error occurs?
@@ -165,13 +335,19 @@ void SectionMemoryManager::invalidateInstructionCache() {
                                             CodeMem.AllocatedMem[i].size());
 }
 
+void SectionMemoryManager::releaseMemoryGroup(MemoryGroup &MemGroup) {
+  for (unsigned i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+    if (Pool)
+      Pool->release(getPurpose(MemGroup), MemGroup.AllocatedMem[i]);
+    else
+      sys::Memory::releaseMappedMemory(MemGroup.AllocatedMem[i]);
+  }
+}
+
 SectionMemoryManager::~SectionMemoryManager() {
-  for (unsigned i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(CodeMem.AllocatedMem[i]);
-  for (unsigned i = 0, e = RWDataMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(RWDataMem.AllocatedMem[i]);
-  for (unsigned i = 0, e = RODataMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(RODataMem.AllocatedMem[i]);
+  releaseMemoryGroup(CodeMem);
+  releaseMemoryGroup(RWDataMem);
+  releaseMemoryGroup(RODataMem);
 }
 
 } // namespace llvm
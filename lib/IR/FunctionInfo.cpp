@@ -0,0 +1,120 @@
+//===-- FunctionInfo.cpp - Function summary index -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the FunctionSummary and FunctionInfoIndex classes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+using namespace llvm;
+
+/// Return true if the body of a function may use \p C, which it refers to,
+/// from another module. Linkonce definitions are not visible there: their own
+/// module drops them if it doesn't need them.
+static bool
+isVisibleFromOtherModules(const Constant *C,
+                          SmallPtrSetImpl<const Constant *> &Visited) {
+  if (!Visited.insert(C).second)
+    return true;
+  if (isa<BlockAddress>(C) || isa<GlobalAlias>(C))
+    return false;
+  if (const auto *GV = dyn_cast<GlobalValue>(C))
+    return !GV->hasLocalLinkage() && !GV->hasLinkOnceLinkage();
+  for (const Use &Op : C->operands())
+    if (!isVisibleFromOtherModules(cast<Constant>(Op), Visited))
+      return false;
+  return true;
+}
+
+FunctionSummary FunctionSummary::compute(const Function &F) {
+  assert(!F.isDeclaration() && "Summarizing a declaration");
+  FunctionSummary Summary;
+
+  bool CanImport = !F.hasLocalLinkage() && !F.mayBeOverridden() &&
+                   !F.hasPrefixData() && !F.hasPrologueData();
+
+  // A recursive linkonce_odr function is imported along with itself.
+  SmallPtrSet<const Constant *, 32> Visited;
+  Visited.insert(&F);
+  DenseMap<const Function *, unsigned> CallSites;
+  std::vector<const Function *> Callees;
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      ++Summary.InstCount;
+
+      for (const Use &Op : I.operands())
+        if (const auto *C = dyn_cast<Constant>(Op))
+          CanImport &= isVisibleFromOtherModules(C, Visited);
+
+      ImmutableCallSite CS(&I);
+      if (!CS)
+        continue;
+      const Function *Callee = CS.getCalledFunction();
+      if (!Callee || Callee->isIntrinsic() || Callee->hasLocalLinkage())
+        continue;
+      if (CallSites[Callee]++ == 0)
+        Callees.push_back(Callee);
+    }
+
+  if (CanImport)
+    Summary.Flags |= Importable;
+  if (F.hasFnAttribute(Attribute::Cold))
+    Summary.Flags |= Cold;
+  for (const Function *Callee : Callees)
+    Summary.Calls.push_back(
+        std::make_pair(Callee->getName().str(), CallSites[Callee]));
+  return Summary;
+}
+
+unsigned FunctionInfoIndex::addModulePath(StringRef Path) {
+  ModulePaths.push_back(Path);
+  return ModulePaths.size() - 1;
+}
+
+void FunctionInfoIndex::addFunction(StringRef Name, unsigned ModuleId,
+                                    FunctionSummary Summary) {
+  assert(ModuleId < ModulePaths.size() && "Unknown module");
+  Entry E;
+  E.ModuleId = ModuleId;
+  E.Summary = std::move(Summary);
+  Functions.insert(std::make_pair(Name, std::move(E)));
+}
+
+const FunctionInfoIndex::Entry *
+FunctionInfoIndex::findFunction(StringRef Name) const {
+  auto I = Functions.find(Name);
+  if (I == Functions.end())
+    return nullptr;
+  return &I->second;
+}
+
+void FunctionInfoIndex::mergeFrom(const FunctionInfoIndex &Other) {
+  unsigned FirstId = ModulePaths.size();
+  for (const std::string &Path : Other.ModulePaths)
+    addModulePath(Path);
+  for (const auto &I : Other.Functions)
+    addFunction(I.first(), FirstId + I.second.ModuleId, I.second.Summary);
+}
+
+void FunctionInfoIndex::addModule(const Module &M) {
+  unsigned ModuleId = addModulePath(M.getModuleIdentifier());
+  for (const Function &F : M)
+    if (!F.isDeclaration() && !F.hasLocalLinkage() &&
+        !F.hasAvailableExternallyLinkage())
+      addFunction(F.getName(), ModuleId, FunctionSummary::compute(F));
+}
@@ -23,11 +23,15 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/thread.h"
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
 using namespace llvm;
 using namespace llvm::legacy;
 
@@ -83,6 +87,11 @@ PrintAfterAll("print-after-all",
               llvm::cl::desc("Print IR after each pass"),
               cl::init(false));
 
+static cl::opt<unsigned>
+FunctionPassThreads("function-pass-threads", cl::Hidden, cl::init(1),
+                    cl::desc("Number of functions that thread safe function "
+                             "passes may process at the same time"));
+
 /// This is a helper to determine whether to print IR before or
 /// after a pass.
 
@@ -498,7 +507,8 @@ static TimingInfo *TheTimeInfo;
 // PMTopLevelManager implementation
 
 /// Initialize top level manager. Create first pass manager.
-PMTopLevelManager::PMTopLevelManager(PMDataManager *PMDM) {
+PMTopLevelManager::PMTopLevelManager(PMDataManager *PMDM)
+    : FunctionPassThreads(::FunctionPassThreads) {
   PMDM->setTopLevelManager(this);
   addPassManager(PMDM);
   activeStack.push(PMDM);
@@ -1552,6 +1562,10 @@ bool FPPassManager::runOnFunction(Function &F) {
 }
 
 bool FPPassManager::runOnModule(Module &M) {
+  unsigned NumThreads = getNumThreads(M);
+  if (NumThreads > 1)
+    return runOnModuleConcurrently(M, NumThreads);
+
   bool Changed = false;
 
   for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
@@ -1560,6 +1574,82 @@ bool FPPassManager::runOnModule(Module &M) {
   return Changed;
 }
 
+unsigned FPPassManager::getNumThreads(Module &M) {
+  unsigned NumThreads = TPM->getFunctionPassThreads();
+  // Pass timers and execution traces are not thread safe, and functions
+  // cannot be materialized concurrently.
+  if (NumThreads <= 1 || !llvm_is_multithreaded() || TimePassesIsEnabled ||
+      PassDebugging >= Executions || M.getMaterializer())
+    return 1;
+
+  // Every thread needs its own instance of each pass, and has to be able to
+  // compute by itself all the analyses the passes require.
+  PassRegistry &PR = *PassRegistry::getPassRegistry();
+  SmallPtrSet<AnalysisID, 8> Available;
+  for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
+    FunctionPass *FP = getContainedPass(Index);
+    const PassInfo *PI = PR.getPassInfo(FP->getPassID());
+    if (!FP->isThreadSafe() || !PI || !PI->getNormalCtor())
+      return 1;
+    for (AnalysisID ID : TPM->findAnalysisUsage(FP)->getRequiredSet())
+      if (!Available.count(ID))
+        return 1;
+    Available.insert(PI->getTypeInfo());
+    for (const PassInfo *ImplementedPI : PI->getInterfacesImplemented())
+      Available.insert(ImplementedPI->getTypeInfo());
+  }
+
+  unsigned NumFunctions = 0;
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      ++NumFunctions;
+  return std::min(NumThreads, NumFunctions);
+}
+
+bool FPPassManager::runOnModuleConcurrently(Module &M, unsigned NumThreads) {
+  // The calling thread runs the passes of this manager. Set up the passes of
+  // the other threads before starting them, as creating a pass may initialize
+  // the PassRegistry.
+  PassRegistry &PR = *PassRegistry::getPassRegistry();
+  std::vector<std::unique_ptr<FunctionPassManager>> ThreadFPMs;
+  for (unsigned I = 1; I < NumThreads; ++I) {
+    ThreadFPMs.emplace_back(new FunctionPassManager(&M));
+    for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
+      const void *ID = getContainedPass(Index)->getPassID();
+      ThreadFPMs.back()->add(PR.getPassInfo(ID)->createPass());
+    }
+  }
+
+  // Functions are handed out to the threads in module order.
+  std::vector<Function *> Functions;
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      Functions.push_back(&F);
+  std::atomic<size_t> NextFunction(0);
+
+  std::vector<char> ThreadChanged(NumThreads - 1, false);
+  std::vector<llvm::thread> Threads;
+  for (unsigned I = 1; I < NumThreads; ++I)
+    Threads.emplace_back([&](unsigned ThreadIdx) {
+      FunctionPassManager &FPM = *ThreadFPMs[ThreadIdx];
+      bool Changed = FPM.doInitialization();
+      for (size_t N = NextFunction++; N < Functions.size(); N = NextFunction++)
+        Changed |= FPM.run(*Functions[N]);
+      Changed |= FPM.doFinalization();
+      ThreadChanged[ThreadIdx] = Changed;
+    }, I - 1);
+
+  bool Changed = false;
+  for (size_t N = NextFunction++; N < Functions.size(); N = NextFunction++)
+    Changed |= runOnFunction(*Functions[N]);
+
+  for (llvm::thread &T : Threads)
+    T.join();
+  for (char C : ThreadChanged)
+    Changed |= C;
+  return Changed;
+}
+
 bool FPPassManager::doInitialization(Module &M) {
   bool Changed = false;
 
@@ -1756,6 +1846,10 @@ bool PassManager::run(Module &M) {
   return PM->run(M);
 }
 
+void PassManager::setFunctionPassThreads(unsigned N) {
+  PM->setFunctionPassThreads(N);
+}
+
 //===----------------------------------------------------------------------===//
 // TimingInfo implementation
 
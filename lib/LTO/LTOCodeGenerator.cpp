@@ -18,6 +18,7 @@
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/RuntimeLibcalls.h"
 #include "llvm/Config/config.h"
 #include "llvm/IR/Constants.h"
@@ -76,6 +77,7 @@ LTOCodeGenerator::LTOCodeGenerator(std::unique_ptr<LLVMContext> Context)
 
 void LTOCodeGenerator::initialize() {
   TargetMach = nullptr;
+  MArch = nullptr;
   EmitDwarfDebugInfo = false;
   ScopeRestrictionsDone = false;
   CodeModel = LTO_CODEGEN_PIC_MODEL_DEFAULT;
@@ -319,19 +321,19 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
   if (TargetMach)
     return true;
 
-  std::string TripleStr = IRLinker.getModule()->getTargetTriple();
+  TripleStr = IRLinker.getModule()->getTargetTriple();
   if (TripleStr.empty())
     TripleStr = sys::getDefaultTargetTriple();
   llvm::Triple Triple(TripleStr);
 
   // create target machine from info for merged modules
-  const Target *march = TargetRegistry::lookupTarget(TripleStr, errMsg);
-  if (!march)
+  MArch = TargetRegistry::lookupTarget(TripleStr, errMsg);
+  if (!MArch)
     return false;
 
   // The relocation model is actually a static member of TargetMachine and
   // needs to be set before the TargetMachine is instantiated.
-  Reloc::Model RelocModel = Reloc::Default;
+  RelocModel = Reloc::Default;
   switch (CodeModel) {
   case LTO_CODEGEN_PIC_MODEL_STATIC:
     RelocModel = Reloc::Static;
@@ -351,7 +353,7 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
   // the default set of features.
   SubtargetFeatures Features(MAttr);
   Features.getDefaultSubtargetFeatures(Triple);
-  std::string FeatureStr = Features.getString();
+  FeatureStr = Features.getString();
   // Set a default CPU for Darwin triples.
   if (MCpu.empty() && Triple.isOSDarwin()) {
     if (Triple.getArch() == llvm::Triple::x86_64)
@@ -362,7 +364,6 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
       MCpu = "cyclone";
   }
 
-  CodeGenOpt::Level CGOptLevel;
   switch (OptLevel) {
   case 0:
     CGOptLevel = CodeGenOpt::None;
@@ -378,12 +379,16 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
     break;
   }
 
-  TargetMach = march->createTargetMachine(TripleStr, MCpu, FeatureStr, Options,
-                                          RelocModel, CodeModel::Default,
-                                          CGOptLevel);
+  TargetMach = createTargetMachine().release();
   return true;
 }
 
+std::unique_ptr<TargetMachine> LTOCodeGenerator::createTargetMachine() {
+  return std::unique_ptr<TargetMachine>(
+      MArch->createTargetMachine(TripleStr, MCpu, FeatureStr, Options,
+                                 RelocModel, CodeModel::Default, CGOptLevel));
+}
+
 void LTOCodeGenerator::
 applyRestriction(GlobalValue &GV,
                  ArrayRef<StringRef> Libcalls,
@@ -569,26 +574,42 @@ bool LTOCodeGenerator::optimize(bool DisableInline,
 
 bool LTOCodeGenerator::compileOptimized(raw_pwrite_stream &out,
                                         std::string &errMsg) {
+  return compileOptimized(makeArrayRef(&out), errMsg);
+}
+
+bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out,
+                                        std::string &errMsg) {
   if (!this->determineTarget(errMsg))
     return false;
 
   Module *mergedModule = IRLinker.getModule();
 
-  legacy::PassManager codeGenPasses;
-
   // If the bitcode files contain ARC code and were compiled with optimization,
   // the ObjCARCContractPass must be run, so do it unconditionally here.
-  codeGenPasses.add(createObjCARCContractPass());
+  legacy::PassManager preCodeGenPasses;
+  preCodeGenPasses.add(createObjCARCContractPass());
+  preCodeGenPasses.run(*mergedModule);
+
+  // Run the code generator, and write the object files. With a single output
+  // the target machine created by determineTarget() is reused; otherwise the
+  // merged module is split and each partition gets a target machine of its
+  // own.
+  if (Out.size() == 1) {
+    legacy::PassManager codeGenPasses;
+    if (TargetMach->addPassesToEmitFile(codeGenPasses, *Out[0],
+                                        TargetMachine::CGFT_ObjectFile)) {
+      errMsg = "target file type not supported";
+      return false;
+    }
+    codeGenPasses.run(*mergedModule);
+    return true;
+  }
 
-  if (TargetMach->addPassesToEmitFile(codeGenPasses, out,
-                                      TargetMachine::CGFT_ObjectFile)) {
+  if (splitCodeGen(*mergedModule, Out, [&] { return createTargetMachine(); })) {
     errMsg = "target file type not supported";
     return false;
   }
 
-  // Run the code generator, and write assembly file
-  codeGenPasses.run(*mergedModule);
-
   return true;
 }
 
@@ -186,6 +186,30 @@ static Module *parseBitcodeFileImpl(MemoryBufferRef Buffer,
   return *M;
 }
 
+static bool readSymbolTableImpl(MemoryBufferRef Buffer, LLVMContext &Context,
+                                std::unique_ptr<BitcodeSymbolTable> &Symtab,
+                                std::string &ErrMsg) {
+  // Find the buffer.
+  ErrorOr<MemoryBufferRef> MBOrErr =
+      IRObjectFile::findBitcodeInMemBuffer(Buffer);
+  if (std::error_code EC = MBOrErr.getError()) {
+    ErrMsg = EC.message();
+    return false;
+  }
+
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>> SymtabOrErr =
+      readBitcodeSymbolTable(*MBOrErr, Context,
+                             [&ErrMsg](const DiagnosticInfo &DI) {
+                               raw_string_ostream Stream(ErrMsg);
+                               DiagnosticPrinterRawOStream DP(Stream);
+                               DI.print(DP);
+                             });
+  if (!SymtabOrErr)
+    return false;
+  Symtab = std::move(*SymtabOrErr);
+  return true;
+}
+
 LTOModule *LTOModule::makeLTOModule(MemoryBufferRef Buffer,
                                     TargetOptions options, std::string &errMsg,
                                     LLVMContext *Context) {
@@ -196,14 +220,22 @@ LTOModule *LTOModule::makeLTOModule(MemoryBufferRef Buffer,
   }
 
   // If we own a context, we know this is being used only for symbol
-  // extraction, not linking.  Be lazy in that case.
-  std::unique_ptr<Module> M(parseBitcodeFileImpl(
-      Buffer, *Context,
-      /* ShouldBeLazy */ static_cast<bool>(OwnedContext), errMsg));
-  if (!M)
+  // extraction, not linking.  Be lazy in that case, and don't parse the module
+  // at all if the bitcode has a symbol table.
+  std::unique_ptr<BitcodeSymbolTable> Symtab;
+  if (OwnedContext && !readSymbolTableImpl(Buffer, *Context, Symtab, errMsg))
     return nullptr;
 
-  std::string TripleStr = M->getTargetTriple();
+  std::unique_ptr<Module> M;
+  if (!Symtab) {
+    M.reset(parseBitcodeFileImpl(
+        Buffer, *Context,
+        /* ShouldBeLazy */ static_cast<bool>(OwnedContext), errMsg));
+    if (!M)
+      return nullptr;
+  }
+
+  std::string TripleStr = M ? M->getTargetTriple() : Symtab->TargetTriple;
   if (TripleStr.empty())
     TripleStr = sys::getDefaultTargetTriple();
   llvm::Triple Triple(TripleStr);
@@ -230,10 +262,14 @@ LTOModule *LTOModule::makeLTOModule(MemoryBufferRef Buffer,
 
   TargetMachine *target = march->createTargetMachine(TripleStr, CPU, FeatureStr,
                                                      options);
-  M->setDataLayout(*target->getDataLayout());
 
-  std::unique_ptr<object::IRObjectFile> IRObj(
-      new object::IRObjectFile(Buffer, std::move(M)));
+  std::unique_ptr<object::IRObjectFile> IRObj;
+  if (M) {
+    M->setDataLayout(*target->getDataLayout());
+    IRObj.reset(new object::IRObjectFile(Buffer, std::move(M)));
+  } else {
+    IRObj.reset(new object::IRObjectFile(Buffer, std::move(Symtab)));
+  }
 
   LTOModule *Ret;
   if (OwnedContext)
@@ -430,44 +466,86 @@ void LTOModule::addDefinedFunctionSymbol(const char *Name, const Function *F) {
   addDefinedSymbol(Name, F, true);
 }
 
-void LTOModule::addDefinedSymbol(const char *Name, const GlobalValue *def,
-                                 bool isFunction) {
+/// Return the attributes of a definition with the given properties. Default
+/// visibility gives LTO_SYMBOL_SCOPE_DEFAULT, which the caller may refine to
+/// LTO_SYMBOL_SCOPE_DEFAULT_CAN_BE_HIDDEN.
+static uint32_t getDefinedSymbolAttributes(unsigned align, bool isFunction,
+                                           bool isConstant,
+                                           GlobalValue::LinkageTypes linkage,
+                                           GlobalValue::VisibilityTypes vis) {
   // set alignment part log2() can have rounding errors
-  uint32_t align = def->getAlignment();
   uint32_t attr = align ? countTrailingZeros(align) : 0;
 
   // set permissions part
-  if (isFunction) {
+  if (isFunction)
     attr |= LTO_SYMBOL_PERMISSIONS_CODE;
-  } else {
-    const GlobalVariable *gv = dyn_cast<GlobalVariable>(def);
-    if (gv && gv->isConstant())
-      attr |= LTO_SYMBOL_PERMISSIONS_RODATA;
-    else
-      attr |= LTO_SYMBOL_PERMISSIONS_DATA;
-  }
+  else if (isConstant)
+    attr |= LTO_SYMBOL_PERMISSIONS_RODATA;
+  else
+    attr |= LTO_SYMBOL_PERMISSIONS_DATA;
 
   // set definition part
-  if (def->hasWeakLinkage() || def->hasLinkOnceLinkage())
+  if (GlobalValue::isWeakLinkage(linkage) ||
+      GlobalValue::isLinkOnceLinkage(linkage))
     attr |= LTO_SYMBOL_DEFINITION_WEAK;
-  else if (def->hasCommonLinkage())
+  else if (GlobalValue::isCommonLinkage(linkage))
     attr |= LTO_SYMBOL_DEFINITION_TENTATIVE;
   else
     attr |= LTO_SYMBOL_DEFINITION_REGULAR;
 
   // set scope part
-  if (def->hasLocalLinkage())
+  if (GlobalValue::isLocalLinkage(linkage))
     // Ignore visibility if linkage is local.
     attr |= LTO_SYMBOL_SCOPE_INTERNAL;
-  else if (def->hasHiddenVisibility())
+  else if (vis == GlobalValue::HiddenVisibility)
     attr |= LTO_SYMBOL_SCOPE_HIDDEN;
-  else if (def->hasProtectedVisibility())
+  else if (vis == GlobalValue::ProtectedVisibility)
     attr |= LTO_SYMBOL_SCOPE_PROTECTED;
-  else if (canBeOmittedFromSymbolTable(def))
-    attr |= LTO_SYMBOL_SCOPE_DEFAULT_CAN_BE_HIDDEN;
   else
     attr |= LTO_SYMBOL_SCOPE_DEFAULT;
 
+  return attr;
+}
+
+void LTOModule::addDefinedSymbol(const char *Name, const GlobalValue *def,
+                                 bool isFunction) {
+  const GlobalVariable *gv = dyn_cast<GlobalVariable>(def);
+  uint32_t attr = getDefinedSymbolAttributes(
+      def->getAlignment(), isFunction, gv && gv->isConstant(),
+      def->getLinkage(), def->getVisibility());
+  if ((attr & LTO_SYMBOL_SCOPE_MASK) == LTO_SYMBOL_SCOPE_DEFAULT &&
+      canBeOmittedFromSymbolTable(def))
+    attr = (attr & ~LTO_SYMBOL_SCOPE_MASK) |
+           LTO_SYMBOL_SCOPE_DEFAULT_CAN_BE_HIDDEN;
+
+  addDefinedSymbol(Name, attr, isFunction, def);
+}
+
+void LTOModule::addDefinedSymbol(const object::BasicSymbolRef &Sym,
+                                 const BitcodeSymbolTable::Symbol &Entry) {
+  SmallString<64> Buffer;
+  {
+    raw_svector_ostream OS(Buffer);
+    Sym.printName(OS);
+  }
+
+  uint32_t attr = getDefinedSymbolAttributes(
+      Entry.Alignment, Entry.isFunction(),
+      Entry.Flags & BitcodeSymbolTable::Symbol::SF_Constant, Entry.Linkage,
+      Entry.Visibility);
+  // Whether other linkonce_odr symbols can be hidden depends on how the IR
+  // uses them, so only the unnamed_addr ones are.
+  if ((attr & LTO_SYMBOL_SCOPE_MASK) == LTO_SYMBOL_SCOPE_DEFAULT &&
+      Entry.Linkage == GlobalValue::LinkOnceODRLinkage &&
+      (Entry.Flags & BitcodeSymbolTable::Symbol::SF_UnnamedAddr))
+    attr = (attr & ~LTO_SYMBOL_SCOPE_MASK) |
+           LTO_SYMBOL_SCOPE_DEFAULT_CAN_BE_HIDDEN;
+
+  addDefinedSymbol(Buffer.c_str(), attr, Entry.isFunction(), nullptr);
+}
+
+void LTOModule::addDefinedSymbol(const char *Name, uint32_t attr,
+                                 bool isFunction, const GlobalValue *def) {
   auto Iter = _defines.insert(Name).first;
 
   // fill information structure
@@ -565,8 +643,14 @@ void LTOModule::addPotentialUndefinedSymbol(const object::BasicSymbolRef &Sym,
   info.name = IterBool.first->first().data();
 
   const GlobalValue *decl = IRFile->getSymbolGV(Sym.getRawDataRefImpl());
+  bool isWeak;
+  if (decl)
+    isWeak = decl->hasExternalWeakLinkage();
+  else
+    isWeak = GlobalValue::isExternalWeakLinkage(
+        IRFile->getSymbolTableEntry(Sym.getRawDataRefImpl())->Linkage);
 
-  if (decl->hasExternalWeakLinkage())
+  if (isWeak)
     info.attributes = LTO_SYMBOL_DEFINITION_WEAKUNDEF;
   else
     info.attributes = LTO_SYMBOL_DEFINITION_UNDEFINED;
@@ -586,6 +670,15 @@ bool LTOModule::parseSymbols(std::string &errMsg) {
 
     bool IsUndefined = Flags & object::BasicSymbolRef::SF_Undefined;
 
+    if (const BitcodeSymbolTable::Symbol *Entry =
+            IRFile->getSymbolTableEntry(Sym.getRawDataRefImpl())) {
+      if (IsUndefined)
+        addPotentialUndefinedSymbol(Sym, Entry->isFunction());
+      else
+        addDefinedSymbol(Sym, *Entry);
+      continue;
+    }
+
     if (!GV) {
       SmallString<64> Buffer;
       {
@@ -639,23 +732,32 @@ bool LTOModule::parseSymbols(std::string &errMsg) {
 /// parseMetadata - Parse metadata from the module
 void LTOModule::parseMetadata() {
   // Linker Options
+  auto AddLinkerOption = [&](StringRef Option) {
+    // FIXME: Make StringSet::insert match Self-Associative Container
+    // requirements, returning <iter,bool> rather than bool, and use that
+    // here.
+    StringRef Op = _linkeropt_strings.insert(Option).first->first();
+    StringRef DepLibName =
+        _target->getObjFileLowering()->getDepLibFromLinkerOpt(Op);
+    if (!DepLibName.empty())
+      _deplibs.push_back(DepLibName.data());
+    else if (!Op.empty())
+      _linkeropts.push_back(Op.data());
+  };
+
+  if (const BitcodeSymbolTable *Symtab = IRFile->getSymbolTable()) {
+    for (const std::string &Option : Symtab->LinkerOptions)
+      AddLinkerOption(Option);
+    return;
+  }
+
   if (Metadata *Val = getModule().getModuleFlag("Linker Options")) {
     MDNode *LinkerOptions = cast<MDNode>(Val);
     for (unsigned i = 0, e = LinkerOptions->getNumOperands(); i != e; ++i) {
       MDNode *MDOptions = cast<MDNode>(LinkerOptions->getOperand(i));
       for (unsigned ii = 0, ie = MDOptions->getNumOperands(); ii != ie; ++ii) {
         MDString *MDOption = cast<MDString>(MDOptions->getOperand(ii));
-        // FIXME: Make StringSet::insert match Self-Associative Container
-        // requirements, returning <iter,bool> rather than bool, and use that
-        // here.
-        StringRef Op =
-            _linkeropt_strings.insert(MDOption->getString()).first->first();
-        StringRef DepLibName =
-            _target->getObjFileLowering()->getDepLibFromLinkerOpt(Op);
-        if (!DepLibName.empty())
-          _deplibs.push_back(DepLibName.data());
-        else if (!Op.empty())
-          _linkeropts.push_back(Op.data());
+        AddLinkerOption(MDOption->getString());
       }
     }
   }
@@ -197,8 +197,8 @@ class ELFObjectWriter : public MCObjectWriter {
       FWriter.write(F, Value);
     }
 
-    void WriteHeader(const MCAssembler &Asm,
-                     unsigned NumberOfSections);
+    void WriteHeader(const MCAssembler &Asm, unsigned NumberOfSections,
+                     uint64_t SectionHeaderOffset);
 
     void WriteSymbol(SymbolTableWriter &Writer, ELFSymbolData &MSD,
                      const MCAsmLayout &Layout);
@@ -402,7 +402,8 @@ ELFObjectWriter::~ELFObjectWriter()
 
 // Emit the ELF header.
 void ELFObjectWriter::WriteHeader(const MCAssembler &Asm,
-                                  unsigned NumberOfSections) {
+                                  unsigned NumberOfSections,
+                                  uint64_t SectionHeaderOffset) {
   // ELF Header
   // ----------
   //
@@ -432,7 +433,7 @@ void ELFObjectWriter::WriteHeader(const MCAssembler &Asm,
   Write32(ELF::EV_CURRENT);         // e_version
   WriteWord(0);                    // e_entry, no entry point in .o file
   WriteWord(0);                    // e_phoff, no program header for .o
-  WriteWord(0);                     // e_shoff = sec hdr table off in bytes
+  WriteWord(SectionHeaderOffset);   // e_shoff = sec hdr table off in bytes
 
   // e_flags = whatever the target wants
   Write32(Asm.getELFHeaderEFlags());
@@ -1155,72 +1156,77 @@ ELFObjectWriter::createRelocationSection(MCAssembler &Asm,
   return &Asm.getOrCreateSectionData(*RelaSection);
 }
 
-static SmallVector<char, 128>
-getUncompressedData(MCAsmLayout &Layout,
-                    MCSectionData::FragmentListType &Fragments) {
-  SmallVector<char, 128> UncompressedData;
-  for (const MCFragment &F : Fragments) {
-    const SmallVectorImpl<char> *Contents;
-    switch (F.getKind()) {
-    case MCFragment::FT_Data:
-      Contents = &cast<MCDataFragment>(F).getContents();
-      break;
-    case MCFragment::FT_Dwarf:
-      Contents = &cast<MCDwarfLineAddrFragment>(F).getContents();
-      break;
-    case MCFragment::FT_DwarfFrame:
-      Contents = &cast<MCDwarfCallFrameFragment>(F).getContents();
-      break;
-    default:
-      llvm_unreachable(
-          "Not expecting any other fragment types in a debug_* section");
-    }
-    UncompressedData.append(Contents->begin(), Contents->end());
+static const SmallVectorImpl<char> &getFragmentContents(const MCFragment &F) {
+  switch (F.getKind()) {
+  case MCFragment::FT_Data:
+    return cast<MCDataFragment>(F).getContents();
+  case MCFragment::FT_Dwarf:
+    return cast<MCDwarfLineAddrFragment>(F).getContents();
+  case MCFragment::FT_DwarfFrame:
+    return cast<MCDwarfCallFrameFragment>(F).getContents();
+  default:
+    llvm_unreachable(
+        "Not expecting any other fragment types in a debug_* section");
   }
-  return UncompressedData;
 }
 
-// Include the debug info compression header:
-// "ZLIB" followed by 8 bytes representing the uncompressed size of the section,
-// useful for consumers to preallocate a buffer to decompress into.
-static bool
-prependCompressionHeader(uint64_t Size,
-                         SmallVectorImpl<char> &CompressedContents) {
-  const StringRef Magic = "ZLIB";
-  if (Size <= Magic.size() + sizeof(Size) + CompressedContents.size())
-    return false;
-  if (sys::IsLittleEndianHost)
-    sys::swapByteOrder(Size);
-  CompressedContents.insert(CompressedContents.begin(),
-                            Magic.size() + sizeof(Size), 0);
-  std::copy(Magic.begin(), Magic.end(), CompressedContents.begin());
-  std::copy(reinterpret_cast<char *>(&Size),
-            reinterpret_cast<char *>(&Size + 1),
-            CompressedContents.begin() + Magic.size());
-  return true;
+// Write the header in front of the compressed contents of a section of
+// \p Size bytes. The .zdebug_* sections start with "ZLIB" followed by the
+// big-endian 8 byte size. SHF_COMPRESSED sections start with an Elf32_Chdr or
+// Elf64_Chdr in the byte order of the object file.
+static void writeCompressionHeader(DebugCompressionType Type, uint64_t Size,
+                                   unsigned Alignment, bool Is64Bit,
+                                   FragmentWriter &FWriter,
+                                   MCDataFragment &F) {
+  if (Type == DebugCompressionType::DCT_ZlibGnu) {
+    const StringRef Magic = "ZLIB";
+    F.getContents().append(Magic.begin(), Magic.end());
+    Size = support::endian::byte_swap<uint64_t, support::big>(Size);
+    const char *Start = (const char *)&Size;
+    F.getContents().append(Start, Start + sizeof(Size));
+    return;
+  }
+
+  FWriter.write(F, uint32_t(ELF::ELFCOMPRESS_ZLIB)); // ch_type
+  if (Is64Bit) {
+    FWriter.write(F, uint32_t(0));         // ch_reserved
+    FWriter.write(F, uint64_t(Size));      // ch_size
+    FWriter.write(F, uint64_t(Alignment)); // ch_addralign
+  } else {
+    FWriter.write(F, uint32_t(Size));      // ch_size
+    FWriter.write(F, uint32_t(Alignment)); // ch_addralign
+  }
 }
 
 // Return a single fragment containing the compressed contents of the whole
-// section. Null if the section was not compressed for any reason.
+// section, behind its compression header. Null if the section was not
+// compressed for any reason.
+//
+// The contents of the fragments are compressed as they are read, in chunks
+// that are compressed concurrently, so the uncompressed section is never
+// copied as a whole.
 static std::unique_ptr<MCDataFragment>
-getCompressedFragment(MCAsmLayout &Layout,
-                      MCSectionData::FragmentListType &Fragments) {
+getCompressedFragment(DebugCompressionType Type, const MCSectionData &SD,
+                      bool Is64Bit, FragmentWriter &FWriter) {
   std::unique_ptr<MCDataFragment> CompressedFragment(new MCDataFragment());
 
-  // Gather the uncompressed data from all the fragments, recording the
-  // alignment fragment, if seen, and any fixups.
-  SmallVector<char, 128> UncompressedData =
-      getUncompressedData(Layout, Fragments);
+  uint64_t Size = 0;
+  for (const MCFragment &F : SD)
+    Size += getFragmentContents(F).size();
+  writeCompressionHeader(Type, Size, SD.getAlignment(), Is64Bit, FWriter,
+                         *CompressedFragment);
 
   SmallVectorImpl<char> &CompressedContents = CompressedFragment->getContents();
-
-  zlib::Status Success = zlib::compress(
-      StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
-  if (Success != zlib::StatusOK)
+  zlib::ChunkedCompressor Compressor(CompressedContents);
+  for (const MCFragment &F : SD) {
+    const SmallVectorImpl<char> &Contents = getFragmentContents(F);
+    Compressor.write(StringRef(Contents.data(), Contents.size()));
+  }
+  if (Compressor.finish() != zlib::StatusOK)
     return nullptr;
 
-  if (!prependCompressionHeader(UncompressedData.size(), CompressedContents))
+  // Leave sections that compression doesn't make any smaller alone.
+  if (Size <= CompressedContents.size())
     return nullptr;
 
   return CompressedFragment;
@@ -1242,12 +1248,15 @@ static void UpdateSymbols(const MCAsmLayout &Layout,
 static void CompressDebugSection(MCAssembler &Asm, MCAsmLayout &Layout,
                                  const DefiningSymbolMap &DefiningSymbols,
                                  const MCSectionELF &Section,
-                                 MCSectionData &SD) {
+                                 MCSectionData &SD, bool Is64Bit,
+                                 FragmentWriter &FWriter) {
   StringRef SectionName = Section.getSectionName();
   MCSectionData::FragmentListType &Fragments = SD.getFragmentList();
+  DebugCompressionType Type =
+      Asm.getContext().getAsmInfo()->compressDebugSections();
 
   std::unique_ptr<MCDataFragment> CompressedFragment =
-      getCompressedFragment(Layout, Fragments);
+      getCompressedFragment(Type, SD, Is64Bit, FWriter);
 
   // Leave the section as-is if the fragments could not be compressed.
   if (!CompressedFragment)
@@ -1269,14 +1278,24 @@ static void CompressDebugSection(MCAssembler &Asm, MCAsmLayout &Layout,
   CompressedFragment->setLayoutOrder(0);
   Fragments.push_back(CompressedFragment.release());
 
-  // Rename from .debug_* to .zdebug_*
-  Asm.getContext().renameELFSection(&Section,
-                                    (".z" + SectionName.drop_front(1)).str());
+  if (Type == DebugCompressionType::DCT_ZlibGnu) {
+    // Rename from .debug_* to .zdebug_*
+    Asm.getContext().renameELFSection(&Section,
+                                      (".z" + SectionName.drop_front(1)).str());
+    return;
+  }
+
+  const_cast<MCSectionELF &>(Section).setFlags(Section.getFlags() |
+                                               ELF::SHF_COMPRESSED);
+  // The section now starts with the compression header, which needs at least
+  // the alignment of its fields.
+  SD.setAlignment(std::max(SD.getAlignment(), Is64Bit ? 8u : 4u));
 }
 
 void ELFObjectWriter::CompressDebugSections(MCAssembler &Asm,
                                             MCAsmLayout &Layout) {
-  if (!Asm.getContext().getAsmInfo()->compressDebugSections())
+  if (Asm.getContext().getAsmInfo()->compressDebugSections() ==
+      DebugCompressionType::DCT_None)
     return;
 
   DefiningSymbolMap DefiningSymbols;
@@ -1296,7 +1315,8 @@ void ELFObjectWriter::CompressDebugSections(MCAssembler &Asm,
     if (!SectionName.startswith(".debug_") || SectionName == ".debug_frame")
       continue;
 
-    CompressDebugSection(Asm, Layout, DefiningSymbols, Section, SD);
+    CompressDebugSection(Asm, Layout, DefiningSymbols, Section, SD, is64Bit(),
+                         FWriter);
   }
 }
 
@@ -1624,47 +1644,51 @@ void ELFObjectWriter::WriteObject(MCAssembler &Asm,
   for (auto &Pair : SectionIndexMap)
     Sections[Pair.second - 1] = Pair.first;
 
+  // Lay out the file before writing it, so that the header can be written
+  // with its final contents and the stream can reserve the whole object up
+  // front instead of growing and patching it.
   SectionOffsetMapTy SectionOffsetMap;
+  uint64_t Offset = OS.tell() + (is64Bit() ? sizeof(ELF::Elf64_Ehdr)
+                                           : sizeof(ELF::Elf32_Ehdr));
+  for (unsigned i = 0; i < NumSections; ++i) {
+    const MCSectionELF &Section = *Sections[i];
+    const MCSectionData &SD = Asm.getOrCreateSectionData(Section);
+    Offset += OffsetToAlignment(Offset, SD.getAlignment());
+    SectionOffsetMap[&Section] = Offset;
+    Offset += IsELFMetaDataSection(SD) ? DataSectionSize(SD)
+                                       : Layout.getSectionFileSize(&SD);
+  }
+
+  uint64_t NaturalAlignment = is64Bit() ? 8 : 4;
+  const uint64_t SectionHeaderOffset =
+      Offset + OffsetToAlignment(Offset, NaturalAlignment);
+  const uint64_t FileSize =
+      SectionHeaderOffset +
+      (NumSections + 1) *
+          (is64Bit() ? sizeof(ELF::Elf64_Shdr) : sizeof(ELF::Elf32_Shdr));
+  OS.reserveExtraSpace(FileSize - OS.tell());
 
   // Write out the ELF header ...
-  WriteHeader(Asm, NumSections + 1);
+  WriteHeader(Asm, NumSections + 1, SectionHeaderOffset);
 
   // ... then the sections ...
   for (unsigned i = 0; i < NumSections; ++i) {
     const MCSectionELF &Section = *Sections[i];
     const MCSectionData &SD = Asm.getOrCreateSectionData(Section);
-    uint64_t Padding = OffsetToAlignment(OS.tell(), SD.getAlignment());
-    WriteZeros(Padding);
-
-    // Remember the offset into the file for this section.
-    SectionOffsetMap[&Section] = OS.tell();
-
+    uint64_t SectionOffset = SectionOffsetMap.lookup(&Section);
+    assert(OS.tell() <= SectionOffset && "Section does not match its layout!");
+    WriteZeros(SectionOffset - OS.tell());
     writeDataSectionData(Asm, Layout, SD);
   }
 
-  uint64_t NaturalAlignment = is64Bit() ? 8 : 4;
-  uint64_t Padding = OffsetToAlignment(OS.tell(), NaturalAlignment);
-  WriteZeros(Padding);
-
-  const unsigned SectionHeaderOffset = OS.tell();
+  assert(OS.tell() <= SectionHeaderOffset &&
+         "Section does not match its layout!");
+  WriteZeros(SectionHeaderOffset - OS.tell());
 
-  // ... then the section header table ...
+  // ... then the section header table.
   writeSectionHeader(Sections, Asm, GroupMap, Layout, SectionIndexMap,
                      SectionOffsetMap);
-
-  if (is64Bit()) {
-    uint64_t Val = SectionHeaderOffset;
-    if (sys::IsLittleEndianHost != IsLittleEndian)
-      sys::swapByteOrder(Val);
-    OS.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-              offsetof(ELF::Elf64_Ehdr, e_shoff));
-  } else {
-    uint32_t Val = SectionHeaderOffset;
-    if (sys::IsLittleEndianHost != IsLittleEndian)
-      sys::swapByteOrder(Val);
-    OS.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-              offsetof(ELF::Elf32_Ehdr, e_shoff));
-  }
+  assert(OS.tell() == FileSize && "Object size does not match its layout!");
 }
 
 bool ELFObjectWriter::IsSymbolRefDifferenceFullyResolvedImpl(
@@ -54,6 +54,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SkippedRelaxations,
+          "Number of fragments not relaxed again in a layout step");
 }
 }
 
@@ -893,6 +895,144 @@ std::pair<uint64_t, bool> MCAssembler::handleFixup(const MCAsmLayout &Layout,
   return std::make_pair(FixedValue, IsPCRel);
 }
 
+/// The relaxation bookkeeping of a section. The contents of a fragment that
+/// may need relaxing are computed from the offsets of a few fragments, so the
+/// fragment only has to be relaxed again once one of the fragments between
+/// them has changed size.
+struct MCAssembler::RelaxationState {
+  struct Candidate {
+    MCFragment *F;
+    /// The layout orders of the first and last of F and the fragments its
+    /// contents depend on.
+    unsigned Begin, End;
+    /// Whether F depends on fragments of other sections, or on its own
+    /// absolute offset, and has to be relaxed in every iteration.
+    bool Unbounded;
+  };
+
+  struct Section {
+    /// The fragments that may still need relaxing, in layout order.
+    std::vector<Candidate> Candidates;
+    /// The layout orders of the align fragments of the section, which change
+    /// size when the fragments before them do.
+    std::vector<unsigned> AlignOrders;
+    /// The layout orders of the fragments relaxed by the last iteration.
+    std::vector<unsigned> Relaxed;
+    /// Whether every candidate has to be relaxed in the next iteration.
+    bool RelaxAll;
+    /// Whether the section can be relaxed incrementally at all. Org fragments
+    /// and bundle padding depend on absolute offsets.
+    bool Incremental;
+    bool Initialized;
+
+    Section() : RelaxAll(true), Incremental(true), Initialized(false) {}
+  };
+
+  /// The sections, by ordinal.
+  std::vector<Section> Sections;
+
+  static void computeDependencies(const MCAssembler &Asm, Candidate &C);
+  static bool needsRelaxing(const Section &S, const Candidate &C);
+};
+
+/// Extend [Begin, End] to the fragments of \p SD that the value of \p Expr
+/// depends on. Return false if the value depends on anything else.
+static bool addExprDependencies(const MCAssembler &Asm, const MCExpr *Expr,
+                                const MCSectionData &SD, unsigned &Begin,
+                                unsigned &End) {
+  switch (Expr->getKind()) {
+  case MCExpr::Target:
+    return false;
+  case MCExpr::Constant:
+    return true;
+  case MCExpr::Unary:
+    return addExprDependencies(Asm, cast<MCUnaryExpr>(Expr)->getSubExpr(), SD,
+                               Begin, End);
+  case MCExpr::Binary: {
+    const MCBinaryExpr *BE = cast<MCBinaryExpr>(Expr);
+    return addExprDependencies(Asm, BE->getLHS(), SD, Begin, End) &&
+           addExprDependencies(Asm, BE->getRHS(), SD, Begin, End);
+  }
+  case MCExpr::SymbolRef: {
+    const MCSymbol &Sym = cast<MCSymbolRefExpr>(Expr)->getSymbol();
+    if (Sym.isVariable())
+      return addExprDependencies(Asm, Sym.getVariableValue(), SD, Begin, End);
+    if (!Sym.isDefined() || !Asm.hasSymbolData(Sym))
+      return false;
+    const MCFragment *F = Asm.getSymbolData(Sym).getFragment();
+    if (!F || F->getParent() != &SD)
+      return false;
+    Begin = std::min(Begin, F->getLayoutOrder());
+    End = std::max(End, F->getLayoutOrder());
+    return true;
+  }
+  }
+  llvm_unreachable("Invalid assembly expression kind!");
+}
+
+/// Compute the fragments the contents of the fragment of \p C depend on.
+void MCAssembler::RelaxationState::computeDependencies(const MCAssembler &Asm,
+                                                       Candidate &C) {
+  const MCSectionData &SD = *C.F->getParent();
+  C.Begin = C.End = C.F->getLayoutOrder();
+  switch (C.F->getKind()) {
+  default:
+    llvm_unreachable("Unexpected fragment kind");
+  case MCFragment::FT_Relaxable: {
+    const MCRelaxableFragment &RF = *cast<MCRelaxableFragment>(C.F);
+    for (const MCFixup &Fixup : RF.getFixups()) {
+      // The value of the fixup depends on the aligned offset of the fragment.
+      if (Asm.getBackend().getFixupKindInfo(Fixup.getKind()).Flags &
+          MCFixupKindInfo::FKF_IsAlignedDownTo32Bits) {
+        C.Unbounded = true;
+        return;
+      }
+      if (!addExprDependencies(Asm, Fixup.getValue(), SD, C.Begin, C.End)) {
+        C.Unbounded = true;
+        return;
+      }
+    }
+    break;
+  }
+  case MCFragment::FT_Dwarf:
+    C.Unbounded = !addExprDependencies(
+        Asm, &cast<MCDwarfLineAddrFragment>(C.F)->getAddrDelta(), SD, C.Begin,
+        C.End);
+    return;
+  case MCFragment::FT_DwarfFrame:
+    C.Unbounded = !addExprDependencies(
+        Asm, &cast<MCDwarfCallFrameFragment>(C.F)->getAddrDelta(), SD, C.Begin,
+        C.End);
+    return;
+  case MCFragment::FT_LEB:
+    C.Unbounded = !addExprDependencies(
+        Asm, &cast<MCLEBFragment>(C.F)->getValue(), SD, C.Begin, C.End);
+    return;
+  }
+  C.Unbounded = false;
+}
+
+/// Return true if the contents of the fragment of \p C may have changed since
+/// it was last relaxed.
+bool MCAssembler::RelaxationState::needsRelaxing(const Section &S,
+                                                const Candidate &C) {
+  if (S.RelaxAll || C.Unbounded)
+    return true;
+  if (S.Relaxed.empty())
+    return false;
+
+  // A fragment that was relaxed, or that lies between C and one of its
+  // dependencies.
+  auto R = std::lower_bound(S.Relaxed.begin(), S.Relaxed.end(), C.Begin);
+  if (R != S.Relaxed.end() && *R <= C.End)
+    return true;
+
+  // An align fragment after the first relaxed fragment.
+  unsigned First = std::max(C.Begin, S.Relaxed.front() + 1);
+  auto A = std::lower_bound(S.AlignOrders.begin(), S.AlignOrders.end(), First);
+  return A != S.AlignOrders.end() && *A <= C.End;
+}
+
 void MCAssembler::Finish() {
   DEBUG_WITH_TYPE("mc-dump", {
       llvm::errs() << "assembler backend - pre-layout\n--\n";
@@ -924,7 +1064,9 @@ void MCAssembler::Finish() {
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout))
+  RelaxationState State;
+  State.Sections.resize(SectionIndex);
+  while (layoutOnce(Layout, State))
     continue;
 
   DEBUG_WITH_TYPE("mc-dump", {
@@ -1082,41 +1224,84 @@ bool MCAssembler::relaxDwarfCallFrameFragment(MCAsmLayout &Layout,
   return OldSize != Data.size();
 }
 
-bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
+bool MCAssembler::relaxFragment(MCAsmLayout &Layout, MCFragment &F) {
+  switch(F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable:
+    assert(!getRelaxAll() &&
+           "Did not expect a MCRelaxableFragment in RelaxAll mode");
+    return relaxInstruction(Layout, cast<MCRelaxableFragment>(F));
+  case MCFragment::FT_Dwarf:
+    return relaxDwarfLineAddr(Layout, cast<MCDwarfLineAddrFragment>(F));
+  case MCFragment::FT_DwarfFrame:
+    return relaxDwarfCallFrameFragment(Layout,
+                                       cast<MCDwarfCallFrameFragment>(F));
+  case MCFragment::FT_LEB:
+    return relaxLEB(Layout, cast<MCLEBFragment>(F));
+  }
+}
+
+bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                                    RelaxationState &State) {
+  RelaxationState::Section &S = State.Sections[SD.getOrdinal()];
+  if (!S.Initialized) {
+    S.Initialized = true;
+    S.Incremental = !isBundlingEnabled();
+    for (MCSectionData::iterator I = SD.begin(), IE = SD.end(); I != IE; ++I) {
+      switch (I->getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Align:
+        S.AlignOrders.push_back(I->getLayoutOrder());
+        break;
+      case MCFragment::FT_Org:
+        S.Incremental = false;
+        break;
+      case MCFragment::FT_Relaxable:
+      case MCFragment::FT_Dwarf:
+      case MCFragment::FT_DwarfFrame:
+      case MCFragment::FT_LEB:
+        RelaxationState::Candidate C = { I, 0, 0, true };
+        S.Candidates.push_back(C);
+        break;
+      }
+    }
+  }
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
+  std::vector<unsigned> Relaxed;
+
+  // Attempt to relax the fragments of the section that may need it.
+  auto Kept = S.Candidates.begin();
+  for (RelaxationState::Candidate &C : S.Candidates) {
+    if (!RelaxationState::needsRelaxing(S, C)) {
+      ++stats::SkippedRelaxations;
+      *Kept++ = C;
+      continue;
+    }
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSectionData::iterator I = SD.begin(), IE = SD.end(); I != IE; ++I) {
-    // Check if this is a fragment that needs relaxation.
-    bool RelaxedFrag = false;
-    switch(I->getKind()) {
-    default:
-      break;
-    case MCFragment::FT_Relaxable:
-      assert(!getRelaxAll() &&
-             "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
-      break;
-    case MCFragment::FT_Dwarf:
-      RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
-      break;
-    case MCFragment::FT_DwarfFrame:
-      RelaxedFrag =
-        relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
-      break;
-    case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
-      break;
+    if (relaxFragment(Layout, *C.F)) {
+      if (!FirstRelaxedFragment)
+        FirstRelaxedFragment = C.F;
+      Relaxed.push_back(C.F->getLayoutOrder());
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = I;
+
+    // An instruction that can't be relaxed any further is done.
+    if (const auto *RF = dyn_cast<MCRelaxableFragment>(C.F))
+      if (!getBackend().mayNeedRelaxation(RF->getInst()))
+        continue;
+    RelaxationState::computeDependencies(*this, C);
+    *Kept++ = C;
   }
+  S.Candidates.erase(Kept, S.Candidates.end());
+  S.Relaxed = std::move(Relaxed);
+  S.RelaxAll = !S.Incremental;
+
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -1124,13 +1309,13 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
+bool MCAssembler::layoutOnce(MCAsmLayout &Layout, RelaxationState &State) {
   ++stats::RelaxationSteps;
 
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSectionData &SD = *it;
-    while (layoutSectionOnce(Layout, SD))
+    while (layoutSectionOnce(Layout, SD, State))
       WasRelaxed = true;
   }
 
@@ -11,6 +11,7 @@
 #include "llvm/MC/MCELFObjectWriter.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCValue.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 
@@ -31,21 +32,20 @@ bool MCELFObjectTargetWriter::needsRelocateWithSymbol(const MCSymbolData &SD,
 
 // ELF doesn't require relocations to be in any order. We sort by the Offset,
 // just to match gnu as for easier comparison. The use type is an arbitrary way
-// of making the sort deterministic.
-static int cmpRel(const ELFRelocationEntry *AP, const ELFRelocationEntry *BP) {
-  const ELFRelocationEntry &A = *AP;
-  const ELFRelocationEntry &B = *BP;
+// of making the sort deterministic. The sort is stable, so relocations that
+// compare equal keep their relative order in the vector; since ELFObjectWriter
+// emits the vector back to front, they are written in the reverse of the order
+// in which they were recorded.
+static bool compareRelocs(const ELFRelocationEntry &A,
+                          const ELFRelocationEntry &B) {
   if (A.Offset != B.Offset)
-    return B.Offset - A.Offset;
-  if (B.Type != A.Type)
-    return A.Type - B.Type;
-  //llvm_unreachable("ELFRelocs might be unstable!");
-  return 0;
+    return A.Offset > B.Offset;
+  return A.Type < B.Type;
 }
 
 
 void
 MCELFObjectTargetWriter::sortRelocs(const MCAssembler &Asm,
                                     std::vector<ELFRelocationEntry> &Relocs) {
-  array_pod_sort(Relocs.begin(), Relocs.end(), cmpRel);
+  parallel_sort(Relocs.begin(), Relocs.end(), compareRelocs);
 }
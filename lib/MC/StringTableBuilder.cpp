@@ -11,6 +11,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/COFF.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 
@@ -34,7 +35,7 @@ void StringTableBuilder::finalize(Kind kind) {
   for (auto i = StringIndexMap.begin(), e = StringIndexMap.end(); i != e; ++i)
     Strings.push_back(i->getKey());
 
-  std::sort(Strings.begin(), Strings.end(), compareBySuffix);
+  parallel_sort(Strings.begin(), Strings.end(), compareBySuffix);
 
   switch (kind) {
   case ELF:
@@ -13,10 +13,13 @@
 
 #include "llvm/Object/Archive.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 using namespace llvm;
 using namespace object;
@@ -27,6 +30,34 @@ static const char *const ThinMagic = "!<thin>\n";
 
 void Archive::anchor() { }
 
+namespace {
+/// DenseMap traits for the names of the symbol table, which point into it.
+/// The empty and tombstone keys point to addresses no name can have.
+struct SymbolNameInfo {
+  static StringRef getEmptyKey() {
+    return StringRef(reinterpret_cast<const char *>(~uintptr_t(0)), 0);
+  }
+  static StringRef getTombstoneKey() {
+    return StringRef(reinterpret_cast<const char *>(~uintptr_t(1)), 0);
+  }
+  static unsigned getHashValue(StringRef Name) { return hash_value(Name); }
+  static bool isEqual(StringRef LHS, StringRef RHS) {
+    if (RHS.data() == getEmptyKey().data() ||
+        RHS.data() == getTombstoneKey().data())
+      return LHS.data() == RHS.data();
+    return LHS == RHS;
+  }
+};
+}
+
+struct Archive::SymbolIndex {
+  /// The first symbol of each name: that is the one a scan of the table
+  /// finds.
+  DenseMap<StringRef, Symbol, SymbolNameInfo> Symbols;
+};
+
+Archive::~Archive() {}
+
 StringRef ArchiveMemberHeader::getName() const {
   char EndCond;
   if (Name[0] == '/' || Name[0] == '#')
@@ -89,9 +120,11 @@ Archive::Child::Child(const Archive *Parent, const char *Start)
   const ArchiveMemberHeader *Header =
       reinterpret_cast<const ArchiveMemberHeader *>(Start);
   uint64_t Size = sizeof(ArchiveMemberHeader);
-  if (!Parent->IsThin || Header->getName() == "/" || Header->getName() == "//")
-    Size += Header->getSize();
   Data = StringRef(Start, Size);
+  if (!isThinMember()) {
+    Size += Header->getSize();
+    Data = StringRef(Start, Size);
+  }
 
   // Setup StartOfFile and PaddingBytes.
   StartOfFile = sizeof(ArchiveMemberHeader);
@@ -115,6 +148,33 @@ uint64_t Archive::Child::getRawSize() const {
   return getHeader()->getSize();
 }
 
+bool Archive::Child::isThinMember() const {
+  StringRef Name = getHeader()->getName();
+  return Parent->IsThin && Name != "/" && Name != "//";
+}
+
+ErrorOr<StringRef> Archive::Child::getBuffer() const {
+  if (!isThinMember())
+    return StringRef(Data.data() + StartOfFile, getSize());
+  std::unique_ptr<MemoryBuffer> &Cached = Parent->ThinBuffers[Data.data()];
+  if (Cached)
+    return Cached->getBuffer();
+  ErrorOr<StringRef> Name = getName();
+  if (std::error_code EC = Name.getError())
+    return EC;
+  // Relative member paths are relative to the directory of the archive.
+  SmallString<128> FullName;
+  if (sys::path::is_relative(*Name))
+    FullName = sys::path::parent_path(
+        Parent->getMemoryBufferRef().getBufferIdentifier());
+  sys::path::append(FullName, *Name);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(FullName);
+  if (std::error_code EC = Buf.getError())
+    return EC;
+  Cached = std::move(*Buf);
+  return Cached->getBuffer();
+}
+
 Archive::Child Archive::Child::getNext() const {
   size_t SpaceToSkip = Data.size();
   // If it's odd, add 1 to make it even.
@@ -162,10 +222,16 @@ ErrorOr<StringRef> Archive::Child::getName() const {
                    + Parent->StringTable->getSize()))
       return object_error::parse_failed;
 
-    // GNU long file names end with a /.
+    // GNU long file names end with a "/\n". The paths of the members of a
+    // thin archive contain slashes of their own.
     if (Parent->kind() == K_GNU || Parent->kind() == K_MIPS64) {
-      StringRef::size_type End = StringRef(addr).find('/');
-      return StringRef(addr, End);
+      const char *TableEnd = Parent->StringTable->Data.begin() +
+                             sizeof(ArchiveMemberHeader) +
+                             Parent->StringTable->getSize();
+      StringRef::size_type End = StringRef(addr, TableEnd - addr).find('\n');
+      if (End == StringRef::npos || End == 0)
+        return object_error::parse_failed;
+      return StringRef(addr, End - 1);
     }
     return StringRef(addr);
   } else if (name.startswith("#1/")) {
@@ -186,7 +252,10 @@ ErrorOr<MemoryBufferRef> Archive::Child::getMemoryBufferRef() const {
   if (std::error_code EC = NameOrErr.getError())
     return EC;
   StringRef Name = NameOrErr.get();
-  return MemoryBufferRef(getBuffer(), Name);
+  ErrorOr<StringRef> Buf = getBuffer();
+  if (std::error_code EC = Buf.getError())
+    return EC;
+  return MemoryBufferRef(*Buf, Name);
 }
 
 ErrorOr<std::unique_ptr<Binary>>
@@ -352,11 +421,11 @@ Archive::child_iterator Archive::child_end() const {
 }
 
 StringRef Archive::Symbol::getName() const {
-  return Parent->SymbolTable->getBuffer().begin() + StringIndex;
+  return Parent->SymbolTable->getBuffer()->begin() + StringIndex;
 }
 
 ErrorOr<Archive::child_iterator> Archive::Symbol::getMember() const {
-  const char *Buf = Parent->SymbolTable->getBuffer().begin();
+  const char *Buf = Parent->SymbolTable->getBuffer()->begin();
   const char *Offsets = Buf;
   if (Parent->kind() == K_MIPS64)
     Offsets += sizeof(uint64_t);
@@ -420,7 +489,7 @@ Archive::Symbol Archive::Symbol::getNext() const {
     // and the second being the offset into the archive of the member that
     // define the symbol. After that the next uint32_t is the byte count of
     // the string table followed by the string table.
-    const char *Buf = Parent->SymbolTable->getBuffer().begin();
+    const char *Buf = Parent->SymbolTable->getBuffer()->begin();
     uint32_t RanlibCount = 0;
     RanlibCount = read32le(Buf) / 8;
     // If t.SymbolIndex + 1 will be past the count of symbols (the RanlibCount)
@@ -438,7 +507,7 @@ Archive::Symbol Archive::Symbol::getNext() const {
   } else {
     // Go to one past next null.
     t.StringIndex =
-        Parent->SymbolTable->getBuffer().find('\0', t.StringIndex) + 1;
+        Parent->SymbolTable->getBuffer()->find('\0', t.StringIndex) + 1;
   }
   ++t.SymbolIndex;
   return t;
@@ -448,7 +517,7 @@ Archive::symbol_iterator Archive::symbol_begin() const {
   if (!hasSymbolTable())
     return symbol_iterator(Symbol(this, 0, 0));
 
-  const char *buf = SymbolTable->getBuffer().begin();
+  const char *buf = SymbolTable->getBuffer()->begin();
   if (kind() == K_GNU) {
     uint32_t symbol_count = 0;
     symbol_count = read32be(buf);
@@ -480,7 +549,7 @@ Archive::symbol_iterator Archive::symbol_begin() const {
     symbol_count = read32le(buf);
     buf += 4 + (symbol_count * 2); // Skip indices.
   }
-  uint32_t string_start_offset = buf - SymbolTable->getBuffer().begin();
+  uint32_t string_start_offset = buf - SymbolTable->getBuffer()->begin();
   return symbol_iterator(Symbol(this, 0, string_start_offset));
 }
 
@@ -488,7 +557,7 @@ Archive::symbol_iterator Archive::symbol_end() const {
   if (!hasSymbolTable())
     return symbol_iterator(Symbol(this, 0, 0));
 
-  const char *buf = SymbolTable->getBuffer().begin();
+  const char *buf = SymbolTable->getBuffer()->begin();
   uint32_t symbol_count = 0;
   if (kind() == K_GNU) {
     symbol_count = read32be(buf);
@@ -506,20 +575,25 @@ Archive::symbol_iterator Archive::symbol_end() const {
 }
 
 Archive::child_iterator Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-
-  for (; bs != es; ++bs) {
-    StringRef SymName = bs->getName();
-    if (SymName == name) {
-      ErrorOr<Archive::child_iterator> ResultOrErr = bs->getMember();
-      // FIXME: Should we really eat the error?
-      if (ResultOrErr.getError())
-        return child_end();
-      return ResultOrErr.get();
+  {
+    // The index is not changed once it has been built, so only building it
+    // needs the lock.
+    std::lock_guard<std::mutex> Lock(SymIndexMutex);
+    if (!SymIndex) {
+      SymIndex.reset(new SymbolIndex());
+      for (const Symbol &Sym : symbols())
+        SymIndex->Symbols.insert(std::make_pair(Sym.getName(), Sym));
     }
   }
-  return child_end();
+
+  auto I = SymIndex->Symbols.find(name);
+  if (I == SymIndex->Symbols.end())
+    return child_end();
+  ErrorOr<Archive::child_iterator> ResultOrErr = I->second.getMember();
+  // FIXME: Should we really eat the error?
+  if (ResultOrErr.getError())
+    return child_end();
+  return ResultOrErr.get();
 }
 
 bool Archive::hasSymbolTable() const {
@@ -0,0 +1,95 @@
+//===- Decompressor.cpp - Compressed section reader -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/Decompressor.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Errc.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+ErrorOr<Decompressor> Decompressor::create(StringRef Name, StringRef Data,
+                                           bool IsLittleEndian, bool Is64Bit) {
+  if (!zlib::isAvailable())
+    return make_error_code(errc::function_not_supported);
+
+  Decompressor D(Data);
+  std::error_code EC = isGnuStyle(Name)
+                           ? D.consumeCompressedGnuHeader()
+                           : D.consumeCompressedZLibHeader(IsLittleEndian,
+                                                           Is64Bit);
+  if (EC)
+    return EC;
+  return D;
+}
+
+std::error_code Decompressor::consumeCompressedGnuHeader() {
+  if (!SectionData.startswith("ZLIB"))
+    return object_error::parse_failed;
+  SectionData = SectionData.substr(4);
+
+  // Consume uncompressed section size (big-endian 8 bytes).
+  if (SectionData.size() < 8)
+    return object_error::unexpected_eof;
+  DataExtractor Extractor(SectionData, false, 8);
+  uint32_t Offset = 0;
+  DecompressedSize = Extractor.getU64(&Offset);
+  SectionData = SectionData.substr(Offset);
+  return std::error_code();
+}
+
+std::error_code Decompressor::consumeCompressedZLibHeader(bool IsLittleEndian,
+                                                          bool Is64Bit) {
+  uint64_t HdrSize =
+      Is64Bit ? sizeof(ELF::Elf64_Chdr) : sizeof(ELF::Elf32_Chdr);
+  if (SectionData.size() < HdrSize)
+    return object_error::unexpected_eof;
+
+  DataExtractor Extractor(SectionData, IsLittleEndian, 0);
+  uint32_t Offset = 0;
+  if (Extractor.getU32(&Offset) != ELF::ELFCOMPRESS_ZLIB)
+    return object_error::parse_failed;
+
+  // Skip Elf64_Chdr::ch_reserved field.
+  if (Is64Bit)
+    Offset += sizeof(ELF::Elf64_Word);
+
+  DecompressedSize = Is64Bit ? Extractor.getU64(&Offset)
+                             : Extractor.getU32(&Offset);
+  SectionData = SectionData.substr(HdrSize);
+  return std::error_code();
+}
+
+std::error_code Decompressor::decompress(SmallVectorImpl<char> &Out) const {
+  if (zlib::uncompress(SectionData, Out, DecompressedSize) != zlib::StatusOK)
+    return object_error::parse_failed;
+  return std::error_code();
+}
+
+bool Decompressor::isCompressed(const SectionRef &Section) {
+  StringRef Name;
+  if (Section.getName(Name))
+    return false;
+  const auto *Obj = dyn_cast<ELFObjectFileBase>(Section.getObject());
+  return isGnuStyle(Name) ||
+         (Obj && (Obj->getSectionFlags(Section) & ELF::SHF_COMPRESSED));
+}
+
+bool Decompressor::isCompressedELFSection(uint64_t Flags, StringRef Name) {
+  return (Flags & ELF::SHF_COMPRESSED) || isGnuStyle(Name);
+}
+
+bool Decompressor::isGnuStyle(StringRef Name) {
+  return Name.startswith(".zdebug");
+}
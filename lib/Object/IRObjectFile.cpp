@@ -112,6 +112,10 @@ IRObjectFile::IRObjectFile(MemoryBufferRef Object, std::unique_ptr<Module> Mod)
   }
 }
 
+IRObjectFile::IRObjectFile(MemoryBufferRef Object,
+                           std::unique_ptr<BitcodeSymbolTable> Symtab)
+    : SymbolicFile(Binary::ID_IR, Object), Symtab(std::move(Symtab)) {}
+
 IRObjectFile::~IRObjectFile() {
  }
 
@@ -150,6 +154,26 @@ static unsigned getAsmSymIndex(DataRefImpl Symb) {
   return Index;
 }
 
+// The flags getSymbolFlags() would compute from the GlobalValue a bitcode
+// symbol table entry describes.
+static uint32_t getSymbolTableFlags(const BitcodeSymbolTable::Symbol &Sym) {
+  uint32_t Res = BasicSymbolRef::SF_None;
+  if (Sym.isUndefined())
+    Res |= BasicSymbolRef::SF_Undefined;
+  if (GlobalValue::isPrivateLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_FormatSpecific;
+  if (!GlobalValue::isLocalLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Global;
+  if (GlobalValue::isCommonLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Common;
+  if (GlobalValue::isLinkOnceLinkage(Sym.Linkage) ||
+      GlobalValue::isWeakLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Weak;
+  if (Sym.Flags & BitcodeSymbolTable::Symbol::SF_FormatSpecific)
+    Res |= BasicSymbolRef::SF_FormatSpecific;
+  return Res;
+}
+
 void IRObjectFile::moveSymbolNext(DataRefImpl &Symb) const {
   const GlobalValue *GV = getGV(Symb);
   uintptr_t Res;
@@ -175,7 +199,7 @@ void IRObjectFile::moveSymbolNext(DataRefImpl &Symb) const {
   }
   case 3: {
     unsigned Index = getAsmSymIndex(Symb);
-    assert(Index < AsmSymbols.size());
+    assert(Index < (Symtab ? Symtab->Symbols.size() : AsmSymbols.size()));
     ++Index;
     Res = (Index << 2) | 3;
     break;
@@ -191,6 +215,10 @@ std::error_code IRObjectFile::printSymbolName(raw_ostream &OS,
                                               DataRefImpl Symb) const {
   const GlobalValue *GV = getGV(Symb);
   if (!GV) {
+    if (const BitcodeSymbolTable::Symbol *Sym = getSymbolTableEntry(Symb)) {
+      OS << Sym->Name;
+      return object_error::success;
+    }
     unsigned Index = getAsmSymIndex(Symb);
     assert(Index <= AsmSymbols.size());
     OS << AsmSymbols[Index].first;
@@ -209,6 +237,8 @@ uint32_t IRObjectFile::getSymbolFlags(DataRefImpl Symb) const {
   const GlobalValue *GV = getGV(Symb);
 
   if (!GV) {
+    if (const BitcodeSymbolTable::Symbol *Sym = getSymbolTableEntry(Symb))
+      return getSymbolTableFlags(*Sym);
     unsigned Index = getAsmSymIndex(Symb);
     assert(Index <= AsmSymbols.size());
     return AsmSymbols[Index].second;
@@ -238,18 +268,32 @@ uint32_t IRObjectFile::getSymbolFlags(DataRefImpl Symb) const {
 
 GlobalValue *IRObjectFile::getSymbolGV(DataRefImpl Symb) { return getGV(Symb); }
 
+const BitcodeSymbolTable::Symbol *
+IRObjectFile::getSymbolTableEntry(DataRefImpl Symb) const {
+  if (!Symtab)
+    return nullptr;
+  unsigned Index = getAsmSymIndex(Symb);
+  assert(Index < Symtab->Symbols.size());
+  return &Symtab->Symbols[Index];
+}
+
 std::unique_ptr<Module> IRObjectFile::takeModule() { return std::move(M); }
 
 basic_symbol_iterator IRObjectFile::symbol_begin_impl() const {
-  Module::const_iterator I = M->begin();
   DataRefImpl Ret;
-  Ret.p = skipEmpty(I, *M);
+  if (M) {
+    Module::const_iterator I = M->begin();
+    Ret.p = skipEmpty(I, *M);
+  } else
+    // Without a module, the entries of the symbol table are numbered like the
+    // symbols of the module inline asm.
+    Ret.p = 3;
   return basic_symbol_iterator(BasicSymbolRef(Ret, this));
 }
 
 basic_symbol_iterator IRObjectFile::symbol_end_impl() const {
   DataRefImpl Ret;
-  uint64_t NumAsm = AsmSymbols.size();
+  uint64_t NumAsm = Symtab ? Symtab->Symbols.size() : AsmSymbols.size();
   NumAsm <<= 2;
   Ret.p = 3 | NumAsm;
   return basic_symbol_iterator(BasicSymbolRef(Ret, this));
@@ -309,3 +353,20 @@ llvm::object::IRObjectFile::create(MemoryBufferRef Object,
   std::unique_ptr<Module> M(MOrErr.get());
   return llvm::make_unique<IRObjectFile>(Object, std::move(M));
 }
+
+ErrorOr<std::unique_ptr<IRObjectFile>>
+llvm::object::IRObjectFile::createFromSymbolTable(MemoryBufferRef Object,
+                                                  LLVMContext &Context) {
+  ErrorOr<MemoryBufferRef> BCOrErr = findBitcodeInMemBuffer(Object);
+  if (!BCOrErr)
+    return BCOrErr.getError();
+
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>> SymtabOrErr =
+      readBitcodeSymbolTable(BCOrErr.get(), Context);
+  if (std::error_code EC = SymtabOrErr.getError())
+    return EC;
+  if (!SymtabOrErr.get())
+    return create(Object, Context);
+
+  return llvm::make_unique<IRObjectFile>(Object, std::move(SymtabOrErr.get()));
+}
@@ -32,8 +32,10 @@ ErrorOr<std::unique_ptr<SymbolicFile>> SymbolicFile::createSymbolicFile(
 
   switch (Type) {
   case sys::fs::file_magic::bitcode:
+    // Symbolic files are only used to list symbols, so use the bitcode symbol
+    // table instead of parsing the module when there is one.
     if (Context)
-      return IRObjectFile::create(Object, *Context);
+      return IRObjectFile::createFromSymbolTable(Object, *Context);
   // Fallthrough
   case sys::fs::file_magic::unknown:
   case sys::fs::file_magic::archive:
@@ -70,7 +72,7 @@ ErrorOr<std::unique_ptr<SymbolicFile>> SymbolicFile::createSymbolicFile(
     if (!BCData)
       return std::move(Obj);
 
-    return IRObjectFile::create(
+    return IRObjectFile::createFromSymbolTable(
         MemoryBufferRef(BCData->getBuffer(), Object.getBufferIdentifier()),
         *Context);
   }
@@ -17,6 +17,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/OnDiskHashTable.h"
+#include <algorithm>
 
 using namespace llvm;
 
@@ -71,19 +72,33 @@ public:
 };
 }
 
+/// Multiplies \p Count by \p Weight. Returns false on overflow.
+static bool scaleCount(uint64_t Count, uint64_t Weight, uint64_t &Result) {
+  if (Weight != 1 && Count > UINT64_MAX / Weight)
+    return false;
+  Result = Count * Weight;
+  return true;
+}
+
 std::error_code
 InstrProfWriter::addFunctionCounts(StringRef FunctionName,
                                    uint64_t FunctionHash,
-                                   ArrayRef<uint64_t> Counters) {
+                                   ArrayRef<uint64_t> Counters,
+                                   uint64_t Weight) {
+  assert(Weight != 0 && "Weight must be positive");
   auto &CounterData = FunctionData[FunctionName];
 
   auto Where = CounterData.find(FunctionHash);
   if (Where == CounterData.end()) {
     // We've never seen a function with this name and hash, add it.
-    CounterData[FunctionHash] = Counters;
+    std::vector<uint64_t> Scaled(Counters.size());
+    for (size_t I = 0, E = Counters.size(); I < E; ++I)
+      if (!scaleCount(Counters[I], Weight, Scaled[I]))
+        return instrprof_error::counter_overflow;
     // We keep track of the max function count as we go for simplicity.
-    if (Counters[0] > MaxFunctionCount)
-      MaxFunctionCount = Counters[0];
+    if (Scaled[0] > MaxFunctionCount)
+      MaxFunctionCount = Scaled[0];
+    CounterData[FunctionHash] = std::move(Scaled);
     return instrprof_error::success;
   }
 
@@ -95,9 +110,11 @@ InstrProfWriter::addFunctionCounts(StringRef FunctionName,
     return instrprof_error::count_mismatch;
 
   for (size_t I = 0, E = Counters.size(); I < E; ++I) {
-    if (FoundCounters[I] + Counters[I] < FoundCounters[I])
+    uint64_t Count;
+    if (!scaleCount(Counters[I], Weight, Count) ||
+        FoundCounters[I] + Count < FoundCounters[I])
       return instrprof_error::counter_overflow;
-    FoundCounters[I] += Counters[I];
+    FoundCounters[I] += Count;
   }
   // We keep track of the max function count as we go for simplicity.
   if (FoundCounters[0] > MaxFunctionCount)
@@ -106,12 +123,43 @@ InstrProfWriter::addFunctionCounts(StringRef FunctionName,
   return instrprof_error::success;
 }
 
+void InstrProfWriter::mergeRecordsFromWriter(
+    InstrProfWriter &&IPW,
+    function_ref<void(StringRef, std::error_code)> Warn) {
+  for (auto &I : IPW.FunctionData) {
+    auto Inserted = FunctionData.insert(
+        std::make_pair(I.getKey(), CounterData()));
+    if (Inserted.second) {
+      // A function we have not seen: take its counts as they are.
+      Inserted.first->getValue() = std::move(I.getValue());
+      continue;
+    }
+    for (auto &Counts : I.getValue())
+      if (std::error_code EC =
+              addFunctionCounts(I.getKey(), Counts.first, Counts.second))
+        Warn(I.getKey(), EC);
+  }
+  if (IPW.MaxFunctionCount > MaxFunctionCount)
+    MaxFunctionCount = IPW.MaxFunctionCount;
+}
+
 std::pair<uint64_t, uint64_t> InstrProfWriter::writeImpl(raw_ostream &OS) {
   OnDiskChainedHashTableGenerator<InstrProfRecordTrait> Generator;
 
-  // Populate the hash table generator.
+  // Populate the hash table generator. Functions that end up in the same
+  // bucket are emitted in insertion order, so insert them in name order to
+  // keep the output independent of how the profiles were accumulated.
+  std::vector<const StringMapEntry<CounterData> *> Functions;
+  Functions.reserve(FunctionData.size());
   for (const auto &I : FunctionData)
-    Generator.insert(I.getKey(), &I.getValue());
+    Functions.push_back(&I);
+  std::sort(Functions.begin(), Functions.end(),
+            [](const StringMapEntry<CounterData> *A,
+               const StringMapEntry<CounterData> *B) {
+              return A->getKey() < B->getKey();
+            });
+  for (const auto *I : Functions)
+    Generator.insert(I->getKey(), &I->getValue());
 
   using namespace llvm::support;
   endian::Writer<little> LE(OS);
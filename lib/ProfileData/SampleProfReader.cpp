@@ -119,8 +119,8 @@ void FunctionSamples::print(raw_ostream &OS) {
        << ", number of samples: " << Sample.getSamples();
     if (Sample.hasCalls()) {
       OS << ", calls:";
-      for (const auto &I : Sample.getCallTargets())
-        OS << " " << I.first() << ":" << I.second;
+      for (const auto &I : Sample.getSortedCallTargets())
+        OS << " " << I.first << ":" << I.second;
     }
     OS << "\n";
   }
@@ -137,10 +137,15 @@ void SampleProfileReader::dumpFunctionProfile(StringRef FName,
   Profiles[FName].print(OS);
 }
 
-/// \brief Dump all the function profiles found on stream \p OS.
+/// \brief Dump all the function profiles found on stream \p OS, sorted by
+/// function name.
 void SampleProfileReader::dump(raw_ostream &OS) {
+  std::vector<StringRef> Names;
   for (const auto &I : Profiles)
-    dumpFunctionProfile(I.getKey(), OS);
+    Names.push_back(I.getKey());
+  std::sort(Names.begin(), Names.end());
+  for (StringRef Name : Names)
+    dumpFunctionProfile(Name, OS);
 }
 
 /// \brief Load samples from a text file.
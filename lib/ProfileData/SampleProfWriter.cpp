@@ -47,8 +47,8 @@ bool SampleProfileWriterText::write(StringRef FName, const FunctionSamples &S) {
 
     OS << Sample.getSamples();
 
-    for (const auto &J : Sample.getCallTargets())
-      OS << " " << J.first() << ":" << J.second;
+    for (const auto &J : Sample.getSortedCallTargets())
+      OS << " " << J.first << ":" << J.second;
     OS << "\n";
   }
 
@@ -86,8 +86,8 @@ bool SampleProfileWriterBinary::write(StringRef FName,
     encodeULEB128(Loc.Discriminator, OS);
     encodeULEB128(Sample.getSamples(), OS);
     encodeULEB128(Sample.getCallTargets().size(), OS);
-    for (const auto &J : Sample.getCallTargets()) {
-      std::string Callee = J.first();
+    for (const auto &J : Sample.getSortedCallTargets()) {
+      std::string Callee = J.first;
       unsigned CalleeSamples = J.second;
       OS << Callee;
       encodeULEB128(0, OS);
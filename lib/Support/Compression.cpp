@@ -17,6 +17,7 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Parallel.h"
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -80,6 +81,151 @@ uint32_t zlib::crc32(StringRef Buffer) {
   return ::crc32(0, (const Bytef *)Buffer.data(), Buffer.size());
 }
 
+/// The number of chunks the ChunkedCompressor buffers and compresses at once.
+static const size_t ChunksPerBatch = 16;
+
+/// The size of the deflate window, which is as far back as a chunk can refer
+/// to the chunk before it.
+static const size_t WindowSize = 1 << MAX_WBITS;
+
+namespace {
+struct CompressedChunk {
+  SmallVector<char, 0> Data;
+  uLong Checksum;
+  zlib::Status Status;
+};
+}
+
+/// Deflate \p Input as a part of a raw deflate stream that continues after
+/// \p Dictionary. Unless this is the \p Final part, the output ends with an
+/// empty stored block that aligns it to a byte boundary without ending the
+/// stream, so that the next part can simply be appended to it.
+static void deflateChunk(StringRef Dictionary, StringRef Input, int Level,
+                         bool Final, CompressedChunk &Chunk) {
+  Chunk.Checksum =
+      ::adler32(::adler32(0, Z_NULL, 0), (const Bytef *)Input.data(),
+                Input.size());
+
+  z_stream Stream;
+  Stream.zalloc = Z_NULL;
+  Stream.zfree = Z_NULL;
+  Stream.opaque = Z_NULL;
+  int Res = ::deflateInit2(&Stream, Level, Z_DEFLATED, -MAX_WBITS, 8,
+                           Z_DEFAULT_STRATEGY);
+  if (Res == Z_OK && !Dictionary.empty())
+    Res = ::deflateSetDictionary(&Stream, (const Bytef *)Dictionary.data(),
+                                 Dictionary.size());
+  if (Res != Z_OK) {
+    Chunk.Status = encodeZlibReturnValue(Res);
+    return;
+  }
+
+  Stream.next_in = (Bytef *)Input.data();
+  Stream.avail_in = Input.size();
+  int Flush = Final ? Z_FINISH : Z_SYNC_FLUSH;
+  SmallVectorImpl<char> &Out = Chunk.Data;
+  // The stored block of a sync flush may not fit in the bound.
+  Out.resize(::deflateBound(&Stream, Input.size()) + 8);
+  size_t Size = 0;
+  do {
+    if (Size == Out.size())
+      Out.resize(Out.size() * 2);
+    Stream.next_out = (Bytef *)Out.data() + Size;
+    Stream.avail_out = Out.size() - Size;
+    Res = ::deflate(&Stream, Flush);
+    Size = Out.size() - Stream.avail_out;
+  } while (Res == Z_OK && Stream.avail_out == 0);
+  ::deflateEnd(&Stream);
+
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  __msan_unpoison(Out.data(), Size);
+  Out.resize(Size);
+  Chunk.Status =
+      Res == Z_STREAM_END ? zlib::StatusOK : encodeZlibReturnValue(Res);
+}
+
+zlib::ChunkedCompressor::ChunkedCompressor(
+    SmallVectorImpl<char> &CompressedBuffer, CompressionLevel Level,
+    size_t ChunkSize)
+    : Out(CompressedBuffer), Level(Level), ChunkSize(ChunkSize),
+      DictionarySize(0), Checksum(::adler32(0, Z_NULL, 0)),
+      UncompressedSize(0), Result(StatusOK) {
+  assert(ChunkSize && "Chunks can't be empty");
+
+  // The zlib header: deflate with a 32K window, the compression level, and a
+  // check of the header.
+  int CLevel = encodeZlibCompressionLevel(Level);
+  unsigned LevelFlags;
+  if (CLevel == Z_DEFAULT_COMPRESSION || CLevel == 6)
+    LevelFlags = 2;
+  else if (CLevel < 2)
+    LevelFlags = 0;
+  else if (CLevel < 6)
+    LevelFlags = 1;
+  else
+    LevelFlags = 3;
+  unsigned Header = (Z_DEFLATED | (MAX_WBITS - 8) << 4) << 8 | LevelFlags << 6;
+  Header += 31 - Header % 31;
+  Out.push_back(Header >> 8);
+  Out.push_back(Header & 0xff);
+}
+
+void zlib::ChunkedCompressor::write(StringRef Data) {
+  UncompressedSize += Data.size();
+  size_t BatchSize = ChunkSize * ChunksPerBatch;
+  while (!Data.empty()) {
+    size_t N =
+        std::min(Data.size(), DictionarySize + BatchSize - Buffer.size());
+    Buffer.insert(Buffer.end(), Data.begin(), Data.begin() + N);
+    Data = Data.drop_front(N);
+    if (Buffer.size() - DictionarySize == BatchSize)
+      compressPending(/*Final=*/false);
+  }
+}
+
+void zlib::ChunkedCompressor::compressPending(bool Final) {
+  size_t Size = Buffer.size() - DictionarySize;
+  if (!Size && !Final)
+    return;
+
+  // Chunks start at multiples of ChunkSize in the stream, however the data
+  // was written, so that the output doesn't depend on it.
+  size_t NumChunks = std::max<size_t>(1, (Size + ChunkSize - 1) / ChunkSize);
+  std::vector<CompressedChunk> Chunks(NumChunks);
+  int CLevel = encodeZlibCompressionLevel(Level);
+  parallel_for_each_task<size_t>(0, NumChunks, [&](size_t I) {
+    size_t Begin = DictionarySize + I * ChunkSize;
+    size_t End = std::min(Begin + ChunkSize, Buffer.size());
+    size_t DictionaryBegin = Begin - std::min(Begin, WindowSize);
+    deflateChunk(StringRef(Buffer.data() + DictionaryBegin,
+                           Begin - DictionaryBegin),
+                 StringRef(Buffer.data() + Begin, End - Begin), CLevel,
+                 Final && I == NumChunks - 1, Chunks[I]);
+  });
+
+  for (size_t I = 0; I != NumChunks; ++I) {
+    const CompressedChunk &Chunk = Chunks[I];
+    if (Result == StatusOK)
+      Result = Chunk.Status;
+    Out.append(Chunk.Data.begin(), Chunk.Data.end());
+    size_t Length = std::min(ChunkSize, Size - I * ChunkSize);
+    Checksum = ::adler32_combine(Checksum, Chunk.Checksum, Length);
+  }
+
+  size_t Keep = std::min(WindowSize, Buffer.size());
+  Buffer.erase(Buffer.begin(), Buffer.end() - Keep);
+  DictionarySize = Keep;
+}
+
+zlib::Status zlib::ChunkedCompressor::finish() {
+  compressPending(/*Final=*/true);
+  // The zlib trailer: the big-endian Adler-32 checksum of the data.
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    Out.push_back((Checksum >> Shift) & 0xff);
+  Buffer.clear();
+  return Result;
+}
+
 #else
 bool zlib::isAvailable() { return false; }
 zlib::Status zlib::compress(StringRef InputBuffer,
@@ -95,5 +241,18 @@ zlib::Status zlib::uncompress(StringRef InputBuffer,
 uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
+zlib::ChunkedCompressor::ChunkedCompressor(
+    SmallVectorImpl<char> &CompressedBuffer, CompressionLevel Level,
+    size_t ChunkSize)
+    : Out(CompressedBuffer), Level(Level), ChunkSize(ChunkSize),
+      DictionarySize(0), Checksum(0), UncompressedSize(0),
+      Result(StatusUnsupported) {}
+void zlib::ChunkedCompressor::write(StringRef Data) {
+  UncompressedSize += Data.size();
+}
+void zlib::ChunkedCompressor::compressPending(bool Final) {}
+zlib::Status zlib::ChunkedCompressor::finish() {
+  return zlib::StatusUnsupported;
+}
 #endif
 
@@ -15,6 +15,8 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Errc.h"
+#include <algorithm>
+#include <cstring>
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -109,4 +111,116 @@ std::error_code FileOutputBuffer::commit() {
   // Rename file to final name.
   return sys::fs::rename(Twine(TempPath), Twine(FinalPath));
 }
+
+raw_mapped_file_ostream::raw_mapped_file_ostream(StringRef Path,
+                                                 unsigned Flags)
+    : Path(Path), Flags(Flags) {
+  resetBuffer();
+}
+
+raw_mapped_file_ostream::~raw_mapped_file_ostream() {
+  // Flush into the mapped file or Tail; the file itself is only written by
+  // commit(), and Buffer discards it otherwise.
+  flush();
+}
+
+void raw_mapped_file_ostream::resetBuffer() {
+  if (Buffer && MappedSize < Buffer->getBufferSize()) {
+    SetBuffer((char *)Buffer->getBufferStart() + MappedSize,
+              Buffer->getBufferSize() - MappedSize);
+    return;
+  }
+  // Like raw_svector_ostream, keep some room at the end of Tail so that
+  // small writes go straight into it.
+  Tail.reserve(Tail.size() + 64);
+  SetBuffer(Tail.end(), Tail.capacity() - Tail.size());
+}
+
+void raw_mapped_file_ostream::reserveExtraSpace(uint64_t ExtraSize) {
+  if (Buffer)
+    return;
+  flush();
+  assert(MappedSize == 0);
+  if (Tail.size() + ExtraSize == 0 ||
+      FileOutputBuffer::create(Path, Tail.size() + ExtraSize, Buffer, Flags))
+    return;
+
+  // Move what has been written so far into the file.
+  memcpy(Buffer->getBufferStart(), Tail.data(), Tail.size());
+  MappedSize = Tail.size();
+  Tail.clear();
+  resetBuffer();
+}
+
+void raw_mapped_file_ostream::write_impl(const char *Ptr, size_t Size) {
+  char *MappedEnd =
+      Buffer ? (char *)Buffer->getBufferStart() + MappedSize : nullptr;
+  if (Ptr == MappedEnd) {
+    // The data was written in place into the mapped file.
+    MappedSize += Size;
+    assert(MappedSize <= Buffer->getBufferSize() && "Invalid write_impl()!");
+  } else if (Ptr == Tail.end()) {
+    // The data was written in place at the end of Tail.
+    assert(Tail.size() + Size <= Tail.capacity() && "Invalid write_impl()!");
+    Tail.set_size(Tail.size() + Size);
+  } else {
+    assert(!GetNumBytesInBuffer());
+    size_t N = 0;
+    if (Buffer) {
+      N = std::min<uint64_t>(Size, Buffer->getBufferSize() - MappedSize);
+      memcpy(MappedEnd, Ptr, N);
+      MappedSize += N;
+    }
+    Tail.append(Ptr + N, Ptr + Size);
+  }
+  resetBuffer();
+}
+
+void raw_mapped_file_ostream::pwrite_impl(const char *Ptr, size_t Size,
+                                          uint64_t Offset) {
+  flush();
+  size_t N = 0;
+  if (Offset < MappedSize) {
+    N = std::min<uint64_t>(Size, MappedSize - Offset);
+    memcpy(Buffer->getBufferStart() + Offset, Ptr, N);
+  }
+  if (N < Size)
+    memcpy(Tail.data() + (Offset + N - MappedSize), Ptr + N, Size - N);
+}
+
+std::error_code raw_mapped_file_ostream::commit() {
+  flush();
+  uint64_t Size = MappedSize + Tail.size();
+  if (!Buffer || !Tail.empty() || MappedSize != Buffer->getBufferSize()) {
+    // The reservation was missing or did not match the output, so copy the
+    // output into a file of the right size.
+    std::unique_ptr<FileOutputBuffer> Exact;
+    if (std::error_code EC = FileOutputBuffer::create(Path, Size, Exact, Flags))
+      return EC;
+    if (Buffer)
+      memcpy(Exact->getBufferStart(), Buffer->getBufferStart(), MappedSize);
+    memcpy(Exact->getBufferStart() + MappedSize, Tail.data(), Tail.size());
+    Buffer = std::move(Exact);
+  }
+  std::error_code EC = Buffer->commit();
+
+  // Any later output goes to Tail and is dropped.
+  Buffer.reset();
+  MappedSize = 0;
+  Tail.clear();
+  resetBuffer();
+  return EC;
+}
+
+bool raw_mapped_file_ostream::isMappable(StringRef Path) {
+  // FileOutputBuffer renames a new file over Path, which would replace a
+  // symlink instead of writing through it.
+  bool IsLink;
+  if (!sys::fs::is_symlink(Path, IsLink) && IsLink)
+    return false;
+  sys::fs::file_status Stat;
+  sys::fs::status(Path, Stat);
+  return Stat.type() == sys::fs::file_type::file_not_found ||
+         Stat.type() == sys::fs::file_type::regular_file;
+}
 } // namespace
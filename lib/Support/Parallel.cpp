@@ -0,0 +1,92 @@
+//===- llvm/Support/Parallel.cpp - Parallel algorithms --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "llvm/Config/llvm-config.h"
+
+#if LLVM_ENABLE_THREADS
+
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+using namespace llvm;
+
+/// The pool shared by all parallel algorithms. It is only created the first
+/// time some work is actually distributed.
+static ManagedStatic<ThreadPool> DefaultPool;
+
+namespace {
+/// The state shared between the threads taking part in a parallel_for_tasks
+/// call. Pool threads may only get to run after the call has returned, so the
+/// state is reference counted; such late threads find no task left to claim
+/// and never touch Fn.
+struct TaskGroup {
+  TaskGroup(size_t NumTasks, function_ref<void(size_t)> Fn)
+      : NumTasks(NumTasks), Fn(Fn), NextTask(0), Pending(NumTasks) {}
+
+  const size_t NumTasks;
+  function_ref<void(size_t)> Fn;
+  std::atomic<size_t> NextTask;
+  size_t Pending;
+  std::mutex Lock;
+  std::condition_variable Done;
+
+  /// Claims and runs tasks until none is left.
+  void run() {
+    size_t Completed = 0;
+    for (size_t I = NextTask++; I < NumTasks; I = NextTask++) {
+      Fn(I);
+      ++Completed;
+    }
+    if (!Completed)
+      return;
+    std::lock_guard<std::mutex> Guard(Lock);
+    Pending -= Completed;
+    if (!Pending)
+      Done.notify_all();
+  }
+};
+}
+
+void llvm::detail::parallel_for_tasks(size_t NumTasks,
+                                      function_ref<void(size_t)> Fn) {
+  if (NumTasks <= 1) {
+    if (NumTasks)
+      Fn(0);
+    return;
+  }
+
+  auto Group = std::make_shared<TaskGroup>(NumTasks, Fn);
+  size_t NumHelpers =
+      std::min<size_t>(NumTasks - 1, DefaultPool->getThreadCount());
+  for (size_t I = 0; I != NumHelpers; ++I)
+    DefaultPool->async([Group] { Group->run(); });
+
+  // Work on the tasks instead of waiting for the pool, which may be busy with
+  // the enclosing parallel algorithm if this call is nested.
+  Group->run();
+  std::unique_lock<std::mutex> Guard(Group->Lock);
+  Group->Done.wait(Guard, [&] { return Group->Pending == 0; });
+}
+
+#else // !LLVM_ENABLE_THREADS
+
+using namespace llvm;
+
+void llvm::detail::parallel_for_tasks(size_t NumTasks,
+                                      function_ref<void(size_t)> Fn) {
+  for (size_t I = 0; I != NumTasks; ++I)
+    Fn(I);
+}
+
+#endif
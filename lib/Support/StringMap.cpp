@@ -12,11 +12,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/StringMap.h"
-#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Compiler.h"
 #include <cassert>
 using namespace llvm;
 
+/// Compute the hash of a key. Only the low bits of the hash select a bucket;
+/// the Bernstein hash mixes them poorly for keys that share long prefixes and
+/// suffixes, such as mangled symbol names, which leads to long probe
+/// sequences. hash_combine_range costs a bit more per key but avoids them.
+static inline unsigned hashKey(StringRef Key) {
+  return static_cast<unsigned>(
+      static_cast<size_t>(hash_combine_range(Key.begin(), Key.end())));
+}
+
 StringMapImpl::StringMapImpl(unsigned InitSize, unsigned itemSize) {
   ItemSize = itemSize;
   
@@ -61,7 +70,7 @@ unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
     init(16);
     HTSize = NumBuckets;
   }
-  unsigned FullHashValue = HashString(Name);
+  unsigned FullHashValue = hashKey(Name);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
@@ -116,7 +125,7 @@ unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
 int StringMapImpl::FindKey(StringRef Key) const {
   unsigned HTSize = NumBuckets;
   if (HTSize == 0) return -1;  // Really empty table?
-  unsigned FullHashValue = HashString(Key);
+  unsigned FullHashValue = hashKey(Key);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
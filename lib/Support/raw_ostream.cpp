@@ -814,6 +814,12 @@ void raw_svector_ostream::write_impl(const char *Ptr, size_t Size) {
   SetBuffer(OS.end(), OS.capacity() - OS.size());
 }
 
+void raw_svector_ostream::reserveExtraSpace(uint64_t ExtraSize) {
+  flush();
+  OS.reserve(OS.size() + ExtraSize);
+  SetBuffer(OS.end(), OS.capacity() - OS.size());
+}
+
 uint64_t raw_svector_ostream::current_pos() const {
    return OS.size();
 }
@@ -0,0 +1,340 @@
+//===- FunctionImport.cpp - Summary-based function importing --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the FunctionImporter class and the -function-import
+// pass, which imports functions of other modules into a module according to a
+// combined function summary index.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionImport.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "function-import"
+
+static cl::opt<unsigned> ImportInstrLimit(
+    "import-instr-limit", cl::init(100), cl::Hidden,
+    cl::desc("Only import functions with at most this many instructions"));
+
+static cl::opt<std::string>
+    SummaryFile("summary-file", cl::value_desc("filename"),
+                cl::desc("The combined function summary index to import "
+                         "functions with"));
+
+/// Each level of a chain of calls lowers the instruction limit of the
+/// functions imported at the next level by this factor, so that imports
+/// stay close to the module.
+static const float ImportInstrEvolutionFactor = 0.7f;
+
+static ErrorOr<std::unique_ptr<Module>> loadBitcodeFile(StringRef Path,
+                                                        LLVMContext &Context) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(Path);
+  if (std::error_code EC = BufferOrErr.getError())
+    return EC;
+  ErrorOr<Module *> MOrErr =
+      getLazyBitcodeModule(std::move(*BufferOrErr), Context);
+  if (std::error_code EC = MOrErr.getError())
+    return EC;
+  return std::unique_ptr<Module>(*MOrErr);
+}
+
+FunctionImporter::FunctionImporter(const FunctionInfoIndex &Index,
+                                   ModuleLoaderTy ModuleLoader,
+                                   DiagnosticHandlerFunction DiagnosticHandler)
+    : Index(Index),
+      ModuleLoader(ModuleLoader ? std::move(ModuleLoader)
+                                : ModuleLoaderTy(loadBitcodeFile)),
+      DiagnosticHandler(std::move(DiagnosticHandler)) {}
+
+void FunctionImporter::computeImportList(const Module &M,
+                                         const FunctionInfoIndex &Index,
+                                         unsigned InstLimit,
+                                         ImportListTy &ImportList) {
+  // The functions M defines, and those selected for import, are never
+  // imported (again).
+  StringSet<> Defined;
+  for (const Function &F : M)
+    if (!F.isDeclaration())
+      Defined.insert(F.getName());
+
+  // Start with the functions M declares and uses, then follow the call edges
+  // of the summaries of the imported ones.
+  std::vector<std::pair<std::string, unsigned>> Worklist;
+  for (const Function &F : M)
+    if (F.isDeclaration() && !F.isIntrinsic() && !F.use_empty())
+      Worklist.push_back(std::make_pair(F.getName().str(), InstLimit));
+
+  while (!Worklist.empty()) {
+    std::string Name = std::move(Worklist.back().first);
+    unsigned Limit = Worklist.back().second;
+    Worklist.pop_back();
+
+    if (Defined.count(Name))
+      continue;
+    const FunctionInfoIndex::Entry *E = Index.findFunction(Name);
+    if (!E)
+      continue;
+    const FunctionSummary &Summary = E->Summary;
+    if (!Summary.isImportable() || Summary.isCold() ||
+        Summary.InstCount > Limit)
+      continue;
+    if (Index.getModulePath(E->ModuleId) == M.getModuleIdentifier())
+      continue;
+
+    DEBUG(dbgs() << "Importing " << Name << " (" << Summary.InstCount
+                 << " instructions) from "
+                 << Index.getModulePath(E->ModuleId) << "\n");
+    ImportList[Index.getModulePath(E->ModuleId)].push_back(Name);
+    Defined.insert(Name);
+
+    unsigned CalleeLimit = Limit * ImportInstrEvolutionFactor;
+    for (const auto &Call : Summary.Calls)
+      Worklist.push_back(std::make_pair(Call.first, CalleeLimit));
+  }
+}
+
+/// Turn \p Src, which the linker will then link into a module with
+/// Linker::LinkOnlyNeeded, into a module whose only definitions are the
+/// functions of \p Names that the module declares. They are materialized,
+/// and everything else \p Src defines becomes a declaration, so that the
+/// imported functions refer to the original definitions.
+static std::error_code prepareImportSource(Module &Src,
+                                           const StringSet<> &Names) {
+  for (Function &F : Src) {
+    if (F.isDeclaration())
+      continue;
+    if (!Names.count(F.getName())) {
+      F.deleteBody();
+      F.setComdat(nullptr);
+      continue;
+    }
+    if (std::error_code EC = F.materialize())
+      return EC;
+    // The imported function may end up alone in a comdat group of the
+    // importing module, which would not define the other members.
+    F.setComdat(nullptr);
+  }
+
+  for (auto I = Src.global_begin(), E = Src.global_end(); I != E;) {
+    GlobalVariable &GV = *I++;
+    // Appending variables are always linked; their entries belong to the
+    // source module.
+    if (GV.hasAppendingLinkage()) {
+      GV.eraseFromParent();
+      continue;
+    }
+    if (GV.isDeclaration())
+      continue;
+    GV.setInitializer(nullptr);
+    GV.setLinkage(GlobalValue::ExternalLinkage);
+    GV.setComdat(nullptr);
+  }
+
+  // Imported functions don't refer to aliases, but anything else may.
+  for (auto I = Src.alias_begin(), E = Src.alias_end(); I != E;) {
+    GlobalAlias &GA = *I++;
+    Type *Ty = GA.getType()->getElementType();
+    GlobalValue *Decl;
+    if (FunctionType *FTy = dyn_cast<FunctionType>(Ty))
+      Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &Src);
+    else
+      Decl = new GlobalVariable(Src, Ty, false, GlobalValue::ExternalLinkage,
+                                nullptr);
+    Decl->takeName(&GA);
+    GA.replaceAllUsesWith(ConstantExpr::getBitCast(Decl, GA.getType()));
+    GA.eraseFromParent();
+  }
+
+  // Named metadata would be linked as well. Only module flags have to agree
+  // between the modules.
+  for (auto I = Src.named_metadata_begin(), E = Src.named_metadata_end();
+       I != E;) {
+    NamedMDNode &NMD = *I++;
+    if (NMD.getName() != "llvm.module.flags")
+      NMD.eraseFromParent();
+  }
+
+  Src.setModuleInlineAsm("");
+  return std::error_code();
+}
+
+bool FunctionImporter::importFunctions(Module &M,
+                                       const ImportListTy &ImportList,
+                                       std::string &ErrMsg) {
+  // A function is imported once M declares it, which for functions that only
+  // imported functions call happens when importing those. Keep visiting the
+  // source modules until no more declarations can be satisfied.
+  StringMap<StringSet<>> Pending;
+  for (const auto &I : ImportList)
+    for (const std::string &Name : I.second)
+      Pending[I.first()].insert(Name);
+
+  DiagnosticHandlerFunction Handler = DiagnosticHandler;
+  if (!Handler)
+    Handler = [&M](const DiagnosticInfo &DI) { M.getContext().diagnose(DI); };
+  Linker L(&M, Handler);
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto &I : Pending) {
+      StringSet<> Names;
+      for (const auto &N : I.second) {
+        Function *F = M.getFunction(N.first());
+        if (F && F->isDeclaration())
+          Names.insert(N.first());
+      }
+      if (Names.empty())
+        continue;
+      for (const auto &N : Names)
+        I.second.erase(N.first());
+
+      ErrorOr<std::unique_ptr<Module>> SrcOrErr =
+          ModuleLoader(I.first(), M.getContext());
+      if (std::error_code EC = SrcOrErr.getError()) {
+        ErrMsg = "error loading file '" + I.first().str() + "': " +
+                 EC.message();
+        return true;
+      }
+      std::unique_ptr<Module> Src = std::move(*SrcOrErr);
+      if (std::error_code EC = prepareImportSource(*Src, Names)) {
+        ErrMsg = "error materializing functions of '" + I.first().str() +
+                 "': " + EC.message();
+        return true;
+      }
+      if (L.linkInModule(Src.get(), Linker::LinkOnlyNeeded)) {
+        ErrMsg = "error linking in functions of '" + I.first().str() + "'";
+        return true;
+      }
+
+      // Import the definitions without emitting them. A linkonce_odr
+      // function may have been dropped by its own module, so M keeps a copy.
+      for (const auto &N : Names) {
+        Function *F = M.getFunction(N.first());
+        if (F && !F->isDeclaration() && !F->hasLinkOnceODRLinkage())
+          F->setLinkage(GlobalValue::AvailableExternallyLinkage);
+      }
+      Changed = true;
+    }
+  }
+  return false;
+}
+
+bool FunctionImporter::importFunctions(Module &M, unsigned InstLimit,
+                                       std::string &ErrMsg) {
+  ImportListTy ImportList;
+  computeImportList(M, Index, InstLimit, ImportList);
+  return importFunctions(M, ImportList, ErrMsg);
+}
+
+namespace {
+/// Pass that imports functions into the module according to the combined
+/// summary index given to it, or read from -summary-file.
+class FunctionImportPass : public ModulePass {
+  const FunctionInfoIndex *Index;
+  /// Where to store errors, or null if they are fatal.
+  std::string *ErrMsg;
+
+  /// Report \p Msg to the creator of the pass, or abort.
+  bool error(const Twine &Msg) {
+    if (!ErrMsg)
+      report_fatal_error(Msg);
+    *ErrMsg = Msg.str();
+    return false;
+  }
+
+public:
+  static char ID; // Pass identification, replacement for typeid
+  explicit FunctionImportPass(const FunctionInfoIndex *Index = nullptr,
+                              std::string *ErrMsg = nullptr)
+      : ModulePass(ID), Index(Index), ErrMsg(ErrMsg) {
+    initializeFunctionImportPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override {
+    const FunctionInfoIndex *CombinedIndex = Index;
+    std::unique_ptr<FunctionInfoIndex> IndexPtr;
+    if (!CombinedIndex) {
+      if (SummaryFile.empty())
+        return error("the function import pass needs -summary-file");
+      ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+          MemoryBuffer::getFile(SummaryFile);
+      std::error_code EC = BufferOrErr.getError();
+      if (!EC) {
+        ErrorOr<std::unique_ptr<FunctionInfoIndex>> IndexOrErr =
+            readFunctionInfoIndex((*BufferOrErr)->getMemBufferRef(),
+                                  M.getContext());
+        EC = IndexOrErr.getError();
+        if (!EC)
+          IndexPtr = std::move(*IndexOrErr);
+      }
+      if (EC)
+        return error("can't read the summary file '" + SummaryFile + "': " +
+                     EC.message());
+      if (!IndexPtr)
+        return error("the summary file '" + SummaryFile +
+                     "' has no function summaries");
+      CombinedIndex = IndexPtr.get();
+    }
+
+    // When errors go back to the creator, so do the linker's, rather than to
+    // the context, whose default handler prints them and exits.
+    DiagnosticHandlerFunction Handler;
+    std::string LinkerErrors;
+    if (ErrMsg)
+      Handler = [&LinkerErrors](const DiagnosticInfo &DI) {
+        if (DI.getSeverity() != DS_Error)
+          return;
+        raw_string_ostream OS(LinkerErrors);
+        DiagnosticPrinterRawOStream DP(OS);
+        DP << ": ";
+        DI.print(DP);
+      };
+
+    auto NumDefinitions = [&M] {
+      unsigned N = 0;
+      for (const Function &F : M)
+        N += !F.isDeclaration();
+      return N;
+    };
+    unsigned NumDefined = NumDefinitions();
+    FunctionImporter Importer(*CombinedIndex, nullptr, Handler);
+    std::string ImportError;
+    if (Importer.importFunctions(M, ImportInstrLimit, ImportError)) {
+      error(ImportError + LinkerErrors);
+      return true;
+    }
+    return NumDefinitions() != NumDefined;
+  }
+};
+}
+
+char FunctionImportPass::ID = 0;
+INITIALIZE_PASS(FunctionImportPass, "function-import",
+                "Summary based function import", false, false)
+
+ModulePass *llvm::createFunctionImportPass(const FunctionInfoIndex *Index,
+                                           std::string *ErrMsg) {
+  return new FunctionImportPass(Index, ErrMsg);
+}
@@ -37,6 +37,7 @@ void llvm::initializeIPO(PassRegistry &Registry) {
   initializeBlockExtractorPassPass(Registry);
   initializeSingleLoopExtractorPass(Registry);
   initializeLowerBitSetsPass(Registry);
+  initializeFunctionImportPassPass(Registry);
   initializeMergeFunctionsPass(Registry);
   initializePartialInlinerPass(Registry);
   initializePruneEHPass(Registry);
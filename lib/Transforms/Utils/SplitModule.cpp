@@ -0,0 +1,270 @@
+//===- SplitModule.cpp - Split a module into partitions -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the function llvm::SplitModule, which splits a module
+// into multiple linkable partitions. It can be used to implement parallel code
+// generation for link-time optimization.
+//
+// Global values are first grouped into clusters with a union-find forest:
+// globals that must stay together (comdat members, aliases and their base
+// objects, blockaddress users) are always merged, then functions are merged
+// with the globals they reference while the merged cluster stays below the
+// target partition size. Clusters are then assigned to partitions largest
+// first, each going to the least loaded partition.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+
+using namespace llvm;
+
+namespace {
+/// A union-find forest over the global values of a module. Globals are
+/// numbered in module order, which keeps the partitioning deterministic.
+class GlobalClusters {
+  DenseMap<const GlobalValue *, unsigned> Index;
+  SmallVector<const GlobalValue *, 0> Globals;
+  SmallVector<unsigned, 0> Parent;
+  SmallVector<unsigned, 0> Cost;
+
+public:
+  void insert(const GlobalValue *GV, unsigned GVCost) {
+    Index[GV] = Globals.size();
+    Parent.push_back(Globals.size());
+    Globals.push_back(GV);
+    Cost.push_back(GVCost);
+  }
+
+  unsigned size() const { return Globals.size(); }
+  const GlobalValue *getGlobal(unsigned I) const { return Globals[I]; }
+  unsigned getIndex(const GlobalValue *GV) const {
+    return Index.find(GV)->second;
+  }
+
+  unsigned findLeader(unsigned I) {
+    while (Parent[I] != I)
+      I = Parent[I] = Parent[Parent[I]];
+    return I;
+  }
+  unsigned findLeader(const GlobalValue *GV) {
+    return findLeader(getIndex(GV));
+  }
+
+  /// Returns the total cost of the cluster led by Leader.
+  unsigned getCost(unsigned Leader) const { return Cost[Leader]; }
+
+  /// Merges the clusters of A and B. The lower numbered leader survives.
+  /// If MaxCost is non-zero, the clusters are only merged when the resulting
+  /// cluster would not be more expensive than MaxCost. Returns true if A and B
+  /// are in the same cluster afterwards.
+  bool merge(const GlobalValue *A, const GlobalValue *B, unsigned MaxCost = 0) {
+    unsigned LA = findLeader(A), LB = findLeader(B);
+    if (LA == LB)
+      return true;
+    if (MaxCost && Cost[LA] + Cost[LB] > MaxCost)
+      return false;
+    if (LB < LA)
+      std::swap(LA, LB);
+    Parent[LB] = LA;
+    Cost[LA] += Cost[LB];
+    return true;
+  }
+};
+}
+
+static unsigned getCost(const GlobalValue *GV) {
+  unsigned Cost = 1;
+  if (auto *F = dyn_cast<Function>(GV))
+    for (const BasicBlock &BB : *F)
+      Cost += BB.size();
+  return Cost;
+}
+
+/// Collects the global values whose definitions refer to V, either directly or
+/// through constants.
+static void collectReferencingGlobals(
+    const Value *V, SmallVectorImpl<const GlobalValue *> &Referencing) {
+  SmallVector<const Value *, 8> Worklist(1, V);
+  SmallPtrSet<const Value *, 8> Visited;
+  while (!Worklist.empty()) {
+    const Value *Cur = Worklist.pop_back_val();
+    for (const User *U : Cur->users()) {
+      if (auto *I = dyn_cast<Instruction>(U))
+        Referencing.push_back(I->getParent()->getParent());
+      else if (auto *GV = dyn_cast<GlobalValue>(U))
+        Referencing.push_back(GV);
+      else if (Visited.insert(U).second)
+        Worklist.push_back(U);
+    }
+  }
+}
+
+/// Makes the local symbol GV visible to other partitions. The symbol is
+/// renamed so that it cannot clash with a symbol defined outside of the
+/// module.
+static void externalize(GlobalValue *GV) {
+  GV->setName(GV->getName() + ".llvm.split");
+  GV->setLinkage(GlobalValue::ExternalLinkage);
+  GV->setVisibility(GlobalValue::HiddenVisibility);
+}
+
+void llvm::SplitModule(
+    Module &M, unsigned N,
+    std::function<void(std::unique_ptr<Module> MPart)> ModuleCallback) {
+  assert(N != 0 && "Cannot split a module into zero partitions!");
+
+  GlobalClusters Clusters;
+  StringSet<> AppendingNames;
+  unsigned TotalCost = 0;
+  auto AddGlobal = [&](GlobalValue &GV) {
+    // Unnamed entities must be named consistently between modules. setName
+    // will give a distinct name to each such entity.
+    if (!GV.hasName())
+      GV.setName("__llvmsplit_unnamed");
+    if (GV.hasAppendingLinkage())
+      AppendingNames.insert(GV.getName());
+    unsigned Cost = getCost(&GV);
+    TotalCost += Cost;
+    Clusters.insert(&GV, Cost);
+  };
+  for (Function &F : M)
+    AddGlobal(F);
+  for (GlobalVariable &GV : M.globals())
+    AddGlobal(GV);
+  for (GlobalAlias &GA : M.aliases())
+    AddGlobal(GA);
+
+  // Merge the globals that have to be emitted into the same object file.
+  DenseMap<const Comdat *, const GlobalValue *> ComdatMembers;
+  for (unsigned I = 0, E = Clusters.size(); I != E; ++I) {
+    const GlobalValue *GV = Clusters.getGlobal(I);
+    if (auto *GA = dyn_cast<GlobalAlias>(GV))
+      if (const GlobalObject *Base = GA->getBaseObject())
+        Clusters.merge(GA, Base);
+    if (const Comdat *C = GV->getComdat()) {
+      auto Member = ComdatMembers.insert(std::make_pair(C, GV));
+      if (!Member.second)
+        Clusters.merge(GV, Member.first->second);
+    }
+    // A blockaddress is only valid in the module defining its function.
+    if (auto *F = dyn_cast<Function>(GV))
+      for (const User *U : F->users())
+        if (isa<BlockAddress>(U)) {
+          SmallVector<const GlobalValue *, 4> Referencing;
+          collectReferencingGlobals(U, Referencing);
+          for (const GlobalValue *R : Referencing)
+            Clusters.merge(F, R);
+        }
+  }
+
+  // Keep functions together with their callees and the globals they
+  // reference, as long as the cluster does not outgrow its share of the
+  // module. This keeps related code in one object and avoids promoting local
+  // symbols.
+  unsigned MaxCost = std::max(1u, TotalCost / N);
+  for (Function &F : M)
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB)
+        for (Value *Op : I.operands()) {
+          auto *Ref = dyn_cast<GlobalValue>(Op->stripPointerCasts());
+          if (Ref && !Ref->isDeclaration() && !Ref->hasAppendingLinkage())
+            Clusters.merge(&F, Ref, MaxCost);
+        }
+
+  // Assign clusters to partitions, most expensive cluster first, each to the
+  // least loaded partition. Appending globals are always emitted into the
+  // first partition.
+  SmallVector<unsigned, 0> Leaders;
+  for (unsigned I = 0, E = Clusters.size(); I != E; ++I)
+    if (Clusters.findLeader(I) == I &&
+        !Clusters.getGlobal(I)->hasAppendingLinkage())
+      Leaders.push_back(I);
+  std::stable_sort(Leaders.begin(), Leaders.end(),
+                   [&](unsigned A, unsigned B) {
+                     return Clusters.getCost(A) > Clusters.getCost(B);
+                   });
+
+  DenseMap<unsigned, unsigned> LeaderPartition;
+  SmallVector<unsigned, 8> PartitionCost(N, 0);
+  for (unsigned Leader : Leaders) {
+    unsigned Part = std::min_element(PartitionCost.begin(),
+                                     PartitionCost.end()) -
+                    PartitionCost.begin();
+    PartitionCost[Part] += Clusters.getCost(Leader);
+    LeaderPartition[Leader] = Part;
+  }
+
+  DenseMap<const GlobalValue *, unsigned> Partition;
+  for (unsigned I = 0, E = Clusters.size(); I != E; ++I) {
+    const GlobalValue *GV = Clusters.getGlobal(I);
+    Partition[GV] =
+        GV->hasAppendingLinkage() ? 0 : LeaderPartition[Clusters.findLeader(I)];
+  }
+
+  // Promote the local symbols that are referenced from another partition.
+  for (unsigned I = 0, E = Clusters.size(); I != E; ++I) {
+    GlobalValue *GV = const_cast<GlobalValue *>(Clusters.getGlobal(I));
+    if (!GV->hasLocalLinkage())
+      continue;
+    SmallVector<const GlobalValue *, 4> Referencing;
+    collectReferencingGlobals(GV, Referencing);
+    unsigned Part = Partition[GV];
+    for (const GlobalValue *R : Referencing)
+      if (Partition[R] != Part) {
+        externalize(GV);
+        break;
+      }
+  }
+
+  // FIXME: We should be able to reuse M as the last partition instead of
+  // cloning it.
+  for (unsigned I = 0; I != N; ++I) {
+    ValueToValueMapTy VMap;
+    std::unique_ptr<Module> MPart(
+        CloneModule(&M, VMap, [&](const GlobalValue *GV) {
+          // Declarations are copied into every partition unchanged.
+          return GV->isDeclaration() || Partition[GV] == I;
+        }));
+    // Local symbols that stayed local are not referenced from this partition
+    // unless they are defined in it; drop their leftover declarations.
+    for (unsigned J = 0, E = Clusters.size(); J != E; ++J) {
+      const GlobalValue *GV = Clusters.getGlobal(J);
+      if (!GV->hasLocalLinkage() || Partition[GV] == I)
+        continue;
+      GlobalValue *NewGV = cast<GlobalValue>(VMap[GV]);
+      if (NewGV->use_empty())
+        NewGV->eraseFromParent();
+    }
+    if (I != 0) {
+      MPart->setModuleInlineAsm("");
+      // The appending globals only live in the first partition; drop the
+      // external references left behind by the clone.
+      for (auto GI = MPart->global_begin(), GE = MPart->global_end();
+           GI != GE;) {
+        GlobalVariable *GV = GI++;
+        if (GV->isDeclaration() && GV->use_empty() &&
+            AppendingNames.count(GV->getName()))
+          GV->eraseFromParent();
+      }
+    }
+    ModuleCallback(std::move(MPart));
+  }
+}
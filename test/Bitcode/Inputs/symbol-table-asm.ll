@@ -0,0 +1,6 @@
+module asm ".globl asm_sym"
+module asm "asm_sym:"
+
+define void @foo() {
+  ret void
+}
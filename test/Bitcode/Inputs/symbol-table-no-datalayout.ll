@@ -0,0 +1,7 @@
+; Without a data layout the mangled names depend on the target the reader
+; picks, so there is no symbol table: foo is _foo on Darwin.
+target triple = "x86_64-apple-macosx10.10.0"
+
+define void @foo() {
+  ret void
+}
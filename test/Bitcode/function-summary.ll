@@ -0,0 +1,46 @@
+; RUN: llvm-as -function-summary < %s | llvm-bcanalyzer -dump | FileCheck %s
+; RUN: llvm-as < %s | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=NOSUMMARY
+; RUN: llvm-as -function-summary < %s | llvm-dis | FileCheck %s -check-prefix=DIS
+
+; The summaries follow the module, and describe its non-local definitions by
+; name. A name is written before the first record that refers to it.
+; CHECK: </MODULE_BLOCK>
+; CHECK-NEXT: <FUNCTION_SUMMARY_BLOCK
+;             [nameid, moduleid, flags, instcount, n x [calleenameid, callsites]]
+; bar
+; CHECK-NEXT: <NAME {{.*}} op0=98 op1=97 op2=114/>
+; CHECK-NEXT: <ENTRY {{.*}} op0=0 op1=0 op2=1 op3=1/>
+; foo
+; CHECK-NEXT: <NAME {{.*}} op0=102 op1=111 op2=111/>
+; ext
+; CHECK-NEXT: <NAME {{.*}} op0=101 op1=120 op2=116/>
+; CHECK-NEXT: <ENTRY {{.*}} op0=1 op1=0 op2=1 op3=4 op4=0 op5=2 op6=2 op7=1/>
+; weak
+; CHECK-NEXT: <NAME {{.*}} op0=119 op1=101 op2=97 op3=107/>
+; CHECK-NEXT: <ENTRY {{.*}} op0=3 op1=0 op2=2 op3=1/>
+; CHECK-NEXT: </FUNCTION_SUMMARY_BLOCK>
+
+; NOSUMMARY-NOT: FUNCTION_SUMMARY_BLOCK
+
+; DIS: define i32 @foo()
+
+define i32 @bar() {
+  ret i32 0
+}
+
+define i32 @foo() {
+  %a = call i32 @bar()
+  %b = call i32 @bar()
+  %c = call i32 @ext()
+  ret i32 %c
+}
+
+define internal i32 @local() {
+  ret i32 1
+}
+
+define weak void @weak() cold {
+  ret void
+}
+
+declare i32 @ext()
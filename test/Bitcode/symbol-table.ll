@@ -0,0 +1,65 @@
+; RUN: llvm-as -emit-symbol-table < %s | llvm-bcanalyzer -dump | FileCheck %s
+; RUN: llvm-as < %s | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=NOTABLE
+; RUN: llvm-as -emit-symbol-table < %s | llvm-dis | FileCheck %s -check-prefix=DIS
+; RUN: llvm-as -emit-symbol-table < %S/Inputs/symbol-table-asm.ll | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=NOTABLE
+; RUN: llvm-as -emit-symbol-table < %S/Inputs/symbol-table-no-datalayout.ll | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=NOTABLE
+
+; The table follows the module block, and lists functions, variables and
+; aliases, in that order.
+; CHECK: </MODULE_BLOCK>
+; CHECK-NEXT: <SYMTAB_BLOCK
+; CHECK-NEXT: <TRIPLE
+; CHECK-NEXT: <COMDAT op0=1 op1=99/>
+;             [flags, linkage, visibility, alignment, comdat, commonsize, name]
+; foo
+; CHECK-NEXT: <SYMBOL {{.*}} op0=2 op1=0 op2=0 op3=0 op4=0 op5=0 op6=102 op7=111 op8=111/>
+; odr
+; CHECK-NEXT: <SYMBOL {{.*}} op0=18 op1=19 op2=0 op3=0 op4=0 op5=0 op6=111 op7=100 op8=114/>
+; bar
+; CHECK-NEXT: <SYMBOL {{.*}} op0=3 op1=0 op2=0 op3=0 op4=0 op5=0 op6=98 op7=97 op8=114/>
+; glob
+; CHECK-NEXT: <SYMBOL {{.*}} op0=0 op1=0 op2=0 op3=4 op4=0 op5=0 op6=103 op7=108 op8=111 op9=98/>
+; cst
+; CHECK-NEXT: <SYMBOL {{.*}} op0=8 op1=0 op2=0 op3=0 op4=0 op5=0 op6=99 op7=115 op8=116/>
+; common
+; CHECK-NEXT: <SYMBOL {{.*}} op0=0 op1=8 op2=0 op3=5 op4=0 op5=32 op6=99 op7=111 op8=109 op9=109 op10=111 op11=110/>
+; hid
+; CHECK-NEXT: <SYMBOL {{.*}} op0=0 op1=0 op2=1 op3=0 op4=0 op5=0 op6=104 op7=105 op8=100/>
+; c
+; CHECK-NEXT: <SYMBOL {{.*}} op0=0 op1=19 op2=0 op3=0 op4=1 op5=0 op6=99/>
+; weakext
+; CHECK-NEXT: <SYMBOL {{.*}} op0=1 op1=7 op2=0 op3=0 op4=0 op5=0 op6=119 op7=101 op8=97 op9=107 op10=101 op11=120 op12=116/>
+; alias
+; CHECK-NEXT: <SYMBOL {{.*}} op0=4 op1=0 op2=0 op3=4 op4=0 op5=0 op6=97 op7=108 op8=105 op9=97 op10=115/>
+; CHECK-NEXT: <LINKER_OPTION op0=45 op1=108 op2=122/>
+; CHECK-NEXT: </SYMTAB_BLOCK>
+
+; NOTABLE-NOT: SYMTAB_BLOCK
+
+; DIS: define void @foo()
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+$c = comdat any
+
+@glob = global i32 0, align 8
+@cst = constant i32 1
+@common = common global [4 x i64] zeroinitializer, align 16
+@hid = hidden global i32 2
+@c = linkonce_odr global i32 3, comdat
+@weakext = extern_weak global i32
+@alias = alias i32* @glob
+
+define void @foo() {
+  ret void
+}
+
+define linkonce_odr void @odr() unnamed_addr {
+  ret void
+}
+
+declare void @bar()
+
+!llvm.module.flags = !{!0}
+!0 = !{i32 6, !"Linker Options", !{!{!"-lz"}}}
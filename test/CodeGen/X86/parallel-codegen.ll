@@ -0,0 +1,42 @@
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -j2 -o %t.s %s
+; RUN: FileCheck --check-prefix=CHECK0 %s < %t.s.0
+; RUN: FileCheck --check-prefix=CHECK1 %s < %t.s.1
+; RUN: not llc -mtriple=x86_64-unknown-linux-gnu -j2 < %s 2>&1 \
+; RUN:   | FileCheck --check-prefix=STDOUT %s
+
+; With -j2 the module is split into two partitions, each compiled on its own
+; thread into its own output file. @local stays internal since it is only
+; called from the partition that defines it.
+
+; CHECK0-NOT: {{^}}f:
+; CHECK0: {{^}}local:
+; CHECK0-NOT: .globl local
+; CHECK0: .globl g
+; CHECK0: {{^}}g:
+; CHECK0: callq local
+; CHECK0-NOT: {{^}}f:
+
+; CHECK1-NOT: {{^}}g:
+; CHECK1: .globl f
+; CHECK1: {{^}}f:
+; CHECK1-NOT: {{^}}g:
+
+; STDOUT: -j requires an output file
+
+define internal i32 @local(i32 %x) {
+  %y = mul i32 %x, 3
+  ret i32 %y
+}
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  %d = add i32 %c, 4
+  ret i32 %d
+}
+
+define i32 @g(i32 %x) {
+  %r = call i32 @local(i32 %x)
+  ret i32 %r
+}
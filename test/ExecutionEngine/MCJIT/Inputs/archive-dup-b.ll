@@ -0,0 +1,3 @@
+define i32 @dup() {
+  ret i32 2
+}
@@ -0,0 +1,22 @@
+; RUN: rm -rf %t.dir
+; RUN: mkdir -p %t.dir
+; RUN: llc -filetype=obj -o %t.dir/a.o %p/Inputs/archive-dup-a.ll
+; RUN: llc -filetype=obj -o %t.dir/b.o %p/Inputs/archive-dup-b.ll
+; RUN: llvm-ar rc %t.dir/ab.a %t.dir/a.o %t.dir/b.o
+; RUN: llvm-ar rc %t.dir/ba.a %t.dir/b.o %t.dir/a.o
+
+; A symbol defined by several members resolves to the first member that
+; defines it. Symbols the archive does not define, like abs, are left to
+; the process.
+; RUN: %lli -extra-archive=%t.dir/ab.a %s
+; RUN: not %lli -extra-archive=%t.dir/ba.a %s
+
+declare i32 @dup()
+declare i32 @abs(i32)
+
+define i32 @main() {
+  %d = call i32 @dup()
+  %a = call i32 @abs(i32 -1)
+  %r = sub i32 %d, %a
+  ret i32 %r
+}
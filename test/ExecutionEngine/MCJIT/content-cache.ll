@@ -0,0 +1,13 @@
+; RUN: rm -rf %t.cachedir
+; RUN: %lli -enable-content-cache -object-cache-dir=%t.cachedir %s
+; RUN: %lli -enable-content-cache -object-cache-dir=%t.cachedir %s
+; RUN: ls %t.cachedir | FileCheck %s
+;
+; Both runs use one cache entry, named after the hash of the module.
+;
+; CHECK: {{^[0-9a-f]{32}\.o$}}
+; CHECK-NOT: .o
+
+define i32 @main() {
+  ret i32 0
+}
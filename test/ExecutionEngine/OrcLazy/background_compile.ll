@@ -0,0 +1,75 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-background-compile %s | FileCheck %s
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-background-compile -debug-only=orc-cod \
+; RUN:   %s 2>&1 | FileCheck %s --check-prefix=DEBUG
+; REQUIRES: asserts
+;
+; Functions that are reached from a compiled function are compiled on a
+; background thread, while the main thread may call them through their stubs.
+; main sleeps before it calls anything, so that the background thread gets to
+; compile some of its callees first.
+;
+; CHECK: fib(25) = 75025
+; CHECK: done
+;
+; DEBUG: Compiled {{.*}} in the background
+
+@fmt = private unnamed_addr constant [13 x i8] c"fib(25) = %d\00"
+@done = private unnamed_addr constant [5 x i8] c"done\00"
+
+define internal i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %ret, label %rec
+
+rec:
+  %n1 = sub i32 %n, 1
+  %a = call i32 @fib(i32 %n1)
+  %n2 = sub i32 %n, 2
+  %b = call i32 @fib(i32 %n2)
+  %s = add i32 %a, %b
+  ret i32 %s
+
+ret:
+  ret i32 %n
+}
+
+define i32 @twice(i32 %n) {
+entry:
+  %r = call i32 @add(i32 %n, i32 %n)
+  ret i32 %r
+}
+
+define i32 @add(i32 %a, i32 %b) {
+entry:
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define void @report(i32 %v) {
+entry:
+  %0 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @fmt, i64 0, i64 0), i32 %v)
+  %1 = call i32 @putchar(i32 10)
+  ret void
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %s = call i32 @usleep(i32 100000)
+  %f = call i32 @fib(i32 25)
+  call void @report(i32 %f)
+  %t = call i32 @twice(i32 21)
+  %ok = icmp eq i32 %t, 42
+  br i1 %ok, label %good, label %bad
+
+good:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([5 x i8], [5 x i8]* @done, i64 0, i64 0))
+  ret i32 0
+
+bad:
+  ret i32 1
+}
+
+declare i32 @printf(i8*, ...)
+declare i32 @putchar(i32)
+declare i32 @puts(i8*)
+declare i32 @usleep(i32)
@@ -0,0 +1,41 @@
+; RUN: lli -jit-kind=orc-tiered -orc-tiered-threshold=50 -orc-tiered-debug \
+; RUN:     %s 2>&1 | FileCheck %s
+;
+; Hot functions are recompiled on a background thread while the program keeps
+; running the unoptimized code. main sleeps before returning so that the
+; worker gets to finish the request before the JIT drops it at exit.
+;
+; CHECK-DAG: orc-tiered: recompiled 'fib'
+; CHECK-DAG: fib(25) = 75025
+
+@fmt = private unnamed_addr constant [13 x i8] c"fib(25) = %d\00"
+
+define internal i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %ret, label %rec
+
+rec:
+  %n1 = sub i32 %n, 1
+  %a = call i32 @fib(i32 %n1)
+  %n2 = sub i32 %n, 2
+  %b = call i32 @fib(i32 %n2)
+  %s = add i32 %a, %b
+  ret i32 %s
+
+ret:
+  ret i32 %n
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %f = call i32 @fib(i32 25)
+  %0 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([13 x i8], [13 x i8]* @fmt, i64 0, i64 0), i32 %f)
+  %1 = call i32 @putchar(i32 10)
+  %2 = call i32 @usleep(i32 200000)
+  ret i32 0
+}
+
+declare i32 @printf(i8*, ...)
+declare i32 @putchar(i32)
+declare i32 @usleep(i32)
@@ -0,0 +1,55 @@
+; RUN: lli -jit-kind=orc-tiered -orc-tiered-background=false \
+; RUN:     -orc-tiered-threshold=100 -orc-tiered-debug %s 2>&1 | FileCheck %s
+;
+; Functions are recompiled once their calls plus loop iterations reach the
+; threshold, and later calls reach the recompiled code through their stubs.
+; Frames that are already running, like the loop in main, stay in the
+; unoptimized code.
+;
+; CHECK-NOT: recompiled 'cold'
+; CHECK: orc-tiered: recompiled 'main'
+; CHECK: orc-tiered: recompiled 'add'
+; CHECK-NOT: recompiled
+; CHECK: sum = 499500
+; CHECK: cold = 7
+
+@fmt = private unnamed_addr constant [9 x i8] c"sum = %d\00"
+@fmt2 = private unnamed_addr constant [10 x i8] c"cold = %d\00"
+@total = internal global i32 0
+
+define internal void @add(i32 %v) {
+entry:
+  %0 = load i32, i32* @total
+  %1 = add i32 %0, %v
+  store i32 %1, i32* @total
+  ret void
+}
+
+define i32 @cold() {
+entry:
+  ret i32 7
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  call void @add(i32 %i)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, 1000
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %sum = load i32, i32* @total
+  %0 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([9 x i8], [9 x i8]* @fmt, i64 0, i64 0), i32 %sum)
+  %1 = call i32 @putchar(i32 10)
+  %c = call i32 @cold()
+  %2 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([10 x i8], [10 x i8]* @fmt2, i64 0, i64 0), i32 %c)
+  %3 = call i32 @putchar(i32 10)
+  ret i32 0
+}
+
+declare i32 @printf(i8*, ...)
+declare i32 @putchar(i32)
@@ -0,0 +1,35 @@
+; RUN: %lli -force-interpreter=true %s | FileCheck %s
+
+; Calls between bytecode functions don't use the C stack, so recursion is as
+; deep as the program makes it. Each frame keeps its own registers and
+; allocas while its callees run.
+
+@fmt = private constant [11 x i8] c"sum = %ld\0A\00"
+
+; CHECK: sum = 5000050000
+
+define i64 @sum(i64 %n) {
+entry:
+  %slot = alloca i64
+  store i64 %n, i64* %slot
+  %done = icmp eq i64 %n, 0
+  br i1 %done, label %base, label %rec
+
+base:
+  ret i64 0
+
+rec:
+  %m = sub i64 %n, 1
+  %r = call i64 @sum(i64 %m)
+  %v = load i64, i64* %slot
+  %s = add i64 %r, %v
+  ret i64 %s
+}
+
+define i32 @main() {
+  %s = call i64 @sum(i64 100000)
+  call i32 (i8*, ...) @printf(i8* getelementptr ([11 x i8], [11 x i8]* @fmt, i32 0, i32 0), i64 %s)
+  ret i32 0
+}
+
+declare i32 @printf(i8*, ...)
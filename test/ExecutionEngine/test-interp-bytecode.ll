@@ -0,0 +1,229 @@
+; RUN: %lli -force-interpreter=true %s | FileCheck %s
+; RUN: %lli -force-interpreter=true -interpreter-bytecode=false %s | FileCheck %s
+
+; Functions are translated to bytecode unless they use something the bytecode
+; doesn't support, like vectors, in which case they run on the IR. Both must
+; give the same results, and be able to call each other.
+
+%pair = type { i8, i32 }
+
+@counter = global i32 0
+@fmt.i = private constant [7 x i8] c"%s %d\0A\00"
+@fmt.f = private constant [7 x i8] c"%s %f\0A\00"
+@s.fib = private constant [4 x i8] c"fib\00"
+@s.iter = private constant [5 x i8] c"iter\00"
+@s.switch = private constant [7 x i8] c"switch\00"
+@s.float = private constant [6 x i8] c"float\00"
+@s.wrap = private constant [5 x i8] c"wrap\00"
+@s.signed = private constant [7 x i8] c"signed\00"
+@s.memory = private constant [7 x i8] c"memory\00"
+@s.vector = private constant [7 x i8] c"vector\00"
+@s.indirect = private constant [9 x i8] c"indirect\00"
+@s.counter = private constant [8 x i8] c"counter\00"
+
+declare i32 @printf(i8*, ...)
+declare void @llvm.memset.p0i8.i64(i8*, i8, i64, i32, i1)
+
+define void @print(i8* %name, i32 %v) {
+  %fmt = getelementptr [7 x i8], [7 x i8]* @fmt.i, i32 0, i32 0
+  call i32 (i8*, ...) @printf(i8* %fmt, i8* %name, i32 %v)
+  %c = load i32, i32* @counter
+  %c1 = add i32 %c, 1
+  store i32 %c1, i32* @counter
+  ret void
+}
+
+define i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %done, label %recurse
+recurse:
+  %n1 = sub i32 %n, 1
+  %n2 = sub i32 %n, 2
+  %f1 = call i32 @fib(i32 %n1)
+  %f2 = call i32 @fib(i32 %n2)
+  %sum = add i32 %f1, %f2
+  ret i32 %sum
+done:
+  ret i32 %n
+}
+
+; The PHIs swap values, so they must be updated together.
+define i32 @fib_iter(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %a = phi i32 [ 0, %entry ], [ %b, %loop ]
+  %b = phi i32 [ 1, %entry ], [ %ab, %loop ]
+  %ab = add i32 %a, %b
+  %i.next = add i32 %i, 1
+  %more = icmp ult i32 %i.next, %n
+  br i1 %more, label %loop, label %exit
+exit:
+  ret i32 %b
+}
+
+define i32 @classify(i64 %v) {
+entry:
+  switch i64 %v, label %other [
+    i64 1, label %one
+    i64 -1, label %minus.one
+    i64 4294967296, label %big
+  ]
+one:
+  br label %exit
+minus.one:
+  br label %exit
+big:
+  br label %exit
+other:
+  br label %exit
+exit:
+  %r = phi i32 [ 10, %one ], [ 20, %minus.one ], [ 30, %big ], [ 40, %other ]
+  ret i32 %r
+}
+
+define double @harmonic(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 1, %entry ], [ %i.next, %loop ]
+  %sum = phi double [ 0.0, %entry ], [ %sum.next, %loop ]
+  %d = sitofp i32 %i to double
+  %inv = fdiv double 1.0, %d
+  %f = fptrunc double %inv to float
+  %fe = fpext float %f to double
+  %sum.next = fadd double %sum, %fe
+  %i.next = add i32 %i, 1
+  %done = icmp sgt i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  ret double %sum.next
+}
+
+define i32 @wrap() {
+  %a = add i8 200, 100
+  %b = mul i8 %a, 3
+  %c = zext i8 %b to i32
+  %d = shl i16 1, 15
+  %e = ashr i16 %d, 3
+  %f = sext i16 %e to i32
+  %g = add i32 %c, %f
+  ret i32 %g
+}
+
+define i32 @signed(i32 %x, i32 %y) {
+  %q = sdiv i32 %x, %y
+  %r = srem i32 %x, %y
+  %neg = icmp slt i32 %r, 0
+  %sel = select i1 %neg, i32 1000, i32 2000
+  %t = mul i32 %q, 10
+  %u = add i32 %t, %r
+  %v = add i32 %u, %sel
+  ret i32 %v
+}
+
+define i32 @memory(i32 %n) {
+entry:
+  %arr = alloca %pair, i32 8
+  %raw = bitcast %pair* %arr to i8*
+  call void @llvm.memset.p0i8.i64(i8* %raw, i8 0, i64 64, i32 4, i1 false)
+  br label %fill
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %fill ]
+  %tag = getelementptr %pair, %pair* %arr, i32 %i, i32 0
+  %val = getelementptr %pair, %pair* %arr, i32 %i, i32 1
+  %i8 = trunc i32 %i to i8
+  store i8 %i8, i8* %tag
+  %sq = mul i32 %i, %i
+  store i32 %sq, i32* %val
+  %i.next = add i32 %i, 1
+  %more = icmp slt i32 %i.next, %n
+  br i1 %more, label %fill, label %sum
+sum:
+  %j = phi i32 [ 0, %fill ], [ %j.next, %sum ]
+  %acc = phi i32 [ 0, %fill ], [ %acc.next, %sum ]
+  %j64 = sext i32 %j to i64
+  %tag2 = getelementptr %pair, %pair* %arr, i64 %j64, i32 0
+  %val2 = getelementptr %pair, %pair* %arr, i64 %j64, i32 1
+  %t = load i8, i8* %tag2
+  %t32 = zext i8 %t to i32
+  %v = load i32, i32* %val2
+  %tv = add i32 %t32, %v
+  %acc.next = add i32 %acc, %tv
+  %j.next = add i32 %j, 1
+  %done = icmp eq i32 %j.next, 8
+  br i1 %done, label %exit, label %sum
+exit:
+  ret i32 %acc.next
+}
+
+; Uses vectors, so it runs on the IR even when called from bytecode.
+define i32 @vector_sum(i32 %a, i32 %b) {
+  %v0 = insertelement <2 x i32> undef, i32 %a, i32 0
+  %v1 = insertelement <2 x i32> %v0, i32 %b, i32 1
+  %v2 = add <2 x i32> %v1, <i32 100, i32 200>
+  %x = extractelement <2 x i32> %v2, i32 0
+  %y = extractelement <2 x i32> %v2, i32 1
+  %z = call i32 @fib(i32 10)
+  %s = add i32 %x, %y
+  %r = add i32 %s, %z
+  ret i32 %r
+}
+
+define i32 @apply(i32 (i32)* %f, i32 %v) {
+  %r = call i32 %f(i32 %v)
+  ret i32 %r
+}
+
+define i32 @main() {
+  %r1 = call i32 @fib(i32 20)
+  call void @print(i8* getelementptr ([4 x i8], [4 x i8]* @s.fib, i32 0, i32 0), i32 %r1)
+; CHECK: fib 6765
+
+  %r2 = call i32 @fib_iter(i32 30)
+  call void @print(i8* getelementptr ([5 x i8], [5 x i8]* @s.iter, i32 0, i32 0), i32 %r2)
+; CHECK: iter 832040
+
+  %c1 = call i32 @classify(i64 1)
+  %c2 = call i32 @classify(i64 -1)
+  %c3 = call i32 @classify(i64 4294967296)
+  %c4 = call i32 @classify(i64 5)
+  %c12 = add i32 %c1, %c2
+  %c34 = add i32 %c3, %c4
+  %c = add i32 %c12, %c34
+  call void @print(i8* getelementptr ([7 x i8], [7 x i8]* @s.switch, i32 0, i32 0), i32 %c)
+; CHECK: switch 100
+
+  %h = call double @harmonic(i32 4)
+  %fmt = getelementptr [7 x i8], [7 x i8]* @fmt.f, i32 0, i32 0
+  call i32 (i8*, ...) @printf(i8* %fmt, i8* getelementptr ([6 x i8], [6 x i8]* @s.float, i32 0, i32 0), double %h)
+; CHECK: float 2.083333
+
+  %w = call i32 @wrap()
+  call void @print(i8* getelementptr ([5 x i8], [5 x i8]* @s.wrap, i32 0, i32 0), i32 %w)
+; CHECK: wrap -3964
+
+  %s = call i32 @signed(i32 -47, i32 5)
+  call void @print(i8* getelementptr ([7 x i8], [7 x i8]* @s.signed, i32 0, i32 0), i32 %s)
+; CHECK: signed 908
+
+  %m = call i32 @memory(i32 8)
+  call void @print(i8* getelementptr ([7 x i8], [7 x i8]* @s.memory, i32 0, i32 0), i32 %m)
+; CHECK: memory 168
+
+  %v = call i32 @vector_sum(i32 1, i32 2)
+  call void @print(i8* getelementptr ([7 x i8], [7 x i8]* @s.vector, i32 0, i32 0), i32 %v)
+; CHECK: vector 358
+
+  %i = call i32 @apply(i32 (i32)* @fib_iter, i32 10)
+  call void @print(i8* getelementptr ([9 x i8], [9 x i8]* @s.indirect, i32 0, i32 0), i32 %i)
+; CHECK: indirect 55
+
+  %n = load i32, i32* @counter
+  call void @print(i8* getelementptr ([8 x i8], [8 x i8]* @s.counter, i32 0, i32 0), i32 %n)
+; CHECK: counter 8
+
+  ret i32 0
+}
@@ -0,0 +1,31 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -j2 -o %t.o %t.bc
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-nm %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+; With -j2 the merged module is split into two partitions that are code
+; generated into separate object files. The internalized @g is shared by both
+; partitions, so it is promoted to a hidden symbol with a unique name.
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = global i32 0
+
+; CHECK0-NOT: bar
+; CHECK0: T foo
+; CHECK0-NOT: bar
+; CHECK0: U g.llvm.split
+define void @foo() {
+  store volatile i32 1, i32* @g
+  store volatile i32 2, i32* @g
+  ret void
+}
+
+; CHECK1-NOT: foo
+; CHECK1: T bar
+; CHECK1-NOT: foo
+; CHECK1: B g.llvm.split
+define void @bar() {
+  store volatile i32 3, i32* @g
+  ret void
+}
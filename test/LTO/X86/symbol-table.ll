@@ -0,0 +1,39 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-as -emit-symbol-table -o %t.symtab.bc %s
+; RUN: llvm-lto -list-symbols-only %t.bc | FileCheck %s
+; RUN: llvm-lto -list-symbols-only %t.symtab.bc | FileCheck %s
+
+; LTOModule lists the same symbols whether it reads them from the symbol table
+; or from the module.
+; CHECK: foo
+; CHECK-NEXT: odr
+; CHECK-NEXT: local
+; CHECK-NEXT: glob
+; CHECK-NEXT: common
+; CHECK-NEXT: alias
+; CHECK-NEXT: bar
+; CHECK-NEXT: ext
+; CHECK-NOT: str
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@glob = global i32 0
+@common = common global i32 0
+@ext = external global i32
+@str = private unnamed_addr constant [2 x i8] c"a\00"
+@alias = alias i32* @glob
+
+define void @foo() {
+  ret void
+}
+
+define linkonce_odr void @odr() unnamed_addr {
+  ret void
+}
+
+define internal void @local() {
+  ret void
+}
+
+declare void @bar()
@@ -0,0 +1,34 @@
+; RUN: llvm-as -function-summary %s -o %t1.bc
+; RUN: llvm-as -function-summary %p/Inputs/thinlto.ll -o %t2.bc
+; RUN: llvm-lto -thinlto -j2 -o %t3.bc %t1.bc %t2.bc
+; RUN: llvm-bcanalyzer -dump %t3.bc | FileCheck %s -check-prefix=INDEX
+; RUN: llvm-dis < %t1.bc.thinlto.bc | FileCheck %s
+; RUN: llvm-dis < %t2.bc.thinlto.bc | FileCheck %s -check-prefix=FOO
+; RUN: llvm-as %p/Inputs/thinlto.ll -o %t4.bc
+; RUN: not llvm-lto -thinlto -o %t5.bc %t1.bc %t4.bc 2>&1 | FileCheck %s -check-prefix=NOSUMMARY
+
+; The combined index has no module, and names both modules.
+; INDEX-NOT: MODULE_BLOCK
+; INDEX: <FUNCTION_SUMMARY_BLOCK
+; INDEX-NEXT: <MODULE_PATH
+; INDEX-NEXT: <MODULE_PATH
+; INDEX-NOT: MODULE_BLOCK
+
+; @foo is imported from the other module, inlined into @main and dropped.
+; CHECK: define i32 @main()
+; CHECK-NEXT: ret i32 42
+; CHECK-NOT: @foo
+
+; FOO: define i32 @foo()
+
+; NOSUMMARY: file '{{.*}}4.bc' has no function summaries
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  %x = call i32 @foo()
+  ret i32 %x
+}
+
+declare i32 @foo()
@@ -0,0 +1,30 @@
+@used_var = global i32 1
+@unused_var = global i32 2
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @ctor, i8* null }]
+
+declare void @unused_decl()
+
+define void @ctor() {
+  ret void
+}
+
+define i32 @used() {
+  %v = load i32, i32* @used_var
+  %r = call i32 @used_indirectly()
+  %s = add i32 %v, %r
+  ret i32 %s
+}
+
+define i32 @used_indirectly() {
+  ret i32 3
+}
+
+define internal i32 @used_internal() {
+  ret i32 4
+}
+
+define i32 @unused() {
+  call void @unused_decl()
+  %r = call i32 @used_internal()
+  ret i32 %r
+}
@@ -0,0 +1,28 @@
+; RUN: llvm-link -S %s %p/Inputs/only-needed.ll | FileCheck %s --check-prefix=ALL
+; RUN: llvm-link -S -only-needed %s %p/Inputs/only-needed.ll | FileCheck %s
+; RUN: llvm-link -S -only-needed %s %p/Inputs/only-needed.ll | \
+; RUN:   FileCheck %s --check-prefix=NOTNEEDED
+
+; With -only-needed, the definitions of the second file are only linked in if
+; the first file refers to them, directly or through other linked definitions.
+
+; CHECK: @llvm.global_ctors = appending global
+; CHECK: @used_var = global i32 1
+; CHECK-DAG: define i32 @main()
+; CHECK-DAG: define i32 @used()
+; CHECK-DAG: define i32 @used_indirectly()
+; CHECK-DAG: define void @ctor()
+
+; NOTNEEDED-NOT: @unused
+; NOTNEEDED-NOT: @used_internal
+
+; ALL-DAG: @unused_var = global i32 2
+; ALL-DAG: define i32 @unused()
+; ALL-DAG: define internal i32 @used_internal()
+
+declare i32 @used()
+
+define i32 @main() {
+  %r = call i32 @used()
+  ret i32 %r
+}
@@ -1,9 +1,18 @@
 // RUN: llvm-mc -filetype=obj -compress-debug-sections -triple x86_64-pc-linux-gnu < %s -o %t
 // RUN: llvm-objdump -s %t | FileCheck %s
 // RUN: llvm-dwarfdump -debug-dump=info %t | FileCheck --check-prefix=INFO %s
+// RUN: llvm-dwarfdump -debug-dump=str %t | FileCheck --check-prefix=STR %s
 // RUN: llvm-mc -filetype=obj -compress-debug-sections -triple i386-pc-linux-gnu < %s \
 // RUN:     | llvm-readobj -symbols - | FileCheck --check-prefix=386-SYMBOLS %s
 
+// RUN: llvm-mc -filetype=obj -compress-debug-sections=zlib -triple x86_64-pc-linux-gnu < %s -o %t.zlib
+// RUN: llvm-readobj -sections %t.zlib | FileCheck --check-prefix=ZLIB %s
+// RUN: llvm-objdump -s %t.zlib | FileCheck --check-prefix=ZLIB-DATA %s
+// RUN: llvm-dwarfdump -debug-dump=str %t.zlib | FileCheck --check-prefix=STR %s
+// RUN: llvm-mc -filetype=obj -compress-debug-sections=zlib -triple i386-pc-linux-gnu < %s -o %t.zlib32
+// RUN: llvm-objdump -s %t.zlib32 | FileCheck --check-prefix=ZLIB32-DATA %s
+// RUN: llvm-dwarfdump -debug-dump=str %t.zlib32 | FileCheck --check-prefix=STR %s
+
 // REQUIRES: zlib
 
 // CHECK: Contents of section .zdebug_line:
@@ -32,6 +41,27 @@
 // 386-SYMBOLS-NOT: }
 // 386-SYMBOLS: Section: .zdebug_str
 
+// Decompress the strings of both formats.
+// STR: 0x00000000: "compress this                                    "
+
+// With SHF_COMPRESSED, the sections keep their names. They start with an
+// aligned compression header: ELFCOMPRESS_ZLIB, then the size and the
+// alignment of the uncompressed contents.
+// ZLIB:      Name: .debug_str
+// ZLIB-NEXT: Type: SHT_PROGBITS
+// ZLIB-NEXT: Flags [
+// ZLIB-NEXT:   SHF_COMPRESSED
+// ZLIB-NEXT:   SHF_MERGE
+// ZLIB-NEXT:   SHF_STRINGS
+// ZLIB:      AddressAlignment: 8
+
+// ZLIB-DATA: Contents of section .debug_str:
+// ZLIB-DATA-NEXT: 0000 01000000 00000000 32000000 00000000
+// ZLIB-DATA-NEXT: 0010 01000000 00000000 789c
+
+// ZLIB32-DATA: Contents of section .debug_str:
+// ZLIB32-DATA-NEXT: 0000 01000000 32000000 01000000 789c
+
 	.section	.debug_line,"",@progbits
 
 	.section	.debug_abbrev,"",@progbits
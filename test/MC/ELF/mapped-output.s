@@ -0,0 +1,29 @@
+// Object files written to a regular file are written in place into a mapped
+// file; check that they match the ones written to a stream, also when the
+// output file already exists and for formats that do not reserve space.
+
+// RUN: rm -f %t.o
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o %t.o
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - > %t.stream.o
+// RUN: cmp %t.o %t.stream.o
+// RUN: llvm-mc -filetype=obj -triple i686-pc-linux-gnu %s -o %t.o
+// RUN: llvm-mc -filetype=obj -triple i686-pc-linux-gnu %s -o - > %t.stream.o
+// RUN: cmp %t.o %t.stream.o
+// RUN: llvm-mc -filetype=obj -triple x86_64-apple-darwin %s -o %t.o
+// RUN: llvm-mc -filetype=obj -triple x86_64-apple-darwin %s -o - > %t.stream.o
+// RUN: cmp %t.o %t.stream.o
+// RUN: llvm-readobj -h %t.o | FileCheck %s
+
+// CHECK: Format: Mach-O 64-bit x86-64
+
+	.text
+foo:
+	movl	$1, %eax
+	call	bar
+	ret
+
+	.data
+	.long	foo
+	.zero	70000
+
+	.comm	buf, 100
@@ -0,0 +1,38 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | llvm-objdump -d - | FileCheck %s
+
+// Test relaxations that only become necessary after other fragments have
+// been relaxed, which later layout iterations have to find.
+
+// Relaxing each jump pushes the target of the jump before it out of range.
+// CHECK: chain:
+// CHECK-NEXT:   0: e9 82 00 00 00 jmp 130
+// CHECK:       82: e9 82 00 00 00 jmp 130
+// CHECK:      104: e9 80 00 00 00 jmp 128
+chain:
+  jmp .Lchain0
+  .fill 125, 1, 0x90
+  jmp .Lchain1
+.Lchain0:
+  .fill 125, 1, 0x90
+  jmp .Lchain2
+.Lchain1:
+  .fill 128, 1, 0x90
+.Lchain2:
+
+// Relaxing the first jump moves the align fragment after the second one,
+// which grows the distance to its target although no fragment between them
+// was relaxed.
+// CHECK: align:
+// CHECK-NEXT: e9 {{.*}} jmp
+// CHECK-NEXT: e9 86 00 00 00 jmp 134
+  .p2align 4
+align:
+  jmp .Lfar
+  jmp .Laligned
+  .fill 123, 1, 0x90
+  .p2align 4
+.Laligned:
+  ret
+  .fill 200, 1, 0x90
+.Lfar:
+  ret
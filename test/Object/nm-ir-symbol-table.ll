@@ -0,0 +1,52 @@
+; RUN: llvm-as -emit-symbol-table %s -o %t.bc
+; RUN: llvm-bcanalyzer -dump %t.bc | FileCheck %s -check-prefix=TABLE
+; RUN: llvm-nm %t.bc | FileCheck %s
+; RUN: llvm-nm -without-aliases %t.bc | FileCheck %s -check-prefix=NOALIAS
+; RUN: rm -f %t.a
+; RUN: llvm-ar rcs %t.a %t.bc
+; RUN: llvm-nm -M %t.a | FileCheck %s -check-prefix=ARMAP
+
+; llvm-nm and llvm-ar read the symbols of bitcode from its symbol table when it
+; has one, and list the same symbols as for the module.
+; RUN: llvm-as %s -o %t.notable.bc
+; RUN: llvm-nm %t.notable.bc | FileCheck %s
+
+; CHECK: D _alias
+; CHECK: U _bar
+; CHECK: C _common
+; CHECK: T _foo
+; CHECK: D _glob
+; CHECK-NOT: memcpy
+; CHECK: W _odr
+
+; TABLE: <SYMTAB_BLOCK
+
+; NOALIAS-NOT: alias
+
+; ARMAP: Archive map
+; ARMAP-DAG: _alias in
+; ARMAP-DAG: _common in
+; ARMAP-DAG: _foo in
+; ARMAP-DAG: _glob in
+; ARMAP-DAG: _odr in
+; ARMAP-NOT: _bar in
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.10.0"
+
+@glob = global i32 0
+@common = common global i32 0
+@alias = alias i32* @glob
+
+define void @foo() {
+  tail call void @llvm.memcpy.p0i8.p0i8.i64(i8* null, i8* null, i64 0, i32 1, i1 false)
+  call void @bar()
+  ret void
+}
+
+define linkonce_odr void @odr() {
+  ret void
+}
+
+declare void @bar()
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture, i8* nocapture readonly, i64, i32, i1)
@@ -0,0 +1,54 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@gv = global i32 0
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @ctor, i8* null }]
+
+define i32 @small(i32 %x) {
+  %y = add i32 %x, 1
+  %z = call i32 @leaf(i32 %y)
+  ret i32 %z
+}
+
+define i32 @leaf(i32 %x) {
+  %y = mul i32 %x, 2
+  ret i32 %y
+}
+
+define i32 @big(i32 %x) {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  ret i32 %c
+}
+
+define internal i32 @local() {
+  ret i32 1
+}
+
+define i32 @uses_local() {
+  %x = call i32 @local()
+  ret i32 %x
+}
+
+define i32 @cold() cold {
+  ret i32 2
+}
+
+define i32 @reads_gv() {
+  %x = load i32, i32* @gv
+  ret i32 %x
+}
+
+define linkonce_odr i32 @odr() {
+  ret i32 3
+}
+
+define weak i32 @weak() {
+  ret i32 4
+}
+
+define internal void @ctor() {
+  store i32 1, i32* @gv
+  ret void
+}
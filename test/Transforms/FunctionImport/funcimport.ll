@@ -0,0 +1,58 @@
+; RUN: llvm-as -function-summary %s -o %t.bc
+; RUN: llvm-as -function-summary %p/Inputs/funcimport.ll -o %t2.bc
+; RUN: llvm-lto -thinlto -o %t3.bc %t.bc %t2.bc
+; RUN: opt -function-import -summary-file %t3.bc -import-instr-limit=3 %t.bc -S > %t.ll
+; RUN: FileCheck %s < %t.ll
+; RUN: FileCheck %s -check-prefix=NOSRC < %t.ll
+; RUN: cp %t2.bc %t4.bc
+; RUN: llvm-lto -thinlto -o %t5.bc %t.bc %t4.bc
+; RUN: rm %t4.bc
+; RUN: not opt -function-import -summary-file %t5.bc %t.bc -o /dev/null 2>&1 | FileCheck %s -check-prefix=NOFILE
+
+; NOFILE: error loading file '{{.*}}4.bc'
+
+; Small functions are imported without being emitted, along with the small
+; functions they call.
+; CHECK-DAG: define available_externally i32 @small(i32 %x)
+; CHECK-DAG: define available_externally i32 @leaf(i32 %x)
+
+; A linkonce_odr function may not be emitted by its own module.
+; CHECK-DAG: define linkonce_odr i32 @odr()
+
+; The variables of the source module become declarations.
+; CHECK-DAG: define available_externally i32 @reads_gv()
+; CHECK-DAG: @gv = external global i32
+
+; Functions that are too big, cold, refer to local values or may be
+; overridden are not imported.
+; CHECK-DAG: declare i32 @big(i32)
+; CHECK-DAG: declare i32 @uses_local()
+; CHECK-DAG: declare i32 @cold()
+; CHECK-DAG: declare i32 @weak()
+
+; Nothing else comes from the source module.
+; NOSRC-NOT: @local
+; NOSRC-NOT: @ctor
+; NOSRC-NOT: @llvm.global_ctors
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  %a = call i32 @small(i32 1)
+  %b = call i32 @big(i32 %a)
+  %c = call i32 @uses_local()
+  %d = call i32 @cold()
+  %e = call i32 @reads_gv()
+  %f = call i32 @odr()
+  %g = call i32 @weak()
+  ret i32 %g
+}
+
+declare i32 @small(i32)
+declare i32 @big(i32)
+declare i32 @uses_local()
+declare i32 @cold()
+declare i32 @reads_gv()
+declare i32 @odr()
+declare i32 @weak()
@@ -0,0 +1,27 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: %gold -plugin %llvmshlibdir/LLVMgold.so -u foo -u bar \
+; RUN:    -plugin-opt=jobs=2 -plugin-opt=obj-path=%t.o \
+; RUN:    -m elf_x86_64 -r -o %t %t.bc
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-nm %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = global i32 0
+
+; CHECK0-NOT: bar
+; CHECK0: T foo
+; CHECK0-NOT: bar
+define void @foo() {
+  store volatile i32 1, i32* @g
+  store volatile i32 2, i32* @g
+  ret void
+}
+
+; CHECK1-NOT: foo
+; CHECK1: T bar
+; CHECK1-NOT: foo
+define void @bar() {
+  store volatile i32 3, i32* @g
+  ret void
+}
@@ -0,0 +1,22 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Aliases are emitted into the partition of their aliasee; the other
+; partitions refer to them through declarations.
+
+; CHECK0-DAG: @afoo = external global [2 x i8*]
+; CHECK1-DAG: @afoo = alias [2 x i8*]* @foo
+@afoo = alias [2 x i8*]* @foo
+
+; CHECK0-DAG: @abar = alias void ()* @bar
+; CHECK1-DAG: declare void @abar()
+@abar = alias void ()* @bar
+
+@foo = global [2 x i8*] [i8* bitcast (void ()* @bar to i8*), i8* bitcast (void ()* @abar to i8*)]
+
+define void @bar() {
+  store [2 x i8*] zeroinitializer, [2 x i8*]* @foo
+  store [2 x i8*] zeroinitializer, [2 x i8*]* @afoo
+  ret void
+}
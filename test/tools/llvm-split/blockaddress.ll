@@ -0,0 +1,23 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; A blockaddress can only refer to a function of the same module, so its user
+; is emitted into the partition of the function.
+
+; CHECK0: define i8* @foo()
+; CHECK0: define i8* @bar()
+; CHECK1: declare i8* @foo()
+; CHECK1: declare i8* @bar()
+define i8* @foo() {
+entry:
+  br label %target
+
+target:
+  ret i8* blockaddress(@foo, %target)
+}
+
+define i8* @bar() {
+  %a = call i8* @foo()
+  ret i8* blockaddress(@foo, %target)
+}
@@ -0,0 +1,29 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; All members of a comdat are emitted into the same partition, and keep their
+; comdat there.
+
+$foo = comdat any
+
+; CHECK0: define void @foo() comdat
+; CHECK1: declare void @foo()
+define void @foo() comdat {
+  call void @bar()
+  ret void
+}
+
+; CHECK0: define void @bar() comdat($foo)
+; CHECK1: declare void @bar()
+define void @bar() comdat($foo) {
+  call void @foo()
+  ret void
+}
+
+; CHECK0: declare void @baz()
+; CHECK1: define void @baz()
+define void @baz() {
+  call void @foo()
+  ret void
+}
@@ -0,0 +1,26 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Appending globals such as llvm.global_ctors are only emitted into the first
+; partition. The constructors they refer to may live in other partitions.
+
+; CHECK0: @llvm.global_ctors = appending global {{.*}} @ctor1.llvm.split {{.*}} @ctor2.llvm.split
+; CHECK0: define hidden void @ctor1.llvm.split()
+; CHECK0: declare hidden void @ctor2.llvm.split()
+; CHECK1-NOT: @llvm.global_ctors
+; CHECK1: declare hidden void @ctor1.llvm.split()
+; CHECK1: define hidden void @ctor2.llvm.split()
+@llvm.global_ctors = appending global [2 x { i32, void ()* }] [{ i32, void ()* } { i32 65535, void ()* @ctor1 }, { i32, void ()* } { i32 65535, void ()* @ctor2 }]
+
+define internal void @ctor1() {
+  call void @ctor2()
+  call void @ctor2()
+  ret void
+}
+
+define internal void @ctor2() {
+  call void @ctor1()
+  call void @ctor1()
+  ret void
+}
@@ -0,0 +1,27 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Each function is defined in exactly one partition and declared in the
+; others. Partitions are balanced by size, so the two big functions are
+; emitted into different partitions.
+
+; CHECK0: define i32 @foo()
+; CHECK1: declare i32 @foo()
+define i32 @foo() {
+  %a = call i32 @bar()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  %d = add i32 %c, 3
+  ret i32 %d
+}
+
+; CHECK0: declare i32 @bar()
+; CHECK1: define i32 @bar()
+define i32 @bar() {
+  %a = call i32 @foo()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  %d = add i32 %c, 3
+  ret i32 %d
+}
@@ -0,0 +1,34 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; A local symbol referenced from another partition is promoted to a hidden
+; symbol with a unique name.
+
+; CHECK0: define i32 @foo()
+; CHECK0: define hidden i32 @helper.llvm.split()
+; CHECK1: declare i32 @foo()
+; CHECK1: declare hidden i32 @helper.llvm.split()
+define i32 @foo() {
+  %a = call i32 @helper()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  %d = add i32 %c, 3
+  ret i32 %d
+}
+
+define internal i32 @helper() {
+  %a = add i32 0, 1
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+; CHECK0: declare i32 @bar()
+; CHECK1: define i32 @bar()
+define i32 @bar() {
+  %a = call i32 @helper()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  %d = add i32 %c, 3
+  ret i32 %d
+}
@@ -0,0 +1,36 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Small callees are kept in the partition of their caller, so their local
+; linkage is preserved.
+
+; CHECK0: define i32 @foo()
+; CHECK1: declare i32 @foo()
+define i32 @foo() {
+  %a = call i32 @foohelper()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  ret i32 %c
+}
+
+; CHECK0: define internal i32 @foohelper()
+; CHECK1-NOT: @foohelper
+define internal i32 @foohelper() {
+  ret i32 1
+}
+
+; CHECK0: declare i32 @bar()
+; CHECK1: define i32 @bar()
+define i32 @bar() {
+  %a = call i32 @barhelper()
+  %b = add i32 %a, 1
+  %c = add i32 %b, 2
+  ret i32 %c
+}
+
+; CHECK0-NOT: @barhelper
+; CHECK1: define internal i32 @barhelper()
+define internal i32 @barhelper() {
+  ret i32 2
+}
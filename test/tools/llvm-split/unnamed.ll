@@ -0,0 +1,24 @@
+; RUN: llvm-split -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; Unnamed globals are given names so that they can be referenced from other
+; partitions.
+
+; CHECK0: define hidden void @__llvmsplit_unnamed.llvm.split()
+; CHECK0: declare hidden void @__llvmsplit_unnamed1.llvm.split()
+; CHECK1: declare hidden void @__llvmsplit_unnamed.llvm.split()
+; CHECK1: define hidden void @__llvmsplit_unnamed1.llvm.split()
+define internal void @0() {
+  call void @1()
+  call void @1()
+  call void @1()
+  ret void
+}
+
+define internal void @1() {
+  call void @0()
+  call void @0()
+  call void @0()
+  ret void
+}
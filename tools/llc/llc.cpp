@@ -16,10 +16,12 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/CodeGen/LinkAllAsmWriterComponents.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LLVMContext.h"
@@ -31,6 +33,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/Host.h"
@@ -45,6 +48,7 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
 #include <memory>
+#include <vector>
 using namespace llvm;
 
 // General options for llc.  Other pass-specific options are specified
@@ -62,6 +66,12 @@ TimeCompilations("time-compilations", cl::Hidden, cl::init(1u),
                  cl::value_desc("N"),
                  cl::desc("Repeat compilation N times for timing"));
 
+static cl::opt<unsigned>
+Parallelism("j", cl::Prefix, cl::init(1),
+            cl::desc("Number of code generation threads; with N > 1, the "
+                     "module is split into N partitions written to "
+                     "<output>.0 ... <output>.N-1"));
+
 static cl::opt<bool>
 NoIntegratedAssembler("no-integrated-as", cl::Hidden,
                       cl::desc("Disable integrated assembler"));
@@ -96,10 +106,10 @@ static cl::opt<bool> AsmVerbose("asm-verbose",
                                 cl::init(true));
 
 static int compileModule(char **, LLVMContext &);
+static int compileModuleInParallel(char **, Module &, const TargetMachine &,
+                                   const Triple &);
 
-static std::unique_ptr<tool_output_file>
-GetOutputStream(const char *TargetName, Triple::OSType OS,
-                const char *ProgName) {
+static void ComputeOutputFilename(const char *TargetName, Triple::OSType OS) {
   // If we don't yet have an output filename, make one.
   if (OutputFilename.empty()) {
     if (InputFilename == "-")
@@ -136,6 +146,12 @@ GetOutputStream(const char *TargetName, Triple::OSType OS,
       }
     }
   }
+}
+
+static std::unique_ptr<tool_output_file>
+GetOutputStream(const char *TargetName, Triple::OSType OS,
+                const char *ProgName, StringRef Suffix = "") {
+  ComputeOutputFilename(TargetName, OS);
 
   // Decide if we need "binary" output.
   bool Binary = false;
@@ -153,8 +169,8 @@ GetOutputStream(const char *TargetName, Triple::OSType OS,
   sys::fs::OpenFlags OpenFlags = sys::fs::F_None;
   if (!Binary)
     OpenFlags |= sys::fs::F_Text;
-  auto FDOut = llvm::make_unique<tool_output_file>(OutputFilename, EC,
-                                                   OpenFlags);
+  std::string Filename = OutputFilename + Suffix.str();
+  auto FDOut = llvm::make_unique<tool_output_file>(Filename, EC, OpenFlags);
   if (EC) {
     errs() << EC.message() << '\n';
     return nullptr;
@@ -309,10 +325,24 @@ static int compileModule(char **argv, LLVMContext &Context) {
   if (GenerateSoftFloatCalls)
     FloatABIForCalls = FloatABI::Soft;
 
-  // Figure out where we are going to send the output.
-  std::unique_ptr<tool_output_file> Out =
-      GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0]);
-  if (!Out) return 1;
+  if (Parallelism != 1)
+    return compileModuleInParallel(argv, *M, *Target, TheTriple);
+
+  // Figure out where we are going to send the output. Object files are
+  // written in place into a memory mapped file when the output can be mapped.
+  ComputeOutputFilename(TheTarget->getName(), TheTriple.getOS());
+  std::unique_ptr<raw_mapped_file_ostream> MappedOut;
+  std::unique_ptr<tool_output_file> Out;
+  raw_pwrite_stream *OutOS;
+  if (FileType == TargetMachine::CGFT_ObjectFile && OutputFilename != "-" &&
+      raw_mapped_file_ostream::isMappable(OutputFilename)) {
+    MappedOut = llvm::make_unique<raw_mapped_file_ostream>(OutputFilename);
+    OutOS = MappedOut.get();
+  } else {
+    Out = GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0]);
+    if (!Out) return 1;
+    OutOS = &Out->os();
+  }
 
   // Build up all of the passes that we want to do to the module.
   legacy::PassManager PM;
@@ -335,9 +365,9 @@ static int compileModule(char **argv, LLVMContext &Context) {
              << ": warning: ignoring -mc-relax-all because filetype != obj";
 
   {
-    raw_pwrite_stream *OS = &Out->os();
+    raw_pwrite_stream *OS = OutOS;
     std::unique_ptr<buffer_ostream> BOS;
-    if (FileType != TargetMachine::CGFT_AssemblyFile &&
+    if (FileType != TargetMachine::CGFT_AssemblyFile && Out &&
         !Out->os().supportsSeeking()) {
       BOS = make_unique<buffer_ostream>(*OS);
       OS = BOS.get();
@@ -377,8 +407,70 @@ static int compileModule(char **argv, LLVMContext &Context) {
     PM.run(*M);
   }
 
+  if (MappedOut) {
+    if (std::error_code EC = MappedOut->commit()) {
+      errs() << argv[0] << ": " << OutputFilename << ": " << EC.message()
+             << '\n';
+      return 1;
+    }
+  } else {
+    // Declare success.
+    Out->keep();
+  }
+
+  return 0;
+}
+
+/// Split M into partitions, generate code for each of them on its own thread
+/// and write each partition to its own output file.
+static int compileModuleInParallel(char **argv, Module &M,
+                                   const TargetMachine &Target,
+                                   const Triple &TheTriple) {
+  if (Parallelism == 0) {
+    errs() << argv[0] << ": number of code generation threads must be at "
+           << "least 1\n";
+    return 1;
+  }
+  // The partitions are compiled by fresh pass managers, which cannot stop or
+  // resume the pipeline, nor use a custom TargetLibraryInfo.
+  if (!StartAfter.empty() || !StopAfter.empty() || DisableSimplifyLibCalls) {
+    errs() << argv[0] << ": -start-after, -stop-after and "
+           << "-disable-simplify-libcalls cannot be used with -j\n";
+    return 1;
+  }
+  if (OutputFilename == "-" ||
+      (OutputFilename.empty() && InputFilename == "-")) {
+    errs() << argv[0] << ": -j requires an output file\n";
+    return 1;
+  }
+
+  // Add the target data from the target machine, if it exists, or the module.
+  if (const DataLayout *DL = Target.getDataLayout())
+    M.setDataLayout(*DL);
+
+  std::vector<std::unique_ptr<tool_output_file>> Outs;
+  std::vector<raw_pwrite_stream *> OSs;
+  for (unsigned I = 0; I != Parallelism; ++I) {
+    Outs.push_back(GetOutputStream(Target.getTarget().getName(),
+                                   TheTriple.getOS(), argv[0],
+                                   "." + utostr(I)));
+    if (!Outs.back())
+      return 1;
+    OSs.push_back(&Outs.back()->os());
+  }
+
+  // Before executing passes, print the final values of the LLVM options.
+  cl::PrintOptionValues();
+
+  if (splitCodeGen(M, OSs, Target, FileType)) {
+    errs() << argv[0] << ": target does not support generation of this"
+           << " file type!\n";
+    return 1;
+  }
+
   // Declare success.
-  Out->keep();
+  for (auto &Out : Outs)
+    Out->keep();
 
   return 0;
 }
@@ -39,6 +39,12 @@ namespace {
                                              "working directory. (WARNING: "
                                              "will overwrite existing files)."),
                                   clEnumValEnd));
+
+  cl::opt<bool> OrcBackgroundCompile("orc-lazy-background-compile",
+                                     cl::desc("Compile the functions that a "
+                                              "compiled function refers to on "
+                                              "a background thread."),
+                                     cl::init(false));
 }
 
 OrcLazyJIT::CallbackManagerBuilder
@@ -131,7 +137,8 @@ int llvm::runOrcLazyJIT(std::unique_ptr<Module> M, int ArgC, char* ArgV[]) {
   }
 
   // Everything looks good. Build the JIT.
-  OrcLazyJIT J(std::move(TM), Context, CallbackMgrBuilder);
+  OrcLazyJIT J(std::move(TM), Context, CallbackMgrBuilder,
+               OrcBackgroundCompile);
 
   // Add the module, look up main and run it.
   auto MainHandle = J.addModule(std::move(M));
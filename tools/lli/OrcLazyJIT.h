@@ -51,7 +51,8 @@ public:
   static CallbackManagerBuilder createCallbackManagerBuilder(Triple T);
 
   OrcLazyJIT(std::unique_ptr<TargetMachine> TM, LLVMContext &Context,
-             CallbackManagerBuilder &BuildCallbackMgr)
+             CallbackManagerBuilder &BuildCallbackMgr,
+             bool CompileInBackground = false)
     : TM(std::move(TM)),
       Mang(this->TM->getDataLayout()),
       ObjectLayer(),
@@ -59,7 +60,7 @@ public:
       IRDumpLayer(CompileLayer, createDebugDumper()),
       LazyEmitLayer(IRDumpLayer),
       CCMgr(BuildCallbackMgr(IRDumpLayer, CCMgrMemMgr, Context)),
-      CODLayer(LazyEmitLayer, *CCMgr),
+      CODLayer(LazyEmitLayer, *CCMgr, CompileInBackground),
       CXXRuntimeOverrides([this](const std::string &S) { return mangle(S); }) {}
 
   ~OrcLazyJIT() {
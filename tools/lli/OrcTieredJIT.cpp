@@ -0,0 +1,486 @@
+//===--- OrcTieredJIT.cpp - Orc-based JIT with hot function recompilation -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTieredJIT.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Analysis/CFG.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+using namespace llvm;
+
+namespace {
+
+  cl::opt<unsigned> OrcTieredThreshold("orc-tiered-threshold",
+                                       cl::desc("Number of calls plus loop "
+                                                "iterations after which a "
+                                                "function is recompiled with "
+                                                "optimization."),
+                                       cl::init(1000));
+
+  cl::opt<bool> OrcTieredBackground("orc-tiered-background",
+                                    cl::desc("Recompile hot functions on a "
+                                             "background thread."),
+                                    cl::init(true));
+
+  cl::opt<bool> OrcTieredDebug("orc-tiered-debug",
+                               cl::desc("Print the names of the functions "
+                                        "recompiled by the orc-tiered JIT."),
+                               cl::init(false));
+
+  const char *HotCallbackName = "__orc_tiered_hot";
+  const char *AddrSuffix = "$orc_addr";
+  const char *BodySuffix = "$orc_body";
+  const char *Tier2Suffix = "$orc_tier2";
+}
+
+// Give every symbol in M external linkage, so that the recompiled functions,
+// which live in modules of their own, can refer to them by name. Local
+// symbols are hidden, and renamed if their names are not usable as symbols.
+static void externalizeSymbols(Module &M) {
+  unsigned NextID = 0;
+  auto Externalize = [&](GlobalValue &GV) {
+    if (GV.getName().startswith("llvm."))
+      return;
+    if (GV.hasLocalLinkage()) {
+      if (!GV.hasName() || GV.getName().startswith("\01L"))
+        GV.setName("__orc_tiered_anon" + Twine(NextID++));
+      GV.setLinkage(GlobalValue::ExternalLinkage);
+      GV.setVisibility(GlobalValue::HiddenVisibility);
+    } else if (!GV.isDeclaration() && !GV.hasAvailableExternallyLinkage() &&
+               !GV.hasCommonLinkage() && !GV.hasAppendingLinkage())
+      GV.setLinkage(GlobalValue::ExternalLinkage);
+  };
+
+  for (auto &F : M) {
+    Externalize(F);
+    F.setComdat(nullptr);
+  }
+  for (auto &GV : M.globals()) {
+    Externalize(GV);
+    GV.setComdat(nullptr);
+  }
+  for (auto &A : M.aliases())
+    Externalize(A);
+}
+
+// Move the body of F into a new function, and turn F into a stub that calls
+// the body through a function pointer.
+static Function *splitOffBody(Function &F) {
+  Module &M = *F.getParent();
+  std::string Name = F.getName();
+  Function *Body = Function::Create(F.getFunctionType(),
+                                    GlobalValue::ExternalLinkage,
+                                    Name + BodySuffix, &M);
+  Body->copyAttributesFrom(&F);
+  Body->setVisibility(GlobalValue::HiddenVisibility);
+  Body->getBasicBlockList().splice(Body->begin(), F.getBasicBlockList());
+  auto BodyArg = Body->arg_begin();
+  for (auto &Arg : F.args()) {
+    Arg.replaceAllUsesWith(BodyArg);
+    BodyArg->takeName(&Arg);
+    ++BodyArg;
+  }
+
+  GlobalVariable *ImplPointer =
+    orc::createImplPointer(*F.getType(), M, Name + AddrSuffix, Body);
+  orc::makeStub(F, *ImplPointer);
+  return Body;
+}
+
+// Count the calls to Body and the iterations of its loops, and call Callback
+// with the JIT and ID when the count reaches Threshold.
+static void insertCounters(Function &Body, uint32_t ID, unsigned Threshold,
+                           Constant *JIT, Function &Callback) {
+  Module &M = *Body.getParent();
+  Type *Int32Ty = Type::getInt32Ty(M.getContext());
+  GlobalVariable *Counter =
+    new GlobalVariable(M, Int32Ty, false, GlobalValue::InternalLinkage,
+                       ConstantInt::get(Int32Ty, 0),
+                       Body.getName() + ".count");
+
+  SmallVector<std::pair<const BasicBlock *, const BasicBlock *>, 8> Backedges;
+  FindFunctionBackedges(Body, Backedges);
+  SmallSetVector<BasicBlock *, 8> Headers;
+  Headers.insert(&Body.getEntryBlock());
+  for (auto &Edge : Backedges)
+    Headers.insert(const_cast<BasicBlock *>(Edge.second));
+
+  for (BasicBlock *BB : Headers) {
+    // Keep the static allocas in the entry block.
+    BasicBlock::iterator InsertPt = BB->getFirstInsertionPt();
+    while (isa<AllocaInst>(InsertPt))
+      ++InsertPt;
+    IRBuilder<> Builder(InsertPt);
+    // The program may run the function on several threads at once, so bump
+    // the counter atomically; exactly one of them then sees the threshold.
+    Value *One = ConstantInt::get(Int32Ty, 1);
+    Value *Count = Builder.CreateAdd(
+        Builder.CreateAtomicRMW(AtomicRMWInst::Add, Counter, One, Monotonic),
+        One);
+    Value *IsHot =
+      Builder.CreateICmpEQ(Count, ConstantInt::get(Int32Ty, Threshold));
+    TerminatorInst *Then =
+      SplitBlockAndInsertIfThen(IsHot, InsertPt, false);
+    Value *Args[] = { JIT, ConstantInt::get(Int32Ty, ID) };
+    IRBuilder<>(Then).CreateCall(&Callback, Args);
+  }
+}
+
+OrcTieredJIT::OrcTieredJIT(std::unique_ptr<TargetMachine> Tier1TM,
+                           std::unique_ptr<TargetMachine> Tier2TM,
+                           unsigned Tier2OptLevel, unsigned HotThreshold,
+                           bool Background)
+    : Tier1TM(std::move(Tier1TM)), Tier2TM(std::move(Tier2TM)),
+      Mang(this->Tier1TM->getDataLayout()), Tier2OptLevel(Tier2OptLevel),
+      HotThreshold(HotThreshold),
+      Tier1Layer(ObjectLayer, orc::SimpleCompiler(*this->Tier1TM)),
+      Tier2Layer(ObjectLayer, orc::SimpleCompiler(*this->Tier2TM)),
+      CXXRuntimeOverrides([this](const std::string &S) { return mangle(S); }),
+      CompileInBackground(false), StopWorker(false) {
+#if LLVM_ENABLE_THREADS
+  if (Background) {
+    CompileInBackground = true;
+    Worker = std::thread([this]() { runWorker(); });
+  }
+#endif
+}
+
+OrcTieredJIT::~OrcTieredJIT() {
+  // Stop recompiling before running the destructors; pending requests are
+  // dropped.
+  if (Worker.joinable()) {
+    {
+      std::lock_guard<std::mutex> Lock(QueueMutex);
+      StopWorker = true;
+    }
+    QueueChanged.notify_one();
+    Worker.join();
+  }
+  // Run any destructors registered with __cxa_atexit.
+  CXXRuntimeOverrides.runDestructors();
+  // Run any IR destructors.
+  for (auto &DtorRunner : IRStaticDestructorRunners)
+    DtorRunner.runViaLayer(*this);
+}
+
+OrcTieredJIT::ModuleSetHandleT
+OrcTieredJIT::addModule(std::unique_ptr<Module> M) {
+  std::vector<std::string> CtorNames, DtorNames;
+  ModuleSetHandleT H;
+  {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+
+    // Attach a data-layout if one isn't already present.
+    if (M->getDataLayout().isDefault())
+      M->setDataLayout(*Tier1TM->getDataLayout());
+
+    externalizeSymbols(*M);
+
+    // Record the static constructors and destructors. We have to do this
+    // before we hand over ownership of the module to the JIT.
+    for (auto Ctor : orc::getConstructors(*M))
+      CtorNames.push_back(mangle(Ctor.Func->getName()));
+    for (auto Dtor : orc::getDestructors(*M))
+      DtorNames.push_back(mangle(Dtor.Func->getName()));
+
+    // Keep an uninstrumented copy of the module to recompile hot functions
+    // from.
+    SourceModules.push_back(std::unique_ptr<Module>(CloneModule(M.get())));
+    const Module *Source = SourceModules.back().get();
+
+    // Functions that can't be called through a simple stub are only compiled
+    // once.
+    std::vector<Function *> Tiered;
+    for (auto &F : *M)
+      if (!F.isDeclaration() && !F.hasAvailableExternallyLinkage() &&
+          !F.isVarArg() && F.getCallingConv() == CallingConv::C)
+        Tiered.push_back(&F);
+
+    LLVMContext &Context = M->getContext();
+    Type *VoidTy = Type::getVoidTy(Context);
+    Type *Int8PtrTy = Type::getInt8PtrTy(Context);
+    Type *Int32Ty = Type::getInt32Ty(Context);
+    Type *CallbackArgs[] = { Int8PtrTy, Int32Ty };
+    Function *Callback =
+      Function::Create(FunctionType::get(VoidTy, CallbackArgs, false),
+                       GlobalValue::ExternalLinkage, HotCallbackName, M.get());
+    uint64_t JITAddr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
+    Constant *JIT = ConstantExpr::getIntToPtr(
+        ConstantInt::get(Type::getInt64Ty(Context), JITAddr), Int8PtrTy);
+
+    std::vector<std::string> Names;
+    for (Function *F : Tiered) {
+      uint32_t ID = Functions.size() + Names.size();
+      Names.push_back(F->getName());
+      Function *Body = splitOffBody(*F);
+      insertCounters(*Body, ID, HotThreshold, JIT, *Callback);
+    }
+
+    // Symbol resolution order:
+    //   1) Search the JIT symbols.
+    //   2) Check for C++ runtime overrides.
+    //   3) Search the host process (LLI)'s symbol table.
+    auto Resolver =
+      orc::createLambdaResolver(
+        [this](const std::string &Name) { return findExternalSymbol(Name); },
+        [](const std::string &Name) { return RuntimeDyld::SymbolInfo(nullptr); }
+      );
+
+    std::vector<std::unique_ptr<Module>> S;
+    S.push_back(std::move(M));
+    H = Tier1Layer.addModuleSet(std::move(S),
+                                make_unique<SectionMemoryManager>(),
+                                std::move(Resolver));
+
+    for (auto &Name : Names)
+      Functions.push_back(TieredFunction(std::move(Name), Source, H));
+    std::lock_guard<std::mutex> QueueLock(QueueMutex);
+    Requested.resize(Functions.size(), false);
+  }
+
+  // Run the static constructors, and save the static destructor runner for
+  // execution when the JIT is torn down.
+  orc::CtorDtorRunner<OrcTieredJIT> CtorRunner(std::move(CtorNames), H);
+  CtorRunner.runViaLayer(*this);
+
+  IRStaticDestructorRunners.push_back(
+      orc::CtorDtorRunner<OrcTieredJIT>(std::move(DtorNames), H));
+
+  return H;
+}
+
+orc::JITSymbol OrcTieredJIT::findSymbolIn(ModuleSetHandleT H,
+                                          const std::string &Name,
+                                          bool ExportedSymbolsOnly) {
+  // Resolve the address while holding the lock: getting it may finalize the
+  // module set.
+  std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+  if (auto Sym = Tier1Layer.findSymbolIn(H, Name, ExportedSymbolsOnly))
+    return orc::JITSymbol(Sym.getAddress(), Sym.getFlags());
+  return nullptr;
+}
+
+RuntimeDyld::SymbolInfo
+OrcTieredJIT::findExternalSymbol(const std::string &Name) {
+  if (Name == mangle(HotCallbackName))
+    return RuntimeDyld::SymbolInfo(
+        static_cast<orc::TargetAddress>(
+            reinterpret_cast<uintptr_t>(&hotFunctionCallback)),
+        JITSymbolFlags::Exported);
+
+  if (auto Sym = ObjectLayer.findSymbol(Name, true))
+    return RuntimeDyld::SymbolInfo(Sym.getAddress(), Sym.getFlags());
+
+  if (auto Sym = CXXRuntimeOverrides.searchOverrides(Name))
+    return Sym;
+
+  if (auto Addr = RTDyldMemoryManager::getSymbolAddressInProcess(Name))
+    return RuntimeDyld::SymbolInfo(Addr, JITSymbolFlags::Exported);
+
+  return RuntimeDyld::SymbolInfo(nullptr);
+}
+
+void OrcTieredJIT::hotFunctionCallback(OrcTieredJIT *J, uint32_t ID) {
+  J->requestRecompile(ID);
+}
+
+void OrcTieredJIT::requestRecompile(uint32_t ID) {
+  {
+    std::lock_guard<std::mutex> Lock(QueueMutex);
+    if (Requested[ID])
+      return;
+    Requested[ID] = true;
+    if (CompileInBackground) {
+      if (!StopWorker) {
+        Queue.push_back(ID);
+        QueueChanged.notify_one();
+      }
+      return;
+    }
+  }
+  recompile(ID);
+}
+
+void OrcTieredJIT::runWorker() {
+  while (true) {
+    uint32_t ID;
+    {
+      std::unique_lock<std::mutex> Lock(QueueMutex);
+      QueueChanged.wait(Lock,
+                        [this]() { return StopWorker || !Queue.empty(); });
+      if (StopWorker)
+        return;
+      ID = Queue.front();
+      Queue.pop_front();
+    }
+    recompile(ID);
+  }
+}
+
+std::unique_ptr<Module>
+OrcTieredJIT::buildTier2Module(const TieredFunction &TF) {
+  std::unique_ptr<Module> M(CloneModule(TF.Source));
+  Function *F = M->getFunction(TF.Name);
+  assert(F && "Hot function is not in its source module.");
+  F->setName(TF.Name + Tier2Suffix);
+
+  // The other functions are only available for inlining; calls that are not
+  // inlined go through the stubs of the tier-1 module, and so reach the
+  // recompiled version of the callee once there is one. Constant globals are
+  // kept for folding; every other global becomes a reference to the tier-1
+  // definition.
+  for (auto &G : *M)
+    if (&G != F && !G.isDeclaration())
+      G.setLinkage(GlobalValue::AvailableExternallyLinkage);
+
+  std::vector<GlobalVariable *> Appending;
+  for (auto &GV : M->globals()) {
+    if (GV.hasAppendingLinkage())
+      Appending.push_back(&GV);
+    else if (GV.isDeclaration())
+      continue;
+    else if (GV.isConstant() && !GV.hasCommonLinkage())
+      GV.setLinkage(GlobalValue::AvailableExternallyLinkage);
+    else {
+      GV.setInitializer(nullptr);
+      GV.setLinkage(GlobalValue::ExternalLinkage);
+    }
+  }
+  for (GlobalVariable *GV : Appending)
+    GV->eraseFromParent();
+
+  // Aliases can't point at available_externally definitions, so replace them
+  // with declarations of the symbols they define.
+  while (!M->alias_empty()) {
+    GlobalAlias &A = *M->alias_begin();
+    GlobalValue *Decl;
+    if (auto *FT = dyn_cast<FunctionType>(A.getType()->getElementType()))
+      Decl = Function::Create(FT, GlobalValue::ExternalLinkage, "", M.get());
+    else
+      Decl = new GlobalVariable(*M, A.getType()->getElementType(), false,
+                                GlobalValue::ExternalLinkage, nullptr);
+    Decl->takeName(&A);
+    A.replaceAllUsesWith(ConstantExpr::getBitCast(Decl, A.getType()));
+    A.eraseFromParent();
+  }
+
+  legacy::FunctionPassManager FPM(M.get());
+  legacy::PassManager MPM;
+  FPM.add(createTargetTransformInfoWrapperPass(Tier2TM->getTargetIRAnalysis()));
+  MPM.add(createTargetTransformInfoWrapperPass(Tier2TM->getTargetIRAnalysis()));
+
+  PassManagerBuilder Builder;
+  Builder.OptLevel = Tier2OptLevel;
+  if (Tier2OptLevel > 1)
+    Builder.Inliner = createFunctionInliningPass(Tier2OptLevel, 0);
+  else
+    Builder.Inliner = createAlwaysInlinerPass();
+  Builder.LoopVectorize = Tier2OptLevel > 1;
+  Builder.SLPVectorize = Tier2OptLevel > 1;
+  Builder.populateFunctionPassManager(FPM);
+  Builder.populateModulePassManager(MPM);
+
+  FPM.doInitialization();
+  FPM.run(*F);
+  FPM.doFinalization();
+  MPM.run(*M);
+
+  return M;
+}
+
+void OrcTieredJIT::recompile(uint32_t ID) {
+  std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+  const TieredFunction &TF = Functions[ID];
+  ModuleSetHandleT Tier1H = TF.Tier1H;
+
+  // Resolve the hidden symbols of the tier-1 module first.
+  auto Resolver =
+    orc::createLambdaResolver(
+      [this, Tier1H](const std::string &Name) {
+        if (auto Sym = ObjectLayer.findSymbolIn(Tier1H, Name, false))
+          return RuntimeDyld::SymbolInfo(Sym.getAddress(), Sym.getFlags());
+        return findExternalSymbol(Name);
+      },
+      [](const std::string &Name) { return RuntimeDyld::SymbolInfo(nullptr); }
+    );
+
+  std::vector<std::unique_ptr<Module>> S;
+  S.push_back(buildTier2Module(TF));
+  auto H = Tier2Layer.addModuleSet(std::move(S),
+                                   make_unique<SectionMemoryManager>(),
+                                   std::move(Resolver));
+
+  auto Sym = Tier2Layer.findSymbolIn(H, mangle(TF.Name + Tier2Suffix), false);
+  assert(Sym && "Recompiled function is missing.");
+  orc::getLocalFPUpdater(Tier1Layer, Tier1H, mangle(TF.Name + AddrSuffix))(
+      Sym.getAddress());
+
+  if (OrcTieredDebug)
+    errs() << "orc-tiered: recompiled '" << TF.Name << "'\n";
+}
+
+std::string OrcTieredJIT::mangle(const std::string &Name) {
+  std::string MangledName;
+  {
+    raw_string_ostream MangledNameStream(MangledName);
+    Mang.getNameWithPrefix(MangledNameStream, Name);
+  }
+  return MangledName;
+}
+
+int llvm::runOrcTieredJIT(std::unique_ptr<Module> M, unsigned OptLevel,
+                          int ArgC, char* ArgV[]) {
+  // Add the program's symbols into the JIT's search space.
+  if (sys::DynamicLibrary::LoadLibraryPermanently(nullptr)) {
+    errs() << "Error loading program symbols.\n";
+    return 1;
+  }
+
+  // Compile everything with FastISel first, and hot functions at the
+  // requested optimization level.
+  static const CodeGenOpt::Level CodeGenLevels[] = {
+    CodeGenOpt::None, CodeGenOpt::Less, CodeGenOpt::Default,
+    CodeGenOpt::Aggressive
+  };
+  std::unique_ptr<TargetMachine> Tier1TM(
+      EngineBuilder().setOptLevel(CodeGenOpt::None).selectTarget());
+  Tier1TM->setFastISel(true);
+  std::unique_ptr<TargetMachine> Tier2TM(
+      EngineBuilder().setOptLevel(CodeGenLevels[OptLevel]).selectTarget());
+
+  OrcTieredJIT J(std::move(Tier1TM), std::move(Tier2TM), OptLevel,
+                 OrcTieredThreshold, OrcTieredBackground);
+
+  // Add the module, look up main and run it.
+  auto MainHandle = J.addModule(std::move(M));
+  auto MainSym = J.findSymbolIn(MainHandle, "main");
+
+  if (!MainSym) {
+    errs() << "Could not find main function.\n";
+    return 1;
+  }
+
+  typedef int (*MainFnPtr)(int, char*[]);
+  auto Main = OrcTieredJIT::fromTargetAddress<MainFnPtr>(MainSym.getAddress());
+  return Main(ArgC, ArgV);
+}
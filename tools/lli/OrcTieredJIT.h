@@ -0,0 +1,134 @@
+//===--- OrcTieredJIT.h - Orc-based JIT with hot function recompilation ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Tiered Orc-based JIT. Modules are first compiled quickly at -O0 with counters
+// on function entries and loop headers. Functions whose counters reach a
+// threshold are recompiled with optimization, and their stubs are pointed at
+// the new code.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLI_ORCTIEREDJIT_H
+#define LLVM_TOOLS_LLI_ORCTIEREDJIT_H
+
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/IR/Mangler.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace llvm {
+
+class OrcTieredJIT {
+public:
+
+  typedef orc::ObjectLinkingLayer<> ObjLayerT;
+  typedef orc::IRCompileLayer<ObjLayerT> CompileLayerT;
+  typedef CompileLayerT::ModuleSetHandleT ModuleSetHandleT;
+
+  /// @brief Construct a tiered JIT.
+  /// @param Tier1TM Target machine for the initial, unoptimized compile.
+  /// @param Tier2TM Target machine for the recompilation of hot functions.
+  /// @param Tier2OptLevel IR optimization level for hot functions.
+  /// @param HotThreshold Number of calls plus loop iterations after which a
+  ///        function is recompiled.
+  /// @param CompileInBackground If true, hot functions are recompiled on a
+  ///        background thread rather than by the thread that made them hot.
+  OrcTieredJIT(std::unique_ptr<TargetMachine> Tier1TM,
+               std::unique_ptr<TargetMachine> Tier2TM, unsigned Tier2OptLevel,
+               unsigned HotThreshold, bool CompileInBackground);
+
+  ~OrcTieredJIT();
+
+  /// @brief Instrument and compile the given module, and run its static
+  ///        constructors.
+  ModuleSetHandleT addModule(std::unique_ptr<Module> M);
+
+  /// @brief Search for the given mangled symbol in the given module.
+  orc::JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name,
+                              bool ExportedSymbolsOnly);
+
+  /// @brief Search for the given unmangled symbol in the given module.
+  orc::JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name) {
+    return findSymbolIn(H, mangle(Name), true);
+  }
+
+  template <typename PtrTy>
+  static PtrTy fromTargetAddress(orc::TargetAddress Addr) {
+    return reinterpret_cast<PtrTy>(static_cast<uintptr_t>(Addr));
+  }
+
+private:
+
+  // A function that may be recompiled once it becomes hot.
+  struct TieredFunction {
+    // The unmangled name of the function.
+    std::string Name;
+    // The uninstrumented copy of the module that defines the function.
+    const Module *Source;
+    // The module set holding the stub of the function.
+    ModuleSetHandleT Tier1H;
+
+    TieredFunction(std::string Name, const Module *Source,
+                   ModuleSetHandleT Tier1H)
+        : Name(std::move(Name)), Source(Source), Tier1H(Tier1H) {}
+  };
+
+  // Called by the instrumented code when the counter of a function reaches
+  // the threshold.
+  static void hotFunctionCallback(OrcTieredJIT *J, uint32_t ID);
+
+  void requestRecompile(uint32_t ID);
+  void recompile(uint32_t ID);
+  std::unique_ptr<Module> buildTier2Module(const TieredFunction &TF);
+  void runWorker();
+
+  // Resolve a symbol that is not defined in the module being linked.
+  RuntimeDyld::SymbolInfo findExternalSymbol(const std::string &Name);
+
+  std::string mangle(const std::string &Name);
+
+  std::unique_ptr<TargetMachine> Tier1TM;
+  std::unique_ptr<TargetMachine> Tier2TM;
+  Mangler Mang;
+  unsigned Tier2OptLevel;
+  unsigned HotThreshold;
+
+  ObjLayerT ObjectLayer;
+  CompileLayerT Tier1Layer;
+  CompileLayerT Tier2Layer;
+
+  orc::LocalCXXRuntimeOverrides CXXRuntimeOverrides;
+  std::vector<orc::CtorDtorRunner<OrcTieredJIT>> IRStaticDestructorRunners;
+
+  // Serializes all use of the layers and of the LLVMContext of the modules.
+  std::recursive_mutex LayerMutex;
+  std::vector<TieredFunction> Functions;
+  std::vector<std::unique_ptr<Module>> SourceModules;
+
+  // Recompilation requests, and whether each function has been requested.
+  std::mutex QueueMutex;
+  std::condition_variable QueueChanged;
+  std::deque<uint32_t> Queue;
+  std::vector<bool> Requested;
+  bool CompileInBackground;
+  bool StopWorker;
+  std::thread Worker;
+};
+
+int runOrcTieredJIT(std::unique_ptr<Module> M, unsigned OptLevel, int ArgC,
+                    char* ArgV[]);
+
+} // end namespace llvm
+
+#endif
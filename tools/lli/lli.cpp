@@ -15,12 +15,14 @@
 
 #include "llvm/IR/LLVMContext.h"
 #include "OrcLazyJIT.h"
+#include "OrcTieredJIT.h"
 #include "RemoteMemoryManager.h"
 #include "RemoteTarget.h"
 #include "RemoteTargetExternal.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
+#include "llvm/ExecutionEngine/FileObjectCache.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/Interpreter.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
@@ -68,7 +70,7 @@ using namespace llvm;
 
 namespace {
 
-  enum class JITKind { MCJIT, OrcMCJITReplacement, OrcLazy };
+  enum class JITKind { MCJIT, OrcMCJITReplacement, OrcLazy, OrcTiered };
 
   cl::opt<std::string>
   InputFile(cl::desc("<input bitcode>"), cl::Positional, cl::init("-"));
@@ -92,6 +94,10 @@ namespace {
                                 clEnumValN(JITKind::OrcLazy,
                                            "orc-lazy",
                                            "Orc-based lazy JIT."),
+                                clEnumValN(JITKind::OrcTiered,
+                                           "orc-tiered",
+                                           "Orc-based JIT that recompiles hot "
+                                           "functions with optimization."),
                                 clEnumValEnd));
 
   // The MCJIT supports building for a target address space separate from
@@ -173,6 +179,24 @@ namespace {
                            "(must be user writable)"),
                   cl::init(""));
 
+  cl::opt<bool>
+  EnableContentCache("enable-content-cache",
+        cl::desc("Cache objects in -object-cache-dir, keyed by a hash of the "
+                 "module and of the code generation options"),
+        cl::init(false));
+
+  cl::opt<unsigned>
+  ObjectCacheMaxSize("object-cache-max-size",
+        cl::desc("Maximum size of the -enable-content-cache cache, in "
+                 "megabytes (0 = unlimited)"),
+        cl::init(0));
+
+  cl::opt<bool>
+  EnablePerfJITEvents("perf-jit-events",
+        cl::desc("Describe JIT'd code to Linux perf in /tmp/perf-<pid>.map "
+                 "and a jitdump file"),
+        cl::init(false));
+
   cl::opt<std::string>
   FakeArgv0("fake-argv0",
             cl::desc("Override the 'argv[0]' value passed into the executing"
@@ -315,6 +339,7 @@ private:
 
 static ExecutionEngine *EE = nullptr;
 static LLIObjectCache *CacheManager = nullptr;
+static FileObjectCache *ContentCache = nullptr;
 
 static void do_shutdown() {
   // Cygwin-1.5 invokes DLL's dtors before atexit handler.
@@ -322,6 +347,7 @@ static void do_shutdown() {
   delete EE;
   if (CacheManager)
     delete CacheManager;
+  delete ContentCache;
   llvm_shutdown();
 #endif
 }
@@ -401,6 +427,15 @@ int main(int argc, char **argv, char * const *envp) {
   if (UseJITKind == JITKind::OrcLazy)
     return runOrcLazyJIT(std::move(Owner), argc, argv);
 
+  if (UseJITKind == JITKind::OrcTiered) {
+    if (OptLevel != ' ' && (OptLevel < '0' || OptLevel > '3')) {
+      errs() << argv[0] << ": invalid optimization level.\n";
+      return 1;
+    }
+    unsigned Level = OptLevel == ' ' ? 2 : OptLevel - '0';
+    return runOrcTieredJIT(std::move(Owner), Level, argc, argv);
+  }
+
   if (EnableCacheManager) {
     std::string CacheName("file:");
     CacheName.append(InputFile);
@@ -485,6 +520,18 @@ int main(int argc, char **argv, char * const *envp) {
   if (EnableCacheManager) {
     CacheManager = new LLIObjectCache(ObjectCacheDir);
     EE->setObjectCache(CacheManager);
+  } else if (EnableContentCache) {
+    if (ObjectCacheDir.empty()) {
+      errs() << argv[0] << ": -enable-content-cache requires "
+             << "-object-cache-dir.\n";
+      exit(1);
+    }
+    // The interpreter has no target machine, and compiles no objects.
+    if (TargetMachine *TM = EE->getTargetMachine()) {
+      ContentCache = new FileObjectCache(ObjectCacheDir, *TM,
+                                         uint64_t(ObjectCacheMaxSize) << 20);
+      EE->setObjectCache(ContentCache);
+    }
   }
 
   // Load any additional modules specified on the command line.
@@ -547,6 +594,9 @@ int main(int argc, char **argv, char * const *envp) {
                 JITEventListener::createOProfileJITEventListener());
   EE->RegisterJITEventListener(
                 JITEventListener::createIntelJITEventListener());
+  if (EnablePerfJITEvents)
+    EE->RegisterJITEventListener(
+                JITEventListener::createPerfJITEventListener());
 
   if (!NoLazyCompilation && RemoteMCJIT) {
     errs() << "warning: remote mcjit does not support lazy compilation\n";
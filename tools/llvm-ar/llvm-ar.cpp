@@ -28,6 +28,7 @@
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -96,6 +97,7 @@ static cl::extrahelp MoreHelp(
   "  [o] - preserve original dates\n"
   "  [s] - create an archive index (cf. ranlib)\n"
   "  [S] - do not build a symbol table\n"
+  "  [T] - create a thin archive\n"
   "  [u] - update only files newer than archive contents\n"
   "\nMODIFIERS (generic):\n"
   "  [c] - do not warn if the library had to be created\n"
@@ -123,6 +125,7 @@ static bool OriginalDates = false; ///< 'o' modifier
 static bool OnlyUpdate = false;    ///< 'u' modifier
 static bool Verbose = false;       ///< 'v' modifier
 static bool Symtab = true;         ///< 's' modifier
+static bool Thin = false;          ///< 'T' modifier
 
 // Relative Positional Argument (for insert/move). This variable holds
 // the name of the archive member to which the 'a', 'b' or 'i' modifier
@@ -222,6 +225,9 @@ static ArchiveOperation parseCommandLine() {
     case 'S':
       Symtab = false;
       break;
+    case 'T':
+      Thin = true;
+      break;
     case 'u': OnlyUpdate = true; break;
     case 'v': Verbose = true; break;
     case 'a':
@@ -275,6 +281,9 @@ static ArchiveOperation parseCommandLine() {
     show_help("The 'o' modifier is only applicable to the 'x' operation");
   if (OnlyUpdate && Operation != ReplaceOrInsert)
     show_help("The 'u' modifier is only applicable to the 'r' operation");
+  if (Thin && Operation != QuickAppend && Operation != ReplaceOrInsert)
+    show_help("The 'T' modifier is only applicable to the 'q' and 'r' "
+              "operations");
 
   // Return the parsed operation to the caller
   return Operation;
@@ -286,7 +295,9 @@ static void doPrint(StringRef Name, object::Archive::child_iterator I) {
   if (Verbose)
     outs() << "Printing " << Name << "\n";
 
-  StringRef Data = I->getBuffer();
+  ErrorOr<StringRef> DataOrErr = I->getBuffer();
+  failIfError(DataOrErr.getError(), Name);
+  StringRef Data = DataOrErr.get();
   outs().write(Data.data(), Data.size());
 }
 
@@ -342,7 +353,9 @@ static void doExtract(StringRef Name, object::Archive::child_iterator I) {
     raw_fd_ostream file(FD, false);
 
     // Get the data and its length
-    StringRef Data = I->getBuffer();
+    ErrorOr<StringRef> DataOrErr = I->getBuffer();
+    failIfError(DataOrErr.getError(), Name);
+    StringRef Data = DataOrErr.get();
 
     // Write the data.
     file.write(Data.data(), Data.size());
@@ -408,7 +421,7 @@ static void performReadOperation(ArchiveOperation Operation,
 namespace {
 class NewArchiveIterator {
   bool IsNewMember;
-  StringRef Name;
+  std::string Name;
 
   object::Archive::child_iterator OldI;
 
@@ -469,6 +482,64 @@ int NewArchiveIterator::getFD(sys::fs::file_status &NewStatus) const {
   return NewFD;
 }
 
+// Split the absolute form of Path into its components, resolving "." and
+// ".." lexically.
+static std::vector<std::string> getAbsolutePathComponents(StringRef Path) {
+  static SmallString<128> CurrentDir;
+  if (CurrentDir.empty())
+    failIfError(sys::fs::current_path(CurrentDir));
+
+  SmallString<128> AbsPath;
+  if (sys::path::is_relative(Path))
+    AbsPath = CurrentDir;
+  sys::path::append(AbsPath, Path);
+
+  std::vector<std::string> Components;
+  for (sys::path::const_iterator I = sys::path::begin(AbsPath),
+                                 E = sys::path::end(AbsPath);
+       I != E; ++I) {
+    if (*I == ".")
+      continue;
+    if (*I == ".." && Components.size() > 1) {
+      Components.pop_back();
+      continue;
+    }
+    Components.push_back(*I);
+  }
+  return Components;
+}
+
+// A thin archive refers to its members by their path relative to the
+// directory of the archive, unless they were given as absolute paths.
+static std::string computeArchiveRelativePath(StringRef Path) {
+  if (sys::path::is_absolute(Path))
+    return Path;
+
+  std::vector<std::string> Dir =
+      getAbsolutePathComponents(sys::path::parent_path(ArchiveName));
+  std::vector<std::string> File = getAbsolutePathComponents(Path);
+  size_t Common = 0;
+  while (Common < Dir.size() && Common + 1 < File.size() &&
+         Dir[Common] == File[Common])
+    ++Common;
+
+  // Paths on different drives have no relative form.
+  SmallString<128> Relative;
+  if (Common != 0)
+    for (size_t I = Common, E = Dir.size(); I < E; ++I)
+      sys::path::append(Relative, "..");
+  for (size_t I = Common, E = File.size(); I < E; ++I)
+    sys::path::append(Relative, File[I]);
+  return Relative.str();
+}
+
+// The name the member read from Path has in the archive.
+static std::string computeMemberName(StringRef Path) {
+  if (Thin)
+    return computeArchiveRelativePath(Path);
+  return sys::path::filename(Path);
+}
+
 template <typename T>
 void addMember(std::vector<NewArchiveIterator> &Members, T I, StringRef Name,
                int Pos = -1) {
@@ -487,21 +558,21 @@ enum InsertAction {
   IA_MoveNewMember
 };
 
-static InsertAction computeInsertAction(ArchiveOperation Operation,
-                                        object::Archive::child_iterator I,
-                                        StringRef Name,
-                                        std::vector<StringRef>::iterator &Pos) {
+// MemberNames holds the member name of each path in Members.
+static InsertAction
+computeInsertAction(ArchiveOperation Operation,
+                    object::Archive::child_iterator I, StringRef Name,
+                    const std::vector<std::string> &MemberNames,
+                    std::vector<StringRef>::iterator &Pos) {
   if (Operation == QuickAppend || Members.empty())
     return IA_AddOldMember;
 
-  auto MI =
-      std::find_if(Members.begin(), Members.end(), [Name](StringRef Path) {
-        return Name == sys::path::filename(Path);
-      });
-
-  if (MI == Members.end())
+  auto NI = std::find(MemberNames.begin(), MemberNames.end(), Name);
+  if (NI == MemberNames.end())
     return IA_AddOldMember;
 
+  std::vector<StringRef>::iterator MI =
+      Members.begin() + (NI - MemberNames.begin());
   Pos = MI;
 
   if (Operation == Delete)
@@ -544,6 +615,14 @@ computeNewArchiveMembers(ArchiveOperation Operation,
   std::vector<NewArchiveIterator> Moved;
   int InsertPos = -1;
   StringRef PosName = sys::path::filename(RelPos);
+
+  // Computing the name of a thin archive member normalizes its path, so do
+  // it once for each new member rather than for each comparison.
+  std::vector<std::string> MemberNames;
+  MemberNames.reserve(Members.size());
+  for (StringRef Member : Members)
+    MemberNames.push_back(computeMemberName(Member));
+
   if (OldArchive) {
     for (auto &Child : OldArchive->children()) {
       int Pos = Ret.size();
@@ -560,7 +639,7 @@ computeNewArchiveMembers(ArchiveOperation Operation,
 
       std::vector<StringRef>::iterator MemberI = Members.end();
       InsertAction Action =
-          computeInsertAction(Operation, Child, Name, MemberI);
+          computeInsertAction(Operation, Child, Name, MemberNames, MemberI);
       switch (Action) {
       case IA_AddOldMember:
         addMember(Ret, Child, Name);
@@ -577,8 +656,10 @@ computeNewArchiveMembers(ArchiveOperation Operation,
         addMember(Moved, *MemberI, Name);
         break;
       }
-      if (MemberI != Members.end())
+      if (MemberI != Members.end()) {
+        MemberNames.erase(MemberNames.begin() + (MemberI - Members.begin()));
         Members.erase(MemberI);
+      }
     }
   }
 
@@ -596,9 +677,8 @@ computeNewArchiveMembers(ArchiveOperation Operation,
 
   Ret.insert(Ret.begin() + InsertPos, Members.size(), NewArchiveIterator());
   int Pos = InsertPos;
-  for (auto &Member : Members) {
-    StringRef Name = sys::path::filename(Member);
-    addMember(Ret, Member, Name, Pos);
+  for (unsigned I = 0, N = Members.size(); I < N; ++I) {
+    addMember(Ret, Members[I], MemberNames[I], Pos);
     ++Pos;
   }
 
@@ -657,6 +737,12 @@ static void printMemberHeader(raw_fd_ostream &Out, unsigned NameOffset,
   printRestOfMemberHeader(Out, ModTime, UID, GID, Perms, Size);
 }
 
+// Members of a thin archive name the files they refer to by paths, which are
+// always stored in the string table.
+static bool useStringTable(StringRef Name) {
+  return Thin || Name.size() >= 16;
+}
+
 static void writeStringTable(raw_fd_ostream &Out,
                              ArrayRef<NewArchiveIterator> Members,
                              std::vector<unsigned> &StringMapIndexes) {
@@ -665,7 +751,7 @@ static void writeStringTable(raw_fd_ostream &Out,
                                               E = Members.end();
        I != E; ++I) {
     StringRef Name = I->getName();
-    if (Name.size() < 16)
+    if (!useStringTable(Name))
       continue;
     if (StartOffset == 0) {
       printWithSpacePadding(Out, "//", 58);
@@ -685,27 +771,74 @@ static void writeStringTable(raw_fd_ostream &Out,
   Out.seek(Pos);
 }
 
+namespace {
+// The symbols a member adds to the symbol table.
+struct MemberSymbols {
+  bool IsSymbolic = false;
+  unsigned NumSyms = 0;
+  // The names of the symbols, each followed by a null character.
+  std::string Names;
+  std::error_code EC;
+};
+}
+
+static void computeMemberSymbols(MemoryBufferRef MemberBuffer,
+                                 MemberSymbols &Syms) {
+  // Each member has its own context, so that members are read in parallel.
+  LLVMContext Context;
+  ErrorOr<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, sys::fs::file_magic::unknown, &Context);
+  if (!ObjOrErr)
+    return;  // FIXME: check only for "not an object file" errors.
+  object::SymbolicFile &Obj = *ObjOrErr.get();
+  Syms.IsSymbolic = true;
+
+  raw_string_ostream NameOS(Syms.Names);
+  for (const object::BasicSymbolRef &S : Obj.symbols()) {
+    uint32_t Symflags = S.getFlags();
+    if (Symflags & object::SymbolRef::SF_FormatSpecific)
+      continue;
+    if (!(Symflags & object::SymbolRef::SF_Global))
+      continue;
+    if (Symflags & object::SymbolRef::SF_Undefined)
+      continue;
+    if ((Syms.EC = S.printName(NameOS)))
+      return;
+    NameOS << '\0';
+    ++Syms.NumSyms;
+  }
+}
+
+// Reading the members is what makes building the symbol table expensive, so
+// it is done for all the members at once, in parallel.
+static std::vector<MemberSymbols>
+computeSymbols(ArrayRef<MemoryBufferRef> Buffers) {
+  std::vector<MemberSymbols> Syms(Buffers.size());
+  ThreadPool Pool;
+  for (unsigned I = 0, N = Buffers.size(); I < N; ++I)
+    Pool.async([&Buffers, &Syms, I]() {
+      computeMemberSymbols(Buffers[I], Syms[I]);
+    });
+  Pool.wait();
+  return Syms;
+}
+
 // Returns the offset of the first reference to a member offset.
 static unsigned writeSymbolTable(raw_fd_ostream &Out,
                                  ArrayRef<NewArchiveIterator> Members,
                                  ArrayRef<MemoryBufferRef> Buffers,
                                  std::vector<unsigned> &MemberOffsetRefs) {
+  std::vector<MemberSymbols> Syms = computeSymbols(Buffers);
+
   unsigned StartOffset = 0;
-  unsigned MemberNum = 0;
-  std::string NameBuf;
-  raw_string_ostream NameOS(NameBuf);
   unsigned NumSyms = 0;
-  LLVMContext &Context = getGlobalContext();
-  for (ArrayRef<NewArchiveIterator>::iterator I = Members.begin(),
-                                              E = Members.end();
-       I != E; ++I, ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Buffers[MemberNum];
-    ErrorOr<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, sys::fs::file_magic::unknown, &Context);
-    if (!ObjOrErr)
-      continue;  // FIXME: check only for "not an object file" errors.
-    object::SymbolicFile &Obj = *ObjOrErr.get();
+  for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N;
+       ++MemberNum) {
+    const MemberSymbols &MemberSyms = Syms[MemberNum];
+    if (!MemberSyms.IsSymbolic)
+      continue;
+    failIfError(MemberSyms.EC, Members[MemberNum].getName());
 
     if (!StartOffset) {
       printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
@@ -713,22 +846,14 @@ static unsigned writeSymbolTable(raw_fd_ostream &Out,
       print32BE(Out, 0);
     }
 
-    for (const object::BasicSymbolRef &S : Obj.symbols()) {
-      uint32_t Symflags = S.getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined)
-        continue;
-      failIfError(S.printName(NameOS));
-      NameOS << '\0';
-      ++NumSyms;
+    for (unsigned I = 0; I < MemberSyms.NumSyms; ++I) {
       MemberOffsetRefs.push_back(MemberNum);
       print32BE(Out, 0);
     }
+    NumSyms += MemberSyms.NumSyms;
   }
-  Out << NameOS.str();
+  for (const MemberSymbols &MemberSyms : Syms)
+    Out << MemberSyms.Names;
 
   if (StartOffset == 0)
     return 0;
@@ -755,7 +880,10 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
   TemporaryOutput = TmpArchive.c_str();
   tool_output_file Output(TemporaryOutput, TmpArchiveFD);
   raw_fd_ostream &Out = Output.os();
-  Out << "!<arch>\n";
+  if (Thin)
+    Out << "!<thin>\n";
+  else
+    Out << "!<arch>\n";
 
   std::vector<unsigned> MemberOffsetRefs;
 
@@ -763,6 +891,10 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
   std::vector<MemoryBufferRef> Members;
   std::vector<sys::fs::file_status> NewMemberStatus;
 
+  // A thin archive only needs the contents of its members for the symbol
+  // table.
+  bool NeedContents = !Thin || Symtab;
+
   for (unsigned I = 0, N = NewMembers.size(); I < N; ++I) {
     NewArchiveIterator &Member = NewMembers[I];
     MemoryBufferRef MemberRef;
@@ -772,18 +904,20 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
       NewMemberStatus.resize(NewMemberStatus.size() + 1);
       sys::fs::file_status &Status = NewMemberStatus.back();
       int FD = Member.getFD(Status);
-      ErrorOr<std::unique_ptr<MemoryBuffer>> MemberBufferOrErr =
-          MemoryBuffer::getOpenFile(FD, Filename, Status.getSize(), false);
-      failIfError(MemberBufferOrErr.getError(), Filename);
+      if (NeedContents) {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> MemberBufferOrErr =
+            MemoryBuffer::getOpenFile(FD, Filename, Status.getSize(), false);
+        failIfError(MemberBufferOrErr.getError(), Filename);
+        Buffers.push_back(std::move(MemberBufferOrErr.get()));
+        MemberRef = Buffers.back()->getMemBufferRef();
+      }
       if (close(FD) != 0)
         fail("Could not close file");
-      Buffers.push_back(std::move(MemberBufferOrErr.get()));
-      MemberRef = Buffers.back()->getMemBufferRef();
-    } else {
+    } else if (NeedContents) {
       object::Archive::child_iterator OldMember = Member.getOld();
       ErrorOr<MemoryBufferRef> MemberBufferOrErr =
           OldMember->getMemoryBufferRef();
-      failIfError(MemberBufferOrErr.getError());
+      failIfError(MemberBufferOrErr.getError(), Member.getName());
       MemberRef = MemberBufferOrErr.get();
     }
     Members.push_back(MemberRef);
@@ -809,14 +943,12 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
     unsigned Pos = Out.tell();
     MemberOffset.push_back(Pos);
 
-    MemoryBufferRef File = Members[MemberNum];
+    StringRef Name = I->getName();
     if (I->isNewMember()) {
-      StringRef FileName = I->getNew();
       const sys::fs::file_status &Status = NewMemberStatus[NewMemberNum];
       NewMemberNum++;
 
-      StringRef Name = sys::path::filename(FileName);
-      if (Name.size() < 16)
+      if (!useStringTable(Name))
         printMemberHeader(Out, Name, Status.getLastModificationTime(),
                           Status.getUser(), Status.getGroup(),
                           Status.permissions(), Status.getSize());
@@ -827,9 +959,8 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
                           Status.getSize());
     } else {
       object::Archive::child_iterator OldMember = I->getOld();
-      StringRef Name = I->getName();
 
-      if (Name.size() < 16)
+      if (!useStringTable(Name))
         printMemberHeader(Out, Name, OldMember->getLastModified(),
                           OldMember->getUID(), OldMember->getGID(),
                           OldMember->getAccessMode(), OldMember->getSize());
@@ -840,7 +971,11 @@ performWriteOperation(ArchiveOperation Operation, object::Archive *OldArchive,
                           OldMember->getSize());
     }
 
-    Out << File.getBuffer();
+    // The members of a thin archive are only referred to.
+    if (Thin)
+      continue;
+
+    Out << Members[MemberNum].getBuffer();
 
     if (Out.tell() % 2)
       Out << '\n';
@@ -886,6 +1021,19 @@ static void createSymbolTable(object::Archive *OldArchive) {
 static void performOperation(ArchiveOperation Operation,
                              object::Archive *OldArchive,
                              std::vector<NewArchiveIterator> *NewMembers) {
+  // An archive keeps its kind when it is modified.
+  if (OldArchive) {
+    if (OldArchive->isThin())
+      Thin = true;
+    else if (Thin)
+      fail("Cannot convert a regular archive to a thin one");
+  }
+
+  // The members of a thin archive are the files it refers to, which
+  // extracting would overwrite with themselves, as GNU ar refuses to do.
+  if (Operation == Extract && Thin)
+    fail("Cannot extract members of a thin archive");
+
   switch (Operation) {
   case Print:
   case DisplayTable:
@@ -56,6 +56,16 @@ static cl::opt<bool> PreserveBitcodeUseListOrder(
     cl::desc("Preserve use-list order when writing LLVM bitcode."),
     cl::init(true), cl::Hidden);
 
+static cl::opt<bool> EmitSymbolTable(
+    "emit-symbol-table",
+    cl::desc("Write a symbol table after the module in the bitcode"),
+    cl::init(false));
+
+static cl::opt<bool> EmitFunctionSummary(
+    "function-summary",
+    cl::desc("Write function summaries after the module in the bitcode"),
+    cl::init(false));
+
 static void WriteOutputFile(const Module *M) {
   // Infer the output filename if needed.
   if (OutputFilename.empty()) {
@@ -83,7 +93,8 @@ static void WriteOutputFile(const Module *M) {
   }
 
   if (Force || !CheckBitcodeOutputToConsole(Out->os(), true))
-    WriteBitcodeToFile(M, Out->os(), PreserveBitcodeUseListOrder);
+    WriteBitcodeToFile(M, Out->os(), PreserveBitcodeUseListOrder,
+                       EmitSymbolTable, EmitFunctionSummary);
 
   // Declare success.
   Out->keep();
@@ -110,6 +110,8 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::METADATA_BLOCK_ID:        return "METADATA_BLOCK";
   case bitc::METADATA_ATTACHMENT_ID:   return "METADATA_ATTACHMENT_BLOCK";
   case bitc::USELIST_BLOCK_ID:         return "USELIST_BLOCK_ID";
+  case bitc::SYMTAB_BLOCK_ID:          return "SYMTAB_BLOCK";
+  case bitc::FUNCTION_SUMMARY_BLOCK_ID: return "FUNCTION_SUMMARY_BLOCK";
   }
 }
 
@@ -282,6 +284,21 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::USELIST_CODE_DEFAULT: return "USELIST_CODE_DEFAULT";
     case bitc::USELIST_CODE_BB:      return "USELIST_CODE_BB";
     }
+  case bitc::SYMTAB_BLOCK_ID:
+    switch(CodeID) {
+    default:return nullptr;
+    case bitc::SYMTAB_CODE_TRIPLE:        return "TRIPLE";
+    case bitc::SYMTAB_CODE_COMDAT:        return "COMDAT";
+    case bitc::SYMTAB_CODE_SYMBOL:        return "SYMBOL";
+    case bitc::SYMTAB_CODE_LINKER_OPTION: return "LINKER_OPTION";
+    }
+  case bitc::FUNCTION_SUMMARY_BLOCK_ID:
+    switch(CodeID) {
+    default:return nullptr;
+    case bitc::FS_CODE_MODULE_PATH: return "MODULE_PATH";
+    case bitc::FS_CODE_NAME:        return "NAME";
+    case bitc::FS_CODE_ENTRY:       return "ENTRY";
+    }
   }
 }
 
@@ -14,6 +14,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/DebugInfo/DWARF/DIContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/RelocVisitor.h"
 #include "llvm/Support/CommandLine.h"
@@ -68,6 +69,11 @@ DumpType("debug-dump", cl::init(DIDT_All),
         clEnumValN(DIDT_StrOffsetsDwo, "str_offsets.dwo", ".debug_str_offsets.dwo"),
         clEnumValEnd));
 
+static cl::list<std::string>
+FindNames("find", cl::ZeroOrMore, cl::value_desc("name"),
+          cl::desc("Dump the DIEs of the functions, variables, types and "
+                   "namespaces with the given name instead of the sections"));
+
 static void DumpInput(StringRef Filename) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BuffOrErr =
       MemoryBuffer::getFileOrSTDIN(Filename);
@@ -90,6 +96,17 @@ static void DumpInput(StringRef Filename) {
 
   outs() << Filename
          << ":\tfile format " << Obj.getFileFormatName() << "\n\n";
+  if (!FindNames.empty()) {
+    DWARFContext *DWARFCtx = cast<DWARFContext>(DICtx.get());
+    for (const auto &Name : FindNames) {
+      SmallVector<std::pair<DWARFCompileUnit *,
+                            const DWARFDebugInfoEntryMinimal *>, 4> DIEs;
+      DWARFCtx->findDIEsByName(Name, DIEs);
+      for (const auto &D : DIEs)
+        D.second->dump(outs(), D.first, /*recurseDepth=*/0);
+    }
+    return;
+  }
   // Dump the complete DWARF structure.
   DICtx->dump(outs(), DumpType);
 }
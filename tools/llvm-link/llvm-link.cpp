@@ -42,6 +42,10 @@ static cl::opt<std::string>
 OutputFilename("o", cl::desc("Override output filename"), cl::init("-"),
                cl::value_desc("filename"));
 
+static cl::opt<bool>
+OnlyNeeded("only-needed",
+           cl::desc("Link only the definitions that the first file needs"));
+
 static cl::opt<bool>
 Force("f", cl::desc("Enable binary output on terminals"));
 
@@ -134,7 +138,12 @@ int main(int argc, char **argv) {
 
     if (Verbose) errs() << "Linking in '" << InputFilenames[i] << "'\n";
 
-    if (L.linkInModule(M.get()))
+    // The first file provides the roots that decide what is needed from the
+    // others.
+    unsigned Flags = Linker::Flags::None;
+    if (OnlyNeeded && i != 0)
+      Flags |= Linker::Flags::LinkOnlyNeeded;
+    if (L.linkInModule(M.get(), Flags))
       return 1;
   }
 
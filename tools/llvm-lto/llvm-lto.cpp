@@ -12,8 +12,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/CommandFlags.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
 #include "llvm/Support/CommandLine.h"
@@ -22,7 +29,12 @@
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include <list>
 
 using namespace llvm;
 
@@ -46,6 +58,12 @@ static cl::opt<bool>
 DisableLTOVectorization("disable-lto-vectorization", cl::init(false),
   cl::desc("Do not run loop or slp vectorization during LTO"));
 
+static cl::opt<unsigned>
+Parallelism("j", cl::Prefix, cl::init(1),
+  cl::desc("Number of backend threads; with N > 1, one object file is "
+           "written per thread as <output>.0 ... <output>.N-1. With "
+           "-thinlto, the number of modules optimized at once"));
+
 static cl::opt<bool>
 UseDiagnosticHandler("use-diagnostic-handler", cl::init(false),
   cl::desc("Use a diagnostic handler to test the handler interface"));
@@ -73,6 +91,12 @@ static cl::opt<bool> ListSymbolsOnly(
     "list-symbols-only", cl::init(false),
     cl::desc("Instead of running LTO, list the symbols in each IR file"));
 
+static cl::opt<bool> ThinLTO(
+    "thinlto", cl::init(false),
+    cl::desc("Write the combined function summary index of the inputs to the "
+             "output, then optimize each input on its own, importing "
+             "functions from the others, into <input>.thinlto.bc"));
+
 static cl::opt<bool> SetMergedModule(
     "set-merged-module", cl::init(false),
     cl::desc("Use the first input module as the merged module"));
@@ -142,6 +166,127 @@ static int listSymbols(StringRef Command, const TargetOptions &Options) {
   return 0;
 }
 
+/// \brief Import functions into the module \p Filename according to \p Index,
+/// optimize it and write it to <Filename>.thinlto.bc, in a context of its own.
+static bool thinLTOBackend(StringRef Filename, const FunctionInfoIndex &Index,
+                           std::string &Error) {
+  LLVMContext Context;
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(Filename);
+  if (std::error_code EC = BufferOrErr.getError()) {
+    Error = EC.message();
+    return false;
+  }
+  ErrorOr<Module *> MOrErr =
+      parseBitcodeFile((*BufferOrErr)->getMemBufferRef(), Context);
+  if (std::error_code EC = MOrErr.getError()) {
+    Error = EC.message();
+    return false;
+  }
+  std::unique_ptr<Module> M(*MOrErr);
+
+  std::string OutputFilename = (Filename + ".thinlto.bc").str();
+  std::error_code EC;
+  tool_output_file Out(OutputFilename.c_str(), EC, sys::fs::F_None);
+  if (EC) {
+    Error = "error opening the file '" + OutputFilename + "': " + EC.message();
+    return false;
+  }
+
+  // Import first, so that a failure stops before the optimizations.
+  {
+    legacy::PassManager ImportPasses;
+    ImportPasses.add(createFunctionImportPass(&Index, &Error));
+    ImportPasses.run(*M);
+    if (!Error.empty())
+      return false;
+  }
+
+  legacy::PassManager Passes;
+  PassManagerBuilder PMB;
+  PMB.OptLevel = OptLevel - '0';
+  if (!DisableInline)
+    PMB.Inliner = createFunctionInliningPass();
+  PMB.DisableGVNLoadPRE = DisableGVNLoadPRE;
+  PMB.LoopVectorize = !DisableLTOVectorization;
+  PMB.SLPVectorize = !DisableLTOVectorization;
+  PMB.populateModulePassManager(Passes);
+  Passes.add(createBitcodeWriterPass(Out.os()));
+  Passes.run(*M);
+
+  Out.keep();
+  return true;
+}
+
+/// \brief Perform a thin link of the inputs, then optimize them in parallel.
+///
+/// The thin link only reads the function summaries of the inputs, and
+/// combines them into an index that it writes to the output. Each input is
+/// then loaded on its own, and only the functions it imports from the others
+/// are read from them.
+static int thinLTO(StringRef Command) {
+  FunctionInfoIndex CombinedIndex;
+  for (auto &Filename : InputFilenames) {
+    LLVMContext Context;
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(Filename);
+    std::error_code EC = BufferOrErr.getError();
+    std::unique_ptr<FunctionInfoIndex> Index;
+    if (!EC) {
+      ErrorOr<std::unique_ptr<FunctionInfoIndex>> IndexOrErr =
+          readFunctionInfoIndex((*BufferOrErr)->getMemBufferRef(), Context);
+      EC = IndexOrErr.getError();
+      if (!EC)
+        Index = std::move(*IndexOrErr);
+    }
+    if (EC) {
+      errs() << Command << ": error loading file '" << Filename
+             << "': " << EC.message() << "\n";
+      return 1;
+    }
+    if (!Index) {
+      errs() << Command << ": file '" << Filename
+             << "' has no function summaries\n";
+      return 1;
+    }
+    CombinedIndex.mergeFrom(*Index);
+  }
+
+  if (!OutputFilename.empty()) {
+    std::error_code EC;
+    tool_output_file Out(OutputFilename.c_str(), EC, sys::fs::F_None);
+    if (EC) {
+      errs() << Command << ": error opening the file '" << OutputFilename
+             << "': " << EC.message() << "\n";
+      return 1;
+    }
+    WriteFunctionInfoIndex(CombinedIndex, Out.os());
+    Out.keep();
+  }
+
+  // Each task writes its own element, so Failed must not be a
+  // std::vector<bool>, whose elements share words.
+  std::vector<std::string> Errors(InputFilenames.size());
+  std::vector<char> Failed(InputFilenames.size());
+  {
+    ThreadPool Pool(Parallelism);
+    for (unsigned I = 0, E = InputFilenames.size(); I != E; ++I)
+      Pool.async([&, I] {
+        Failed[I] = !thinLTOBackend(InputFilenames[I], CombinedIndex,
+                                    Errors[I]);
+      });
+    Pool.wait();
+  }
+
+  for (unsigned I = 0, E = InputFilenames.size(); I != E; ++I)
+    if (Failed[I]) {
+      errs() << Command << ": error optimizing '" << InputFilenames[I]
+             << "': " << Errors[I] << "\n";
+      return 1;
+    }
+  return 0;
+}
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -155,6 +300,11 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (Parallelism == 0) {
+    errs() << argv[0] << ": number of backend threads must be at least 1\n";
+    return 1;
+  }
+
   // Initialize the configured targets.
   InitializeAllTargets();
   InitializeAllTargetMCs();
@@ -167,6 +317,9 @@ int main(int argc, char **argv) {
   if (ListSymbolsOnly)
     return listSymbols(argv[0], Options);
 
+  if (ThinLTO)
+    return thinLTO(argv[0]);
+
   unsigned BaseArg = 0;
 
   LTOCodeGenerator CodeGen;
@@ -253,26 +406,36 @@ int main(int argc, char **argv) {
     CodeGen.setAttr(attrs.c_str());
 
   if (!OutputFilename.empty()) {
-    size_t len = 0;
     std::string ErrorInfo;
-    const void *Code =
-        CodeGen.compile(&len, DisableInline, DisableGVNLoadPRE,
-                        DisableLTOVectorization, ErrorInfo);
-    if (!Code) {
-      errs() << argv[0]
-             << ": error compiling the code: " << ErrorInfo << "\n";
+    if (!CodeGen.optimize(DisableInline, DisableGVNLoadPRE,
+                          DisableLTOVectorization, ErrorInfo)) {
+      errs() << argv[0] << ": error optimizing the code: " << ErrorInfo << "\n";
       return 1;
     }
 
-    std::error_code EC;
-    raw_fd_ostream FileStream(OutputFilename, EC, sys::fs::F_None);
-    if (EC) {
-      errs() << argv[0] << ": error opening the file '" << OutputFilename
-             << "': " << EC.message() << "\n";
+    std::list<tool_output_file> OSs;
+    std::vector<raw_pwrite_stream *> OSPtrs;
+    for (unsigned I = 0; I != Parallelism; ++I) {
+      std::string PartFilename = OutputFilename;
+      if (Parallelism != 1)
+        PartFilename += "." + utostr(I);
+      std::error_code EC;
+      OSs.emplace_back(PartFilename.c_str(), EC, sys::fs::F_None);
+      if (EC) {
+        errs() << argv[0] << ": error opening the file '" << PartFilename
+               << "': " << EC.message() << "\n";
+        return 1;
+      }
+      OSPtrs.push_back(&OSs.back().os());
+    }
+
+    if (!CodeGen.compileOptimized(OSPtrs, ErrorInfo)) {
+      errs() << argv[0] << ": error compiling the code: " << ErrorInfo << "\n";
       return 1;
     }
 
-    FileStream.write(reinterpret_cast<const char *>(Code), len);
+    for (tool_output_file &OS : OSs)
+      OS.keep();
   } else {
     std::string ErrorInfo;
     const char *OutputName = nullptr;
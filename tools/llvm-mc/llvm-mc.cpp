@@ -28,6 +28,7 @@
 #include "llvm/MC/MCTargetOptionsCommandFlags.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/Host.h"
@@ -51,9 +52,35 @@ OutputFilename("o", cl::desc("Output filename"),
 static cl::opt<bool>
 ShowEncoding("show-encoding", cl::desc("Show instruction encodings"));
 
-static cl::opt<bool>
-CompressDebugSections("compress-debug-sections",
-                      cl::desc("Compress DWARF debug sections"));
+namespace {
+/// -compress-debug-sections without a value keeps its original meaning, the
+/// .zdebug_* sections.
+struct DebugCompressionParser : public cl::parser<DebugCompressionType> {
+  DebugCompressionParser(cl::Option &O)
+      : cl::parser<DebugCompressionType>(O) {}
+
+  bool parse(cl::Option &O, StringRef ArgName, StringRef Arg,
+             DebugCompressionType &V) {
+    if (Arg.empty()) {
+      V = DebugCompressionType::DCT_ZlibGnu;
+      return false;
+    }
+    return cl::parser<DebugCompressionType>::parse(O, ArgName, Arg, V);
+  }
+};
+}
+
+static cl::opt<DebugCompressionType, false, DebugCompressionParser>
+CompressDebugSections("compress-debug-sections", cl::ValueOptional,
+                      cl::init(DebugCompressionType::DCT_None),
+                      cl::desc("Compress DWARF debug sections"),
+                      cl::values(
+       clEnumValN(DebugCompressionType::DCT_None, "none", "No compression"),
+       clEnumValN(DebugCompressionType::DCT_Zlib, "zlib",
+                  "zlib, in SHF_COMPRESSED sections"),
+       clEnumValN(DebugCompressionType::DCT_ZlibGnu, "zlib-gnu",
+                  "zlib, in .zdebug_* sections (without a value)"),
+       clEnumValEnd));
 
 static cl::opt<bool>
 ShowInst("show-inst", cl::desc("Show internal instruction representation"));
@@ -390,13 +417,13 @@ int main(int argc, char **argv) {
   std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
   assert(MAI && "Unable to create target asm info!");
 
-  if (CompressDebugSections) {
+  if (CompressDebugSections != DebugCompressionType::DCT_None) {
     if (!zlib::isAvailable()) {
       errs() << ProgName
              << ": build tools with zlib to enable -compress-debug-sections";
       return 1;
     }
-    MAI->setCompressDebugSections(true);
+    MAI->setCompressDebugSections(CompressDebugSections);
   }
 
   // FIXME: This is not pretty. MCContext has a ptr to MCObjectFileInfo and
@@ -435,12 +462,24 @@ int main(int argc, char **argv) {
     FeaturesStr = Features.getString();
   }
 
-  std::unique_ptr<tool_output_file> Out = GetOutputStream();
-  if (!Out)
-    return 1;
+  // Object files are written in place into a memory mapped file when the
+  // output can be mapped.
+  std::unique_ptr<raw_mapped_file_ostream> MappedOut;
+  std::unique_ptr<tool_output_file> Out;
+  raw_pwrite_stream *OS;
+  if (FileType == OFT_ObjectFile && !OutputFilename.empty() &&
+      OutputFilename != "-" &&
+      raw_mapped_file_ostream::isMappable(OutputFilename)) {
+    MappedOut = llvm::make_unique<raw_mapped_file_ostream>(OutputFilename);
+    OS = MappedOut.get();
+  } else {
+    Out = GetOutputStream();
+    if (!Out)
+      return 1;
+    OS = &Out->os();
+  }
 
   std::unique_ptr<buffer_ostream> BOS;
-  raw_pwrite_stream *OS = &Out->os();
   std::unique_ptr<MCStreamer> Str;
 
   std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
@@ -472,7 +511,7 @@ int main(int argc, char **argv) {
   } else {
     assert(FileType == OFT_ObjectFile && "Invalid file type!");
 
-    if (!Out->os().supportsSeeking()) {
+    if (Out && !Out->os().supportsSeeking()) {
       BOS = make_unique<buffer_ostream>(Out->os());
       OS = BOS.get();
     }
@@ -486,11 +525,12 @@ int main(int argc, char **argv) {
       Str->InitSections(true);
   }
 
+  raw_ostream &TextOS = Out ? Out->os() : *OS;
   int Res = 1;
   bool disassemble = false;
   switch (Action) {
   case AC_AsLex:
-    Res = AsLexInput(SrcMgr, *MAI, Out->os());
+    Res = AsLexInput(SrcMgr, *MAI, TextOS);
     break;
   case AC_Assemble:
     Res = AssembleInput(ProgName, TheTarget, SrcMgr, Ctx, *Str, *MAI, *STI,
@@ -507,9 +547,19 @@ int main(int argc, char **argv) {
   }
   if (disassemble)
     Res = Disassembler::disassemble(*TheTarget, TripleName, *STI, *Str,
-                                    *Buffer, SrcMgr, Out->os());
+                                    *Buffer, SrcMgr, TextOS);
 
   // Keep output if no errors.
-  if (Res == 0) Out->keep();
+  if (Res == 0) {
+    if (MappedOut) {
+      if (std::error_code EC = MappedOut->commit()) {
+        errs() << ProgName << ": " << OutputFilename << ": " << EC.message()
+               << '\n';
+        return 1;
+      }
+    } else {
+      Out->keep();
+    }
+  }
   return Res;
 }
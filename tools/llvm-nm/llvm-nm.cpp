@@ -33,6 +33,7 @@
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
@@ -535,11 +536,11 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
                                    std::string ArchitectureName) {
   if (!NoSort) {
     if (NumericSort)
-      std::sort(SymbolList.begin(), SymbolList.end(), compareSymbolAddress);
+      parallel_sort(SymbolList.begin(), SymbolList.end(), compareSymbolAddress);
     else if (SizeSort)
-      std::sort(SymbolList.begin(), SymbolList.end(), compareSymbolSize);
+      parallel_sort(SymbolList.begin(), SymbolList.end(), compareSymbolSize);
     else
-      std::sort(SymbolList.begin(), SymbolList.end(), compareSymbolName);
+      parallel_sort(SymbolList.begin(), SymbolList.end(), compareSymbolName);
   }
 
   if (!PrintFileName) {
@@ -779,9 +780,14 @@ static char getSymbolNMTypeChar(const GlobalValue &GV) {
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I) {
   const GlobalValue *GV = Obj.getSymbolGV(I->getRawDataRefImpl());
-  if (!GV)
-    return 't';
-  return getSymbolNMTypeChar(*GV);
+  if (GV)
+    return getSymbolNMTypeChar(*GV);
+  // Symbols from the bitcode symbol table say whether they are functions;
+  // those from module inline asm don't.
+  if (const BitcodeSymbolTable::Symbol *Sym =
+          Obj.getSymbolTableEntry(I->getRawDataRefImpl()))
+    return Sym->isFunction() ? 't' : 'd';
+  return 't';
 }
 
 template <class ELFT>
@@ -922,6 +928,10 @@ static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
         const GlobalValue *GV = IR->getSymbolGV(I->getRawDataRefImpl());
         if (GV && isa<GlobalAlias>(GV))
           continue;
+        const BitcodeSymbolTable::Symbol *Sym =
+            IR->getSymbolTableEntry(I->getRawDataRefImpl());
+        if (Sym && Sym->isAlias())
+          continue;
       }
     }
     // If a "-s segname sectname" option was specified and this is a Mach-O
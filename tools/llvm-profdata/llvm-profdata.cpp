@@ -11,6 +11,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/ProfileData/InstrProfReader.h"
@@ -25,7 +26,10 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <tuple>
 
 using namespace llvm;
 
@@ -39,8 +43,76 @@ static void exitWithError(const Twine &Message, StringRef Whence = "") {
 
 enum ProfileKinds { instr, sample };
 
-static void mergeInstrProfile(const cl::list<std::string> &Inputs,
-                              StringRef OutputFilename) {
+namespace {
+/// An input profile and the weight its counts are multiplied by.
+struct WeightedFile {
+  std::string Filename;
+  uint64_t Weight;
+};
+
+/// The counts of one function, copied out of the reader that produced them.
+struct FunctionRecord {
+  std::string Name;
+  uint64_t Hash;
+  std::vector<uint64_t> Counts;
+  /// The shard of the merge that adds these counts.
+  size_t Shard;
+};
+
+/// The records of one input file, or the error that stopped its reading.
+struct InputRecords {
+  std::vector<FunctionRecord> Records;
+  std::error_code Error;
+};
+
+/// A warning issued while adding a record, and where in the input it was.
+struct MergeWarning {
+  size_t File;
+  size_t Record;
+  std::string Name;
+  std::error_code Error;
+
+  bool operator<(const MergeWarning &RHS) const {
+    return std::tie(File, Record) < std::tie(RHS.File, RHS.Record);
+  }
+};
+} // end anonymous namespace
+
+static void readInstrProfile(const WeightedFile &Input, size_t NumShards,
+                             InputRecords &Result) {
+  auto ReaderOrErr = InstrProfReader::create(Input.Filename);
+  if ((Result.Error = ReaderOrErr.getError()))
+    return;
+
+  auto Reader = std::move(ReaderOrErr.get());
+  for (const auto &I : *Reader)
+    Result.Records.push_back(
+        {I.Name, I.Hash, I.Counts, hash_value(I.Name) % NumShards});
+  if (Reader->hasError())
+    Result.Error = Reader->getError();
+}
+
+/// Adds the records in \p Batch that belong to \p Shard to \p Writer, in input
+/// order.
+static void mergeShard(ArrayRef<WeightedFile> Inputs,
+                       ArrayRef<InputRecords> Batch, size_t Shard,
+                       InstrProfWriter &Writer,
+                       std::vector<MergeWarning> &Warnings) {
+  for (size_t F = 0, FE = Batch.size(); F != FE; ++F) {
+    const std::vector<FunctionRecord> &Records = Batch[F].Records;
+    for (size_t R = 0, RE = Records.size(); R != RE; ++R) {
+      const FunctionRecord &I = Records[R];
+      if (I.Shard != Shard)
+        continue;
+      if (std::error_code EC = Writer.addFunctionCounts(
+              I.Name, I.Hash, I.Counts, Inputs[F].Weight))
+        Warnings.push_back({F, R, I.Name, EC});
+    }
+  }
+}
+
+static void mergeInstrProfile(ArrayRef<WeightedFile> Inputs,
+                              StringRef OutputFilename, unsigned NumThreads) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -49,24 +121,89 @@ static void mergeInstrProfile(const cl::list<std::string> &Inputs,
   if (EC)
     exitWithError(EC.message(), OutputFilename);
 
-  InstrProfWriter Writer;
-  for (const auto &Filename : Inputs) {
-    auto ReaderOrErr = InstrProfReader::create(Filename);
-    if (std::error_code ec = ReaderOrErr.getError())
-      exitWithError(ec.message(), Filename);
+  if (NumThreads <= 1) {
+    InstrProfWriter Writer;
+    for (const auto &Input : Inputs) {
+      auto ReaderOrErr = InstrProfReader::create(Input.Filename);
+      if (std::error_code ec = ReaderOrErr.getError())
+        exitWithError(ec.message(), Input.Filename);
+
+      auto Reader = std::move(ReaderOrErr.get());
+      for (const auto &I : *Reader)
+        if (std::error_code EC = Writer.addFunctionCounts(I.Name, I.Hash,
+                                                          I.Counts,
+                                                          Input.Weight))
+          errs() << Input.Filename << ": " << I.Name << ": " << EC.message()
+                 << "\n";
+      if (Reader->hasError())
+        exitWithError(Reader->getError().message(), Input.Filename);
+    }
+    Writer.write(Output);
+    return;
+  }
 
-    auto Reader = std::move(ReaderOrErr.get());
-    for (const auto &I : *Reader)
-      if (std::error_code EC =
-              Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
-        errs() << Filename << ": " << I.Name << ": " << EC.message() << "\n";
-    if (Reader->hasError())
-      exitWithError(Reader->getError().message(), Filename);
+  // Read a batch of files in parallel, then add their records to one writer
+  // per shard of the function names. Each shard sees the records of its
+  // functions in input order, so every function ends up with the counts and
+  // warnings the serial merge would give it. The shards hold disjoint sets of
+  // functions and are combined once all inputs have been read.
+  ThreadPool Pool(NumThreads);
+  const size_t NumShards = NumThreads;
+  std::vector<InstrProfWriter> Shards(NumShards);
+  std::vector<std::vector<MergeWarning>> ShardWarnings(NumShards);
+  // Bound the number of inputs whose records are held in memory at once.
+  const size_t BatchSize = 4 * NumThreads;
+  for (size_t Begin = 0, E = Inputs.size(); Begin < E; Begin += BatchSize) {
+    ArrayRef<WeightedFile> BatchInputs =
+        Inputs.slice(Begin, std::min(BatchSize, E - Begin));
+    std::vector<InputRecords> Batch(BatchInputs.size());
+    for (size_t I = 0, BE = BatchInputs.size(); I != BE; ++I)
+      Pool.async([&, I] {
+        readInstrProfile(BatchInputs[I], NumShards, Batch[I]);
+      });
+    Pool.wait();
+
+    // Like the serial merge, stop at the first input that failed, after
+    // adding what could be read from it.
+    size_t FailedInput = Batch.size();
+    for (size_t I = 0, BE = Batch.size(); I != BE; ++I)
+      if (Batch[I].Error) {
+        FailedInput = I;
+        Batch.resize(I + 1);
+        break;
+      }
+
+    for (size_t S = 0; S != NumShards; ++S)
+      Pool.async([&, S] {
+        mergeShard(BatchInputs, Batch, S, Shards[S], ShardWarnings[S]);
+      });
+    Pool.wait();
+
+    std::vector<MergeWarning> Warnings;
+    for (auto &W : ShardWarnings) {
+      Warnings.insert(Warnings.end(), W.begin(), W.end());
+      W.clear();
+    }
+    std::sort(Warnings.begin(), Warnings.end());
+    for (const MergeWarning &W : Warnings)
+      errs() << BatchInputs[W.File].Filename << ": " << W.Name << ": "
+             << W.Error.message() << "\n";
+
+    if (FailedInput != Batch.size())
+      exitWithError(Batch[FailedInput].Error.message(),
+                    BatchInputs[FailedInput].Filename);
   }
+
+  InstrProfWriter Writer;
+  for (InstrProfWriter &Shard : Shards)
+    Writer.mergeRecordsFromWriter(
+        std::move(Shard), [](StringRef, std::error_code) {
+          llvm_unreachable("Shards hold disjoint sets of functions");
+        });
   Writer.write(Output);
 }
 
-static void mergeSampleProfile(const cl::list<std::string> &Inputs,
+static void mergeSampleProfile(ArrayRef<WeightedFile> Inputs,
                                StringRef OutputFilename,
                                sampleprof::SampleProfileFormat OutputFormat) {
   using namespace sampleprof;
@@ -76,7 +213,8 @@ static void mergeSampleProfile(const cl::list<std::string> &Inputs,
 
   auto Writer = std::move(WriterOrErr.get());
   StringMap<FunctionSamples> ProfileMap;
-  for (const auto &Filename : Inputs) {
+  for (const auto &Input : Inputs) {
+    const std::string &Filename = Input.Filename;
     auto ReaderOrErr =
         SampleProfileReader::create(Filename, getGlobalContext());
     if (std::error_code EC = ReaderOrErr.getError())
@@ -99,8 +237,12 @@ static void mergeSampleProfile(const cl::list<std::string> &Inputs,
 }
 
 static int merge_main(int argc, const char *argv[]) {
-  cl::list<std::string> Inputs(cl::Positional, cl::Required, cl::OneOrMore,
-                               cl::desc("<filenames...>"));
+  cl::list<std::string> InputFilenames(cl::Positional,
+                                       cl::desc("<filenames...>"));
+  cl::list<std::string> WeightedInputFilenames(
+      "weighted-input", cl::value_desc("weight>,<filename"),
+      cl::desc("<weight>,<filename>. The counts of the profile are multiplied "
+               "by <weight>"));
 
   cl::opt<std::string> OutputFilename("output", cl::value_desc("output"),
                                       cl::init("-"), cl::Required,
@@ -120,13 +262,38 @@ static int merge_main(int argc, const char *argv[]) {
                  clEnumValN(sampleprof::SPF_Text, "text", "Text encoding"),
                  clEnumValN(sampleprof::SPF_GCC, "gcc", "GCC encoding"),
                  clEnumValEnd));
+  cl::opt<unsigned> NumThreads(
+      "j", cl::init(1), cl::value_desc("N"),
+      cl::desc("Number of threads to read and merge instrumentation profiles "
+               "with"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
+  std::vector<WeightedFile> Inputs;
+  for (const auto &Filename : InputFilenames)
+    Inputs.push_back({Filename, 1});
+  for (StringRef Arg : WeightedInputFilenames) {
+    StringRef WeightStr, Filename;
+    std::tie(WeightStr, Filename) = Arg.split(',');
+    uint64_t Weight;
+    if (WeightStr.getAsInteger(10, Weight) || Weight < 1)
+      exitWithError("Input weight must be a positive integer.", Arg);
+    if (Filename.empty())
+      exitWithError("Missing filename for weighted input.", Arg);
+    Inputs.push_back({Filename, Weight});
+  }
+  if (Inputs.empty())
+    exitWithError("No input files specified.");
+
   if (ProfileKind == instr)
-    mergeInstrProfile(Inputs, OutputFilename);
-  else
+    mergeInstrProfile(Inputs, OutputFilename, NumThreads);
+  else {
+    for (const auto &Input : Inputs)
+      if (Input.Weight != 1)
+        exitWithError("Weighted inputs are not supported for sample profiles.",
+                      Input.Filename);
     mergeSampleProfile(Inputs, OutputFilename, OutputFormat);
+  }
 
   return 0;
 }
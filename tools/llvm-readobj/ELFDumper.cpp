@@ -452,6 +452,7 @@ static const EnumEntry<unsigned> ElfSectionFlags[] = {
   LLVM_READOBJ_ENUM_ENT(ELF, SHF_OS_NONCONFORMING),
   LLVM_READOBJ_ENUM_ENT(ELF, SHF_GROUP           ),
   LLVM_READOBJ_ENUM_ENT(ELF, SHF_TLS             ),
+  LLVM_READOBJ_ENUM_ENT(ELF, SHF_COMPRESSED      ),
   LLVM_READOBJ_ENUM_ENT(ELF, XCORE_SHF_CP_SECTION),
   LLVM_READOBJ_ENUM_ENT(ELF, XCORE_SHF_DP_SECTION),
   LLVM_READOBJ_ENUM_ENT(ELF, SHF_MIPS_NOSTRIP    )
@@ -32,6 +32,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <list>
 #include <system_error>
@@ -103,8 +104,28 @@ SpecificSectionMappings("map-section",
                         cl::desc("Map a section to a specific address."),
                         cl::ZeroOrMore);
 
+static cl::opt<bool>
+ShowTimes("show-times",
+          cl::desc("Show the time spent loading the inputs, resolving "
+                   "relocations and running or verifying the result."));
+
 /* *** */
 
+// The timers for -show-times. They are printed when they are destroyed.
+struct RTDyldTimers {
+  TimerGroup RTDyldTG;
+  Timer LoadObjectsTimer;
+  Timer LinkTimer;
+  Timer RunTimer;
+
+  RTDyldTimers()
+      : RTDyldTG("llvm-rtdyld"), LoadObjectsTimer("Load objects", RTDyldTG),
+        LinkTimer("Resolve relocations", RTDyldTG),
+        RunTimer("Execute or verify", RTDyldTG) {}
+};
+
+static std::unique_ptr<RTDyldTimers> Timers;
+
 // A trivial memory manager that doesn't do anything fancy, just uses the
 // support library allocation routines directly.
 class TrivialMemoryManager : public RTDyldMemoryManager {
@@ -276,6 +297,7 @@ static int executeInput() {
   if (!InputFileList.size())
     InputFileList.push_back("-");
   for(unsigned i = 0, e = InputFileList.size(); i != e; ++i) {
+    TimeRegion TR(Timers ? &Timers->LoadObjectsTimer : nullptr);
     // Load the input memory buffer.
     ErrorOr<std::unique_ptr<MemoryBuffer>> InputBuffer =
         MemoryBuffer::getFileOrSTDIN(InputFileList[i]);
@@ -298,7 +320,10 @@ static int executeInput() {
   }
 
   // Resolve all the relocations we can.
-  Dyld.resolveRelocations();
+  {
+    TimeRegion TR(Timers ? &Timers->LinkTimer : nullptr);
+    Dyld.resolveRelocations();
+  }
   // Clear instruction cache before code will be executed.
   MemMgr.invalidateInstructionCache();
 
@@ -322,6 +347,8 @@ static int executeInput() {
   // Dispatch to _main().
   errs() << "loaded '" << EntryPoint << "' at: " << (void*)MainAddress << "\n";
 
+  TimeRegion TR(Timers ? &Timers->RunTimer : nullptr);
+
   int (*Main)(int, const char**) =
     (int(*)(int,const char**)) uintptr_t(MainAddress);
   const char **Argv = new const char*[2];
@@ -534,6 +561,7 @@ static int linkAndVerify() {
   if (!InputFileList.size())
     InputFileList.push_back("-");
   for(unsigned i = 0, e = InputFileList.size(); i != e; ++i) {
+    TimeRegion TR(Timers ? &Timers->LoadObjectsTimer : nullptr);
     // Load the input memory buffer.
     ErrorOr<std::unique_ptr<MemoryBuffer>> InputBuffer =
         MemoryBuffer::getFileOrSTDIN(InputFileList[i]);
@@ -561,12 +589,19 @@ static int linkAndVerify() {
   remapSections(TheTriple, MemMgr, Checker);
 
   // Resolve all the relocations we can.
-  Dyld.resolveRelocations();
+  {
+    TimeRegion TR(Timers ? &Timers->LinkTimer : nullptr);
+    Dyld.resolveRelocations();
+  }
 
   // Register EH frames.
   Dyld.registerEHFrames();
 
-  int ErrorCode = checkAllExpressions(Checker);
+  int ErrorCode;
+  {
+    TimeRegion TR(Timers ? &Timers->RunTimer : nullptr);
+    ErrorCode = checkAllExpressions(Checker);
+  }
   if (Dyld.hasError()) {
     errs() << "RTDyld reported an error applying relocations:\n  "
            << Dyld.getErrorString() << "\n";
@@ -589,12 +624,24 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm MC-JIT tool\n");
 
+  if (ShowTimes)
+    Timers.reset(new RTDyldTimers());
+
+  int Result = 0;
   switch (Action) {
   case AC_Execute:
-    return executeInput();
+    Result = executeInput();
+    break;
   case AC_PrintLineInfo:
-    return printLineInfoForInput();
+    Result = printLineInfoForInput();
+    break;
   case AC_Verify:
-    return linkAndVerify();
+    Result = linkAndVerify();
+    break;
   }
+
+  // Print the timers.
+  Timers.reset();
+
+  return Result;
 }
@@ -13,7 +13,9 @@
 
 #include "LLVMSymbolize.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/config.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Support/Casting.h"
@@ -23,6 +25,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include <sstream>
 #include <stdlib.h>
 
@@ -462,11 +465,35 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   }
   DIContext *Context = DIContext::getDWARFContext(*Objects.second);
   assert(Context);
+  if (Opts.UseDwarfIndex || !Opts.DwarfIndexCacheDir.empty())
+    prepareDwarfIndex(Context, BinaryName);
   ModuleInfo *Info = new ModuleInfo(Objects.first, Context);
   Modules.insert(make_pair(ModuleName, Info));
   return Info;
 }
 
+void LLVMSymbolizer::prepareDwarfIndex(DIContext *Context,
+                                       const std::string &BinaryName) {
+  DWARFContext *DICtx = dyn_cast<DWARFContext>(Context);
+  if (!DICtx)
+    return;
+  if (Opts.DwarfIndexCacheDir.empty()) {
+    DICtx->getLookupIndex();
+    return;
+  }
+  // Different builds of a binary usually have the same name, so the cache
+  // file is named after the debug info as well.
+  SmallString<128> CachePath(Opts.DwarfIndexCacheDir);
+  sys::path::append(CachePath, sys::path::filename(BinaryName) + "-" +
+                                   utohexstr(DICtx->getLookupIndexKey()) +
+                                   ".dwarfindex");
+  if (DICtx->loadLookupIndex(CachePath))
+    return;
+  if (std::error_code EC = DICtx->saveLookupIndex(CachePath))
+    errs() << "warning: cannot write DWARF index " << CachePath << ": "
+           << EC.message() << "\n";
+}
+
 std::string LLVMSymbolizer::printDILineInfo(DILineInfo LineInfo) const {
   // By default, DILineInfo contains "<invalid>" for function/filename it
   // cannot fetch. We replace it to "??" to make our output closer to addr2line.
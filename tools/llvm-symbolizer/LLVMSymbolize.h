@@ -41,13 +41,19 @@ public:
     bool Demangle : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// Build the DWARF lookup index of every module up front, parsing its
+    /// compile units concurrently.
+    bool UseDwarfIndex : 1;
+    /// If not empty, the directory in which DWARF lookup indexes are cached
+    /// across runs. Implies UseDwarfIndex.
+    std::string DwarfIndexCacheDir;
     Options(bool UseSymbolTable = true,
             FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool PrintInlining = true, bool Demangle = true,
             std::string DefaultArch = "")
         : UseSymbolTable(UseSymbolTable),
           PrintFunctions(PrintFunctions), PrintInlining(PrintInlining),
-          Demangle(Demangle), DefaultArch(DefaultArch) {}
+          Demangle(Demangle), DefaultArch(DefaultArch), UseDwarfIndex(false) {}
   };
 
   LLVMSymbolizer(const Options &Opts = Options()) : Opts(Opts) {}
@@ -79,6 +85,10 @@ private:
 
   std::string printDILineInfo(DILineInfo LineInfo) const;
 
+  /// \brief Loads the DWARF lookup index of the module \p BinaryName from the
+  /// cache, or builds it (and adds it to the cache).
+  void prepareDwarfIndex(DIContext *Context, const std::string &BinaryName);
+
   // Owns all the parsed binaries and object files.
   SmallVector<std::unique_ptr<Binary>, 4> ParsedBinariesAndObjects;
   SmallVector<std::unique_ptr<MemoryBuffer>, 4> MemoryBuffers;
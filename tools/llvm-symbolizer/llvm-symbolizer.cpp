@@ -68,6 +68,16 @@ ClDsymHint("dsym-hint", cl::ZeroOrMore,
            cl::desc("Path to .dSYM bundles to search for debug info for the "
                     "object files"));
 
+static cl::opt<bool>
+ClDwarfIndex("dwarf-index", cl::init(false),
+             cl::desc("Index the debug info of each object file up front, "
+                      "parsing its compile units in parallel"));
+
+static cl::opt<std::string>
+ClDwarfIndexCacheDir("dwarf-index-cache-dir", cl::init(""),
+                     cl::desc("Directory in which to cache the debug info "
+                              "indexes across runs (implies -dwarf-index)"));
+
 static bool parseCommand(bool &IsData, std::string &ModuleName,
                          uint64_t &ModuleOffset) {
   const char *kDataCmd = "DATA ";
@@ -134,6 +144,8 @@ int main(int argc, char **argv) {
                 "\" (must have the '.dSYM' extension).\n";
     }
   }
+  Opts.UseDwarfIndex = ClDwarfIndex;
+  Opts.DwarfIndexCacheDir = ClDwarfIndexCacheDir;
   LLVMSymbolizer Symbolizer(Opts);
 
   bool IsData = false;
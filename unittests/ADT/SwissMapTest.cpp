@@ -0,0 +1,252 @@
+//===- llvm/unittest/ADT/SwissMapTest.cpp - SwissMap unit tests -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissMap.h"
+#include "llvm/ADT/StringExtras.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <set>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+/// Checks that every constructed value is destroyed exactly once.
+class CtorTester {
+  static std::set<CtorTester *> Constructed;
+  int Value;
+
+public:
+  explicit CtorTester(int Value = 0) : Value(Value) {
+    EXPECT_TRUE(Constructed.insert(this).second);
+  }
+  CtorTester(const CtorTester &Arg) : Value(Arg.Value) {
+    EXPECT_TRUE(Constructed.insert(this).second);
+  }
+  CtorTester &operator=(const CtorTester &) = default;
+  ~CtorTester() { EXPECT_EQ(1u, Constructed.erase(this)); }
+
+  int getValue() const { return Value; }
+  static unsigned getNumLive() { return Constructed.size(); }
+};
+
+std::set<CtorTester *> CtorTester::Constructed;
+
+TEST(SwissMapTest, EmptyMap) {
+  SwissMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0u, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(0u, Map.getMemorySize());
+
+  const SwissMap<unsigned, unsigned> &ConstMap = Map;
+  EXPECT_TRUE(ConstMap.begin() == ConstMap.end());
+  EXPECT_TRUE(ConstMap.find(1) == ConstMap.end());
+}
+
+TEST(SwissMapTest, SingleEntry) {
+  SwissMap<unsigned, unsigned> Map;
+  Map[1] = 2;
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(1u, Map.count(1));
+  EXPECT_EQ(2u, Map.lookup(1));
+  EXPECT_EQ(1u, Map.begin()->first);
+  EXPECT_EQ(2u, Map.begin()->second);
+  EXPECT_TRUE(++Map.begin() == Map.end());
+
+  auto R = Map.insert(std::make_pair(1u, 3u));
+  EXPECT_FALSE(R.second);
+  EXPECT_EQ(2u, R.first->second);
+
+  EXPECT_TRUE(Map.erase(1));
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.count(1));
+}
+
+TEST(SwissMapTest, GrowEraseAndReinsert) {
+  SwissMap<unsigned, unsigned> Map;
+  const unsigned N = 10000;
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_TRUE(Map.insert(std::make_pair(I * 7, I)).second);
+  EXPECT_EQ(N, Map.size());
+  for (unsigned I = 0; I != N; ++I) {
+    auto It = Map.find(I * 7);
+    ASSERT_TRUE(It != Map.end());
+    EXPECT_EQ(I, It->second);
+    EXPECT_EQ(0u, Map.count(I * 7 + 1));
+  }
+
+  // Leave tombstones behind, then fill the map again; the deleted buckets
+  // must be reused or reclaimed rather than making the table grow forever.
+  for (unsigned Round = 0; Round != 10; ++Round) {
+    for (unsigned I = 0; I != N; I += 2)
+      EXPECT_TRUE(Map.erase(I * 7));
+    EXPECT_EQ(N / 2, Map.size());
+    for (unsigned I = 0; I != N; I += 2)
+      Map[I * 7] = I;
+    EXPECT_EQ(N, Map.size());
+  }
+  for (unsigned I = 0; I != N; ++I)
+    EXPECT_EQ(I, Map.lookup(I * 7));
+  size_t ReservedSize = SwissMap<unsigned, unsigned>(N).getMemorySize();
+  EXPECT_LE(Map.getMemorySize(), 2 * ReservedSize);
+}
+
+TEST(SwissMapTest, Iteration) {
+  SwissMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Expected;
+  for (unsigned I = 0; I != 1000; ++I) {
+    Map[I * 13] = I;
+    Expected[I * 13] = I;
+  }
+  for (unsigned I = 0; I < 1000; I += 3) {
+    Map.erase(I * 13);
+    Expected.erase(I * 13);
+  }
+
+  std::map<unsigned, unsigned> Visited;
+  for (const auto &Entry : Map)
+    EXPECT_TRUE(Visited.insert(std::make_pair(Entry.first, Entry.second))
+                    .second);
+  EXPECT_EQ(Expected, Visited);
+
+  // Erasing through an iterator.
+  auto It = Map.find(13);
+  ASSERT_TRUE(It != Map.end());
+  Map.erase(It);
+  EXPECT_EQ(0u, Map.count(13));
+
+  // Const iterators can be built from and compared with iterators.
+  SwissMap<unsigned, unsigned>::const_iterator CI = Map.begin();
+  EXPECT_TRUE(CI == Map.begin());
+}
+
+TEST(SwissMapTest, CopyMoveAndSwap) {
+  SwissMap<unsigned, std::string> A;
+  for (unsigned I = 0; I != 100; ++I)
+    A[I] = utostr(I);
+
+  SwissMap<unsigned, std::string> B(A);
+  EXPECT_EQ(100u, B.size());
+  EXPECT_EQ("42", B[42]);
+  B[42] = "x";
+  EXPECT_EQ("42", A[42]);
+
+  SwissMap<unsigned, std::string> C(std::move(B));
+  EXPECT_EQ(100u, C.size());
+  EXPECT_EQ("x", C[42]);
+
+  SwissMap<unsigned, std::string> D;
+  D[1000] = "y";
+  D = A;
+  EXPECT_EQ(100u, D.size());
+  EXPECT_EQ(0u, D.count(1000));
+
+  D.clear();
+  EXPECT_TRUE(D.empty());
+  EXPECT_EQ(0u, D.count(42));
+  D.swap(C);
+  EXPECT_EQ(100u, D.size());
+  EXPECT_TRUE(C.empty());
+  EXPECT_EQ("x", D[42]);
+}
+
+TEST(SwissMapTest, ConstructionAndDestruction) {
+  {
+    SwissMap<unsigned, CtorTester> Map;
+    for (unsigned I = 0; I != 500; ++I)
+      Map.insert(std::make_pair(I, CtorTester(I)));
+    EXPECT_EQ(500u, CtorTester::getNumLive());
+    for (unsigned I = 0; I != 500; I += 2)
+      Map.erase(I);
+    EXPECT_EQ(250u, CtorTester::getNumLive());
+    SwissMap<unsigned, CtorTester> Copy(Map);
+    EXPECT_EQ(500u, CtorTester::getNumLive());
+    EXPECT_EQ(7, Copy.find(7)->second.getValue());
+  }
+  EXPECT_EQ(0u, CtorTester::getNumLive());
+}
+
+/// Hashes every key to the same value, so all keys share one probe sequence.
+struct CollidingInfo {
+  static unsigned getEmptyKey() { return ~0u; }
+  static unsigned getTombstoneKey() { return ~0u - 1; }
+  static unsigned getHashValue(unsigned) { return 0; }
+  static unsigned getHashValue(StringRef) { return 0; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+  static bool isEqual(StringRef LHS, unsigned RHS) {
+    return LHS == utostr(RHS);
+  }
+};
+
+TEST(SwissMapTest, Collisions) {
+  SwissMap<unsigned, unsigned, CollidingInfo> Map;
+  for (unsigned I = 0; I != 200; ++I)
+    Map[I] = I + 1;
+  for (unsigned I = 0; I != 200; ++I)
+    EXPECT_EQ(I + 1, Map.lookup(I));
+  EXPECT_EQ(0u, Map.count(200));
+  for (unsigned I = 0; I != 200; I += 2)
+    Map.erase(I);
+  for (unsigned I = 0; I != 200; ++I)
+    EXPECT_EQ(I % 2 ? I + 1 : 0, Map.lookup(I));
+
+  // The empty and tombstone keys of the DenseMapInfo are ordinary keys.
+  Map[~0u] = 1;
+  Map[~0u - 1] = 2;
+  EXPECT_EQ(1u, Map.lookup(~0u));
+  EXPECT_EQ(2u, Map.lookup(~0u - 1));
+
+  auto It = Map.find_as(StringRef("17"));
+  ASSERT_TRUE(It != Map.end());
+  EXPECT_EQ(18u, It->second);
+  EXPECT_TRUE(Map.find_as(StringRef("18")) == Map.end());
+}
+
+template <typename GroupT> void testGroup() {
+  int8_t Ctrl[GroupT::Width];
+  for (unsigned I = 0; I != GroupT::Width; ++I)
+    Ctrl[I] = I % 4 == 0 ? int8_t(detail::SwissCtrlEmpty)
+                         : I % 4 == 1 ? int8_t(detail::SwissCtrlDeleted)
+                                      : int8_t(I);
+  GroupT G(Ctrl);
+
+  unsigned Positions = 0;
+  for (auto M = G.matchEmpty(); M; M.clearLowest())
+    Positions |= 1u << M.lowest();
+  unsigned Expected = 0;
+  for (unsigned I = 0; I < GroupT::Width; I += 4)
+    Expected |= 1u << I;
+  EXPECT_EQ(Expected, Positions);
+
+  Positions = 0;
+  for (auto M = G.matchEmptyOrDeleted(); M; M.clearLowest())
+    Positions |= 1u << M.lowest();
+  EXPECT_EQ(Expected | Expected << 1, Positions);
+
+  // The portable group may report false positives above a real match, but
+  // must report the real one first.
+  auto M = G.match(6);
+  ASSERT_TRUE(bool(M));
+  EXPECT_EQ(6u, M.lowest());
+  EXPECT_FALSE(bool(G.match(5)));
+}
+
+TEST(SwissMapTest, PortableGroup) { testGroup<detail::SwissGroupPortable>(); }
+
+#if LLVM_SWISSMAP_HAS_SSE2
+TEST(SwissMapTest, SSE2Group) { testGroup<detail::SwissGroupSSE2>(); }
+#endif
+
+} // end anonymous namespace
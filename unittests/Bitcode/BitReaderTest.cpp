@@ -9,6 +9,7 @@
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeSymbolTable.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Constants.h"
@@ -164,4 +165,78 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+TEST(BitReaderTest, SymbolTableRoundTrip) {
+  std::unique_ptr<Module> M = parseAssembly(
+      "target datalayout = \"e-m:o-i64:64-f80:128-n8:16:32:64-S128\"\n"
+      "target triple = \"x86_64-apple-macosx10.10.0\"\n"
+      "$c = comdat any\n"
+      "@c = linkonce_odr global i32 1, comdat, align 8\n"
+      "@common = common global [4 x i64] zeroinitializer, align 16\n"
+      "@alias = hidden alias i32* @c\n"
+      "define void @func() unnamed_addr {\n"
+      "  ret void\n"
+      "}\n"
+      "declare void @decl()\n");
+
+  BitcodeSymbolTable Expected;
+  ASSERT_TRUE(buildBitcodeSymbolTable(*M, Expected));
+
+  SmallString<1024> Mem;
+  {
+    raw_svector_ostream OS(Mem);
+    WriteBitcodeToFile(M.get(), OS, /*ShouldPreserveUseListOrder=*/false,
+                       /*EmitSymbolTable=*/true);
+  }
+
+  LLVMContext Context;
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>> SymtabOrErr =
+      readBitcodeSymbolTable(MemoryBufferRef(Mem.str(), "test"), Context);
+  ASSERT_TRUE(bool(SymtabOrErr));
+  ASSERT_TRUE(bool(*SymtabOrErr));
+  const BitcodeSymbolTable &Symtab = **SymtabOrErr;
+
+  EXPECT_EQ("x86_64-apple-macosx10.10.0", Symtab.TargetTriple);
+  ASSERT_EQ(1u, Symtab.Comdats.size());
+  EXPECT_EQ("c", Symtab.Comdats[0].first);
+  EXPECT_EQ(Comdat::Any, Symtab.Comdats[0].second);
+
+  ASSERT_EQ(Expected.Symbols.size(), Symtab.Symbols.size());
+  for (unsigned I = 0, E = Symtab.Symbols.size(); I != E; ++I) {
+    const BitcodeSymbolTable::Symbol &A = Expected.Symbols[I];
+    const BitcodeSymbolTable::Symbol &B = Symtab.Symbols[I];
+    EXPECT_EQ(A.Name, B.Name);
+    EXPECT_EQ(A.Linkage, B.Linkage);
+    EXPECT_EQ(A.Visibility, B.Visibility);
+    EXPECT_EQ(A.Flags, B.Flags);
+    EXPECT_EQ(A.Alignment, B.Alignment);
+    EXPECT_EQ(A.CommonSize, B.CommonSize);
+    EXPECT_EQ(A.Comdat, B.Comdat);
+  }
+
+  // Functions come first, then variables, then aliases. Names are mangled.
+  ASSERT_EQ(5u, Symtab.Symbols.size());
+  EXPECT_EQ("_func", Symtab.Symbols[0].Name);
+  EXPECT_TRUE(Symtab.Symbols[0].isFunction());
+  EXPECT_TRUE(Symtab.Symbols[0].Flags &
+              BitcodeSymbolTable::Symbol::SF_UnnamedAddr);
+  EXPECT_EQ("_decl", Symtab.Symbols[1].Name);
+  EXPECT_TRUE(Symtab.Symbols[1].isUndefined());
+  EXPECT_EQ(8u, Symtab.Symbols[2].Alignment);
+  EXPECT_EQ(0, Symtab.Symbols[2].Comdat);
+  EXPECT_EQ(32u, Symtab.Symbols[3].CommonSize);
+  EXPECT_EQ(GlobalValue::HiddenVisibility, Symtab.Symbols[4].Visibility);
+  EXPECT_EQ(0, Symtab.Symbols[4].Comdat);
+
+  // Bitcode without a table has none.
+  Mem.clear();
+  {
+    raw_svector_ostream OS(Mem);
+    WriteBitcodeToFile(M.get(), OS);
+  }
+  SymtabOrErr =
+      readBitcodeSymbolTable(MemoryBufferRef(Mem.str(), "test"), Context);
+  ASSERT_TRUE(bool(SymtabOrErr));
+  EXPECT_FALSE(bool(*SymtabOrErr));
+}
+
 } // end namespace
@@ -0,0 +1,183 @@
+//===- FileObjectCacheTest.cpp - Unit tests for the on-disk object cache --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCJITTestBase.h"
+#include "llvm/ExecutionEngine/FileObjectCache.h"
+#include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+/// Counts the objects that were compiled rather than loaded from the cache.
+class CountingObjectCache : public FileObjectCache {
+public:
+  CountingObjectCache(StringRef CacheDir, const TargetMachine &TM)
+      : FileObjectCache(CacheDir, TM), NumCompiled(0) {}
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override {
+    ++NumCompiled;
+    FileObjectCache::notifyObjectCompiled(M, Obj);
+  }
+
+  unsigned NumCompiled;
+};
+
+class FileObjectCacheTest : public testing::Test, public MCJITTestBase {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("FileObjectCacheTest", CacheDir));
+  }
+
+  void TearDown() override {
+    std::error_code EC;
+    for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+         I.increment(EC))
+      sys::fs::remove(I->path());
+    sys::fs::remove(CacheDir);
+  }
+
+  unsigned countEntries() {
+    unsigned Count = 0;
+    std::error_code EC;
+    for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+         I.increment(EC))
+      if (sys::path::extension(I->path()) == ".o")
+        ++Count;
+    return Count;
+  }
+
+  /// Build a module whose main returns \p RC, give it the identifier \p Name,
+  /// and run it with \p Cache.
+  void compileAndRun(StringRef Name, uint32_t RC, ObjectCache &Cache) {
+    M.reset(createEmptyModule(Name));
+    Function *Main = insertMainFunction(M.get(), RC);
+    MM.reset(new SectionMemoryManager());
+    createJIT(std::move(M));
+    TheJIT->setObjectCache(&Cache);
+    TheJIT->finalizeObject();
+    void *Ptr = TheJIT->getPointerToFunction(Main);
+    ASSERT_TRUE(Ptr != nullptr);
+    int (*FuncPtr)(void) = (int (*)(void))(intptr_t)Ptr;
+    EXPECT_EQ(int(RC), FuncPtr());
+    TheJIT.reset();
+  }
+
+  SmallString<128> CacheDir;
+};
+
+TEST_F(FileObjectCacheTest, ReusesObjectsAcrossInstances) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  std::unique_ptr<TargetMachine> TM(
+      EngineBuilder().setOptLevel(CodeGenOpt::None)
+                     .setMCPU(sys::getHostCPUName())
+                     .selectTarget());
+  ASSERT_TRUE(TM != nullptr);
+
+  {
+    CountingObjectCache Cache(CacheDir, *TM);
+    compileAndRun("first", 6, Cache);
+    EXPECT_EQ(1u, Cache.NumCompiled);
+    EXPECT_EQ(1u, countEntries());
+  }
+
+  // A new cache instance, as in a later process, finds the object even though
+  // the module has a different identifier.
+  CountingObjectCache Cache(CacheDir, *TM);
+  compileAndRun("second", 6, Cache);
+  EXPECT_EQ(0u, Cache.NumCompiled);
+
+  // A module with different contents is compiled and cached separately.
+  compileAndRun("third", 7, Cache);
+  EXPECT_EQ(1u, Cache.NumCompiled);
+  EXPECT_EQ(2u, countEntries());
+}
+
+TEST_F(FileObjectCacheTest, KeyDependsOnCodeGenOptions) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  std::unique_ptr<TargetMachine> TM0(
+      EngineBuilder().setOptLevel(CodeGenOpt::None).selectTarget());
+  std::unique_ptr<TargetMachine> TM2(
+      EngineBuilder().setOptLevel(CodeGenOpt::Default).selectTarget());
+  std::unique_ptr<TargetMachine> PIC(
+      EngineBuilder().setOptLevel(CodeGenOpt::None)
+                     .setRelocationModel(Reloc::PIC_)
+                     .selectTarget());
+  std::unique_ptr<TargetMachine> Small(
+      EngineBuilder().setOptLevel(CodeGenOpt::None)
+                     .setCodeModel(CodeModel::Small)
+                     .selectTarget());
+  TargetOptions Opts;
+  Opts.FunctionSections = true;
+  std::unique_ptr<TargetMachine> Sections(
+      EngineBuilder().setOptLevel(CodeGenOpt::None)
+                     .setTargetOptions(Opts)
+                     .selectTarget());
+  ASSERT_TRUE(TM0 != nullptr && TM2 != nullptr && PIC != nullptr &&
+              Small != nullptr && Sections != nullptr);
+
+  std::unique_ptr<Module> A(createEmptyModule("A"));
+  insertMainFunction(A.get(), 1);
+  std::unique_ptr<Module> B(createEmptyModule("B"));
+  insertMainFunction(B.get(), 1);
+
+  FileObjectCache Cache0(CacheDir, *TM0);
+  FileObjectCache Cache2(CacheDir, *TM2);
+  EXPECT_EQ(Cache0.getKey(*A), Cache0.getKey(*B));
+  EXPECT_NE(Cache0.getKey(*A), Cache2.getKey(*A));
+  EXPECT_NE(Cache0.getKey(*A), FileObjectCache(CacheDir, *PIC).getKey(*A));
+  EXPECT_NE(Cache0.getKey(*A), FileObjectCache(CacheDir, *Small).getKey(*A));
+  EXPECT_NE(Cache0.getKey(*A),
+            FileObjectCache(CacheDir, *Sections).getKey(*A));
+}
+
+TEST_F(FileObjectCacheTest, PrunesLeastRecentlyUsed) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  std::unique_ptr<TargetMachine> TM(EngineBuilder().selectTarget());
+  ASSERT_TRUE(TM != nullptr);
+  FileObjectCache Cache(CacheDir, *TM, 150);
+
+  // Write three 100-byte entries used at different times, and a file that
+  // isn't an entry.
+  const char *Names[] = { "old.o", "new.o", "newer.o", "other.tmp" };
+  for (unsigned I = 0; I != 4; ++I) {
+    SmallString<128> Path(CacheDir);
+    sys::path::append(Path, Names[I]);
+    int FD;
+    ASSERT_FALSE(sys::fs::openFileForWrite(Path, FD, sys::fs::F_None));
+    raw_fd_ostream OS(FD, true);
+    OS << std::string(100, 'x');
+    OS.flush();
+    ASSERT_FALSE(sys::fs::setLastModificationAndAccessTime(
+        FD, sys::TimeValue(1000000000 + I * 1000, 0)));
+  }
+
+  Cache.prune();
+
+  auto Exists = [&](StringRef Name) {
+    SmallString<128> Path(CacheDir);
+    sys::path::append(Path, Name);
+    return sys::fs::exists(Twine(Path));
+  };
+  EXPECT_FALSE(Exists("old.o"));
+  EXPECT_FALSE(Exists("new.o"));
+  EXPECT_TRUE(Exists("newer.o"));
+  EXPECT_TRUE(Exists("other.tmp"));
+}
+
+} // end anonymous namespace
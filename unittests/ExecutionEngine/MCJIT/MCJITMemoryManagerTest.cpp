@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/Support/Process.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -166,5 +167,147 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, PoolReusesFreedMemory) {
+  auto Pool = std::make_shared<SectionMemoryPool>(0x100000);
+  uint8_t *code1, *data1;
+  {
+    SectionMemoryManager MemMgr(Pool);
+    code1 = MemMgr.allocateCodeSection(256, 0, 1, "");
+    data1 = MemMgr.allocateDataSection(256, 0, 2, "", false);
+    EXPECT_NE((uint8_t*)nullptr, code1);
+    EXPECT_NE((uint8_t*)nullptr, data1);
+    code1[0] = 1;
+    std::string Error;
+    EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+  }
+  EXPECT_EQ(2u, Pool->getNumSlabs());
+  EXPECT_EQ(0x100000u,
+            Pool->getFreeSize(SectionMemoryPool::AllocationPurpose::Code));
+
+  // The memory of the first module is reused, and is writable again.
+  SectionMemoryManager MemMgr(Pool);
+  uint8_t *code2 = MemMgr.allocateCodeSection(256, 0, 1, "");
+  uint8_t *data2 = MemMgr.allocateDataSection(256, 0, 2, "", false);
+  EXPECT_EQ(code1, code2);
+  EXPECT_EQ(data1, data2);
+  code2[0] = 2;
+  EXPECT_EQ(2u, Pool->getNumSlabs());
+}
+
+TEST(MCJITMemoryManagerTest, PoolKeepsModulesClose) {
+  auto Pool = std::make_shared<SectionMemoryPool>(0x100000);
+  SectionMemoryManager MemMgr1(Pool);
+  SectionMemoryManager MemMgr2(Pool);
+
+  uint8_t *code1 = MemMgr1.allocateCodeSection(256, 0, 1, "");
+  uint8_t *code2 = MemMgr2.allocateCodeSection(256, 0, 1, "");
+  ASSERT_NE((uint8_t*)nullptr, code1);
+  ASSERT_NE((uint8_t*)nullptr, code2);
+
+  // Both modules are carved out of the same slab, one page apart.
+  uintptr_t Distance = code1 < code2 ? code2 - code1 : code1 - code2;
+  EXPECT_EQ(sys::Process::getPageSize(), Distance);
+  EXPECT_EQ(1u, Pool->getNumSlabs());
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr1.finalizeMemory(&Error));
+  EXPECT_FALSE(MemMgr2.finalizeMemory(&Error));
+}
+
+TEST(MCJITMemoryManagerTest, PoolReservesAllocationSpace) {
+  auto Pool = std::make_shared<SectionMemoryPool>(0x100000, true);
+  SectionMemoryManager MemMgr(Pool);
+  EXPECT_TRUE(MemMgr.needsToReserveAllocationSpace());
+
+  // The sections of an object are allocated from one reserved chunk.
+  MemMgr.reserveAllocationSpace(1024, 0, 1024);
+  uint8_t *code1 = MemMgr.allocateCodeSection(256, 16, 1, "");
+  uint8_t *code2 = MemMgr.allocateCodeSection(256, 16, 2, "");
+  uint8_t *data1 = MemMgr.allocateDataSection(256, 16, 3, "", false);
+  ASSERT_NE((uint8_t*)nullptr, code1);
+  ASSERT_NE((uint8_t*)nullptr, code2);
+  ASSERT_NE((uint8_t*)nullptr, data1);
+  EXPECT_EQ(code1 + 256, code2);
+
+  // An allocation larger than the slab size gets a slab of its own.
+  uint8_t *data2 = MemMgr.allocateDataSection(0x200000, 0, 4, "", true);
+  ASSERT_NE((uint8_t*)nullptr, data2);
+  data2[0x1fffff] = 1;
+  EXPECT_EQ(3u, Pool->getNumSlabs());
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+}
+
+TEST(MCJITMemoryManagerTest, PoolHugePageCodeChunks) {
+  size_t PageSize = sys::Process::getPageSize();
+  size_t HugePageSize = SectionMemoryPool::HugePageSize;
+  size_t MinHugeCodeChunk = SectionMemoryPool::MinHugeCodeChunk;
+  if (PageSize >= HugePageSize)
+    return;
+  auto Pool = std::make_shared<SectionMemoryPool>(2 * HugePageSize, true);
+  typedef SectionMemoryPool::AllocationPurpose Purpose;
+  EXPECT_EQ(PageSize, Pool->getChunkAlignment(Purpose::Code, 256));
+  EXPECT_EQ(HugePageSize,
+            Pool->getChunkAlignment(Purpose::Code, MinHugeCodeChunk));
+  EXPECT_EQ(PageSize,
+            Pool->getChunkAlignment(Purpose::RWData, MinHugeCodeChunk));
+
+  // Small modules share a regular slab instead of using a huge page each.
+  SectionMemoryManager MemMgr1(Pool);
+  SectionMemoryManager MemMgr2(Pool);
+  uint8_t *code1 = MemMgr1.allocateCodeSection(256, 0, 1, "");
+  uint8_t *code2 = MemMgr2.allocateCodeSection(256, 0, 1, "");
+  ASSERT_NE((uint8_t*)nullptr, code1);
+  ASSERT_NE((uint8_t*)nullptr, code2);
+  uintptr_t Distance = code1 < code2 ? code2 - code1 : code1 - code2;
+  EXPECT_EQ(PageSize, Distance);
+  EXPECT_EQ(1u, Pool->getNumSlabs());
+
+  // Large code gets whole huge pages, so finalizing one module doesn't
+  // change the permissions of part of a huge page used by another.
+  SectionMemoryManager MemMgr3(Pool);
+  SectionMemoryManager MemMgr4(Pool);
+  uint8_t *code3 = MemMgr3.allocateCodeSection(MinHugeCodeChunk, 0, 1, "");
+  uint8_t *code4 = MemMgr4.allocateCodeSection(MinHugeCodeChunk, 0, 1, "");
+  ASSERT_NE((uint8_t*)nullptr, code3);
+  ASSERT_NE((uint8_t*)nullptr, code4);
+  Distance = code3 < code4 ? code4 - code3 : code3 - code4;
+  EXPECT_EQ(HugePageSize, Distance);
+  EXPECT_EQ(2u, Pool->getNumSlabs());
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr1.finalizeMemory(&Error));
+  code2[0] = 1;
+  EXPECT_FALSE(MemMgr2.finalizeMemory(&Error));
+  EXPECT_FALSE(MemMgr3.finalizeMemory(&Error));
+  code4[MinHugeCodeChunk - 1] = 1;
+  EXPECT_FALSE(MemMgr4.finalizeMemory(&Error));
+}
+
+TEST(MCJITMemoryManagerTest, PoolCoalescesFreedChunks) {
+  size_t PageSize = sys::Process::getPageSize();
+  SectionMemoryPool Pool(16 * PageSize);
+  typedef SectionMemoryPool::AllocationPurpose Purpose;
+
+  std::error_code EC;
+  sys::MemoryBlock A = Pool.allocate(Purpose::RWData, PageSize, EC);
+  sys::MemoryBlock B = Pool.allocate(Purpose::RWData, PageSize, EC);
+  sys::MemoryBlock C = Pool.allocate(Purpose::RWData, PageSize, EC);
+  EXPECT_FALSE(EC);
+  EXPECT_EQ(13 * PageSize, Pool.getFreeSize(Purpose::RWData));
+
+  Pool.release(Purpose::RWData, A);
+  Pool.release(Purpose::RWData, C);
+  Pool.release(Purpose::RWData, B);
+
+  // The freed chunks merge back into one range covering the whole slab.
+  sys::MemoryBlock D = Pool.allocate(Purpose::RWData, 16 * PageSize, EC);
+  EXPECT_FALSE(EC);
+  EXPECT_EQ(A.base(), D.base());
+  EXPECT_EQ(1u, Pool.getNumSlabs());
+  Pool.release(Purpose::RWData, D);
+}
+
 } // Namespace
 
@@ -0,0 +1,196 @@
+//===- PerfJITEventListenerTest.cpp - Unit tests for perf JIT listener ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetSelect.h"
+#include "gtest/gtest.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+
+namespace {
+
+// The listener only exists on Linux.
+#if defined(__linux__)
+
+const char DebugModule[] =
+  "define i32 @jitted_answer() {\n"
+  "  ret i32 42, !dbg !8\n"
+  "}\n"
+  "!llvm.dbg.cu = !{!0}\n"
+  "!llvm.module.flags = !{!6, !7}\n"
+  "!0 = !MDCompileUnit(language: DW_LANG_C99, producer: \"test\", "
+  "isOptimized: false, emissionKind: 1, file: !1, subprograms: !2)\n"
+  "!1 = !MDFile(filename: \"answer.c\", directory: \"/src\")\n"
+  "!2 = !{!3}\n"
+  "!3 = !MDSubprogram(name: \"jitted_answer\", line: 6, isLocal: false, "
+  "isDefinition: true, scopeLine: 6, file: !1, scope: !1, type: !4, "
+  "function: i32 ()* @jitted_answer)\n"
+  "!4 = !MDSubroutineType(types: !5)\n"
+  "!5 = !{null}\n"
+  "!6 = !{i32 2, !\"Dwarf Version\", i32 4}\n"
+  "!7 = !{i32 1, !\"Debug Info Version\", i32 3}\n"
+  "!8 = !MDLocation(line: 7, scope: !3)\n";
+
+template <typename T> T read(const char *&Ptr) {
+  T Value;
+  memcpy(&Value, Ptr, sizeof(T));
+  Ptr += sizeof(T);
+  return Value;
+}
+
+TEST(PerfJITEventListenerTest, WritesPerfMapAndJITDump) {
+  // Skip hosts without a native target to run the code on.
+  if (InitializeNativeTarget() || InitializeNativeTargetAsmPrinter())
+    return;
+
+  SmallString<128> Dir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("PerfJITEventListenerTest",
+                                              Dir));
+  SmallString<128> MapPath(Dir);
+  sys::path::append(MapPath, "perf-" + Twine(::getpid()) + ".map");
+  SmallString<128> DumpPath(Dir);
+  sys::path::append(DumpPath, "jit-" + Twine(::getpid()) + ".dump");
+
+  std::unique_ptr<JITEventListener> Listener(
+      JITEventListener::createPerfJITEventListener(Dir, Dir));
+  ASSERT_TRUE(Listener != nullptr);
+
+  LLVMContext Context;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(DebugModule, Err, Context);
+  ASSERT_TRUE(M != nullptr);
+  std::string Error;
+  std::unique_ptr<ExecutionEngine> TheJIT(
+      EngineBuilder(std::move(M))
+          .setEngineKind(EngineKind::JIT)
+          .setMCJITMemoryManager(llvm::make_unique<SectionMemoryManager>())
+          .setErrorStr(&Error)
+          .create());
+  ASSERT_TRUE(TheJIT != nullptr) << Error;
+  TheJIT->RegisterJITEventListener(Listener.get());
+  uint64_t Addr = TheJIT->getFunctionAddress("jitted_answer");
+  ASSERT_NE(0u, Addr);
+  EXPECT_EQ(42, ((int (*)())Addr)());
+  TheJIT->UnregisterJITEventListener(Listener.get());
+  TheJIT.reset();
+  Listener.reset();
+
+  // The map has a "start size name" line for the function.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Map =
+      MemoryBuffer::getFile(MapPath);
+  ASSERT_TRUE(bool(Map));
+  SmallVector<StringRef, 4> Lines;
+  (*Map)->getBuffer().split(Lines, "\n", -1, false);
+  bool FoundInMap = false;
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Start = Line.split(' ');
+    std::pair<StringRef, StringRef> Size = Start.second.split(' ');
+    if (Size.second != "jitted_answer")
+      continue;
+    uint64_t MapAddr, MapSize;
+    ASSERT_FALSE(Start.first.getAsInteger(16, MapAddr));
+    ASSERT_FALSE(Size.first.getAsInteger(16, MapSize));
+    EXPECT_EQ(Addr, MapAddr);
+    EXPECT_LT(0u, MapSize);
+    FoundInMap = true;
+  }
+  EXPECT_TRUE(FoundInMap);
+
+  // The jitdump has a header, the line table, a copy of the code, and a
+  // close record.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Dump =
+      MemoryBuffer::getFile(DumpPath);
+  ASSERT_TRUE(bool(Dump));
+  const char *Ptr = (*Dump)->getBufferStart();
+  const char *End = (*Dump)->getBufferEnd();
+  ASSERT_LE(40, End - Ptr);
+  EXPECT_EQ(0x4A695444u, read<uint32_t>(Ptr));
+  EXPECT_EQ(1u, read<uint32_t>(Ptr));
+  uint32_t HeaderSize = read<uint32_t>(Ptr);
+  Ptr = (*Dump)->getBufferStart() + HeaderSize;
+
+  bool FoundDebugInfo = false, FoundCode = false, FoundClose = false;
+  while (Ptr < End) {
+    const char *Record = Ptr;
+    ASSERT_LE(16, End - Ptr);
+    uint32_t Id = read<uint32_t>(Ptr);
+    uint32_t Size = read<uint32_t>(Ptr);
+    read<uint64_t>(Ptr); // Timestamp.
+    ASSERT_LE(Size, size_t(End - Record));
+
+    if (Id == 2 && read<uint64_t>(Ptr) == Addr) {
+      // The line table must come before the code it describes.
+      EXPECT_FALSE(FoundCode);
+      // The entries start with the line of the function, and cover the line
+      // of the return.
+      uint64_t NumEntries = read<uint64_t>(Ptr);
+      bool FoundReturnLine = false;
+      for (uint64_t I = 0; I != NumEntries; ++I) {
+        uint64_t LineAddr = read<uint64_t>(Ptr);
+        uint32_t Line = read<uint32_t>(Ptr);
+        read<uint32_t>(Ptr); // Discriminator.
+        StringRef File(Ptr);
+        Ptr += File.size() + 1;
+        EXPECT_TRUE(File.endswith("answer.c"));
+        if (I == 0) {
+          EXPECT_EQ(Addr, LineAddr);
+          EXPECT_EQ(6u, Line);
+        }
+        FoundReturnLine |= Line == 7;
+      }
+      EXPECT_TRUE(FoundReturnLine);
+      FoundDebugInfo = true;
+    } else if (Id == 0) {
+      EXPECT_EQ(uint32_t(::getpid()), read<uint32_t>(Ptr));
+      // The code was compiled on this thread, which is the main thread.
+      EXPECT_EQ(uint32_t(::getpid()), read<uint32_t>(Ptr));
+      uint64_t VMA = read<uint64_t>(Ptr);
+      read<uint64_t>(Ptr); // Code address.
+      uint64_t CodeSize = read<uint64_t>(Ptr);
+      read<uint64_t>(Ptr); // Code index.
+      StringRef Name(Ptr);
+      if (Name == "jitted_answer") {
+        EXPECT_EQ(Addr, VMA);
+        EXPECT_EQ(Size, 16 + 40 + Name.size() + 1 + CodeSize);
+        FoundCode = true;
+      }
+    } else if (Id == 3) {
+      FoundClose = true;
+    }
+    Ptr = Record + Size;
+  }
+  EXPECT_TRUE(FoundDebugInfo);
+  EXPECT_TRUE(FoundCode);
+  EXPECT_TRUE(FoundClose);
+
+  Map->reset();
+  Dump->reset();
+  ASSERT_FALSE(sys::fs::remove(MapPath.str()));
+  ASSERT_FALSE(sys::fs::remove(DumpPath.str()));
+  ASSERT_FALSE(sys::fs::remove(Dir.str()));
+}
+
+#endif // defined(__linux__)
+
+} // end anonymous namespace
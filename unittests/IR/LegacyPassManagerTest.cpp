@@ -33,8 +33,14 @@
 #include "llvm/IR/Verifier.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
 
 using namespace llvm;
 
@@ -44,6 +50,7 @@ namespace llvm {
   void initializeCGPassPass(PassRegistry&);
   void initializeLPassPass(PassRegistry&);
   void initializeBPassPass(PassRegistry&);
+  void initializeConcurrentFPassPass(PassRegistry&);
 
   namespace {
     // ND = no deps
@@ -382,6 +389,104 @@ namespace llvm {
 
     }
 
+    // Records the functions it runs on, along with their number of loops, and
+    // the pass instances that ran.
+    struct ConcurrentFPass : public FunctionPass {
+    public:
+      static char ID;
+      static bool ThreadSafe;
+      static std::mutex Lock;
+      static std::condition_variable InstancesChanged;
+      static std::map<const Function *, unsigned> NumLoops;
+      static std::set<const Pass *> Instances;
+      ConcurrentFPass() : FunctionPass(ID) {
+        initializeConcurrentFPassPass(*PassRegistry::getPassRegistry());
+      }
+      bool runOnFunction(Function &F) override {
+        LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+        unsigned N = std::distance(LI.begin(), LI.end());
+        std::unique_lock<std::mutex> Guard(Lock);
+        EXPECT_TRUE(NumLoops.insert(std::make_pair(&F, N)).second);
+        Instances.insert(this);
+        // Hold the first instance until another one has started, so that the
+        // calling thread cannot run all the functions by itself before the
+        // other threads get going.
+        if (ThreadSafe && llvm_is_multithreaded()) {
+          InstancesChanged.notify_all();
+          InstancesChanged.wait_for(Guard, std::chrono::seconds(10),
+                                    [] { return Instances.size() > 1; });
+        }
+        return false;
+      }
+      bool isThreadSafe() const override { return ThreadSafe; }
+      void getAnalysisUsage(AnalysisUsage &AU) const override {
+        AU.addRequired<LoopInfoWrapperPass>();
+        AU.setPreservesAll();
+      }
+    };
+    char ConcurrentFPass::ID=0;
+    bool ConcurrentFPass::ThreadSafe=false;
+    std::mutex ConcurrentFPass::Lock;
+    std::condition_variable ConcurrentFPass::InstancesChanged;
+    std::map<const Function *, unsigned> ConcurrentFPass::NumLoops;
+    std::set<const Pass *> ConcurrentFPass::Instances;
+
+    // Build a module where only the functions with an even index have a loop.
+    static void makeLoopModule(Module &M, unsigned NumFunctions) {
+      LLVMContext &Context = M.getContext();
+      FunctionType *FTy = FunctionType::get(Type::getVoidTy(Context),
+                                            Type::getInt1Ty(Context), false);
+      for (unsigned I = 0; I != NumFunctions; ++I) {
+        Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage,
+                                       "f" + Twine(I), &M);
+        BasicBlock *Entry = BasicBlock::Create(Context, "entry", F);
+        BasicBlock *Body = BasicBlock::Create(Context, "body", F);
+        BasicBlock *Exit = BasicBlock::Create(Context, "exit", F);
+        BranchInst::Create(Body, Entry);
+        if (I % 2 == 0)
+          BranchInst::Create(Body, Exit, F->arg_begin(), Body);
+        else
+          BranchInst::Create(Exit, Body);
+        ReturnInst::Create(Context, Exit);
+      }
+    }
+
+    static void runConcurrentFPass(bool ThreadSafe) {
+      LLVMContext Context;
+      Module M("test-concurrent", Context);
+      makeLoopModule(M, 256);
+      ConcurrentFPass::ThreadSafe = ThreadSafe;
+      ConcurrentFPass::NumLoops.clear();
+      ConcurrentFPass::Instances.clear();
+
+      legacy::PassManager Passes;
+      Passes.setFunctionPassThreads(4);
+      Passes.add(new ConcurrentFPass());
+      Passes.run(M);
+
+      // Every function must have been processed exactly once, with the loop
+      // information of that function.
+      EXPECT_EQ(256u, ConcurrentFPass::NumLoops.size());
+      unsigned I = 0;
+      for (const Function &F : M)
+        EXPECT_EQ(I++ % 2 == 0 ? 1u : 0u, ConcurrentFPass::NumLoops[&F]);
+    }
+
+    TEST(PassManager, ConcurrentFunctionPasses) {
+      {
+        SCOPED_TRACE("Thread safe pass");
+        runConcurrentFPass(true);
+        EXPECT_GE(4u, ConcurrentFPass::Instances.size());
+        if (llvm_is_multithreaded())
+          EXPECT_LT(1u, ConcurrentFPass::Instances.size());
+      }
+      {
+        SCOPED_TRACE("Pass that is not thread safe");
+        runConcurrentFPass(false);
+        EXPECT_EQ(1u, ConcurrentFPass::Instances.size());
+      }
+    }
+
     TEST(PassManager, MemoryOnTheFly) {
       Module *M = makeLLVMModule();
       {
@@ -546,3 +651,6 @@ INITIALIZE_PASS_BEGIN(LPass, "lp","lp", false, false)
 INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_END(LPass, "lp","lp", false, false)
 INITIALIZE_PASS(BPass, "bp","bp", false, false)
+INITIALIZE_PASS_BEGIN(ConcurrentFPass, "cfp","cfp", false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_END(ConcurrentFPass, "cfp","cfp", false, false)
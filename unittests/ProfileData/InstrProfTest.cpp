@@ -95,4 +95,56 @@ TEST_F(InstrProfTest, get_max_function_count) {
   ASSERT_EQ(1ULL << 63, Reader->getMaximumFunctionCount());
 }
 
+TEST_F(InstrProfTest, get_weighted_function_counts) {
+  Writer.addFunctionCounts("foo", 0x1234, {1, 2}, 3);
+  Writer.addFunctionCounts("foo", 0x1234, {1, 2});
+  ASSERT_TRUE(ErrorEquals(
+      instrprof_error::counter_overflow,
+      Writer.addFunctionCounts("bar", 0, {1ULL << 62}, 4)));
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  std::vector<uint64_t> Counts;
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x1234, Counts)));
+  ASSERT_EQ(2U, Counts.size());
+  ASSERT_EQ(4U, Counts[0]);
+  ASSERT_EQ(8U, Counts[1]);
+  ASSERT_EQ(4U, Reader->getMaximumFunctionCount());
+}
+
+TEST_F(InstrProfTest, merge_records_from_writer) {
+  Writer.addFunctionCounts("foo", 0x1234, {1, 2});
+  Writer.addFunctionCounts("bar", 0, {3});
+  InstrProfWriter Other;
+  Other.addFunctionCounts("foo", 0x1234, {10, 20});
+  Other.addFunctionCounts("foo", 0x5678, {5});
+  Other.addFunctionCounts("bar", 0, {1, 2});
+  Other.addFunctionCounts("baz", 0, {100});
+
+  std::vector<std::string> Warned;
+  Writer.mergeRecordsFromWriter(
+      std::move(Other), [&](StringRef Name, std::error_code EC) {
+        ASSERT_TRUE(ErrorEquals(instrprof_error::count_mismatch, EC));
+        Warned.push_back(Name);
+      });
+  ASSERT_EQ(1U, Warned.size());
+  ASSERT_EQ("bar", Warned[0]);
+
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  std::vector<uint64_t> Counts;
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x1234, Counts)));
+  ASSERT_EQ(11U, Counts[0]);
+  ASSERT_EQ(22U, Counts[1]);
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x5678, Counts)));
+  ASSERT_EQ(5U, Counts[0]);
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("bar", 0, Counts)));
+  ASSERT_EQ(1U, Counts.size());
+  ASSERT_EQ(3U, Counts[0]);
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("baz", 0, Counts)));
+  ASSERT_EQ(100U, Counts[0]);
+  ASSERT_EQ(100U, Reader->getMaximumFunctionCount());
+}
+
 } // end anonymous namespace
@@ -59,6 +59,43 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestChunkedCompression(StringRef Input, size_t ChunkSize,
+                            size_t WriteSize) {
+  SmallString<32> Compressed;
+  zlib::ChunkedCompressor Compressor(Compressed, zlib::DefaultCompression,
+                                     ChunkSize);
+  for (size_t I = 0; I < Input.size(); I += WriteSize)
+    Compressor.write(Input.substr(I, WriteSize));
+  EXPECT_EQ(Input.size(), Compressor.getUncompressedSize());
+  EXPECT_EQ(zlib::StatusOK, Compressor.finish());
+
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Compressed, Uncompressed, Input.size()));
+  EXPECT_EQ(Input, Uncompressed);
+
+  // The output doesn't depend on how the data was written.
+  SmallString<32> Compressed2;
+  zlib::ChunkedCompressor Compressor2(Compressed2, zlib::DefaultCompression,
+                                      ChunkSize);
+  Compressor2.write(Input);
+  EXPECT_EQ(zlib::StatusOK, Compressor2.finish());
+  EXPECT_EQ(Compressed, Compressed2);
+}
+
+TEST(CompressionTest, ZlibChunked) {
+  TestChunkedCompression("", 16, 1);
+  TestChunkedCompression("hello, world!", 4, 3);
+
+  std::string Data;
+  for (size_t I = 0; I != 100000; ++I)
+    Data += "abcdefghijklmnopqrstuvwxyz"[(I * I + I / 7) % 26];
+  TestChunkedCompression(Data, 64, 1000);
+  TestChunkedCompression(Data, 1000, 64);
+  TestChunkedCompression(Data, 4096, Data.size());
+  TestChunkedCompression(Data, 1 << 20, 4096);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -11,6 +11,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
@@ -111,4 +112,84 @@ TEST(FileOutputBuffer, Test) {
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+static std::string readFile(StringRef Path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf = MemoryBuffer::getFile(Path);
+  if (!Buf)
+    return "";
+  return (*Buf)->getBuffer();
+}
+
+TEST(FileOutputBuffer, MappedStream) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-test", TestDirectory));
+  SmallString<128> File(TestDirectory);
+  File.append("/file");
+  std::string Big(5000, 'x');
+
+  // The output fits into the reservation exactly and is written in place;
+  // pwrite patches bytes written before the reservation.
+  {
+    raw_mapped_file_ostream OS(File);
+    OS << "head";
+    OS.reserveExtraSpace(4 + Big.size());
+    OS << "body" << Big;
+    OS.pwrite("HE", 2, 0);
+    EXPECT_EQ(8 + Big.size(), OS.tell());
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  EXPECT_EQ("HEadbody" + Big, readFile(File));
+
+  // The output overflows the reservation.
+  {
+    raw_mapped_file_ostream OS(File);
+    OS.reserveExtraSpace(6);
+    OS << "abc" << Big << "def";
+    OS.pwrite("12345678", 8, 2);
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  EXPECT_EQ("ab12345678" + Big.substr(7) + "def", readFile(File));
+
+  // The output is smaller than the reservation.
+  {
+    raw_mapped_file_ostream OS(File);
+    OS.reserveExtraSpace(100);
+    OS << "small";
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  EXPECT_EQ("small", readFile(File));
+
+  // Nothing is reserved.
+  {
+    raw_mapped_file_ostream OS(File);
+    OS << Big << "end";
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  EXPECT_EQ(Big + "end", readFile(File));
+
+  // The file is not written if the stream is not committed.
+  ASSERT_NO_ERROR(fs::remove(File.str()));
+  {
+    raw_mapped_file_ostream OS(File);
+    OS.reserveExtraSpace(4);
+    OS << "lost";
+  }
+  EXPECT_FALSE(fs::exists(Twine(File)));
+
+  EXPECT_TRUE(raw_mapped_file_ostream::isMappable(File));
+  EXPECT_FALSE(raw_mapped_file_ostream::isMappable(TestDirectory));
+
+#if defined(LLVM_ON_UNIX)
+  // Writing through a symlink must not replace the link itself.
+  SmallString<128> Link(TestDirectory);
+  path::append(Link, "link");
+  ASSERT_NO_ERROR(fs::create_link(Twine(File), Twine(Link)));
+  EXPECT_FALSE(raw_mapped_file_ostream::isMappable(Link));
+  ASSERT_NO_ERROR(fs::remove(Link.str()));
+#endif
+
+  // Clean up.
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
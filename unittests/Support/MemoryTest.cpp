@@ -347,6 +347,27 @@ TEST_P(MappedMemoryTest, UnalignedNear) {
   EXPECT_FALSE(Memory::releaseMappedMemory(M1));
 }
 
+TEST_P(MappedMemoryTest, HugePageHint) {
+  // The hint must not change the protection or the usable size of the block.
+  std::error_code EC;
+  const size_t Size = 4 * 1024 * 1024 + 15;
+  MemoryBlock M1 = Memory::allocateMappedMemory(
+      Size, nullptr, Flags | Memory::MF_HUGE_HINT, EC);
+  EXPECT_EQ(std::error_code(), EC);
+
+  EXPECT_NE((void*)nullptr, M1.base());
+  EXPECT_LE(Size, M1.size());
+  EXPECT_FALSE(Memory::protectMappedMemory(M1, getTestableEquivalent(Flags)));
+
+  unsigned char *Bytes = (unsigned char *)M1.base();
+  Bytes[0] = 1;
+  Bytes[Size - 1] = 2;
+  EXPECT_EQ(1, Bytes[0]);
+  EXPECT_EQ(2, Bytes[Size - 1]);
+
+  EXPECT_FALSE(Memory::releaseMappedMemory(M1));
+}
+
 // Note that Memory::MF_WRITE is not supported exclusively across
 // operating systems and architectures and can imply MF_READ|MF_WRITE
 unsigned MemoryFlags[] = {
@@ -0,0 +1,113 @@
+//===- llvm/unittest/Support/ParallelTest.cpp - Parallel algorithm tests --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <random>
+#include <utility>
+
+using namespace llvm;
+
+namespace {
+
+TEST(Parallel, ForEach) {
+  std::vector<unsigned> Values(100000);
+  for (unsigned I = 0, E = Values.size(); I != E; ++I)
+    Values[I] = I;
+  parallel_for_each(Values, [](unsigned &V) { V *= 2; });
+  for (unsigned I = 0, E = Values.size(); I != E; ++I)
+    ASSERT_EQ(2 * I, Values[I]);
+}
+
+TEST(Parallel, ForEmptyAndSmallRanges) {
+  std::atomic<unsigned> Count(0);
+  parallel_for(0u, 0u, [&](unsigned) { ++Count; });
+  EXPECT_EQ(0u, Count);
+  parallel_for(5u, 3u, [&](unsigned) { ++Count; });
+  EXPECT_EQ(0u, Count);
+  parallel_for(3u, 10u, [&](unsigned) { ++Count; });
+  EXPECT_EQ(7u, Count);
+}
+
+TEST(Parallel, ForEachTask) {
+  std::vector<unsigned> Calls(10);
+  parallel_for_each_task(2u, 10u, [&](unsigned I) { ++Calls[I]; });
+  for (unsigned I = 0; I != 10; ++I)
+    EXPECT_EQ(I >= 2 ? 1u : 0u, Calls[I]);
+  std::atomic<unsigned> Count(0);
+  parallel_for_each_task(3u, 3u, [&](unsigned) { ++Count; });
+  EXPECT_EQ(0u, Count);
+}
+
+TEST(Parallel, Nested) {
+  std::atomic<unsigned> Count(0);
+  parallel_for(0u, 4096u, [&](unsigned) {
+    parallel_for(0u, 2048u, [&](unsigned) { ++Count; });
+  });
+  EXPECT_EQ(4096u * 2048u, Count);
+}
+
+TEST(Parallel, Sort) {
+  std::mt19937 Rand(0);
+  std::vector<unsigned> Values(100000);
+  for (unsigned &V : Values)
+    V = Rand();
+  std::vector<unsigned> Expected = Values;
+  std::sort(Expected.begin(), Expected.end());
+  parallel_sort(Values.begin(), Values.end());
+  EXPECT_EQ(Expected, Values);
+}
+
+TEST(Parallel, SortIsStable) {
+  // Sort on the first member only; the second one records the original
+  // position, so any reordering of equal keys shows up in the comparison.
+  typedef std::pair<unsigned, unsigned> Entry;
+  std::mt19937 Rand(0);
+  std::vector<Entry> Values;
+  for (unsigned I = 0; I != 50000; ++I)
+    Values.push_back(Entry(Rand() % 64, I));
+  auto Comp = [](const Entry &A, const Entry &B) { return A.first < B.first; };
+  std::vector<Entry> Expected = Values;
+  std::stable_sort(Expected.begin(), Expected.end(), Comp);
+  parallel_sort(Values.begin(), Values.end(), Comp);
+  EXPECT_EQ(Expected, Values);
+}
+
+TEST(Parallel, TransformReduce) {
+  std::vector<unsigned> Values(100000);
+  for (unsigned I = 0, E = Values.size(); I != E; ++I)
+    Values[I] = I;
+  uint64_t Sum = parallel_transform_reduce(
+      Values, uint64_t(1), [](uint64_t A, uint64_t B) { return A + B; },
+      [](unsigned V) { return uint64_t(V) * 3; });
+  EXPECT_EQ(1 + 3 * (uint64_t(99999) * 100000 / 2), Sum);
+
+  std::vector<unsigned> Empty;
+  EXPECT_EQ(42u, parallel_transform_reduce(
+                     Empty, 42u, [](unsigned A, unsigned B) { return A + B; },
+                     [](unsigned V) { return V; }));
+}
+
+TEST(Parallel, TransformReduceIsDeterministic) {
+  // Floating point additions are not associative, so the result depends on
+  // how the partial sums are grouped. It must be the same on every run.
+  std::mt19937 Rand(0);
+  std::uniform_real_distribution<double> Dist(-1e6, 1e6);
+  std::vector<double> Values(100000);
+  for (double &V : Values)
+    V = Dist(Rand);
+  auto Add = [](double A, double B) { return A + B; };
+  auto Identity = [](double V) { return V; };
+  double First = parallel_transform_reduce(Values, 0.0, Add, Identity);
+  for (unsigned I = 0; I != 10; ++I)
+    EXPECT_EQ(First, parallel_transform_reduce(Values, 0.0, Add, Identity));
+}
+
+} // end anonymous namespace
@@ -419,6 +419,17 @@ TEST_F(FileSystemTest, TempFiles) {
   ASSERT_NO_ERROR(fs::status(Twine(TempPath2), B));
   EXPECT_TRUE(fs::equivalent(A, B));
 
+  // create_link makes a symbolic link on Unix and a hard link on Windows.
+  bool IsLink;
+  ASSERT_NO_ERROR(fs::is_symlink(Twine(TempPath), IsLink));
+  EXPECT_FALSE(IsLink);
+  ASSERT_NO_ERROR(fs::is_symlink(Twine(TempPath2), IsLink));
+#ifdef LLVM_ON_UNIX
+  EXPECT_TRUE(IsLink);
+#else
+  EXPECT_FALSE(IsLink);
+#endif
+
   // Remove Temp1.
   ::close(FileDescriptor);
   ASSERT_NO_ERROR(fs::remove(Twine(TempPath)));